@@ -4,4 +4,19 @@
 #define DXL_1_INIT_POS (uint32_t)2048
 #define DXL_2_INIT_POS (uint32_t)2000
 
+// IMU calibration begin (generated by tools/imu_calibration.py)
+// Nominal values: not yet calibrated
+#define IMU_AXES_ALIGNMENT FusionAxesAlignmentPXPYPZ
+#define IMU_GYRO_MISALIGNMENT {.array = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}}
+#define IMU_GYRO_SENSITIVITY {.axis = {7.62939453e-03f, 7.62939453e-03f, 7.62939453e-03f}} // [dps/LSB]
+#define IMU_GYRO_OFFSET {.axis = {0.0f, 0.0f, 0.0f}}                                       // [LSB]
+#define IMU_ACCEL_MISALIGNMENT {.array = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}}
+#define IMU_ACCEL_SENSITIVITY {.axis = {6.10351562e-05f, 6.10351562e-05f, 6.10351562e-05f}} // [g/LSB]
+#define IMU_ACCEL_OFFSET {.axis = {0.0f, 0.0f, 0.0f}}                                        // [LSB]
+// IMU calibration end
+
+// Motor vibration frequency per unit of motor command (-100 ~ +100), used to
+// narrow the accelerometer notch search; 0.0f searches the full band
+#define MOTOR_VIBRATION_HZ_PER_COMMAND 0.0f
+
 #endif
@@ -0,0 +1,292 @@
+/**
+ * @file adaptive_notch.c
+ * @brief Notch filter that follows the dominant vibration frequency of a
+ * multi-axis signal.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "adaptive_notch.h"
+#include <math.h>   // cosf, sqrtf, fabsf, lroundf
+#include <string.h> // memset
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Goertzel coefficients are Q14, so 2 cos(omega) fits in an int32_t
+ * and the product with a state needs a 64-bit intermediate.
+ */
+#define COEFFICIENT_Q (14)
+
+/**
+ * @brief A peak must exceed the mean bin power by this ratio to be notched.
+ */
+#define PEAK_RATIO (8.0f)
+
+/**
+ * @brief Weight of a new estimate in the smoothed frequency.
+ */
+#define SMOOTHING (0.3f)
+
+/**
+ * @brief The notch is retuned once the smoothed estimate moves by more than
+ * this fraction of the notched frequency.
+ */
+#define RETUNE_FRACTION (0.01f)
+
+/**
+ * @brief Blocks without a peak before the notch is switched off.
+ */
+#define HOLD_BLOCKS (5)
+
+/**
+ * @brief Highest notch frequency as a fraction of the sample rate.
+ */
+#define MAX_FRACTION (0.45f)
+
+#ifndef M_PI
+#define M_PI (3.14159265358979323846)
+#endif
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+static void configure_bins(adaptive_notch_t *const notch, float low_hz, float high_hz);
+static void estimate(adaptive_notch_t *const notch);
+static void tune(adaptive_notch_t *const notch, const float frequency_hz);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises the adaptive notch.  The notch is off until a peak is
+ * found.
+ * @param notch Adaptive notch structure.
+ * @param settings Settings.
+ * @param axes Number of axes, at most ADAPTIVE_NOTCH_MAX_AXES.
+ */
+void adaptive_notch_init(adaptive_notch_t *const notch, const adaptive_notch_settings_t *const settings,
+                         const uint8_t axes)
+{
+    memset(notch, 0, sizeof(*notch));
+    notch->settings = *settings;
+    notch->axes = (axes < ADAPTIVE_NOTCH_MAX_AXES) ? axes : ADAPTIVE_NOTCH_MAX_AXES;
+    filter_bank_init(&notch->bank, notch->axes);
+    configure_bins(notch, settings->min_hz, settings->max_hz);
+}
+
+/**
+ * @brief Narrows the search band around an expected vibration frequency, e.g.
+ * one derived from the motor command.  The estimate still comes from the
+ * Goertzel bins, so a wrong hint cannot notch a frequency that is not present.
+ * @param notch Adaptive notch structure.
+ * @param hint_hz Expected frequency in Hz, or zero to search the full band.
+ */
+void adaptive_notch_set_hint(adaptive_notch_t *const notch, const float hint_hz)
+{
+    if (hint_hz <= 0.0f)
+    {
+        if (notch->hint_hz > 0.0f)
+        {
+            notch->hint_hz = 0.0f;
+            configure_bins(notch, notch->settings.min_hz, notch->settings.max_hz);
+        }
+        return;
+    }
+    // Keep the block running unless the hint leaves the middle of the current band
+    if (fabsf(hint_hz - notch->hint_hz) < 0.25f * notch->settings.hint_span_hz)
+    {
+        return;
+    }
+    notch->hint_hz = hint_hz;
+    configure_bins(notch, hint_hz - notch->settings.hint_span_hz, hint_hz + notch->settings.hint_span_hz);
+}
+
+/**
+ * @brief Filters one sample of every axis and updates the frequency estimate.
+ * The results are read with adaptive_notch_output().
+ * @param notch Adaptive notch structure.
+ * @param input One integer sample per axis.
+ */
+void adaptive_notch_update(adaptive_notch_t *const notch, const int32_t *const input)
+{
+    filter_bank_update(&notch->bank, input);
+
+    for (uint8_t axis = 0; axis < notch->axes; axis++)
+    {
+        const int32_t x = input[axis];
+        for (uint8_t bin = 0; bin < ADAPTIVE_NOTCH_BINS; bin++)
+        {
+            const int32_t s =
+                x + (int32_t)(((int64_t)notch->coefficient[bin] * notch->s1[axis][bin]) >> COEFFICIENT_Q) -
+                notch->s2[axis][bin];
+            notch->s2[axis][bin] = notch->s1[axis][bin];
+            notch->s1[axis][bin] = s;
+        }
+    }
+
+    if (++notch->sample_count >= notch->block_length)
+    {
+        estimate(notch);
+        memset(notch->s1, 0, sizeof(notch->s1));
+        memset(notch->s2, 0, sizeof(notch->s2));
+        notch->sample_count = 0;
+    }
+}
+
+/**
+ * @brief Returns the notched frequency.
+ * @param notch Adaptive notch structure.
+ * @return Frequency in Hz, or zero while the notch is off.
+ */
+float adaptive_notch_get_frequency(const adaptive_notch_t *const notch)
+{
+    return notch->frequency_hz;
+}
+
+/**
+ * @brief Places the bins on consecutive DFT bins of a block whose bin spacing
+ * spreads them over the band, so the block length follows the band width.
+ */
+static void configure_bins(adaptive_notch_t *const notch, float low_hz, float high_hz)
+{
+    const float sample_hz = notch->settings.sample_hz;
+    if (high_hz > MAX_FRACTION * sample_hz)
+    {
+        high_hz = MAX_FRACTION * sample_hz;
+    }
+    if (low_hz < 1.0f)
+    {
+        low_hz = 1.0f;
+    }
+    if (high_hz <= low_hz)
+    {
+        high_hz = low_hz + 1.0f;
+    }
+
+    long length = lroundf(sample_hz * (float)(ADAPTIVE_NOTCH_BINS - 1) / (high_hz - low_hz));
+    if (length < 2 * (ADAPTIVE_NOTCH_BINS + 1))
+    {
+        length = 2 * (ADAPTIVE_NOTCH_BINS + 1);
+    }
+    if (length > ADAPTIVE_NOTCH_MAX_BLOCK)
+    {
+        length = ADAPTIVE_NOTCH_MAX_BLOCK;
+    }
+    long first = lroundf(low_hz * (float)length / sample_hz);
+    if (first + ADAPTIVE_NOTCH_BINS > length / 2)
+    {
+        first = length / 2 - ADAPTIVE_NOTCH_BINS;
+    }
+    if (first < 1)
+    {
+        first = 1;
+    }
+
+    notch->block_length = (uint16_t)length;
+    notch->first_bin = (uint16_t)first;
+    for (uint8_t bin = 0; bin < ADAPTIVE_NOTCH_BINS; bin++)
+    {
+        const float omega = 2.0f * (float)M_PI * (float)(first + bin) / (float)length;
+        notch->coefficient[bin] = (int32_t)lroundf(2.0f * cosf(omega) * (float)(1 << COEFFICIENT_Q));
+    }
+    memset(notch->s1, 0, sizeof(notch->s1));
+    memset(notch->s2, 0, sizeof(notch->s2));
+    notch->sample_count = 0;
+}
+
+/**
+ * @brief Picks the strongest bin at the end of a block, interpolates the
+ * frequency between its neighbours and retunes the notch.
+ */
+static void estimate(adaptive_notch_t *const notch)
+{
+    float magnitude[ADAPTIVE_NOTCH_BINS];
+    float total = 0.0f;
+    uint8_t peak = 0;
+    for (uint8_t bin = 0; bin < ADAPTIVE_NOTCH_BINS; bin++)
+    {
+        const float coefficient = (float)notch->coefficient[bin] * (1.0f / (float)(1 << COEFFICIENT_Q));
+        float power = 0.0f;
+        for (uint8_t axis = 0; axis < notch->axes; axis++)
+        {
+            const float s1 = (float)notch->s1[axis][bin];
+            const float s2 = (float)notch->s2[axis][bin];
+            power += s1 * s1 + s2 * s2 - coefficient * s1 * s2;
+        }
+        total += power;
+        magnitude[bin] = sqrtf(fabsf(power));
+        if (magnitude[bin] > magnitude[peak])
+        {
+            peak = bin;
+        }
+    }
+
+    // Amplitude of a sinusoid is 2 |X| / N
+    const float amplitude = 2.0f * magnitude[peak] / (float)notch->block_length;
+    const float peakPower = magnitude[peak] * magnitude[peak];
+    if ((amplitude < notch->settings.min_amplitude) || (peakPower < PEAK_RATIO * total / (float)ADAPTIVE_NOTCH_BINS))
+    {
+        if ((notch->frequency_hz > 0.0f) && (++notch->missed_blocks >= HOLD_BLOCKS))
+        {
+            tune(notch, 0.0f);
+        }
+        return;
+    }
+    notch->missed_blocks = 0;
+
+    // Rife interpolation, exact for a tone under the rectangular window of a block
+    const float left = (peak > 0) ? magnitude[peak - 1] : 0.0f;
+    const float right = (peak < ADAPTIVE_NOTCH_BINS - 1) ? magnitude[peak + 1] : 0.0f;
+    const float delta = (right > left) ? right / (magnitude[peak] + right) : -left / (magnitude[peak] + left);
+    const float binHz = notch->settings.sample_hz / (float)notch->block_length;
+    const float measured = ((float)(notch->first_bin + peak) + delta) * binHz;
+
+    // Smooth small changes, follow jumps of more than two bins immediately
+    if ((notch->frequency_hz <= 0.0f) || (fabsf(measured - notch->frequency_hz) > 2.0f * binHz))
+    {
+        tune(notch, measured);
+        return;
+    }
+    const float smoothed = notch->frequency_hz + SMOOTHING * (measured - notch->frequency_hz);
+    if (fabsf(smoothed - notch->frequency_hz) > RETUNE_FRACTION * notch->frequency_hz)
+    {
+        tune(notch, smoothed);
+    }
+}
+
+/**
+ * @brief Sets the notch sections of every axis to a frequency, or removes
+ * them if the frequency is zero.
+ */
+static void tune(adaptive_notch_t *const notch, const float frequency_hz)
+{
+    const adaptive_notch_settings_t *const settings = &notch->settings;
+    const bool harmonic = settings->harmonic && (2.0f * frequency_hz < MAX_FRACTION * settings->sample_hz);
+    for (uint8_t axis = 0; axis < notch->axes; axis++)
+    {
+        if (frequency_hz > 0.0f)
+        {
+            filter_bank_set_notch(&notch->bank, axis, 0, frequency_hz, settings->q, settings->sample_hz);
+        }
+        else
+        {
+            filter_bank_clear_section(&notch->bank, axis, 0);
+        }
+        if ((frequency_hz > 0.0f) && harmonic)
+        {
+            filter_bank_set_notch(&notch->bank, axis, 1, 2.0f * frequency_hz, settings->q, settings->sample_hz);
+        }
+        else
+        {
+            filter_bank_clear_section(&notch->bank, axis, 1);
+        }
+    }
+    notch->frequency_hz = frequency_hz;
+    notch->missed_blocks = 0;
+}
+
+//------------------------------------------------------------------------------
+// End of file
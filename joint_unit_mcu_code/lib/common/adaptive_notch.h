@@ -0,0 +1,90 @@
+/**
+ * @file adaptive_notch.h
+ * @brief Notch filter that follows the dominant vibration frequency of a
+ * multi-axis signal.  A bank of integer Goertzel bins estimates the frequency
+ * once per block, optionally narrowed around a hint such as the frequency
+ * implied by the motor command, and the notch sections of a filter_bank_t are
+ * retuned to it.
+ */
+
+#ifndef _ADAPTIVE_NOTCH_H_
+#define _ADAPTIVE_NOTCH_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "filter_bank.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Maximum number of axes, Goertzel bins and samples per block.
+ */
+#define ADAPTIVE_NOTCH_MAX_AXES (3)
+#define ADAPTIVE_NOTCH_BINS (16)
+#define ADAPTIVE_NOTCH_MAX_BLOCK (512)
+
+/**
+ * @brief Adaptive notch settings.
+ */
+typedef struct
+{
+    float sample_hz;     // sample rate of adaptive_notch_update()
+    float min_hz;        // search band without a hint
+    float max_hz;        // search band without a hint, below sample_hz / 2
+    float q;             // notch quality factor
+    float hint_span_hz;  // search band is hint +/- hint_span_hz when a hint is set
+    float min_amplitude; // smallest vibration amplitude, in input units, that is notched
+    bool harmonic;       // also notch twice the estimated frequency
+} adaptive_notch_settings_t;
+
+/**
+ * @brief Adaptive notch structure.  Structure members are used internally and
+ * must not be accessed by the application.
+ */
+typedef struct
+{
+    adaptive_notch_settings_t settings;
+    uint8_t axes;
+    filter_bank_t bank;
+    float hint_hz;
+    uint16_t block_length;
+    uint16_t sample_count;
+    uint16_t first_bin;
+    int32_t coefficient[ADAPTIVE_NOTCH_BINS]; // 2 cos(omega) in Q14
+    int32_t s1[ADAPTIVE_NOTCH_MAX_AXES][ADAPTIVE_NOTCH_BINS];
+    int32_t s2[ADAPTIVE_NOTCH_MAX_AXES][ADAPTIVE_NOTCH_BINS];
+    float frequency_hz; // notched frequency, zero while the notch is off
+    uint8_t missed_blocks;
+} adaptive_notch_t;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+void adaptive_notch_init(adaptive_notch_t *const notch, const adaptive_notch_settings_t *const settings,
+                         const uint8_t axes);
+void adaptive_notch_set_hint(adaptive_notch_t *const notch, const float hint_hz);
+void adaptive_notch_update(adaptive_notch_t *const notch, const int32_t *const input);
+float adaptive_notch_get_frequency(const adaptive_notch_t *const notch);
+
+//------------------------------------------------------------------------------
+// Inline functions
+
+/**
+ * @brief Returns the latest notched output of an axis.
+ * @param notch Adaptive notch structure.
+ * @param axis Axis index.
+ * @return Notched output, with the fraction bits kept.
+ */
+static inline float adaptive_notch_output(const adaptive_notch_t *const notch, const uint8_t axis)
+{
+    return filter_bank_output_float(&notch->bank, axis);
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
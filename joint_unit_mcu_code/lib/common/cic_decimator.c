@@ -0,0 +1,83 @@
+/**
+ * @file cic_decimator.c
+ * @brief Multi-channel cascaded integrator-comb decimator.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "cic_decimator.h"
+#include <string.h> // memset
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises the decimator with zero state.
+ * @param decimator CIC decimator structure.
+ * @param channels Number of channels, at most CIC_DECIMATOR_MAX_CHANNELS.
+ * @param ratio Input samples per output, 1 to CIC_DECIMATOR_MAX_RATIO.
+ * @return False if an argument is out of range.
+ */
+bool cic_decimator_init(cic_decimator_t *const decimator, const uint8_t channels, const uint16_t ratio)
+{
+    if ((channels == 0) || (channels > CIC_DECIMATOR_MAX_CHANNELS) || (ratio == 0) ||
+        (ratio > CIC_DECIMATOR_MAX_RATIO))
+    {
+        return false;
+    }
+    memset(decimator, 0, sizeof(*decimator));
+    decimator->channels = channels;
+    decimator->ratio = ratio;
+    float gain = 1.0f;
+    for (uint8_t stage = 0; stage < CIC_DECIMATOR_ORDER; stage++)
+    {
+        gain /= (float)ratio;
+    }
+    decimator->gain = gain;
+    return true;
+}
+
+/**
+ * @brief Adds one sample of every channel.  The integrators wrap modulo 2^64,
+ * which the combs undo, so they never need to be reset.
+ * @param decimator CIC decimator structure.
+ * @param input One sample per channel.
+ * @return True once every ratio samples, when a new output is available.
+ */
+bool cic_decimator_update(cic_decimator_t *const decimator, const int32_t *const input)
+{
+    for (uint8_t channel = 0; channel < decimator->channels; channel++)
+    {
+        int64_t *const integrator = decimator->integrator[channel];
+        uint64_t sum = (uint64_t)(int64_t)input[channel];
+        for (uint8_t stage = 0; stage < CIC_DECIMATOR_ORDER; stage++)
+        {
+            sum += (uint64_t)integrator[stage];
+            integrator[stage] = (int64_t)sum;
+        }
+    }
+
+    if (++decimator->phase < decimator->ratio)
+    {
+        return false;
+    }
+    decimator->phase = 0;
+
+    for (uint8_t channel = 0; channel < decimator->channels; channel++)
+    {
+        int64_t *const comb = decimator->comb[channel];
+        int64_t value = decimator->integrator[channel][CIC_DECIMATOR_ORDER - 1];
+        for (uint8_t stage = 0; stage < CIC_DECIMATOR_ORDER; stage++)
+        {
+            const int64_t previous = comb[stage];
+            comb[stage] = value;
+            value = (int64_t)((uint64_t)value - (uint64_t)previous);
+        }
+        decimator->output[channel] = (float)value * decimator->gain;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,67 @@
+/**
+ * @file cic_decimator.h
+ * @brief Multi-channel cascaded integrator-comb decimator.  Every input sample
+ * costs CIC_DECIMATOR_ORDER 64-bit additions per channel and the combs only
+ * run once per output, so the ratio can be changed at run time without
+ * designing coefficients.
+ */
+
+#ifndef _CIC_DECIMATOR_H_
+#define _CIC_DECIMATOR_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Maximum number of channels, filter order and decimation ratio.  The
+ * DC gain ratio^order must fit in 64 bits together with the inputs.
+ */
+#define CIC_DECIMATOR_MAX_CHANNELS (10)
+#define CIC_DECIMATOR_ORDER (3)
+#define CIC_DECIMATOR_MAX_RATIO (256)
+
+/**
+ * @brief CIC decimator structure.  Structure members are used internally and
+ * must not be accessed by the application.
+ */
+typedef struct
+{
+    uint8_t channels;
+    uint16_t ratio;
+    uint16_t phase;
+    float gain; // 1 / ratio^order
+    int64_t integrator[CIC_DECIMATOR_MAX_CHANNELS][CIC_DECIMATOR_ORDER];
+    int64_t comb[CIC_DECIMATOR_MAX_CHANNELS][CIC_DECIMATOR_ORDER];
+    float output[CIC_DECIMATOR_MAX_CHANNELS];
+} cic_decimator_t;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+bool cic_decimator_init(cic_decimator_t *const decimator, const uint8_t channels, const uint16_t ratio);
+bool cic_decimator_update(cic_decimator_t *const decimator, const int32_t *const input);
+
+//------------------------------------------------------------------------------
+// Inline functions
+
+/**
+ * @brief Returns the latest output of a channel, in input units.
+ * @param decimator CIC decimator structure.
+ * @param channel Channel index.
+ * @return Decimated output.
+ */
+static inline float cic_decimator_output(const cic_decimator_t *const decimator, const uint8_t channel)
+{
+    return decimator->output[channel];
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,90 @@
+/**
+ * @file fft_q15.c
+ * @brief In-place radix-2 fixed-point FFT on interleaved Q15 complex data.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "fft_q15.h"
+#include "sin_table.h"
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Computes the forward FFT in place, scaled by 1 / 2^log2_points.
+ * @param data 2^log2_points complex values stored as re, im, re, im, ...
+ * @param log2_points Base 2 logarithm of the number of points.
+ */
+void fft_q15(int16_t *const data, const uint8_t log2_points)
+{
+    if ((log2_points < FFT_Q15_MIN_LOG2) || (log2_points > FFT_Q15_MAX_LOG2))
+    {
+        return;
+    }
+    const uint16_t points = (uint16_t)1 << log2_points;
+
+    // Bit-reversed reordering
+    for (uint16_t i = 1, j = 0; i < points; i++)
+    {
+        uint16_t bit = points >> 1;
+        while (j & bit)
+        {
+            j ^= bit;
+            bit >>= 1;
+        }
+        j |= bit;
+        if (i < j)
+        {
+            const int16_t re = data[2 * i];
+            const int16_t im = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = re;
+            data[2 * j + 1] = im;
+        }
+    }
+
+    // Decimation in time butterflies, halving every stage
+    for (uint8_t stage = 1; stage <= log2_points; stage++)
+    {
+        const uint16_t half = (uint16_t)1 << (stage - 1);
+        for (uint16_t k = 0; k < half; k++)
+        {
+            // W = exp(-j 2 pi k / 2^stage)
+            const uint32_t phase = (uint32_t)k << (32 - stage);
+            const int32_t wr = sin_table_cos_q15(phase);
+            const int32_t wi = -sin_table_sin_q15(phase);
+            for (uint16_t a = k; a < points; a += (uint16_t)(2 * half))
+            {
+                const uint16_t b = a + half;
+                const int32_t br = data[2 * b];
+                const int32_t bi = data[2 * b + 1];
+                const int32_t tr = (wr * br - wi * bi + (1 << 14)) >> 15;
+                const int32_t ti = (wr * bi + wi * br + (1 << 14)) >> 15;
+                const int32_t ar = data[2 * a];
+                const int32_t ai = data[2 * a + 1];
+                data[2 * a] = (int16_t)((ar + tr) >> 1);
+                data[2 * a + 1] = (int16_t)((ai + ti) >> 1);
+                data[2 * b] = (int16_t)((ar - tr) >> 1);
+                data[2 * b + 1] = (int16_t)((ai - ti) >> 1);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Returns a coefficient of the periodic Hann window.
+ * @param index Sample index.
+ * @param log2_points Base 2 logarithm of the window length.
+ * @return Window coefficient in Q15.
+ */
+int16_t fft_q15_hann(const uint16_t index, const uint8_t log2_points)
+{
+    const uint32_t phase = (uint32_t)index << (32 - log2_points);
+    return (int16_t)((32767 - (int32_t)sin_table_cos_q15(phase)) >> 1);
+}
+
+//------------------------------------------------------------------------------
+// End of file
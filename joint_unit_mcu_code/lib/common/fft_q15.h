@@ -0,0 +1,35 @@
+/**
+ * @file fft_q15.h
+ * @brief In-place radix-2 fixed-point FFT on interleaved Q15 complex data.
+ * Every stage halves its output, so the result is the DFT divided by the
+ * number of points and cannot overflow.  Twiddle factors come from the
+ * flash-resident sine table, so no twiddle buffer is needed.
+ */
+
+#ifndef _FFT_Q15_H_
+#define _FFT_Q15_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Supported sizes are 2^FFT_Q15_MIN_LOG2 to 2^FFT_Q15_MAX_LOG2 points.
+ */
+#define FFT_Q15_MIN_LOG2 (2)
+#define FFT_Q15_MAX_LOG2 (12)
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+void fft_q15(int16_t *const data, const uint8_t log2_points);
+int16_t fft_q15_hann(const uint16_t index, const uint8_t log2_points);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
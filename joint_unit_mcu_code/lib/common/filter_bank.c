@@ -0,0 +1,197 @@
+/**
+ * @file filter_bank.c
+ * @brief Multi-channel cascade of first-order and biquad sections in Q format.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "filter_bank.h"
+#include <math.h>   // tanf, sinf, cosf
+#include <string.h> // memset
+
+//------------------------------------------------------------------------------
+// Definitions
+
+#define ONE_Q ((int32_t)1 << FILTER_BANK_COEFFICIENT_Q)
+
+#ifndef M_PI
+#define M_PI (3.14159265358979323846)
+#endif
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+static void set_section(filter_bank_t *const bank, const uint8_t channel, const uint8_t section, const float b0,
+                        const float b2, const float a1, const float a2);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises the filter bank with no sections and zero state.
+ * @param bank Filter bank structure.
+ * @param channels Number of channels, at most FILTER_BANK_MAX_CHANNELS.
+ */
+void filter_bank_init(filter_bank_t *const bank, const uint8_t channels)
+{
+    memset(bank, 0, sizeof(*bank));
+    bank->channels = (channels < FILTER_BANK_MAX_CHANNELS) ? channels : FILTER_BANK_MAX_CHANNELS;
+}
+
+/**
+ * @brief Sets a first-order low-pass section (bilinear transform, prewarped).
+ * @param bank Filter bank structure.
+ * @param channel Channel index.
+ * @param section Section index.
+ * @param cutoff_hz -3 dB frequency in Hz, below sample_hz / 2.
+ * @param sample_hz Sample rate in Hz.
+ */
+void filter_bank_set_first_order_low_pass(filter_bank_t *const bank, const uint8_t channel, const uint8_t section,
+                                          const float cutoff_hz, const float sample_hz)
+{
+    const float k = tanf((float)M_PI * cutoff_hz / sample_hz);
+    const float norm = 1.0f / (1.0f + k);
+    set_section(bank, channel, section, k * norm, 0.0f, (k - 1.0f) * norm, 0.0f);
+}
+
+/**
+ * @brief Sets a second-order low-pass section.
+ * @param bank Filter bank structure.
+ * @param channel Channel index.
+ * @param section Section index.
+ * @param cutoff_hz Cutoff frequency in Hz, below sample_hz / 2.
+ * @param q Quality factor, 0.7071 for a Butterworth response.
+ * @param sample_hz Sample rate in Hz.
+ */
+void filter_bank_set_low_pass(filter_bank_t *const bank, const uint8_t channel, const uint8_t section,
+                              const float cutoff_hz, const float q, const float sample_hz)
+{
+    const float omega = 2.0f * (float)M_PI * cutoff_hz / sample_hz;
+    const float cosine = cosf(omega);
+    const float alpha = sinf(omega) / (2.0f * q);
+    const float norm = 1.0f / (1.0f + alpha);
+    const float b = 0.5f * (1.0f - cosine) * norm;
+    set_section(bank, channel, section, b, b, -2.0f * cosine * norm, (1.0f - alpha) * norm);
+}
+
+/**
+ * @brief Sets a notch section.
+ * @param bank Filter bank structure.
+ * @param channel Channel index.
+ * @param section Section index.
+ * @param center_hz Notch frequency in Hz, below sample_hz / 2.
+ * @param q Quality factor, center frequency divided by the -3 dB bandwidth.
+ * @param sample_hz Sample rate in Hz.
+ */
+void filter_bank_set_notch(filter_bank_t *const bank, const uint8_t channel, const uint8_t section,
+                           const float center_hz, const float q, const float sample_hz)
+{
+    const float omega = 2.0f * (float)M_PI * center_hz / sample_hz;
+    const float cosine = cosf(omega);
+    const float alpha = sinf(omega) / (2.0f * q);
+    const float norm = 1.0f / (1.0f + alpha);
+    set_section(bank, channel, section, norm, norm, -2.0f * cosine * norm, (1.0f - alpha) * norm);
+}
+
+/**
+ * @brief Removes a section so that it passes its input through.
+ * @param bank Filter bank structure.
+ * @param channel Channel index.
+ * @param section Section index.
+ */
+void filter_bank_clear_section(filter_bank_t *const bank, const uint8_t channel, const uint8_t section)
+{
+    if ((channel >= FILTER_BANK_MAX_CHANNELS) || (section >= FILTER_BANK_MAX_SECTIONS))
+    {
+        return;
+    }
+    memset(&bank->section[channel][section], 0, sizeof(filter_section_t));
+}
+
+/**
+ * @brief Quantises the coefficients of a section with unity DC gain, which
+ * every supported section type has.  b1 is derived from the others so that
+ * the quantised DC gain is exactly one.
+ */
+static void set_section(filter_bank_t *const bank, const uint8_t channel, const uint8_t section, const float b0,
+                        const float b2, const float a1, const float a2)
+{
+    if ((channel >= FILTER_BANK_MAX_CHANNELS) || (section >= FILTER_BANK_MAX_SECTIONS))
+    {
+        return;
+    }
+    filter_section_t *const s = &bank->section[channel][section];
+    s->b0 = (int32_t)lroundf(b0 * (float)ONE_Q);
+    s->b2 = (int32_t)lroundf(b2 * (float)ONE_Q);
+    s->a1 = (int32_t)lroundf(a1 * (float)ONE_Q);
+    s->a2 = (int32_t)lroundf(a2 * (float)ONE_Q);
+    s->b1 = ONE_Q + s->a1 + s->a2 - s->b0 - s->b2;
+}
+
+/**
+ * @brief Sets every state as if input had been applied forever, to avoid the
+ * start-up transient of a zero state.
+ * @param bank Filter bank structure.
+ * @param input One integer sample per channel.
+ */
+void filter_bank_reset(filter_bank_t *const bank, const int32_t *const input)
+{
+    for (uint8_t channel = 0; channel < bank->channels; channel++)
+    {
+        const int32_t x = input[channel] * (1 << FILTER_BANK_STATE_Q);
+        for (uint8_t section = 0; section < FILTER_BANK_MAX_SECTIONS; section++)
+        {
+            filter_section_state_t *const state = &bank->state[channel][section];
+            state->x1 = x;
+            state->x2 = x;
+            state->y1 = x;
+            state->y2 = x;
+        }
+        bank->output[channel] = x;
+    }
+}
+
+/**
+ * @brief Filters one sample of every channel.  The results are read with
+ * filter_bank_output() or filter_bank_output_float().
+ * @param bank Filter bank structure.
+ * @param input One integer sample per channel.
+ */
+void filter_bank_update(filter_bank_t *const bank, const int32_t *const input)
+{
+    for (uint8_t channel = 0; channel < bank->channels; channel++)
+    {
+        int32_t x = input[channel] * (1 << FILTER_BANK_STATE_Q);
+        for (uint8_t section = 0; section < FILTER_BANK_MAX_SECTIONS; section++)
+        {
+            const filter_section_t *const s = &bank->section[channel][section];
+            filter_section_state_t *const state = &bank->state[channel][section];
+            if (s->b0 == 0)
+            {
+                // Track the input as a pass-through so that a later set starts without a transient
+                state->x2 = state->x1;
+                state->x1 = x;
+                state->y2 = state->y1;
+                state->y1 = x;
+                continue;
+            }
+            int64_t accumulator = (int64_t)s->b0 * x + (int64_t)s->b1 * state->x1 - (int64_t)s->a1 * state->y1;
+            if (s->a2 != 0)
+            {
+                accumulator += (int64_t)s->b2 * state->x2 - (int64_t)s->a2 * state->y2;
+            }
+            const int32_t y =
+                (int32_t)((accumulator + ((int64_t)1 << (FILTER_BANK_COEFFICIENT_Q - 1))) >> FILTER_BANK_COEFFICIENT_Q);
+            state->x2 = state->x1;
+            state->x1 = x;
+            state->y2 = state->y1;
+            state->y1 = y;
+            x = y;
+        }
+        bank->output[channel] = x;
+    }
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,118 @@
+/**
+ * @file filter_bank.h
+ * @brief Multi-channel cascade of first-order and biquad sections in Q format.
+ * Coefficients are computed once from a cutoff in Hz and a sample rate, and
+ * every sample is then filtered with multiply-shift arithmetic only, so there
+ * is no division in the per-sample path.
+ */
+
+#ifndef _FILTER_BANK_H_
+#define _FILTER_BANK_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Maximum number of channels and of sections per channel.
+ */
+#define FILTER_BANK_MAX_CHANNELS (7)
+#define FILTER_BANK_MAX_SECTIONS (2)
+
+/**
+ * @brief Coefficients are Q28, so |coefficient| < 8.
+ */
+#define FILTER_BANK_COEFFICIENT_Q (28)
+
+/**
+ * @brief Fraction bits kept in the section states.  Inputs and outputs are
+ * integers; the states carry the extra resolution so that low cutoffs do not
+ * collapse onto integer steps.
+ */
+#define FILTER_BANK_STATE_Q (8)
+
+/**
+ * @brief Section coefficients, y = b0 x0 + b1 x1 + b2 x2 - a1 y1 - a2 y2.  A
+ * first-order section has b2 = a2 = 0.
+ */
+typedef struct
+{
+    int32_t b0;
+    int32_t b1;
+    int32_t b2;
+    int32_t a1;
+    int32_t a2;
+} filter_section_t;
+
+/**
+ * @brief Direct form I state of one section of one channel, in
+ * FILTER_BANK_STATE_Q.
+ */
+typedef struct
+{
+    int32_t x1;
+    int32_t x2;
+    int32_t y1;
+    int32_t y2;
+} filter_section_state_t;
+
+/**
+ * @brief Filter bank structure.  A section with all-zero coefficients is
+ * skipped, so channels may have different numbers of sections.
+ */
+typedef struct
+{
+    uint8_t channels;
+    filter_section_t section[FILTER_BANK_MAX_CHANNELS][FILTER_BANK_MAX_SECTIONS];
+    filter_section_state_t state[FILTER_BANK_MAX_CHANNELS][FILTER_BANK_MAX_SECTIONS];
+    int32_t output[FILTER_BANK_MAX_CHANNELS]; // FILTER_BANK_STATE_Q
+} filter_bank_t;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+void filter_bank_init(filter_bank_t *const bank, const uint8_t channels);
+void filter_bank_set_first_order_low_pass(filter_bank_t *const bank, const uint8_t channel, const uint8_t section,
+                                          const float cutoff_hz, const float sample_hz);
+void filter_bank_set_low_pass(filter_bank_t *const bank, const uint8_t channel, const uint8_t section,
+                              const float cutoff_hz, const float q, const float sample_hz);
+void filter_bank_set_notch(filter_bank_t *const bank, const uint8_t channel, const uint8_t section,
+                           const float center_hz, const float q, const float sample_hz);
+void filter_bank_clear_section(filter_bank_t *const bank, const uint8_t channel, const uint8_t section);
+void filter_bank_reset(filter_bank_t *const bank, const int32_t *const input);
+void filter_bank_update(filter_bank_t *const bank, const int32_t *const input);
+
+//------------------------------------------------------------------------------
+// Inline functions
+
+/**
+ * @brief Returns the latest output of a channel rounded to an integer.
+ * @param bank Filter bank structure.
+ * @param channel Channel index.
+ * @return Filtered output.
+ */
+static inline int32_t filter_bank_output(const filter_bank_t *const bank, const uint8_t channel)
+{
+    return (bank->output[channel] + (1 << (FILTER_BANK_STATE_Q - 1))) >> FILTER_BANK_STATE_Q;
+}
+
+/**
+ * @brief Returns the latest output of a channel as a float, keeping the
+ * fraction bits of the state.
+ * @param bank Filter bank structure.
+ * @param channel Channel index.
+ * @return Filtered output.
+ */
+static inline float filter_bank_output_float(const filter_bank_t *const bank, const uint8_t channel)
+{
+    return (float)bank->output[channel] * (1.0f / (float)(1 << FILTER_BANK_STATE_Q));
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,247 @@
+/**
+ * @file math_backend.h
+ * @brief Compile-time selected kernels behind the square root, inverse square
+ * root and trigonometric functions of math_utils.h.  Select a backend by
+ * defining FUSION_MATH_BACKEND as one of:
+ *
+ * FUSION_MATH_BACKEND_LIBM          sqrtf, sinf, cosf, atan2f and asinf.  On
+ *                                   the RP2040 the SDK routes these to the
+ *                                   ROM float routines (pico_float).
+ * FUSION_MATH_BACKEND_FAST          Default.  Fast inverse square root and the
+ *                                   Q15 sin_table.h kernels, as the library
+ *                                   used before.
+ * FUSION_MATH_BACKEND_FAST_INT_SQRT Integer square root of the float mantissa
+ *                                   and 32-bit integer division, which the
+ *                                   RP2040 SDK maps to the SIO hardware
+ *                                   divider, with the Q15 sin_table.h kernels.
+ *
+ * Every backend keeps the vector and quaternion arithmetic in float and only
+ * swaps these kernels.  The fixed-point AHRS is a separate build, see
+ * FUSION_USE_FIXED_POINT in FusionAhrs.h.
+ *
+ * tools/math_backend_report.c measures the speed and accuracy of each.
+ */
+
+#ifndef _MATH_BACKEND_H_
+#define _MATH_BACKEND_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <math.h> // sqrtf, sinf, cosf, atan2f, asinf
+#include <stdint.h>
+
+#include "sin_table.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+#define FUSION_MATH_BACKEND_LIBM (1)
+#define FUSION_MATH_BACKEND_FAST (2)
+#define FUSION_MATH_BACKEND_FAST_INT_SQRT (3)
+
+#ifndef FUSION_MATH_BACKEND
+#define FUSION_MATH_BACKEND FUSION_MATH_BACKEND_FAST
+#endif
+
+#if (FUSION_MATH_BACKEND != FUSION_MATH_BACKEND_LIBM) && (FUSION_MATH_BACKEND != FUSION_MATH_BACKEND_FAST) &&        \
+    (FUSION_MATH_BACKEND != FUSION_MATH_BACKEND_FAST_INT_SQRT)
+#error "FUSION_MATH_BACKEND must be FUSION_MATH_BACKEND_LIBM, _FAST or _FAST_INT_SQRT"
+#endif
+
+#ifndef M_PI
+#define M_PI (3.14159265358979323846)
+#endif
+
+//------------------------------------------------------------------------------
+// Inline functions - Integer square root kernels
+
+#if FUSION_MATH_BACKEND == FUSION_MATH_BACKEND_FAST_INT_SQRT
+
+/**
+ * @brief Float and integer views of the same bits.
+ */
+typedef union
+{
+    float f;
+    uint32_t i;
+} fusion_math_bits_t;
+
+/**
+ * @brief Returns the 16-bit square root of a 32-bit integer, rounded down.
+ * @param value Operand.
+ * @return Square root.
+ */
+static inline uint32_t fusion_math_root_u32(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = (uint32_t)1 << 30;
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/**
+ * @brief Splits a positive float into a 16-bit mantissa root in [2^15, 2^16)
+ * and the power of two of the square root, so sqrt(x) = root * 2^exponent.
+ * @param x Positive operand.
+ * @param exponent Power of two of the result.
+ * @return Mantissa root.
+ */
+static inline uint32_t fusion_math_split_root(const float x, int32_t *const exponent)
+{
+    const fusion_math_bits_t bits = {.f = x};
+    int32_t power = (int32_t)((bits.i >> 23) & 0xFF) - 127;
+    uint32_t mantissa = (bits.i & 0x7FFFFF) | 0x800000; // [1, 2) in Q23
+    if (power & 1)
+    {
+        mantissa <<= 1;
+        power -= 1;
+    }
+    *exponent = power / 2 - 15;
+    return fusion_math_root_u32(mantissa << 7); // [2^30, 2^32) -> [2^15, 2^16)
+}
+
+/**
+ * @brief Returns 2^exponent as a float for exponents of normal floats.
+ * @param exponent Exponent.
+ * @return Power of two.
+ */
+static inline float fusion_math_power_of_two(const int32_t exponent)
+{
+    const fusion_math_bits_t bits = {.i = (uint32_t)(exponent + 127) << 23};
+    return bits.f;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// Inline functions - Backend interface
+
+/**
+ * @brief Returns the square root.
+ * @param x Operand.
+ * @return Square root of x, zero for non-positive x.
+ */
+static inline float fusion_math_sqrt(const float x)
+{
+#if FUSION_MATH_BACKEND == FUSION_MATH_BACKEND_FAST_INT_SQRT
+    if (x <= 0.0f)
+    {
+        return 0.0f;
+    }
+    int32_t exponent;
+    const uint32_t root = fusion_math_split_root(x, &exponent);
+    return (float)root * fusion_math_power_of_two(exponent);
+#else
+    return sqrtf(x);
+#endif
+}
+
+/**
+ * @brief Returns the reciprocal of the square root.
+ * @param x Positive operand.
+ * @return Reciprocal of the square root of x.
+ */
+static inline float fusion_math_inverse_sqrt(const float x)
+{
+#if FUSION_MATH_BACKEND == FUSION_MATH_BACKEND_LIBM
+    return 1.0f / sqrtf(x);
+#elif FUSION_MATH_BACKEND == FUSION_MATH_BACKEND_FAST
+    // See https://pizer.wordpress.com/2008/10/12/fast-inverse-square-root/
+    typedef union
+    {
+        float f;
+        int32_t i;
+    } Union32;
+
+    Union32 union32 = {.f = x};
+    union32.i = 0x5F1F1412 - (union32.i >> 1);
+    return union32.f * (1.69000231f - 0.714158168f * x * union32.f * union32.f);
+#else
+    int32_t exponent;
+    const uint32_t root = fusion_math_split_root(x, &exponent);
+    return (float)(0x80000000u / root) * fusion_math_power_of_two(-exponent - 31);
+#endif
+}
+
+/**
+ * @brief Returns the sine.
+ * @param radians Angle in radians.
+ * @return Sine.
+ */
+static inline float fusion_math_sin(const float radians)
+{
+#if FUSION_MATH_BACKEND == FUSION_MATH_BACKEND_LIBM
+    return sinf(radians);
+#else
+    return sin_table_sinf(radians);
+#endif
+}
+
+/**
+ * @brief Returns the cosine.
+ * @param radians Angle in radians.
+ * @return Cosine.
+ */
+static inline float fusion_math_cos(const float radians)
+{
+#if FUSION_MATH_BACKEND == FUSION_MATH_BACKEND_LIBM
+    return cosf(radians);
+#else
+    return sin_table_cosf(radians);
+#endif
+}
+
+/**
+ * @brief Returns the four-quadrant arc tangent of y / x.
+ * @param y Y.
+ * @param x X.
+ * @return Angle in radians.
+ */
+static inline float fusion_math_atan2(const float y, const float x)
+{
+#if FUSION_MATH_BACKEND == FUSION_MATH_BACKEND_LIBM
+    return atan2f(y, x);
+#else
+    return sin_table_atan2f(y, x);
+#endif
+}
+
+/**
+ * @brief Returns the arc sine, saturated outside [-1, 1].
+ * @param value Value.
+ * @return Angle in radians.
+ */
+static inline float fusion_math_asin(const float value)
+{
+    if (value <= -1.0f)
+    {
+        return (float)M_PI / -2.0f;
+    }
+    if (value >= 1.0f)
+    {
+        return (float)M_PI / 2.0f;
+    }
+#if FUSION_MATH_BACKEND == FUSION_MATH_BACKEND_LIBM
+    return asinf(value);
+#else
+    return sin_table_atan2f(value, fusion_math_sqrt(1.0f - value * value));
+#endif
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
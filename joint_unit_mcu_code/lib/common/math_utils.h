@@ -4,10 +4,12 @@
 //------------------------------------------------------------------------------
 // Includes
 
-#include <math.h> // M_PI, sqrtf, atan2f, asinf
+#include <math.h> // M_PI
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "math_backend.h"
+
 //------------------------------------------------------------------------------
 // Definitions
 
@@ -114,7 +116,8 @@ typedef union
 
 /**
  * @brief Include this definition or add as a preprocessor definition to use
- * normal square root operations.
+ * normal square root operations.  Equivalent to FUSION_MATH_BACKEND_LIBM for
+ * the inverse square root only, see math_backend.h.
  */
 //#define FUSION_USE_NORMAL_SQRT
 
@@ -139,22 +142,13 @@ static inline float FusionRadiansToDegrees(const float radians) { return radians
 // Inline functions - Arc sine
 
 /**
- * @brief Returns the arc sine of the value.
+ * @brief Returns the arc sine of the value.  With the fast and fixed-point
+ * backends this is atan2(x, sqrt(1 - x^2)) with the Q15 table kernel, accurate
+ * to better than 1e-4 radians.
  * @param value Value.
  * @return Arc sine of the value.
  */
-static inline float FusionAsin(const float value)
-{
-    if (value <= -1.0f)
-    {
-        return (float)M_PI / -2.0f;
-    }
-    if (value >= 1.0f)
-    {
-        return (float)M_PI / 2.0f;
-    }
-    return asinf(value);
-}
+static inline float FusionAsin(const float value) { return fusion_math_asin(value); }
 
 //------------------------------------------------------------------------------
 // Inline functions - Fast inverse square root
@@ -162,24 +156,13 @@ static inline float FusionAsin(const float value)
 #ifndef FUSION_USE_NORMAL_SQRT
 
 /**
- * @brief Calculates the reciprocal of the square root.
- * See https://pizer.wordpress.com/2008/10/12/fast-inverse-square-root/
+ * @brief Calculates the reciprocal of the square root with the selected
+ * backend; the fast inverse square root unless FUSION_MATH_BACKEND says
+ * otherwise.
  * @param x Operand.
  * @return Reciprocal of the square root of x.
  */
-static inline float FusionFastInverseSqrt(const float x)
-{
-
-    typedef union
-    {
-        float f;
-        int32_t i;
-    } Union32;
-
-    Union32 union32 = {.f = x};
-    union32.i = 0x5F1F1412 - (union32.i >> 1);
-    return union32.f * (1.69000231f - 0.714158168f * x * union32.f * union32.f);
-}
+static inline float FusionFastInverseSqrt(const float x) { return fusion_math_inverse_sqrt(x); }
 
 #endif
 
@@ -315,7 +298,7 @@ static inline float FusionVectorMagnitudeSquared(const FusionVector vector)
  */
 static inline float FusionVectorMagnitude(const FusionVector vector)
 {
-    return sqrtf(FusionVectorMagnitudeSquared(vector));
+    return fusion_math_sqrt(FusionVectorMagnitudeSquared(vector));
 }
 
 /**
@@ -479,7 +462,9 @@ static inline FusionMatrix FusionQuaternionToMatrix(const FusionQuaternion quate
 }
 
 /**
- * @brief Converts a quaternion to ZYX Euler angles in degrees.
+ * @brief Converts a quaternion to ZYX Euler angles in degrees.  With the fast
+ * and fixed-point backends this uses the Q15 table kernel, accurate to better
+ * than 0.01 degrees.
  * @param quaternion Quaternion.
  * @return Euler angles in degrees.
  */
@@ -489,9 +474,9 @@ static inline FusionEuler FusionQuaternionToEuler(const FusionQuaternion quatern
     const float halfMinusQySquared = 0.5f - Q.y * Q.y; // calculate common terms to avoid repeated operations
     const FusionEuler euler = {
         .angle = {
-            .roll = FusionRadiansToDegrees(atan2f(Q.w * Q.x + Q.y * Q.z, halfMinusQySquared - Q.x * Q.x)),
+            .roll = FusionRadiansToDegrees(fusion_math_atan2(Q.w * Q.x + Q.y * Q.z, halfMinusQySquared - Q.x * Q.x)),
             .pitch = FusionRadiansToDegrees(FusionAsin(2.0f * (Q.w * Q.y - Q.z * Q.x))),
-            .yaw = FusionRadiansToDegrees(atan2f(Q.w * Q.z + Q.x * Q.y, halfMinusQySquared - Q.z * Q.z)),
+            .yaw = FusionRadiansToDegrees(fusion_math_atan2(Q.w * Q.z + Q.x * Q.y, halfMinusQySquared - Q.z * Q.z)),
         }};
     return euler;
 #undef Q
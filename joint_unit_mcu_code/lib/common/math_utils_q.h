@@ -0,0 +1,378 @@
+/**
+ * @file math_utils_q.h
+ * @brief Fixed-point (Q-format) counterparts of the math_utils.h vector and
+ * quaternion operations for the FPU-less RP2040.  Unit quaternions and unit
+ * vectors are Q30, sensor measurements are Q16.
+ */
+
+#ifndef _MATH_UTILS_Q_H_
+#define _MATH_UTILS_Q_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "math_utils.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief 3D vector of fixed-point values.
+ */
+typedef union
+{
+    int32_t array[3];
+
+    struct
+    {
+        int32_t x;
+        int32_t y;
+        int32_t z;
+    } axis;
+} fusion_vector_q_t;
+
+/**
+ * @brief Quaternion of Q30 values.
+ */
+typedef union
+{
+    int32_t array[4];
+
+    struct
+    {
+        int32_t w;
+        int32_t x;
+        int32_t y;
+        int32_t z;
+    } element;
+} fusion_quaternion_q_t;
+
+/**
+ * @brief One in Q30 and Q16.
+ */
+#define FUSION_Q30_ONE ((int32_t)1 << 30)
+#define FUSION_Q16_ONE ((int32_t)1 << 16)
+
+/**
+ * @brief Float conversions.  Only intended for initialisation and output.
+ */
+#define FUSION_FLOAT_TO_Q30(value) ((int32_t)((value) * (float)FUSION_Q30_ONE))
+#define FUSION_FLOAT_TO_Q16(value) ((int32_t)((value) * (float)FUSION_Q16_ONE))
+#define FUSION_Q30_TO_FLOAT(value) ((float)(value) * (1.0f / (float)FUSION_Q30_ONE))
+#define FUSION_Q16_TO_FLOAT(value) ((float)(value) * (1.0f / (float)FUSION_Q16_ONE))
+
+/**
+ * @brief Vector of zeros.
+ */
+#define FUSION_VECTOR_Q_ZERO ((fusion_vector_q_t){.array = {0, 0, 0}})
+
+/**
+ * @brief Identity quaternion.
+ */
+#define FUSION_IDENTITY_QUATERNION_Q ((fusion_quaternion_q_t){.array = {FUSION_Q30_ONE, 0, 0, 0}})
+
+//------------------------------------------------------------------------------
+// Inline functions - Scalar operations
+
+/**
+ * @brief Returns (a * b) >> shift using a 64-bit intermediate.
+ * @param a Operand A.
+ * @param b Operand B.
+ * @param shift Right shift applied to the product.
+ * @return Product.
+ */
+static inline int32_t fusion_q_multiply(const int32_t a, const int32_t b, const int shift)
+{
+    return (int32_t)(((int64_t)a * (int64_t)b) >> shift);
+}
+
+/**
+ * @brief Returns the integer square root, rounded down.
+ * @param value Operand.
+ * @return Square root of value.
+ */
+static inline uint32_t fusion_q_sqrt(uint32_t value)
+{
+    uint32_t result = 0;
+    uint32_t bit = (uint32_t)1 << 30;
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
+
+//------------------------------------------------------------------------------
+// Inline functions - Vector operations
+
+/**
+ * @brief Returns true if the vector is zero.
+ * @param vector Vector.
+ * @return True if the vector is zero.
+ */
+static inline bool fusion_vector_q_is_zero(const fusion_vector_q_t vector)
+{
+    return (vector.axis.x == 0) && (vector.axis.y == 0) && (vector.axis.z == 0);
+}
+
+/**
+ * @brief Returns the sum of two vectors.
+ * @param vectorA Vector A.
+ * @param vectorB Vector B.
+ * @return Sum of two vectors.
+ */
+static inline fusion_vector_q_t fusion_vector_q_add(const fusion_vector_q_t vectorA, const fusion_vector_q_t vectorB)
+{
+    const fusion_vector_q_t result = {.axis = {
+                                          .x = vectorA.axis.x + vectorB.axis.x,
+                                          .y = vectorA.axis.y + vectorB.axis.y,
+                                          .z = vectorA.axis.z + vectorB.axis.z,
+                                      }};
+    return result;
+}
+
+/**
+ * @brief Returns the multiplication of a vector by a scalar.
+ * @param vector Vector.
+ * @param scalar Scalar.
+ * @param shift Right shift applied to each product.
+ * @return Multiplication of a vector by a scalar.
+ */
+static inline fusion_vector_q_t fusion_vector_q_multiply_scalar(const fusion_vector_q_t vector, const int32_t scalar,
+                                                                const int shift)
+{
+    const fusion_vector_q_t result = {.axis = {
+                                          .x = fusion_q_multiply(vector.axis.x, scalar, shift),
+                                          .y = fusion_q_multiply(vector.axis.y, scalar, shift),
+                                          .z = fusion_q_multiply(vector.axis.z, scalar, shift),
+                                      }};
+    return result;
+}
+
+/**
+ * @brief Returns the cross product of two Q30 vectors.
+ * @param vectorA Vector A.
+ * @param vectorB Vector B.
+ * @return Cross product.
+ */
+static inline fusion_vector_q_t fusion_vector_q_cross_product(const fusion_vector_q_t vectorA,
+                                                              const fusion_vector_q_t vectorB)
+{
+#define A vectorA.axis
+#define B vectorB.axis
+    const fusion_vector_q_t result = {.axis = {
+                                          .x = (int32_t)(((int64_t)A.y * B.z - (int64_t)A.z * B.y) >> 30),
+                                          .y = (int32_t)(((int64_t)A.z * B.x - (int64_t)A.x * B.z) >> 30),
+                                          .z = (int32_t)(((int64_t)A.x * B.y - (int64_t)A.y * B.x) >> 30),
+                                      }};
+    return result;
+#undef A
+#undef B
+}
+
+/**
+ * @brief Returns the dot product of two Q30 vectors.
+ * @param vectorA Vector A.
+ * @param vectorB Vector B.
+ * @return Dot product in Q30.
+ */
+static inline int32_t fusion_vector_q_dot_product(const fusion_vector_q_t vectorA, const fusion_vector_q_t vectorB)
+{
+    return (int32_t)(((int64_t)vectorA.axis.x * vectorB.axis.x + (int64_t)vectorA.axis.y * vectorB.axis.y +
+                      (int64_t)vectorA.axis.z * vectorB.axis.z) >>
+                     30);
+}
+
+/**
+ * @brief Returns the normalised vector.  The input may be in any Q format; the
+ * direction is resolved to Q15 and returned in Q30.
+ * @param vector Vector.
+ * @return Normalised Q30 vector, or zero if the vector is zero.
+ */
+static inline fusion_vector_q_t fusion_vector_q_normalise(const fusion_vector_q_t vector)
+{
+    int32_t scaled[3];
+    uint32_t largest = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        const uint32_t magnitude = vector.array[i] < 0 ? (uint32_t)0 - (uint32_t)vector.array[i] : (uint32_t)vector.array[i];
+        largest = magnitude > largest ? magnitude : largest;
+    }
+    if (largest == 0)
+    {
+        return FUSION_VECTOR_Q_ZERO;
+    }
+
+    // Scale so that the largest component is in [2^14, 2^15)
+    int shift = 0;
+    while (largest >= ((uint32_t)1 << 15))
+    {
+        largest >>= 1;
+        shift++;
+    }
+    while (largest < ((uint32_t)1 << 14))
+    {
+        largest <<= 1;
+        shift--;
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        scaled[i] = shift >= 0 ? vector.array[i] >> shift : vector.array[i] * (1 << -shift);
+    }
+
+    const uint32_t magnitude = fusion_q_sqrt((uint32_t)(scaled[0] * scaled[0]) + (uint32_t)(scaled[1] * scaled[1]) +
+                                             (uint32_t)(scaled[2] * scaled[2]));
+    const fusion_vector_q_t result = {.axis = {
+                                          .x = (scaled[0] * (1 << 15) / (int32_t)magnitude) * (1 << 15),
+                                          .y = (scaled[1] * (1 << 15) / (int32_t)magnitude) * (1 << 15),
+                                          .z = (scaled[2] * (1 << 15) / (int32_t)magnitude) * (1 << 15),
+                                      }};
+    return result;
+}
+
+/**
+ * @brief Returns the vector magnitude squared of a Q30 vector.
+ * @param vector Vector.
+ * @return Vector magnitude squared in Q30.
+ */
+static inline int32_t fusion_vector_q_magnitude_squared(const fusion_vector_q_t vector)
+{
+    return fusion_vector_q_dot_product(vector, vector);
+}
+
+//------------------------------------------------------------------------------
+// Inline functions - Quaternion operations
+
+/**
+ * @brief Returns the sum of two quaternions.
+ * @param quaternionA Quaternion A.
+ * @param quaternionB Quaternion B.
+ * @return Sum of two quaternions.
+ */
+static inline fusion_quaternion_q_t fusion_quaternion_q_add(const fusion_quaternion_q_t quaternionA,
+                                                            const fusion_quaternion_q_t quaternionB)
+{
+    const fusion_quaternion_q_t result = {.element = {
+                                              .w = quaternionA.element.w + quaternionB.element.w,
+                                              .x = quaternionA.element.x + quaternionB.element.x,
+                                              .y = quaternionA.element.y + quaternionB.element.y,
+                                              .z = quaternionA.element.z + quaternionB.element.z,
+                                          }};
+    return result;
+}
+
+/**
+ * @brief Returns the multiplication of two Q30 quaternions.
+ * @param quaternionA Quaternion A (to be post-multiplied).
+ * @param quaternionB Quaternion B (to be pre-multiplied).
+ * @return Multiplication of two quaternions.
+ */
+static inline fusion_quaternion_q_t fusion_quaternion_q_multiply(const fusion_quaternion_q_t quaternionA,
+                                                                 const fusion_quaternion_q_t quaternionB)
+{
+#define A quaternionA.element
+#define B quaternionB.element
+    const fusion_quaternion_q_t result = {
+        .element = {
+            .w = (int32_t)(((int64_t)A.w * B.w - (int64_t)A.x * B.x - (int64_t)A.y * B.y - (int64_t)A.z * B.z) >> 30),
+            .x = (int32_t)(((int64_t)A.w * B.x + (int64_t)A.x * B.w + (int64_t)A.y * B.z - (int64_t)A.z * B.y) >> 30),
+            .y = (int32_t)(((int64_t)A.w * B.y - (int64_t)A.x * B.z + (int64_t)A.y * B.w + (int64_t)A.z * B.x) >> 30),
+            .z = (int32_t)(((int64_t)A.w * B.z + (int64_t)A.x * B.y - (int64_t)A.y * B.x + (int64_t)A.z * B.w) >> 30),
+        }};
+    return result;
+#undef A
+#undef B
+}
+
+/**
+ * @brief Returns the multiplication of a Q30 quaternion with a Q30 vector
+ * treated as a quaternion with a W element value of zero.
+ * @param quaternion Quaternion.
+ * @param vector Vector.
+ * @return Multiplication of a quaternion with a vector.
+ */
+static inline fusion_quaternion_q_t fusion_quaternion_q_multiply_vector(const fusion_quaternion_q_t quaternion,
+                                                                        const fusion_vector_q_t vector)
+{
+#define Q quaternion.element
+#define V vector.axis
+    const fusion_quaternion_q_t result = {.element = {
+                                              .w = (int32_t)((-(int64_t)Q.x * V.x - (int64_t)Q.y * V.y -
+                                                              (int64_t)Q.z * V.z) >> 30),
+                                              .x = (int32_t)(((int64_t)Q.w * V.x + (int64_t)Q.y * V.z -
+                                                              (int64_t)Q.z * V.y) >> 30),
+                                              .y = (int32_t)(((int64_t)Q.w * V.y - (int64_t)Q.x * V.z +
+                                                              (int64_t)Q.z * V.x) >> 30),
+                                              .z = (int32_t)(((int64_t)Q.w * V.z + (int64_t)Q.x * V.y -
+                                                              (int64_t)Q.y * V.x) >> 30),
+                                          }};
+    return result;
+#undef Q
+#undef V
+}
+
+/**
+ * @brief Returns the normalised quaternion.  Uses Newton iterations of the
+ * reciprocal square root starting from one, which converge quadratically
+ * because the quaternion is renormalised after every update.
+ * @param quaternion Quaternion.
+ * @return Normalised quaternion.
+ */
+static inline fusion_quaternion_q_t fusion_quaternion_q_normalise(fusion_quaternion_q_t quaternion)
+{
+#define Q quaternion.element
+    for (int iteration = 0; iteration < 4; iteration++)
+    {
+        const int32_t magnitudeSquared = (int32_t)(((int64_t)Q.w * Q.w + (int64_t)Q.x * Q.x + (int64_t)Q.y * Q.y +
+                                                    (int64_t)Q.z * Q.z) >> 30);
+        const int32_t error = FUSION_Q30_ONE - magnitudeSquared;
+        if ((error < (1 << 8)) && (error > -(1 << 8)))
+        {
+            break;
+        }
+        const int32_t magnitudeReciprocal = FUSION_Q30_ONE + (error >> 1);
+        for (int i = 0; i < 4; i++)
+        {
+            quaternion.array[i] = fusion_q_multiply(quaternion.array[i], magnitudeReciprocal, 30);
+        }
+    }
+    return quaternion;
+#undef Q
+}
+
+/**
+ * @brief Converts a Q30 quaternion to a float quaternion.
+ * @param quaternion Quaternion.
+ * @return Float quaternion.
+ */
+static inline FusionQuaternion fusion_quaternion_q_to_float(const fusion_quaternion_q_t quaternion)
+{
+    const FusionQuaternion result = {.element = {
+                                         .w = FUSION_Q30_TO_FLOAT(quaternion.element.w),
+                                         .x = FUSION_Q30_TO_FLOAT(quaternion.element.x),
+                                         .y = FUSION_Q30_TO_FLOAT(quaternion.element.y),
+                                         .z = FUSION_Q30_TO_FLOAT(quaternion.element.z),
+                                     }};
+    return result;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,251 @@
+/**
+ * @file sin_table.c
+ * @brief Flash-resident Q15 quarter-wave sine table with linearly interpolated
+ * sine, cosine and arc tangent helpers.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "sin_table.h"
+#include <math.h> // fabsf
+#include <stdbool.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Bits of the phase used to interpolate between two table entries.
+ */
+#define PHASE_FRACTION_BITS (16)
+
+/**
+ * @brief 2^32 / (2 * pi), converts radians to phase.
+ */
+#define RADIANS_TO_PHASE (683565275.6f)
+
+/**
+ * @brief Q15 radians to float radians.
+ */
+#define Q15_TO_FLOAT (1.0f / 32768.0f)
+
+// Generated with min(32767, round(32768 * sin(i * pi / 512))), i = 0..256
+const int16_t SIN_TABLE_Q15[SIN_TABLE_SIZE + 1] = {
+    0, 201, 402, 603, 804, 1005, 1206, 1407, 1608, 1809, 2009, 2210,
+    2411, 2611, 2811, 3012, 3212, 3412, 3612, 3812, 4011, 4211, 4410, 4609,
+    4808, 5007, 5205, 5404, 5602, 5800, 5998, 6195, 6393, 6590, 6787, 6983,
+    7180, 7376, 7571, 7767, 7962, 8157, 8351, 8546, 8740, 8933, 9127, 9319,
+    9512, 9704, 9896, 10088, 10279, 10469, 10660, 10850, 11039, 11228, 11417, 11605,
+    11793, 11980, 12167, 12354, 12540, 12725, 12910, 13095, 13279, 13463, 13646, 13828,
+    14010, 14192, 14373, 14553, 14733, 14912, 15091, 15269, 15447, 15624, 15800, 15976,
+    16151, 16326, 16500, 16673, 16846, 17018, 17190, 17361, 17531, 17700, 17869, 18037,
+    18205, 18372, 18538, 18703, 18868, 19032, 19195, 19358, 19520, 19681, 19841, 20001,
+    20160, 20318, 20475, 20632, 20788, 20943, 21097, 21251, 21403, 21555, 21706, 21856,
+    22006, 22154, 22302, 22449, 22595, 22740, 22884, 23028, 23170, 23312, 23453, 23593,
+    23732, 23870, 24008, 24144, 24279, 24414, 24548, 24680, 24812, 24943, 25073, 25202,
+    25330, 25457, 25583, 25708, 25833, 25956, 26078, 26199, 26320, 26439, 26557, 26674,
+    26791, 26906, 27020, 27133, 27246, 27357, 27467, 27576, 27684, 27791, 27897, 28002,
+    28106, 28209, 28311, 28411, 28511, 28610, 28707, 28803, 28899, 28993, 29086, 29178,
+    29269, 29359, 29448, 29535, 29622, 29707, 29792, 29875, 29957, 30038, 30118, 30196,
+    30274, 30350, 30425, 30499, 30572, 30644, 30715, 30784, 30853, 30920, 30986, 31050,
+    31114, 31177, 31238, 31298, 31357, 31415, 31471, 31527, 31581, 31634, 31686, 31737,
+    31786, 31834, 31881, 31927, 31972, 32015, 32058, 32099, 32138, 32177, 32214, 32251,
+    32286, 32319, 32352, 32383, 32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
+    32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718, 32729, 32738, 32746, 32753,
+    32758, 32762, 32766, 32767, 32767,
+};
+
+// Generated with round(32768 * atan(i / 256)), i = 0..256
+const int16_t ATAN_TABLE_Q15[SIN_TABLE_SIZE + 1] = {
+    0, 128, 256, 384, 512, 640, 768, 896, 1024, 1152, 1279, 1407,
+    1535, 1663, 1790, 1918, 2045, 2173, 2300, 2428, 2555, 2682, 2809, 2936,
+    3063, 3190, 3317, 3443, 3570, 3696, 3823, 3949, 4075, 4201, 4327, 4452,
+    4578, 4703, 4829, 4954, 5079, 5204, 5329, 5453, 5578, 5702, 5826, 5950,
+    6073, 6197, 6320, 6444, 6567, 6689, 6812, 6935, 7057, 7179, 7301, 7422,
+    7544, 7665, 7786, 7907, 8027, 8148, 8268, 8388, 8508, 8627, 8746, 8865,
+    8984, 9102, 9221, 9339, 9456, 9574, 9691, 9808, 9925, 10041, 10158, 10274,
+    10389, 10505, 10620, 10735, 10849, 10964, 11078, 11192, 11305, 11418, 11531, 11644,
+    11756, 11868, 11980, 12092, 12203, 12314, 12424, 12535, 12645, 12754, 12864, 12973,
+    13082, 13190, 13298, 13406, 13514, 13621, 13728, 13835, 13941, 14047, 14153, 14258,
+    14363, 14468, 14573, 14677, 14781, 14884, 14987, 15090, 15193, 15295, 15397, 15499,
+    15600, 15701, 15801, 15902, 16002, 16101, 16201, 16300, 16398, 16497, 16595, 16693,
+    16790, 16887, 16984, 17080, 17176, 17272, 17368, 17463, 17557, 17652, 17746, 17840,
+    17933, 18027, 18119, 18212, 18304, 18396, 18488, 18579, 18670, 18760, 18851, 18941,
+    19030, 19120, 19209, 19297, 19386, 19474, 19561, 19649, 19736, 19823, 19909, 19995,
+    20081, 20166, 20252, 20336, 20421, 20505, 20589, 20673, 20756, 20839, 20922, 21004,
+    21086, 21168, 21249, 21331, 21411, 21492, 21572, 21652, 21732, 21811, 21890, 21969,
+    22047, 22126, 22203, 22281, 22358, 22435, 22512, 22588, 22664, 22740, 22815, 22891,
+    22966, 23040, 23115, 23189, 23262, 23336, 23409, 23482, 23555, 23627, 23699, 23771,
+    23842, 23914, 23985, 24055, 24126, 24196, 24266, 24335, 24405, 24474, 24542, 24611,
+    24679, 24747, 24815, 24882, 24950, 25017, 25083, 25150, 25216, 25282, 25347, 25413,
+    25478, 25543, 25607, 25672, 25736,
+};
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Returns the sine of a phase within the first quarter turn.
+ * @param phase Phase in [0, SIN_TABLE_QUARTER_TURN].
+ * @return Sine in Q15.
+ */
+static inline int32_t QuarterSine(const uint32_t phase)
+{
+    const uint32_t index = phase >> (30 - SIN_TABLE_BITS);
+    if (index >= SIN_TABLE_SIZE)
+    {
+        return SIN_TABLE_Q15[SIN_TABLE_SIZE];
+    }
+    const int32_t fraction = (int32_t)((phase >> (30 - SIN_TABLE_BITS - PHASE_FRACTION_BITS)) &
+                                       ((1 << PHASE_FRACTION_BITS) - 1));
+    const int32_t a = SIN_TABLE_Q15[index];
+    const int32_t b = SIN_TABLE_Q15[index + 1];
+    return a + (((b - a) * fraction) >> PHASE_FRACTION_BITS);
+}
+
+/**
+ * @brief Returns the sine of a phase.
+ * @param phase Phase where 2^32 is a full turn.
+ * @return Sine in Q15.
+ */
+int16_t sin_table_sin_q15(const uint32_t phase)
+{
+    const uint32_t quadrant = phase >> 30;
+    const uint32_t remainder = phase & (SIN_TABLE_QUARTER_TURN - 1);
+    switch (quadrant)
+    {
+    case 0:
+        return (int16_t)QuarterSine(remainder);
+    case 1:
+        return (int16_t)QuarterSine(SIN_TABLE_QUARTER_TURN - remainder);
+    case 2:
+        return (int16_t)-QuarterSine(remainder);
+    default:
+        return (int16_t)-QuarterSine(SIN_TABLE_QUARTER_TURN - remainder);
+    }
+}
+
+/**
+ * @brief Returns the cosine of a phase.
+ * @param phase Phase where 2^32 is a full turn.
+ * @return Cosine in Q15.
+ */
+int16_t sin_table_cos_q15(const uint32_t phase) { return sin_table_sin_q15(phase + SIN_TABLE_QUARTER_TURN); }
+
+/**
+ * @brief Returns the arc tangent of the first octant and applies the octant
+ * symmetries.
+ * @param ratio Ratio of the smaller to the larger magnitude in Q16.
+ * @param swapped True if |y| > |x|.
+ * @param xNegative True if x < 0.
+ * @param yNegative True if y < 0.
+ * @return Angle in Q15 radians in [-pi, pi].
+ */
+static int32_t Atan2FromRatio(const uint32_t ratio, const bool swapped, const bool xNegative, const bool yNegative)
+{
+    const uint32_t index = ratio >> (16 - SIN_TABLE_BITS);
+    int32_t angle;
+    if (index >= SIN_TABLE_SIZE)
+    {
+        angle = ATAN_TABLE_Q15[SIN_TABLE_SIZE];
+    }
+    else
+    {
+        const int32_t fraction = (int32_t)(ratio & ((1 << (16 - SIN_TABLE_BITS)) - 1));
+        const int32_t a = ATAN_TABLE_Q15[index];
+        const int32_t b = ATAN_TABLE_Q15[index + 1];
+        angle = a + (((b - a) * fraction) >> (16 - SIN_TABLE_BITS));
+    }
+    if (swapped)
+    {
+        angle = SIN_TABLE_HALF_PI_Q15 - angle;
+    }
+    if (xNegative)
+    {
+        angle = SIN_TABLE_PI_Q15 - angle;
+    }
+    return yNegative ? -angle : angle;
+}
+
+/**
+ * @brief Returns the arc tangent of y / x using the signs of both arguments to
+ * determine the quadrant.
+ * @param y Y.
+ * @param x X.
+ * @return Angle in Q15 radians in [-pi, pi].
+ */
+int32_t sin_table_atan2_q15(const int32_t y, const int32_t x)
+{
+    const uint32_t absX = x < 0 ? (uint32_t)0 - (uint32_t)x : (uint32_t)x;
+    const uint32_t absY = y < 0 ? (uint32_t)0 - (uint32_t)y : (uint32_t)y;
+    if ((absX == 0) && (absY == 0))
+    {
+        return 0;
+    }
+    const bool swapped = absY > absX;
+    uint32_t numerator = swapped ? absX : absY;
+    uint32_t denominator = swapped ? absY : absX;
+    while (denominator > 0xFFFF)
+    { // keep numerator << 16 within 32 bits
+        numerator >>= 1;
+        denominator >>= 1;
+    }
+    return Atan2FromRatio((numerator << 16) / denominator, swapped, x < 0, y < 0);
+}
+
+/**
+ * @brief Converts radians to a phase where 2^32 is a full turn.
+ * @param radians Radians.
+ * @return Phase.
+ */
+uint32_t sin_table_radians_to_phase(const float radians)
+{
+    if (fabsf(radians) < 3.0f)
+    { // fits int32 without the slower 64-bit conversion
+        return (uint32_t)(int32_t)(radians * RADIANS_TO_PHASE);
+    }
+    return (uint32_t)(int64_t)(radians * RADIANS_TO_PHASE);
+}
+
+/**
+ * @brief Returns the sine of the angle.
+ * @param radians Radians.
+ * @return Sine.
+ */
+float sin_table_sinf(const float radians)
+{
+    return (float)sin_table_sin_q15(sin_table_radians_to_phase(radians)) * Q15_TO_FLOAT;
+}
+
+/**
+ * @brief Returns the cosine of the angle.
+ * @param radians Radians.
+ * @return Cosine.
+ */
+float sin_table_cosf(const float radians)
+{
+    return (float)sin_table_cos_q15(sin_table_radians_to_phase(radians)) * Q15_TO_FLOAT;
+}
+
+/**
+ * @brief Returns the arc tangent of y / x using the signs of both arguments to
+ * determine the quadrant.
+ * @param y Y.
+ * @param x X.
+ * @return Angle in radians in [-pi, pi].
+ */
+float sin_table_atan2f(const float y, const float x)
+{
+    const float absX = fabsf(x);
+    const float absY = fabsf(y);
+    if ((absX == 0.0f) && (absY == 0.0f))
+    {
+        return 0.0f;
+    }
+    const bool swapped = absY > absX;
+    const float ratio = swapped ? (absX / absY) : (absY / absX);
+    return (float)Atan2FromRatio((uint32_t)(ratio * 65536.0f + 0.5f), swapped, x < 0.0f, y < 0.0f) * Q15_TO_FLOAT;
+}
+
+//------------------------------------------------------------------------------
+// End of file
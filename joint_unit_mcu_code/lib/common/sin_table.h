@@ -1,524 +1,60 @@
-// Sin Table generated by SinTableGen
-// https://github.com/NoWare-Development/sintablegen
+/**
+ * @file sin_table.h
+ * @brief Flash-resident Q15 quarter-wave sine table with linearly interpolated
+ * sine, cosine and arc tangent helpers.  The tables are const so they stay in
+ * flash (XIP) on the RP2040 instead of being copied into SRAM, and the lookups
+ * only use integer arithmetic so they avoid soft-float calls on the M0+.
+ */
 
 #ifndef _SIN_TABLE_H_
 #define _SIN_TABLE_H_
 
-static float SIN_TABLE[4097] = {
-0.00000000,0.00038350,0.00076699,0.00115049,0.00153398,0.00191747,0.00230097,0.00268446,
-0.00306796,0.00345145,0.00383494,0.00421843,0.00460193,0.00498542,0.00536891,0.00575240,
-0.00613588,0.00651937,0.00690286,0.00728634,0.00766983,0.00805331,0.00843679,0.00882027,
-0.00920375,0.00958723,0.00997071,0.01035419,0.01073766,0.01112113,0.01150460,0.01188807,
-0.01227154,0.01265500,0.01303847,0.01342193,0.01380539,0.01418885,0.01457230,0.01495576,
-0.01533921,0.01572265,0.01610610,0.01648955,0.01687299,0.01725643,0.01763986,0.01802330,
-0.01840673,0.01879016,0.01917358,0.01955701,0.01994043,0.02032385,0.02070726,0.02109067,
-0.02147408,0.02185749,0.02224089,0.02262429,0.02300768,0.02339107,0.02377446,0.02415785,
-0.02454123,0.02492461,0.02530798,0.02569135,0.02607472,0.02645808,0.02684144,0.02722479,
-0.02760815,0.02799149,0.02837484,0.02875817,0.02914151,0.02952484,0.02990817,0.03029149,
-0.03067480,0.03105812,0.03144142,0.03182473,0.03220803,0.03259132,0.03297461,0.03335789,
-0.03374117,0.03412445,0.03450771,0.03489098,0.03527424,0.03565749,0.03604074,0.03642398,
-0.03680722,0.03719046,0.03757368,0.03795690,0.03834012,0.03872333,0.03910654,0.03948973,
-0.03987293,0.04025612,0.04063930,0.04102247,0.04140564,0.04178881,0.04217196,0.04255511,
-0.04293826,0.04332139,0.04370453,0.04408765,0.04447077,0.04485388,0.04523699,0.04562009,
-0.04600318,0.04638627,0.04676935,0.04715242,0.04753548,0.04791854,0.04830159,0.04868464,
-0.04906768,0.04945070,0.04983373,0.05021674,0.05059975,0.05098275,0.05136574,0.05174873,
-0.05213170,0.05251468,0.05289764,0.05328059,0.05366354,0.05404648,0.05442941,0.05481233,
-0.05519525,0.05557815,0.05596105,0.05634394,0.05672682,0.05710969,0.05749256,0.05787542,
-0.05825827,0.05864111,0.05902394,0.05940676,0.05978957,0.06017238,0.06055517,0.06093796,
-0.06132074,0.06170351,0.06208627,0.06246902,0.06285176,0.06323449,0.06361721,0.06399993,
-0.06438263,0.06476533,0.06514801,0.06553069,0.06591335,0.06629601,0.06667866,0.06706129,
-0.06744392,0.06782654,0.06820914,0.06859174,0.06897433,0.06935690,0.06973947,0.07012203,
-0.07050458,0.07088711,0.07126963,0.07165215,0.07203465,0.07241715,0.07279963,0.07318210,
-0.07356457,0.07394701,0.07432945,0.07471188,0.07509430,0.07547671,0.07585911,0.07624149,
-0.07662386,0.07700622,0.07738858,0.07777091,0.07815325,0.07853556,0.07891786,0.07930016,
-0.07968244,0.08006471,0.08044697,0.08082921,0.08121145,0.08159367,0.08197588,0.08235808,
-0.08274026,0.08312244,0.08350460,0.08388675,0.08426889,0.08465102,0.08503313,0.08541522,
-0.08579731,0.08617939,0.08656145,0.08694350,0.08732554,0.08770756,0.08808957,0.08847157,
-0.08885355,0.08923552,0.08961748,0.08999943,0.09038136,0.09076328,0.09114519,0.09152707,
-0.09190895,0.09229082,0.09267268,0.09305451,0.09343634,0.09381814,0.09419994,0.09458172,
-0.09496350,0.09534525,0.09572699,0.09610872,0.09649043,0.09687213,0.09725381,0.09763549,
-0.09801714,0.09839878,0.09878041,0.09916202,0.09954362,0.09992521,0.10030677,0.10068832,
-0.10106986,0.10145139,0.10183290,0.10221439,0.10259587,0.10297734,0.10335878,0.10374022,
-0.10412163,0.10450304,0.10488442,0.10526580,0.10564715,0.10602850,0.10640982,0.10679113,
-0.10717242,0.10755371,0.10793497,0.10831621,0.10869744,0.10907866,0.10945985,0.10984104,
-0.11022221,0.11060335,0.11098449,0.11136561,0.11174671,0.11212780,0.11250886,0.11288992,
-0.11327095,0.11365197,0.11403298,0.11441396,0.11479492,0.11517588,0.11555681,0.11593773,
-0.11631863,0.11669952,0.11708038,0.11746123,0.11784206,0.11822288,0.11860368,0.11898445,
-0.11936522,0.11974596,0.12012669,0.12050740,0.12088808,0.12126876,0.12164941,0.12203006,
-0.12241068,0.12279128,0.12317186,0.12355243,0.12393297,0.12431350,0.12469402,0.12507451,
-0.12545498,0.12583543,0.12621588,0.12659630,0.12697670,0.12735708,0.12773745,0.12811778,
-0.12849811,0.12887841,0.12925871,0.12963897,0.13001922,0.13039945,0.13077967,0.13115986,
-0.13154003,0.13192019,0.13230032,0.13268043,0.13306053,0.13344060,0.13382065,0.13420069,
-0.13458070,0.13496071,0.13534068,0.13572064,0.13610058,0.13648050,0.13686039,0.13724026,
-0.13762012,0.13799995,0.13837977,0.13875957,0.13913934,0.13951910,0.13989884,0.14027855,
-0.14065824,0.14103791,0.14141756,0.14179720,0.14217681,0.14255640,0.14293596,0.14331551,
-0.14369503,0.14407454,0.14445402,0.14483349,0.14521292,0.14559235,0.14597175,0.14635111,
-0.14673047,0.14710981,0.14748912,0.14786841,0.14824767,0.14862692,0.14900614,0.14938535,
-0.14976454,0.15014370,0.15052283,0.15090194,0.15128104,0.15166011,0.15203916,0.15241818,
-0.15279719,0.15317616,0.15355512,0.15393406,0.15431297,0.15469186,0.15507074,0.15544957,
-0.15582840,0.15620720,0.15658598,0.15696472,0.15734346,0.15772216,0.15810084,0.15847951,
-0.15885815,0.15923676,0.15961535,0.15999392,0.16037245,0.16075097,0.16112947,0.16150795,
-0.16188639,0.16226482,0.16264322,0.16302159,0.16339995,0.16377828,0.16415659,0.16453487,
-0.16491312,0.16529135,0.16566956,0.16604774,0.16642590,0.16680405,0.16718215,0.16756023,
-0.16793829,0.16831633,0.16869435,0.16907233,0.16945030,0.16982822,0.17020614,0.17058402,
-0.17096189,0.17133972,0.17171754,0.17209533,0.17247309,0.17285082,0.17322853,0.17360622,
-0.17398387,0.17436151,0.17473911,0.17511670,0.17549425,0.17587179,0.17624930,0.17662677,
-0.17700422,0.17738165,0.17775905,0.17813642,0.17851377,0.17889109,0.17926839,0.17964566,
-0.18002290,0.18040012,0.18077731,0.18115447,0.18153161,0.18190871,0.18228580,0.18266286,
-0.18303989,0.18341689,0.18379387,0.18417081,0.18454774,0.18492463,0.18530150,0.18567833,
-0.18605515,0.18643194,0.18680869,0.18718542,0.18756212,0.18793881,0.18831545,0.18869208,
-0.18906866,0.18944523,0.18982176,0.19019827,0.19057475,0.19095121,0.19132763,0.19170403,
-0.19208039,0.19245674,0.19283305,0.19320934,0.19358559,0.19396181,0.19433801,0.19471419,
-0.19509032,0.19546643,0.19584252,0.19621857,0.19659460,0.19697060,0.19734657,0.19772249,
-0.19809841,0.19847429,0.19885014,0.19922596,0.19960175,0.19997752,0.20035325,0.20072895,
-0.20110464,0.20148028,0.20185590,0.20223148,0.20260704,0.20298256,0.20335807,0.20373353,
-0.20410897,0.20448437,0.20485975,0.20523509,0.20561041,0.20598570,0.20636095,0.20673618,
-0.20711137,0.20748654,0.20786168,0.20823678,0.20861185,0.20898689,0.20936191,0.20973688,
-0.21011184,0.21048675,0.21086164,0.21123651,0.21161133,0.21198612,0.21236089,0.21273562,
-0.21311031,0.21348499,0.21385963,0.21423423,0.21460882,0.21498336,0.21535787,0.21573235,
-0.21610680,0.21648121,0.21685560,0.21722995,0.21760428,0.21797857,0.21835282,0.21872705,
-0.21910124,0.21947540,0.21984953,0.22022362,0.22059768,0.22097172,0.22134572,0.22171968,
-0.22209363,0.22246753,0.22284140,0.22321522,0.22358903,0.22396280,0.22433653,0.22471024,
-0.22508392,0.22545755,0.22583115,0.22620472,0.22657827,0.22695176,0.22732525,0.22769868,
-0.22807208,0.22844546,0.22881879,0.22919209,0.22956537,0.22993860,0.23031181,0.23068498,
-0.23105811,0.23143122,0.23180428,0.23217730,0.23255031,0.23292327,0.23329620,0.23366910,
-0.23404196,0.23441479,0.23478758,0.23516034,0.23553306,0.23590575,0.23627840,0.23665102,
-0.23702361,0.23739615,0.23776866,0.23814115,0.23851359,0.23888600,0.23925838,0.23963071,
-0.24000302,0.24037530,0.24074753,0.24111973,0.24149188,0.24186401,0.24223611,0.24260816,
-0.24298018,0.24335216,0.24372411,0.24409603,0.24446790,0.24483974,0.24521154,0.24558331,
-0.24595505,0.24632674,0.24669841,0.24707003,0.24744162,0.24781317,0.24818468,0.24855617,
-0.24892761,0.24929900,0.24967039,0.25004172,0.25041300,0.25078428,0.25115550,0.25152668,
-0.25189781,0.25226894,0.25264001,0.25301105,0.25338203,0.25375301,0.25412393,0.25449482,
-0.25486565,0.25523648,0.25560725,0.25597799,0.25634867,0.25671935,0.25708997,0.25746056,
-0.25783110,0.25820160,0.25857207,0.25894251,0.25931293,0.25968328,0.26005360,0.26042387,
-0.26079410,0.26116434,0.26153448,0.26190463,0.26227471,0.26264477,0.26301476,0.26338473,
-0.26375467,0.26412457,0.26449442,0.26486424,0.26523402,0.26560378,0.26597348,0.26634315,
-0.26671275,0.26708233,0.26745188,0.26782140,0.26819086,0.26856029,0.26892966,0.26929903,
-0.26966831,0.27003759,0.27040681,0.27077600,0.27114516,0.27151427,0.27188334,0.27225238,
-0.27262136,0.27299032,0.27335921,0.27372807,0.27409691,0.27446571,0.27483445,0.27520314,
-0.27557182,0.27594045,0.27630904,0.27667758,0.27704608,0.27741453,0.27778298,0.27815136,
-0.27851969,0.27888799,0.27925625,0.27962446,0.27999264,0.28036079,0.28072888,0.28109694,
-0.28146493,0.28183290,0.28220084,0.28256872,0.28293657,0.28330436,0.28367212,0.28403986,
-0.28440753,0.28477517,0.28514278,0.28551033,0.28587782,0.28624532,0.28661272,0.28698012,
-0.28734747,0.28771475,0.28808203,0.28844923,0.28881642,0.28918353,0.28955063,0.28991768,
-0.29028466,0.29065165,0.29101855,0.29138544,0.29175225,0.29211906,0.29248580,0.29285249,
-0.29321915,0.29358578,0.29395235,0.29431888,0.29468536,0.29505181,0.29541820,0.29578456,
-0.29615089,0.29651716,0.29688337,0.29724956,0.29761571,0.29798180,0.29834786,0.29871386,
-0.29907984,0.29944575,0.29981163,0.30017745,0.30054325,0.30090898,0.30127469,0.30164033,
-0.30200595,0.30237150,0.30273703,0.30310252,0.30346796,0.30383334,0.30419868,0.30456397,
-0.30492923,0.30529442,0.30565959,0.30602473,0.30638981,0.30675483,0.30711982,0.30748475,
-0.30784965,0.30821449,0.30857930,0.30894405,0.30930877,0.30967343,0.31003806,0.31040263,
-0.31076714,0.31113163,0.31149608,0.31186047,0.31222481,0.31258911,0.31295338,0.31331757,
-0.31368175,0.31404585,0.31440994,0.31477395,0.31513792,0.31550187,0.31586576,0.31622958,
-0.31659338,0.31695712,0.31732082,0.31768447,0.31804809,0.31841165,0.31877515,0.31913862,
-0.31950203,0.31986541,0.32022873,0.32059202,0.32095525,0.32131842,0.32168156,0.32204464,
-0.32240769,0.32277068,0.32313362,0.32349652,0.32385936,0.32422218,0.32458493,0.32494763,
-0.32531029,0.32567289,0.32603547,0.32639799,0.32676044,0.32712287,0.32748523,0.32784757,
-0.32820985,0.32857206,0.32893425,0.32929638,0.32965845,0.33002049,0.33038250,0.33074442,
-0.33110631,0.33146814,0.33182994,0.33219168,0.33255336,0.33291501,0.33327660,0.33363816,
-0.33399966,0.33436111,0.33472249,0.33508384,0.33544514,0.33580640,0.33616760,0.33652875,
-0.33688986,0.33725092,0.33761191,0.33797285,0.33833376,0.33869463,0.33905542,0.33941618,
-0.33977687,0.34013754,0.34049815,0.34085870,0.34121922,0.34157965,0.34194008,0.34230042,
-0.34266073,0.34302098,0.34338117,0.34374133,0.34410143,0.34446147,0.34482148,0.34518144,
-0.34554133,0.34590116,0.34626096,0.34662071,0.34698042,0.34734005,0.34769964,0.34805918,
-0.34841868,0.34877813,0.34913751,0.34949684,0.34985614,0.35021538,0.35057455,0.35093367,
-0.35129276,0.35165179,0.35201076,0.35236970,0.35272855,0.35308737,0.35344616,0.35380486,
-0.35416353,0.35452214,0.35488069,0.35523921,0.35559767,0.35595608,0.35631442,0.35667270,
-0.35703096,0.35738915,0.35774729,0.35810539,0.35846341,0.35882139,0.35917935,0.35953721,
-0.35989505,0.36025280,0.36061051,0.36096820,0.36132580,0.36168337,0.36204088,0.36239833,
-0.36275572,0.36311308,0.36347038,0.36382762,0.36418480,0.36454192,0.36489901,0.36525601,
-0.36561298,0.36596993,0.36632678,0.36668360,0.36704034,0.36739704,0.36775368,0.36811030,
-0.36846682,0.36882332,0.36917976,0.36953613,0.36989245,0.37024871,0.37060493,0.37096110,
-0.37131721,0.37167326,0.37202924,0.37238517,0.37274107,0.37309691,0.37345266,0.37380838,
-0.37416407,0.37451968,0.37487522,0.37523073,0.37558618,0.37594157,0.37629691,0.37665218,
-0.37700742,0.37736258,0.37771770,0.37807274,0.37842774,0.37878269,0.37913761,0.37949243,
-0.37984720,0.38020194,0.38055661,0.38091120,0.38126576,0.38162026,0.38197473,0.38232911,
-0.38268343,0.38303772,0.38339192,0.38374609,0.38410020,0.38445425,0.38480824,0.38516217,
-0.38551605,0.38586989,0.38622364,0.38657734,0.38693100,0.38728461,0.38763815,0.38799161,
-0.38834503,0.38869843,0.38905174,0.38940498,0.38975817,0.39011133,0.39046440,0.39081740,
-0.39117038,0.39152330,0.39187613,0.39222893,0.39258167,0.39293435,0.39328697,0.39363953,
-0.39399204,0.39434448,0.39469686,0.39504921,0.39540148,0.39575368,0.39610586,0.39645794,
-0.39681000,0.39716196,0.39751390,0.39786574,0.39821756,0.39856932,0.39892101,0.39927262,
-0.39962420,0.39997572,0.40032718,0.40067858,0.40102988,0.40138116,0.40173239,0.40208355,
-0.40243465,0.40278569,0.40313667,0.40348759,0.40383846,0.40418926,0.40454000,0.40489069,
-0.40524131,0.40559188,0.40594238,0.40629283,0.40664321,0.40699354,0.40734380,0.40769401,
-0.40804416,0.40839425,0.40874428,0.40909424,0.40944415,0.40979400,0.41014379,0.41049349,
-0.41084316,0.41119277,0.41154233,0.41189182,0.41224122,0.41259059,0.41293988,0.41328913,
-0.41363832,0.41398743,0.41433650,0.41468549,0.41503441,0.41538331,0.41573212,0.41608086,
-0.41642955,0.41677818,0.41712677,0.41747528,0.41782370,0.41817209,0.41852042,0.41886869,
-0.41921690,0.41956502,0.41991311,0.42026111,0.42060909,0.42095697,0.42130479,0.42165256,
-0.42200026,0.42234790,0.42269549,0.42304301,0.42339048,0.42373788,0.42408520,0.42443249,
-0.42477968,0.42512682,0.42547390,0.42582092,0.42616788,0.42651477,0.42686161,0.42720839,
-0.42755508,0.42790174,0.42824832,0.42859483,0.42894128,0.42928767,0.42963400,0.42998028,
-0.43032649,0.43067262,0.43101871,0.43136472,0.43171066,0.43205655,0.43240237,0.43274814,
-0.43309382,0.43343946,0.43378502,0.43413052,0.43447596,0.43482134,0.43516666,0.43551189,
-0.43585709,0.43620220,0.43654725,0.43689224,0.43723717,0.43758205,0.43792683,0.43827158,
-0.43861625,0.43896085,0.43930539,0.43964985,0.43999428,0.44033861,0.44068289,0.44102710,
-0.44137126,0.44171536,0.44205937,0.44240335,0.44274724,0.44309106,0.44343480,0.44377851,
-0.44412214,0.44446570,0.44480920,0.44515264,0.44549602,0.44583932,0.44618255,0.44652572,
-0.44686884,0.44721189,0.44755486,0.44789776,0.44824061,0.44858339,0.44892609,0.44926876,
-0.44961134,0.44995385,0.45029628,0.45063868,0.45098099,0.45132324,0.45166543,0.45200753,
-0.45234957,0.45269158,0.45303348,0.45337534,0.45371711,0.45405883,0.45440048,0.45474207,
-0.45508358,0.45542502,0.45576641,0.45610774,0.45644897,0.45679015,0.45713127,0.45747232,
-0.45781329,0.45815420,0.45849505,0.45883584,0.45917654,0.45951718,0.45985776,0.46019828,
-0.46053872,0.46087909,0.46121940,0.46155962,0.46189979,0.46223989,0.46257994,0.46291989,
-0.46325979,0.46359962,0.46393937,0.46427906,0.46461868,0.46495825,0.46529773,0.46563715,
-0.46597651,0.46631578,0.46665499,0.46699414,0.46733320,0.46767223,0.46801114,0.46835002,
-0.46868882,0.46902755,0.46936622,0.46970481,0.47004333,0.47038180,0.47072017,0.47105849,
-0.47139674,0.47173491,0.47207302,0.47241107,0.47274902,0.47308692,0.47342476,0.47376251,
-0.47410020,0.47443783,0.47477537,0.47511286,0.47545028,0.47578761,0.47612488,0.47646210,
-0.47679922,0.47713628,0.47747329,0.47781020,0.47814706,0.47848383,0.47882056,0.47915718,
-0.47949377,0.47983027,0.48016667,0.48050305,0.48083934,0.48117554,0.48151168,0.48184776,
-0.48218378,0.48251972,0.48285556,0.48319137,0.48352706,0.48386273,0.48419830,0.48453382,
-0.48486924,0.48520461,0.48553991,0.48587513,0.48621029,0.48654535,0.48688036,0.48721531,
-0.48755017,0.48788494,0.48821968,0.48855433,0.48888889,0.48922339,0.48955783,0.48989218,
-0.49022648,0.49056071,0.49089485,0.49122891,0.49156290,0.49189684,0.49223071,0.49256447,
-0.49289820,0.49323183,0.49356541,0.49389890,0.49423230,0.49456567,0.49489895,0.49523214,
-0.49556527,0.49589831,0.49623129,0.49656421,0.49689704,0.49722981,0.49756250,0.49789512,
-0.49822766,0.49856013,0.49889255,0.49922487,0.49955711,0.49988928,0.50022137,0.50055343,
-0.50088537,0.50121725,0.50154907,0.50188082,0.50221246,0.50254405,0.50287557,0.50320703,
-0.50353837,0.50386965,0.50420088,0.50453204,0.50486308,0.50519413,0.50552505,0.50585586,
-0.50618666,0.50651735,0.50684798,0.50717854,0.50750899,0.50783938,0.50816971,0.50849998,
-0.50883013,0.50916022,0.50949025,0.50982022,0.51015007,0.51047993,0.51080960,0.51113927,
-0.51146883,0.51179832,0.51212776,0.51245713,0.51278639,0.51311558,0.51344472,0.51377380,
-0.51410276,0.51443166,0.51476043,0.51508921,0.51541787,0.51574647,0.51607502,0.51640344,
-0.51673180,0.51706010,0.51738828,0.51771647,0.51804453,0.51837248,0.51870042,0.51902825,
-0.51935601,0.51968366,0.52001125,0.52033877,0.52066624,0.52099365,0.52132094,0.52164817,
-0.52197528,0.52230239,0.52262938,0.52295625,0.52328312,0.52360988,0.52393657,0.52426314,
-0.52458966,0.52491611,0.52524251,0.52556878,0.52589500,0.52622116,0.52654725,0.52687323,
-0.52719915,0.52752495,0.52785075,0.52817643,0.52850199,0.52882755,0.52915299,0.52947831,
-0.52980363,0.53012884,0.53045398,0.53077900,0.53110403,0.53142887,0.53175372,0.53207844,
-0.53240311,0.53272772,0.53305221,0.53337663,0.53370100,0.53402525,0.53434944,0.53467357,
-0.53499764,0.53532159,0.53564548,0.53596926,0.53629297,0.53661662,0.53694016,0.53726369,
-0.53758705,0.53791040,0.53823364,0.53855681,0.53887993,0.53920293,0.53952587,0.53984869,
-0.54017144,0.54049414,0.54081678,0.54113930,0.54146177,0.54178417,0.54210645,0.54242867,
-0.54275078,0.54307282,0.54339480,0.54371673,0.54403853,0.54436028,0.54468191,0.54500347,
-0.54532498,0.54564643,0.54596776,0.54628897,0.54661018,0.54693127,0.54725230,0.54757321,
-0.54789406,0.54821485,0.54853553,0.54885614,0.54917663,0.54949713,0.54981750,0.55013776,
-0.55045795,0.55077809,0.55109817,0.55141813,0.55173796,0.55205780,0.55237752,0.55269712,
-0.55301672,0.55333620,0.55365556,0.55397487,0.55429411,0.55461329,0.55493236,0.55525130,
-0.55557024,0.55588907,0.55620778,0.55652648,0.55684501,0.55716354,0.55748194,0.55780029,
-0.55811852,0.55843669,0.55875480,0.55907279,0.55939072,0.55970854,0.56002629,0.56034398,
-0.56066155,0.56097907,0.56129652,0.56161386,0.56193113,0.56224829,0.56256539,0.56288242,
-0.56319934,0.56351620,0.56383294,0.56414962,0.56446624,0.56478274,0.56509918,0.56541556,
-0.56573182,0.56604797,0.56636411,0.56668013,0.56699604,0.56731188,0.56762767,0.56794333,
-0.56825894,0.56857449,0.56888992,0.56920522,0.56952053,0.56983572,0.57015079,0.57046580,
-0.57078075,0.57109559,0.57141036,0.57172501,0.57203960,0.57235414,0.57266855,0.57298291,
-0.57329714,0.57361132,0.57392544,0.57423943,0.57455337,0.57486719,0.57518095,0.57549459,
-0.57580817,0.57612169,0.57643509,0.57674843,0.57706165,0.57737482,0.57768792,0.57800090,
-0.57831377,0.57862663,0.57893932,0.57925200,0.57956457,0.57987702,0.58018941,0.58050174,
-0.58081394,0.58112609,0.58143812,0.58175009,0.58206201,0.58237380,0.58268547,0.58299714,
-0.58330864,0.58362013,0.58393145,0.58424276,0.58455396,0.58486503,0.58517605,0.58548701,
-0.58579785,0.58610862,0.58641928,0.58672988,0.58704036,0.58735079,0.58766115,0.58797139,
-0.58828157,0.58859164,0.58890158,0.58921152,0.58952129,0.58983105,0.59014070,0.59045023,
-0.59075969,0.59106910,0.59137839,0.59168756,0.59199667,0.59230572,0.59261465,0.59292352,
-0.59323227,0.59354097,0.59384960,0.59415805,0.59446651,0.59477484,0.59508306,0.59539121,
-0.59569931,0.59600729,0.59631521,0.59662300,0.59693068,0.59723836,0.59754586,0.59785336,
-0.59816068,0.59846801,0.59877521,0.59908229,0.59938931,0.59969622,0.60000306,0.60030979,
-0.60061646,0.60092306,0.60122955,0.60153592,0.60184222,0.60214847,0.60245460,0.60276067,
-0.60306662,0.60337245,0.60367823,0.60398394,0.60428953,0.60459507,0.60490048,0.60520577,
-0.60551107,0.60581619,0.60612124,0.60642624,0.60673112,0.60703593,0.60734063,0.60764527,
-0.60794979,0.60825425,0.60855860,0.60886282,0.60916704,0.60947108,0.60977507,0.61007899,
-0.61038280,0.61068654,0.61099017,0.61129373,0.61159718,0.61190051,0.61220378,0.61250699,
-0.61281008,0.61311311,0.61341602,0.61371881,0.61402154,0.61432421,0.61462677,0.61492920,
-0.61523157,0.61553389,0.61583608,0.61613816,0.61644018,0.61674207,0.61704391,0.61734563,
-0.61764729,0.61794889,0.61825031,0.61855173,0.61885297,0.61915416,0.61945528,0.61975628,
-0.62005723,0.62035805,0.62065876,0.62095940,0.62125999,0.62156045,0.62186080,0.62216109,
-0.62246126,0.62276137,0.62306136,0.62336129,0.62366110,0.62396085,0.62426049,0.62456006,
-0.62485951,0.62515885,0.62545812,0.62575728,0.62605637,0.62635541,0.62665427,0.62695312,
-0.62725180,0.62755042,0.62784898,0.62814742,0.62844574,0.62874401,0.62904221,0.62934023,
-0.62963825,0.62993610,0.63023394,0.63053161,0.63082922,0.63112676,0.63142419,0.63172150,
-0.63201874,0.63231587,0.63261294,0.63290989,0.63320678,0.63350356,0.63380021,0.63409680,
-0.63439327,0.63468969,0.63498598,0.63528222,0.63557833,0.63587433,0.63617027,0.63646615,
-0.63676184,0.63705748,0.63735306,0.63764852,0.63794392,0.63823920,0.63853437,0.63882947,
-0.63912445,0.63941932,0.63971418,0.64000887,0.64030349,0.64059800,0.64089245,0.64118677,
-0.64148104,0.64177513,0.64206922,0.64236319,0.64265704,0.64295083,0.64324450,0.64353806,
-0.64383155,0.64412493,0.64441824,0.64471143,0.64500451,0.64529753,0.64559048,0.64588326,
-0.64617604,0.64646864,0.64676118,0.64705360,0.64734596,0.64763820,0.64793038,0.64822245,
-0.64851439,0.64880627,0.64909804,0.64938974,0.64968133,0.64997280,0.65026420,0.65055549,
-0.65084666,0.65113777,0.65142882,0.65171969,0.65201056,0.65230125,0.65259188,0.65288240,
-0.65317285,0.65346318,0.65375340,0.65404356,0.65433359,0.65462357,0.65491343,0.65520316,
-0.65549284,0.65578240,0.65607190,0.65636128,0.65665054,0.65693974,0.65722883,0.65751779,
-0.65780669,0.65809548,0.65838420,0.65867281,0.65896130,0.65924972,0.65953803,0.65982622,
-0.66011435,0.66040236,0.66069031,0.66097814,0.66126585,0.66155344,0.66184098,0.66212845,
-0.66241580,0.66270304,0.66299015,0.66327721,0.66356415,0.66385102,0.66413778,0.66442442,
-0.66471100,0.66499746,0.66528380,0.66557008,0.66585624,0.66614228,0.66642827,0.66671413,
-0.66699994,0.66728562,0.66757119,0.66785663,0.66814202,0.66842735,0.66871250,0.66899759,
-0.66928262,0.66956747,0.66985226,0.67013699,0.67042154,0.67070603,0.67099047,0.67127478,
-0.67155898,0.67184305,0.67212707,0.67241096,0.67269474,0.67297846,0.67326206,0.67354560,
-0.67382902,0.67411232,0.67439550,0.67467862,0.67496163,0.67524457,0.67552739,0.67581010,
-0.67609268,0.67637521,0.67665762,0.67693996,0.67722219,0.67750430,0.67778629,0.67806822,
-0.67835003,0.67863178,0.67891335,0.67919493,0.67947632,0.67975765,0.68003887,0.68031996,
-0.68060100,0.68088192,0.68116271,0.68144345,0.68172407,0.68200457,0.68228501,0.68256533,
-0.68284553,0.68312567,0.68340570,0.68368560,0.68396538,0.68424511,0.68452471,0.68480426,
-0.68508369,0.68536299,0.68564218,0.68592131,0.68620032,0.68647921,0.68675804,0.68703675,
-0.68731534,0.68759382,0.68787223,0.68815053,0.68842876,0.68870687,0.68898487,0.68926275,
-0.68954057,0.68981826,0.69009584,0.69037330,0.69065070,0.69092798,0.69120520,0.69148225,
-0.69175923,0.69203615,0.69231290,0.69258958,0.69286615,0.69314265,0.69341904,0.69369531,
-0.69397146,0.69424754,0.69452351,0.69479936,0.69507509,0.69535077,0.69562632,0.69590175,
-0.69617712,0.69645238,0.69672751,0.69700259,0.69727749,0.69755232,0.69782710,0.69810170,
-0.69837624,0.69865066,0.69892502,0.69919920,0.69947332,0.69974738,0.70002127,0.70029509,
-0.70056880,0.70084238,0.70111591,0.70138931,0.70166260,0.70193577,0.70220888,0.70248187,
-0.70275474,0.70302755,0.70330018,0.70357275,0.70384526,0.70411760,0.70438987,0.70466202,
-0.70493406,0.70520604,0.70547789,0.70574963,0.70602125,0.70629281,0.70656425,0.70683557,
-0.70710677,0.70737791,0.70764893,0.70791984,0.70819062,0.70846134,0.70873195,0.70900244,
-0.70927280,0.70954311,0.70981330,0.71008337,0.71035337,0.71062320,0.71089298,0.71116263,
-0.71143222,0.71170163,0.71197098,0.71224022,0.71250939,0.71277839,0.71304733,0.71331614,
-0.71358484,0.71385348,0.71412200,0.71439040,0.71465868,0.71492690,0.71519494,0.71546292,
-0.71573085,0.71599859,0.71626627,0.71653384,0.71680129,0.71706861,0.71733588,0.71760303,
-0.71787006,0.71813697,0.71840382,0.71867049,0.71893710,0.71920365,0.71947002,0.71973634,
-0.72000253,0.72026861,0.72053456,0.72080046,0.72106618,0.72133183,0.72159743,0.72186285,
-0.72212821,0.72239345,0.72265857,0.72292358,0.72318846,0.72345328,0.72371799,0.72398257,
-0.72424710,0.72451144,0.72477573,0.72503990,0.72530395,0.72556794,0.72583181,0.72609550,
-0.72635913,0.72662270,0.72688609,0.72714943,0.72741264,0.72767574,0.72793871,0.72820163,
-0.72846437,0.72872704,0.72898960,0.72925210,0.72951442,0.72977668,0.73003882,0.73030084,
-0.73056275,0.73082459,0.73108631,0.73134792,0.73160940,0.73187077,0.73213202,0.73239321,
-0.73265427,0.73291522,0.73317605,0.73343682,0.73369741,0.73395795,0.73421836,0.73447865,
-0.73473889,0.73499894,0.73525894,0.73551881,0.73577857,0.73603827,0.73629779,0.73655725,
-0.73681659,0.73707581,0.73733491,0.73759389,0.73785281,0.73811162,0.73837030,0.73862886,
-0.73888731,0.73914570,0.73940390,0.73966205,0.73992008,0.74017799,0.74043584,0.74069351,
-0.74095112,0.74120861,0.74146599,0.74172324,0.74198043,0.74223745,0.74249440,0.74275124,
-0.74300796,0.74326456,0.74352109,0.74377745,0.74403375,0.74428993,0.74454600,0.74480194,
-0.74505776,0.74531353,0.74556917,0.74582469,0.74608010,0.74633539,0.74659055,0.74684566,
-0.74710059,0.74735546,0.74761021,0.74786484,0.74811935,0.74837381,0.74862808,0.74888229,
-0.74913639,0.74939036,0.74964422,0.74989802,0.75015163,0.75040519,0.75065863,0.75091195,
-0.75116515,0.75141823,0.75167120,0.75192410,0.75217682,0.75242949,0.75268203,0.75293446,
-0.75318682,0.75343901,0.75369114,0.75394309,0.75419497,0.75444674,0.75469840,0.75494993,
-0.75520140,0.75545269,0.75570393,0.75595504,0.75620598,0.75645685,0.75670767,0.75695831,
-0.75720882,0.75745928,0.75770962,0.75795978,0.75820988,0.75845993,0.75870979,0.75895953,
-0.75920922,0.75945872,0.75970817,0.75995749,0.76020670,0.76045579,0.76070476,0.76095361,
-0.76120239,0.76145101,0.76169956,0.76194799,0.76219630,0.76244450,0.76269257,0.76294053,
-0.76318842,0.76343614,0.76368380,0.76393133,0.76417875,0.76442605,0.76467323,0.76492029,
-0.76516724,0.76541412,0.76566088,0.76590747,0.76615399,0.76640040,0.76664668,0.76689285,
-0.76713890,0.76738489,0.76763070,0.76787645,0.76812202,0.76836753,0.76861292,0.76885819,
-0.76910335,0.76934838,0.76959330,0.76983815,0.77008283,0.77032745,0.77057189,0.77081627,
-0.77106053,0.77130467,0.77154869,0.77179259,0.77203637,0.77228010,0.77252364,0.77276713,
-0.77301043,0.77325368,0.77349681,0.77373981,0.77398270,0.77422547,0.77446812,0.77471066,
-0.77495313,0.77519542,0.77543765,0.77567971,0.77592170,0.77616358,0.77640533,0.77664697,
-0.77688849,0.77712989,0.77737117,0.77761233,0.77785343,0.77809435,0.77833521,0.77857590,
-0.77881652,0.77905703,0.77929735,0.77953762,0.77977777,0.78001779,0.78025776,0.78049755,
-0.78073722,0.78097677,0.78121626,0.78145558,0.78169483,0.78193396,0.78217292,0.78241181,
-0.78265059,0.78288925,0.78312778,0.78336620,0.78360450,0.78384268,0.78408080,0.78431875,
-0.78455657,0.78479433,0.78503191,0.78526944,0.78550684,0.78574407,0.78598124,0.78621829,
-0.78645521,0.78669202,0.78692871,0.78716528,0.78740174,0.78763807,0.78787434,0.78811044,
-0.78834641,0.78858232,0.78881806,0.78905374,0.78928924,0.78952467,0.78975999,0.78999513,
-0.79023021,0.79046518,0.79070002,0.79093474,0.79116935,0.79140383,0.79163820,0.79187244,
-0.79210657,0.79234058,0.79257452,0.79280829,0.79304194,0.79327554,0.79350895,0.79374230,
-0.79397547,0.79420859,0.79444152,0.79467440,0.79490715,0.79513973,0.79537225,0.79560465,
-0.79583693,0.79606909,0.79630107,0.79653299,0.79676479,0.79699647,0.79722804,0.79745948,
-0.79769087,0.79792207,0.79815316,0.79838413,0.79861498,0.79884577,0.79907638,0.79930687,
-0.79953724,0.79976755,0.79999769,0.80022776,0.80045766,0.80068749,0.80091715,0.80114675,
-0.80137616,0.80160552,0.80183470,0.80206382,0.80229282,0.80252165,0.80275041,0.80297905,
-0.80320752,0.80343592,0.80366421,0.80389231,0.80412036,0.80434829,0.80457610,0.80480379,
-0.80503136,0.80525875,0.80548608,0.80571330,0.80594039,0.80616736,0.80639422,0.80662096,
-0.80684757,0.80707407,0.80730045,0.80752671,0.80775285,0.80797881,0.80820471,0.80843049,
-0.80865616,0.80888170,0.80910712,0.80933243,0.80955762,0.80978268,0.81000763,0.81023246,
-0.81045717,0.81068176,0.81090623,0.81113064,0.81135488,0.81157899,0.81180298,0.81202686,
-0.81225061,0.81247425,0.81269777,0.81292117,0.81314439,0.81336755,0.81359059,0.81381351,
-0.81403631,0.81425899,0.81448156,0.81470400,0.81492633,0.81514853,0.81537062,0.81559259,
-0.81581444,0.81603611,0.81625772,0.81647921,0.81670058,0.81692183,0.81714290,0.81736392,
-0.81758481,0.81780559,0.81802619,0.81824672,0.81846714,0.81868738,0.81890756,0.81912762,
-0.81934750,0.81956732,0.81978697,0.82000655,0.82022595,0.82044530,0.82066447,0.82088357,
-0.82110250,0.82132137,0.82154006,0.82175863,0.82197714,0.82219547,0.82241368,0.82263178,
-0.82284981,0.82306767,0.82328540,0.82350302,0.82372051,0.82393789,0.82415515,0.82437229,
-0.82458931,0.82480621,0.82502300,0.82523960,0.82545614,0.82567257,0.82588887,0.82610500,
-0.82632107,0.82653701,0.82675278,0.82696849,0.82718402,0.82739949,0.82761478,0.82782996,
-0.82804507,0.82826000,0.82847482,0.82868952,0.82890409,0.82911855,0.82933295,0.82954711,
-0.82976121,0.82997519,0.83018905,0.83040279,0.83061641,0.83082986,0.83104324,0.83125651,
-0.83146960,0.83168262,0.83189547,0.83210826,0.83232087,0.83253336,0.83274579,0.83295804,
-0.83317018,0.83338219,0.83359408,0.83380586,0.83401752,0.83422905,0.83444041,0.83465171,
-0.83486289,0.83507389,0.83528483,0.83549559,0.83570629,0.83591682,0.83612728,0.83633757,
-0.83654773,0.83675778,0.83696771,0.83717752,0.83738720,0.83759677,0.83780622,0.83801550,
-0.83822471,0.83843380,0.83864272,0.83885151,0.83906025,0.83926880,0.83947724,0.83968562,
-0.83989382,0.84010190,0.84030986,0.84051764,0.84072536,0.84093297,0.84114045,0.84134775,
-0.84155500,0.84176207,0.84196901,0.84217590,0.84238261,0.84258920,0.84279567,0.84300202,
-0.84320825,0.84341437,0.84362030,0.84382617,0.84403187,0.84423751,0.84444296,0.84464836,
-0.84485358,0.84505868,0.84526366,0.84546852,0.84567326,0.84587789,0.84608233,0.84628671,
-0.84649092,0.84669507,0.84689903,0.84710288,0.84730661,0.84751028,0.84771377,0.84791708,
-0.84812033,0.84832346,0.84852648,0.84872931,0.84893203,0.84913468,0.84933716,0.84953952,
-0.84974176,0.84994388,0.85014588,0.85034776,0.85054946,0.85075110,0.85095257,0.85115397,
-0.85135520,0.85155630,0.85175729,0.85195816,0.85215890,0.85235953,0.85255998,0.85276037,
-0.85296059,0.85316074,0.85336071,0.85356057,0.85376030,0.85395992,0.85415941,0.85435873,
-0.85455799,0.85475707,0.85495609,0.85515493,0.85535365,0.85555226,0.85575074,0.85594910,
-0.85614735,0.85634542,0.85654342,0.85674125,0.85693896,0.85713655,0.85733402,0.85753137,
-0.85772860,0.85792571,0.85812265,0.85831952,0.85851622,0.85871279,0.85890925,0.85910559,
-0.85930181,0.85949790,0.85969388,0.85988969,0.86008537,0.86028099,0.86047643,0.86067176,
-0.86086696,0.86106199,0.86125696,0.86145175,0.86164647,0.86184102,0.86203545,0.86222976,
-0.86242396,0.86261803,0.86281192,0.86300576,0.86319941,0.86339295,0.86358637,0.86377966,
-0.86397284,0.86416590,0.86435878,0.86455160,0.86474425,0.86493677,0.86512917,0.86532146,
-0.86551362,0.86570567,0.86589754,0.86608928,0.86628097,0.86647248,0.86666387,0.86685508,
-0.86704624,0.86723727,0.86742812,0.86761886,0.86780947,0.86799997,0.86819035,0.86838061,
-0.86857069,0.86876070,0.86895055,0.86914027,0.86932987,0.86951935,0.86970866,0.86989790,
-0.87008697,0.87027597,0.87046480,0.87065351,0.87084204,0.87103051,0.87121886,0.87140703,
-0.87159508,0.87178302,0.87197083,0.87215853,0.87234604,0.87253350,0.87272078,0.87290794,
-0.87309498,0.87328190,0.87346870,0.87365532,0.87384182,0.87402827,0.87421453,0.87440062,
-0.87458664,0.87477255,0.87495828,0.87514389,0.87532938,0.87551475,0.87570000,0.87588513,
-0.87607008,0.87625492,0.87643969,0.87662429,0.87680870,0.87699306,0.87717724,0.87736136,
-0.87754530,0.87772912,0.87791282,0.87809634,0.87827981,0.87846309,0.87864625,0.87882930,
-0.87901223,0.87919503,0.87937766,0.87956017,0.87974262,0.87992483,0.88010699,0.88028902,
-0.88047087,0.88065267,0.88083428,0.88101578,0.88119709,0.88137835,0.88155943,0.88174045,
-0.88192129,0.88210195,0.88228256,0.88246304,0.88264334,0.88282353,0.88300359,0.88318354,
-0.88336337,0.88354301,0.88372254,0.88390195,0.88408124,0.88426042,0.88443947,0.88461834,
-0.88479710,0.88497573,0.88515425,0.88533258,0.88551086,0.88568896,0.88586694,0.88604480,
-0.88622254,0.88640010,0.88657761,0.88675493,0.88693213,0.88710916,0.88728613,0.88746291,
-0.88763964,0.88781619,0.88799256,0.88816887,0.88834506,0.88852108,0.88869697,0.88887274,
-0.88904834,0.88922387,0.88939923,0.88957447,0.88974959,0.88992459,0.89009941,0.89027411,
-0.89044875,0.89062315,0.89079750,0.89097172,0.89114577,0.89131969,0.89149350,0.89166719,
-0.89184070,0.89201415,0.89218742,0.89236057,0.89253354,0.89270645,0.89287919,0.89305180,
-0.89322430,0.89339668,0.89356887,0.89374095,0.89391297,0.89408475,0.89425647,0.89442807,
-0.89459950,0.89477080,0.89494199,0.89511299,0.89528394,0.89545470,0.89562535,0.89579588,
-0.89596623,0.89613652,0.89630663,0.89647663,0.89664650,0.89681619,0.89698577,0.89715523,
-0.89732456,0.89749378,0.89766282,0.89783180,0.89800060,0.89816928,0.89833778,0.89850616,
-0.89867449,0.89884263,0.89901060,0.89917850,0.89934623,0.89951384,0.89968133,0.89984870,
-0.90001589,0.90018296,0.90034992,0.90051675,0.90068340,0.90085000,0.90101641,0.90118271,
-0.90134883,0.90151489,0.90168077,0.90184653,0.90201217,0.90217763,0.90234298,0.90250820,
-0.90267330,0.90283829,0.90300310,0.90316778,0.90333235,0.90349680,0.90366107,0.90382528,
-0.90398932,0.90415317,0.90431696,0.90448058,0.90464407,0.90480745,0.90497071,0.90513378,
-0.90529674,0.90545958,0.90562230,0.90578485,0.90594727,0.90610957,0.90627176,0.90643382,
-0.90659571,0.90675747,0.90691912,0.90708059,0.90724200,0.90740323,0.90756434,0.90772527,
-0.90788609,0.90804684,0.90820736,0.90836781,0.90852809,0.90868831,0.90884835,0.90900820,
-0.90916800,0.90932763,0.90948713,0.90964645,0.90980572,0.90996480,0.91012377,0.91028261,
-0.91044128,0.91059983,0.91075826,0.91091657,0.91107476,0.91123277,0.91139066,0.91154844,
-0.91170603,0.91186351,0.91202086,0.91217810,0.91233516,0.91249216,0.91264898,0.91280562,
-0.91296220,0.91311860,0.91327488,0.91343105,0.91358703,0.91374290,0.91389865,0.91405427,
-0.91420978,0.91436511,0.91452032,0.91467535,0.91483033,0.91498512,0.91513979,0.91529429,
-0.91544873,0.91560298,0.91575712,0.91591108,0.91606498,0.91621870,0.91637230,0.91652572,
-0.91667908,0.91683227,0.91698527,0.91713822,0.91729099,0.91744363,0.91759616,0.91774851,
-0.91790080,0.91805291,0.91820484,0.91835672,0.91850841,0.91865999,0.91881138,0.91896272,
-0.91911387,0.91926485,0.91941577,0.91956651,0.91971713,0.91986763,0.92001796,0.92016822,
-0.92031831,0.92046821,0.92061806,0.92076772,0.92091721,0.92106664,0.92121589,0.92136502,
-0.92151403,0.92166293,0.92181164,0.92196023,0.92210865,0.92225701,0.92240518,0.92255324,
-0.92270112,0.92284888,0.92299652,0.92314404,0.92329144,0.92343867,0.92358577,0.92373270,
-0.92387950,0.92402625,0.92417276,0.92431921,0.92446548,0.92461163,0.92475760,0.92490351,
-0.92504925,0.92519486,0.92534029,0.92548561,0.92563081,0.92577589,0.92592078,0.92606556,
-0.92621022,0.92635477,0.92649913,0.92664337,0.92678750,0.92693144,0.92707527,0.92721897,
-0.92736250,0.92750597,0.92764926,0.92779237,0.92793542,0.92807829,0.92822099,0.92836362,
-0.92850608,0.92864841,0.92879063,0.92893267,0.92907459,0.92921638,0.92935801,0.92949951,
-0.92964089,0.92978215,0.92992324,0.93006420,0.93020505,0.93034571,0.93048626,0.93062669,
-0.93076694,0.93090713,0.93104708,0.93118697,0.93132669,0.93146628,0.93160576,0.93174505,
-0.93188429,0.93202329,0.93216223,0.93230098,0.93243963,0.93257815,0.93271649,0.93285471,
-0.93299282,0.93313074,0.93326855,0.93340623,0.93354380,0.93368119,0.93381846,0.93395555,
-0.93409252,0.93422937,0.93436611,0.93450272,0.93463916,0.93477541,0.93491161,0.93504763,
-0.93518353,0.93531924,0.93545485,0.93559033,0.93572569,0.93586087,0.93599594,0.93613088,
-0.93626565,0.93640029,0.93653482,0.93666923,0.93680346,0.93693757,0.93707150,0.93720531,
-0.93733901,0.93747258,0.93760598,0.93773925,0.93787235,0.93800539,0.93813825,0.93827093,
-0.93840355,0.93853599,0.93866831,0.93880045,0.93893248,0.93906438,0.93919611,0.93932772,
-0.93945920,0.93959057,0.93972176,0.93985283,0.93998373,0.94011456,0.94024521,0.94037569,
-0.94050604,0.94063628,0.94076639,0.94089633,0.94102615,0.94115585,0.94128537,0.94141477,
-0.94154406,0.94167322,0.94180220,0.94193101,0.94205976,0.94218832,0.94231677,0.94244504,
-0.94257319,0.94270122,0.94282907,0.94295686,0.94308442,0.94321191,0.94333923,0.94346642,
-0.94359344,0.94372034,0.94384712,0.94397378,0.94410026,0.94422662,0.94435281,0.94447893,
-0.94460481,0.94473064,0.94485629,0.94498181,0.94510722,0.94523245,0.94535756,0.94548249,
-0.94560730,0.94573200,0.94585657,0.94598097,0.94610524,0.94622934,0.94635338,0.94647717,
-0.94660091,0.94672447,0.94684792,0.94697124,0.94709438,0.94721740,0.94734025,0.94746298,
-0.94758558,0.94770807,0.94783038,0.94795257,0.94807458,0.94819647,0.94831824,0.94843990,
-0.94856137,0.94868267,0.94880390,0.94892496,0.94904590,0.94916666,0.94928730,0.94940782,
-0.94952816,0.94964838,0.94976848,0.94988847,0.95000827,0.95012790,0.95024747,0.95036685,
-0.95048606,0.95060515,0.95072412,0.95084298,0.95096165,0.95108020,0.95119864,0.95131689,
-0.95143503,0.95155299,0.95167089,0.95178854,0.95190614,0.95202357,0.95214087,0.95225799,
-0.95237499,0.95249188,0.95260859,0.95272517,0.95284164,0.95295793,0.95307410,0.95319015,
-0.95330602,0.95342177,0.95353740,0.95365286,0.95376819,0.95388335,0.95399845,0.95411330,
-0.95422810,0.95434272,0.95445722,0.95457155,0.95468575,0.95479983,0.95491374,0.95502752,
-0.95514119,0.95525467,0.95536804,0.95548123,0.95559436,0.95570725,0.95582008,0.95593274,
-0.95604527,0.95615762,0.95626986,0.95638198,0.95649391,0.95660573,0.95671743,0.95682895,
-0.95694035,0.95705158,0.95716268,0.95727366,0.95738453,0.95749521,0.95760572,0.95771617,
-0.95782644,0.95793653,0.95804650,0.95815635,0.95826608,0.95837563,0.95848507,0.95859432,
-0.95870346,0.95881248,0.95892131,0.95903003,0.95913863,0.95924705,0.95935535,0.95946348,
-0.95957154,0.95967937,0.95978713,0.95989472,0.96000212,0.96010947,0.96021664,0.96032363,
-0.96043050,0.96053725,0.96064389,0.96075034,0.96085662,0.96096283,0.96106887,0.96117473,
-0.96128047,0.96138608,0.96149158,0.96159691,0.96170205,0.96180713,0.96191204,0.96201676,
-0.96212143,0.96222585,0.96233022,0.96243441,0.96253848,0.96264237,0.96274614,0.96284980,
-0.96295327,0.96305662,0.96315980,0.96326286,0.96336579,0.96346855,0.96357119,0.96367371,
-0.96377605,0.96387827,0.96398038,0.96408230,0.96418405,0.96428573,0.96438724,0.96448857,
-0.96458977,0.96469086,0.96479183,0.96489263,0.96499324,0.96509379,0.96519411,0.96529436,
-0.96539444,0.96549439,0.96559417,0.96569383,0.96579337,0.96589273,0.96599197,0.96609104,
-0.96618998,0.96628881,0.96638745,0.96648598,0.96658438,0.96668261,0.96678072,0.96687865,
-0.96697646,0.96707416,0.96717167,0.96726906,0.96736628,0.96746337,0.96756035,0.96765715,
-0.96775383,0.96785039,0.96794677,0.96804303,0.96813911,0.96823508,0.96833086,0.96842659,
-0.96852207,0.96861750,0.96871275,0.96880782,0.96890283,0.96899760,0.96909231,0.96918684,
-0.96928126,0.96937549,0.96946961,0.96956354,0.96965736,0.96975106,0.96984458,0.96993798,
-0.97003126,0.97012436,0.97021735,0.97031015,0.97040284,0.97049540,0.97058779,0.97068006,
-0.97077215,0.97086412,0.97095591,0.97104764,0.97113913,0.97123057,0.97132182,0.97141290,
-0.97150391,0.97159469,0.97168541,0.97177595,0.97186631,0.97195661,0.97204673,0.97213668,
-0.97222650,0.97231621,0.97240573,0.97249514,0.97258437,0.97267348,0.97276247,0.97285128,
-0.97293997,0.97302848,0.97311687,0.97320515,0.97329324,0.97338122,0.97346902,0.97355670,
-0.97364426,0.97373164,0.97381890,0.97390598,0.97399294,0.97407979,0.97416645,0.97425300,
-0.97433937,0.97442561,0.97451174,0.97459769,0.97468352,0.97476918,0.97485471,0.97494012,
-0.97502536,0.97511047,0.97519541,0.97528023,0.97536486,0.97544938,0.97553378,0.97561800,
-0.97570211,0.97578609,0.97586989,0.97595358,0.97603709,0.97612047,0.97620368,0.97628677,
-0.97636974,0.97645253,0.97653520,0.97661769,0.97670007,0.97678232,0.97686440,0.97694635,
-0.97702813,0.97710979,0.97719133,0.97727269,0.97735387,0.97743499,0.97751594,0.97759670,
-0.97767735,0.97775787,0.97783822,0.97791845,0.97799850,0.97807842,0.97815824,0.97823787,
-0.97831738,0.97839671,0.97847593,0.97855502,0.97863394,0.97871268,0.97879136,0.97886986,
-0.97894818,0.97902638,0.97910446,0.97918236,0.97926015,0.97933775,0.97941524,0.97949255,
-0.97956979,0.97964680,0.97972375,0.97980046,0.97987711,0.97995359,0.98002988,0.98010612,
-0.98018211,0.98025805,0.98033381,0.98040938,0.98048484,0.98056018,0.98063534,0.98071039,
-0.98078525,0.98085999,0.98093462,0.98100907,0.98108339,0.98115754,0.98123157,0.98130548,
-0.98137921,0.98145276,0.98152626,0.98159951,0.98167270,0.98174572,0.98181856,0.98189127,
-0.98196387,0.98203629,0.98210859,0.98218071,0.98225272,0.98232460,0.98239630,0.98246789,
-0.98253930,0.98261058,0.98268169,0.98275268,0.98282355,0.98289424,0.98296481,0.98303521,
-0.98310548,0.98317564,0.98324561,0.98331541,0.98338509,0.98345464,0.98352402,0.98359329,
-0.98366243,0.98373139,0.98380023,0.98386890,0.98393744,0.98400581,0.98407406,0.98414212,
-0.98421007,0.98427790,0.98434556,0.98441309,0.98448044,0.98454767,0.98461479,0.98468173,
-0.98474848,0.98481518,0.98488164,0.98494804,0.98501426,0.98508030,0.98514622,0.98521203,
-0.98527765,0.98534316,0.98540848,0.98547369,0.98553872,0.98560363,0.98566842,0.98573303,
-0.98579752,0.98586184,0.98592603,0.98599005,0.98605394,0.98611772,0.98618132,0.98624480,
-0.98630810,0.98637128,0.98643428,0.98649716,0.98655993,0.98662251,0.98668492,0.98674726,
-0.98680937,0.98687142,0.98693329,0.98699498,0.98705655,0.98711801,0.98717928,0.98724043,
-0.98730141,0.98736227,0.98742294,0.98748350,0.98754394,0.98760420,0.98766434,0.98772430,
-0.98778415,0.98784381,0.98790336,0.98796278,0.98802203,0.98808110,0.98814011,0.98819888,
-0.98825759,0.98831612,0.98837447,0.98843271,0.98849082,0.98854876,0.98860651,0.98866421,
-0.98872167,0.98877907,0.98883629,0.98889333,0.98895025,0.98900706,0.98906368,0.98912019,
-0.98917651,0.98923272,0.98928875,0.98934466,0.98940045,0.98945606,0.98951149,0.98956686,
-0.98962200,0.98967707,0.98973197,0.98978668,0.98984128,0.98989570,0.98995006,0.99000418,
-0.99005818,0.99011207,0.99016583,0.99021935,0.99027282,0.99032611,0.99037921,0.99043226,
-0.99048507,0.99053776,0.99059033,0.99064279,0.99069500,0.99074715,0.99079913,0.99085093,
-0.99090266,0.99095416,0.99100554,0.99105680,0.99110794,0.99115884,0.99120969,0.99126035,
-0.99131083,0.99136126,0.99141145,0.99146152,0.99151146,0.99156123,0.99161088,0.99166042,
-0.99170977,0.99175894,0.99180800,0.99185693,0.99190569,0.99195433,0.99200279,0.99205112,
-0.99209929,0.99214733,0.99219525,0.99224299,0.99229062,0.99233806,0.99238533,0.99243253,
-0.99247956,0.99252641,0.99257314,0.99261969,0.99266613,0.99271244,0.99275857,0.99280459,
-0.99285042,0.99289614,0.99294168,0.99298710,0.99303234,0.99307746,0.99312246,0.99316728,
-0.99321193,0.99325651,0.99330086,0.99334514,0.99338919,0.99343318,0.99347699,0.99352062,
-0.99356413,0.99360752,0.99365073,0.99369377,0.99373674,0.99377948,0.99382216,0.99386466,
-0.99390697,0.99394917,0.99399120,0.99403310,0.99407488,0.99411649,0.99415797,0.99419928,
-0.99424046,0.99428147,0.99432236,0.99436307,0.99440366,0.99444413,0.99448442,0.99452454,
-0.99456459,0.99460441,0.99464417,0.99468368,0.99472314,0.99476242,0.99480152,0.99484050,
-0.99487931,0.99491799,0.99495655,0.99499494,0.99503320,0.99507129,0.99510926,0.99514705,
-0.99518472,0.99522227,0.99525958,0.99529684,0.99533391,0.99537086,0.99540764,0.99544424,
-0.99548078,0.99551708,0.99555331,0.99558938,0.99562526,0.99566102,0.99569660,0.99573207,
-0.99576741,0.99580258,0.99583763,0.99587250,0.99590725,0.99594182,0.99597627,0.99601054,
-0.99604470,0.99607873,0.99611259,0.99614626,0.99617982,0.99621326,0.99624652,0.99627966,
-0.99631262,0.99634546,0.99637812,0.99641067,0.99644303,0.99647528,0.99650741,0.99653935,
-0.99657112,0.99660277,0.99663430,0.99666566,0.99669689,0.99672794,0.99675888,0.99678969,
-0.99682027,0.99685079,0.99688113,0.99691129,0.99694133,0.99697125,0.99700099,0.99703062,
-0.99706006,0.99708939,0.99711853,0.99714756,0.99717641,0.99720514,0.99723375,0.99726218,
-0.99729043,0.99731857,0.99734658,0.99737442,0.99740213,0.99742967,0.99745709,0.99748433,
-0.99751145,0.99753845,0.99756521,0.99759191,0.99761844,0.99764484,0.99767107,0.99769711,
-0.99772304,0.99774885,0.99777448,0.99779999,0.99782532,0.99785054,0.99787563,0.99790055,
-0.99792528,0.99794990,0.99797440,0.99799871,0.99802285,0.99804688,0.99807078,0.99809450,
-0.99811810,0.99814153,0.99816483,0.99818802,0.99821103,0.99823385,0.99825656,0.99827915,
-0.99830157,0.99832380,0.99834591,0.99836791,0.99838972,0.99841142,0.99843293,0.99845433,
-0.99847555,0.99849665,0.99851763,0.99853843,0.99855906,0.99857956,0.99859995,0.99862015,
-0.99864024,0.99866015,0.99867994,0.99869955,0.99871904,0.99873835,0.99875754,0.99877656,
-0.99879545,0.99881423,0.99883282,0.99885124,0.99886954,0.99888772,0.99890572,0.99892360,
-0.99894130,0.99895889,0.99897629,0.99899358,0.99901068,0.99902767,0.99904448,0.99906117,
-0.99907774,0.99909413,0.99911034,0.99912649,0.99914241,0.99915820,0.99917388,0.99918938,
-0.99920475,0.99921995,0.99923503,0.99924999,0.99926478,0.99927938,0.99929386,0.99930817,
-0.99932235,0.99933642,0.99935031,0.99936408,0.99937767,0.99939114,0.99940443,0.99941760,
-0.99943060,0.99944347,0.99945617,0.99946874,0.99948120,0.99949348,0.99950558,0.99951756,
-0.99952942,0.99954110,0.99955267,0.99956405,0.99957532,0.99958640,0.99959737,0.99960816,
-0.99961883,0.99962932,0.99963969,0.99964994,0.99966002,0.99966991,0.99967968,0.99968934,
-0.99969882,0.99970818,0.99971735,0.99972641,0.99973530,0.99974406,0.99975264,0.99976110,
-0.99976939,0.99977756,0.99978560,0.99979347,0.99980116,0.99980873,0.99981618,0.99982345,
-0.99983060,0.99983758,0.99984443,0.99985111,0.99985766,0.99986404,0.99987030,0.99987638,
-0.99988234,0.99988818,0.99989384,0.99989933,0.99990469,0.99990994,0.99991500,0.99991995,
-0.99992472,0.99992931,0.99993384,0.99993813,0.99994236,0.99994642,0.99995029,0.99995404,
-0.99995762,0.99996108,0.99996442,0.99996758,0.99997061,0.99997348,0.99997616,0.99997872,
-0.99998116,0.99998343,0.99998558,0.99998760,0.99998939,0.99999112,0.99999267,0.99999404,
-0.99999529,0.99999642,0.99999738,0.99999815,0.99999881,0.99999934,0.99999970,0.99999994,
-1.00000000
-};
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Number of table segments per quarter wave (and per octant of atan).
+ */
+#define SIN_TABLE_BITS (8)
+#define SIN_TABLE_SIZE (1 << SIN_TABLE_BITS)
+
+/**
+ * @brief Phase representing a full turn is 2^32, so a uint32_t wraps naturally.
+ */
+#define SIN_TABLE_QUARTER_TURN ((uint32_t)1 << 30)
+
+/**
+ * @brief Pi and pi / 2 in Q15 radians.
+ */
+#define SIN_TABLE_PI_Q15 (102944)
+#define SIN_TABLE_HALF_PI_Q15 (51472)
+
+/**
+ * @brief sin(i * pi / (2 * SIN_TABLE_SIZE)) in Q15, saturated to 32767.
+ */
+extern const int16_t SIN_TABLE_Q15[SIN_TABLE_SIZE + 1];
+
+/**
+ * @brief atan(i / SIN_TABLE_SIZE) in Q15 radians.
+ */
+extern const int16_t ATAN_TABLE_Q15[SIN_TABLE_SIZE + 1];
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+int16_t sin_table_sin_q15(const uint32_t phase);
+int16_t sin_table_cos_q15(const uint32_t phase);
+int32_t sin_table_atan2_q15(const int32_t y, const int32_t x);
+
+uint32_t sin_table_radians_to_phase(const float radians);
+float sin_table_sinf(const float radians);
+float sin_table_cosf(const float radians);
+float sin_table_atan2f(const float y, const float x);
 
 #endif
 
@@ -0,0 +1,211 @@
+/**
+ * @file vibration_monitor.c
+ * @brief Condition monitoring of joint vibration.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "vibration_monitor.h"
+#include "fft_q15.h"
+#include <math.h>   // sqrtf
+#include <string.h> // memset
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Largest magnitude fed to the FFT, leaving one bit of headroom.
+ */
+#define INPUT_LIMIT (1 << 14)
+
+/**
+ * @brief One-sided RMS^2 per unit of |X|^2 for an FFT scaled by 1 / N under a
+ * Hann window: 2 / (sum(w^2) / N) = 2 / (3 / 8).
+ */
+#define HANN_POWER_SCALE (16.0f / 3.0f)
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises the vibration monitor, starting with the x axis.
+ * @param monitor Vibration monitor structure.
+ * @param settings Settings.
+ */
+void vibration_monitor_init(vibration_monitor_t *const monitor, const vibration_monitor_settings_t *const settings)
+{
+    memset(monitor, 0, sizeof(*monitor));
+    monitor->settings = *settings;
+    if (monitor->settings.decimation == 0)
+    {
+        monitor->settings.decimation = 1;
+    }
+}
+
+/**
+ * @brief Adds one accelerometer sample.  Samples are ignored while a full
+ * buffer waits for vibration_monitor_process(), so this is safe to call from
+ * the sampling interrupt.
+ * @param monitor Vibration monitor structure.
+ * @param accelerometer Accelerometer sample of every axis.
+ */
+void vibration_monitor_add_sample(vibration_monitor_t *const monitor, const int32_t *const accelerometer)
+{
+    if (monitor->ready)
+    {
+        return;
+    }
+    monitor->accumulator += accelerometer[monitor->axis];
+    if (++monitor->decimation_count < monitor->settings.decimation)
+    {
+        return;
+    }
+    monitor->buffer[monitor->count] = (int16_t)(monitor->accumulator / monitor->settings.decimation);
+    monitor->accumulator = 0;
+    monitor->decimation_count = 0;
+    if (++monitor->count >= VIBRATION_MONITOR_POINTS)
+    {
+        monitor->ready = true;
+    }
+}
+
+/**
+ * @brief Transforms a full buffer and updates the summary.  Call from the
+ * idle loop; it returns immediately if the buffer is not full yet.
+ * @param monitor Vibration monitor structure.
+ * @return True if a new summary is available.
+ */
+bool vibration_monitor_process(vibration_monitor_t *const monitor)
+{
+    if (monitor->ready == false)
+    {
+        return false;
+    }
+    int16_t *const buffer = monitor->buffer;
+
+    // Remove the mean (gravity) and scale the block to use the Q15 range
+    int32_t sum = 0;
+    for (uint16_t i = 0; i < VIBRATION_MONITOR_POINTS; i++)
+    {
+        sum += buffer[i];
+    }
+    const int32_t mean = sum / VIBRATION_MONITOR_POINTS;
+    int32_t largest = 1;
+    for (uint16_t i = 0; i < VIBRATION_MONITOR_POINTS; i++)
+    {
+        const int32_t deviation = (buffer[i] > mean) ? buffer[i] - mean : mean - buffer[i];
+        if (deviation > largest)
+        {
+            largest = deviation;
+        }
+    }
+    // Gain of 2^up / 2^down that brings largest into (INPUT_LIMIT / 2, INPUT_LIMIT],
+    // with at most one of the two non-zero; largest is at most 65535
+    uint8_t up = 0;
+    uint8_t down = 0;
+    while ((largest << (up + 1)) <= INPUT_LIMIT)
+    {
+        up++;
+    }
+    while ((largest >> down) > INPUT_LIMIT)
+    {
+        down++;
+    }
+
+    // Window and expand to interleaved complex in place, last sample first.
+    // Signed samples are scaled by multiplying and dividing, not shifting.
+    for (int32_t i = VIBRATION_MONITOR_POINTS - 1; i >= 0; i--)
+    {
+        const int32_t x = (buffer[i] - mean) * (1 << up) / (1 << down);
+        buffer[2 * i] = (int16_t)((x * fft_q15_hann((uint16_t)i, VIBRATION_MONITOR_LOG2_POINTS)) >> 15);
+        buffer[2 * i + 1] = 0;
+    }
+    fft_q15(buffer, VIBRATION_MONITOR_LOG2_POINTS);
+
+    // Reduce the one-sided spectrum
+    vibration_summary_t *const summary = &monitor->summary;
+    memset(summary, 0, sizeof(*summary));
+    summary->axis = monitor->axis;
+    const float bin_hz = monitor->settings.sample_hz /
+                         ((float)monitor->settings.decimation * (float)VIBRATION_MONITOR_POINTS);
+    const float input_gain = (float)(1 << up) / (float)(1 << down);
+    const float scale = HANN_POWER_SCALE / (input_gain * input_gain);
+    float total = 0.0f;
+    float band[VIBRATION_MONITOR_BANDS] = {0};
+    uint16_t peak = 1;
+    int32_t peak_power = -1;
+    for (uint16_t k = 1; k < VIBRATION_MONITOR_POINTS / 2; k++)
+    {
+        const int32_t re = buffer[2 * k];
+        const int32_t im = buffer[2 * k + 1];
+        const int32_t power = re * re + im * im;
+        const float frequency = (float)k * bin_hz;
+        total += (float)power;
+        for (uint8_t b = 0; b < VIBRATION_MONITOR_BANDS; b++)
+        {
+            const float *const edges = monitor->settings.band_edges_hz;
+            if ((frequency >= edges[b]) && (frequency < edges[b + 1]))
+            {
+                band[b] += (float)power;
+                break;
+            }
+        }
+        if (power > peak_power)
+        {
+            peak_power = power;
+            peak = k;
+        }
+    }
+
+    // Parabolic interpolation of the peak on magnitudes
+    float delta = 0.0f;
+    if ((peak > 1) && (peak < VIBRATION_MONITOR_POINTS / 2 - 1))
+    {
+        const float left = sqrtf((float)(buffer[2 * peak - 2] * buffer[2 * peak - 2] +
+                                         buffer[2 * peak - 1] * buffer[2 * peak - 1]));
+        const float centre = sqrtf((float)peak_power);
+        const float right = sqrtf((float)(buffer[2 * peak + 2] * buffer[2 * peak + 2] +
+                                          buffer[2 * peak + 3] * buffer[2 * peak + 3]));
+        const float denominator = left - 2.0f * centre + right;
+        if (denominator < 0.0f)
+        {
+            delta = 0.5f * (left - right) / denominator;
+        }
+    }
+    summary->peak_hz = ((float)peak + delta) * bin_hz;
+
+    // A Hann-windowed tone spreads over three bins
+    const float peak_left = (peak > 1) ? (float)(buffer[2 * peak - 2] * buffer[2 * peak - 2] +
+                                                 buffer[2 * peak - 1] * buffer[2 * peak - 1])
+                                       : 0.0f;
+    const float peak_right = (float)(buffer[2 * peak + 2] * buffer[2 * peak + 2] +
+                                     buffer[2 * peak + 3] * buffer[2 * peak + 3]);
+    summary->peak_rms = sqrtf(((float)peak_power + peak_left + peak_right) * scale);
+    summary->rms = sqrtf(total * scale);
+    for (uint8_t b = 0; b < VIBRATION_MONITOR_BANDS; b++)
+    {
+        summary->band_rms[b] = sqrtf(band[b] * scale);
+    }
+
+    // Start collecting the next axis
+    monitor->axis = (uint8_t)((monitor->axis + 1) % VIBRATION_MONITOR_AXES);
+    monitor->accumulator = 0;
+    monitor->decimation_count = 0;
+    monitor->count = 0;
+    monitor->ready = false;
+    return true;
+}
+
+/**
+ * @brief Returns the latest summary.
+ * @param monitor Vibration monitor structure.
+ * @return Summary of the axis processed last.
+ */
+const vibration_summary_t *vibration_monitor_get_summary(const vibration_monitor_t *const monitor)
+{
+    return &monitor->summary;
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,88 @@
+/**
+ * @file vibration_monitor.h
+ * @brief Condition monitoring of joint vibration.  Decimated accelerometer
+ * samples of one axis at a time are collected into a fixed buffer, which is
+ * then windowed and transformed in place by fft_q15() from the idle loop and
+ * reduced to band RMS values and a peak frequency.
+ */
+
+#ifndef _VIBRATION_MONITOR_H_
+#define _VIBRATION_MONITOR_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief FFT size, 8 to 10 for 256 to 1024 points.  The buffer is
+ * 4 * 2^VIBRATION_MONITOR_LOG2_POINTS bytes.
+ */
+#define VIBRATION_MONITOR_LOG2_POINTS (9)
+#define VIBRATION_MONITOR_POINTS (1 << VIBRATION_MONITOR_LOG2_POINTS)
+
+/**
+ * @brief Number of frequency bands in a summary.
+ */
+#define VIBRATION_MONITOR_BANDS (6)
+
+/**
+ * @brief Number of accelerometer axes, monitored in turn.
+ */
+#define VIBRATION_MONITOR_AXES (3)
+
+/**
+ * @brief Vibration monitor settings.
+ */
+typedef struct
+{
+    float sample_hz;    // rate of vibration_monitor_add_sample()
+    uint8_t decimation; // samples averaged into one FFT input
+    float band_edges_hz[VIBRATION_MONITOR_BANDS + 1];
+} vibration_monitor_settings_t;
+
+/**
+ * @brief Spectrum summary of one axis.  Amplitudes are RMS values in input
+ * units (accelerometer counts).
+ */
+typedef struct
+{
+    uint8_t axis;
+    float peak_hz;
+    float peak_rms;
+    float rms; // over every bin above DC
+    float band_rms[VIBRATION_MONITOR_BANDS];
+} vibration_summary_t;
+
+/**
+ * @brief Vibration monitor structure.  Structure members are used internally
+ * and must not be accessed by the application.
+ */
+typedef struct
+{
+    vibration_monitor_settings_t settings;
+    volatile bool ready; // buffer full, owned by vibration_monitor_process()
+    uint8_t axis;
+    uint8_t decimation_count;
+    int32_t accumulator;
+    uint16_t count;
+    int16_t buffer[2 * VIBRATION_MONITOR_POINTS]; // samples, then interleaved spectrum
+    vibration_summary_t summary;
+} vibration_monitor_t;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+void vibration_monitor_init(vibration_monitor_t *const monitor, const vibration_monitor_settings_t *const settings);
+void vibration_monitor_add_sample(vibration_monitor_t *const monitor, const int32_t *const accelerometer);
+bool vibration_monitor_process(vibration_monitor_t *const monitor);
+const vibration_summary_t *vibration_monitor_get_summary(const vibration_monitor_t *const monitor);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
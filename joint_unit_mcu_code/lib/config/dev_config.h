@@ -64,6 +64,7 @@
 #define PARITY UART_PARITY_NONE
 
 #define FLASH_TARGET_OFFSET (256 * 1024)
+#define FLASH_GYRO_OFFSET_OFFSET (FLASH_TARGET_OFFSET + FLASH_SECTOR_SIZE) // learnt gyroscope offset model
 
 // const uint8_t *flash_target_contents = (const uint8_t *) (XIP_BASE +
 // FLASH_TARGET_OFFSET);
@@ -1,32 +1,38 @@
 #include "icm42688.h"
 
-void imu_filter_init(imu_filter_t *imu_filter)
+// Anti-alias filter settings from the datasheet table, by ascending 3 dB bandwidth
+static const struct
 {
-    imu_filter->accel[0].first_order_tau = ACCEL_X_LOWPASS_TAU;
-    imu_filter->accel[0].first_order_sample_hz = ACCEL_X_LOWPASS_SAMPLE_HZ;
-    imu_filter->accel[1].first_order_tau = ACCEL_Y_LOWPASS_TAU;
-    imu_filter->accel[1].first_order_sample_hz = ACCEL_Y_LOWPASS_SAMPLE_HZ;
-    imu_filter->accel[2].first_order_tau = ACCEL_Z_LOWPASS_TAU;
-    imu_filter->accel[2].first_order_sample_hz = ACCEL_Z_LOWPASS_SAMPLE_HZ;
-    for (uint8_t i = 0; i < 3; i++)
-    {
-        low_pass_filter_init(&imu_filter->accel[i]);
-    }
+    uint16_t hz;
+    uint8_t delt;
+    uint16_t deltsqr;
+    uint8_t bitshift;
+} icm_aaf_table[] = {
+    {42, 1, 1, 15},   {84, 2, 4, 13},    {126, 3, 9, 12},   {170, 4, 16, 11},  {213, 5, 25, 10},
+    {258, 6, 36, 10}, {303, 7, 49, 9},   {348, 8, 64, 9},   {394, 9, 81, 9},   {441, 10, 100, 8},
+    {536, 12, 144, 8}, {734, 16, 256, 7},
+};
 
-    imu_filter->gyro[0].first_order_tau = GYRO_X_LOWPASS_TAU;
-    imu_filter->gyro[0].first_order_sample_hz = GYRO_X_LOWPASS_SAMPLE_HZ;
-    imu_filter->gyro[1].first_order_tau = GYRO_Y_LOWPASS_TAU;
-    imu_filter->gyro[1].first_order_sample_hz = GYRO_Y_LOWPASS_SAMPLE_HZ;
-    imu_filter->gyro[2].first_order_tau = GYRO_Z_LOWPASS_TAU;
-    imu_filter->gyro[2].first_order_sample_hz = GYRO_Z_LOWPASS_SAMPLE_HZ;
-    for (uint8_t i = 0; i < 3; i++)
-    {
-        low_pass_filter_init(&imu_filter->gyro[i]);
-    }
+// Set once a filter profile is applied; the sensor then band-limits and the MCU low-pass is bypassed
+static bool icm_ui_filter_active = false;
 
-    imu_filter->temperature.first_order_tau = TEMP_LOWPASS_TAU;
-    imu_filter->temperature.first_order_sample_hz = TEMP_LOWPASS_SAMPLE_HZ;
-    low_pass_filter_init(&imu_filter->temperature);
+void imu_filter_init(imu_filter_t *imu_filter)
+{
+    filter_bank_init(imu_filter, IMU_FILTER_CHANNELS);
+    filter_bank_set_first_order_low_pass(imu_filter, IMU_FILTER_ACCEL_X, 0, ACCEL_X_LOWPASS_CUTOFF_HZ,
+                                         ACCEL_X_LOWPASS_SAMPLE_HZ);
+    filter_bank_set_first_order_low_pass(imu_filter, IMU_FILTER_ACCEL_Y, 0, ACCEL_Y_LOWPASS_CUTOFF_HZ,
+                                         ACCEL_Y_LOWPASS_SAMPLE_HZ);
+    filter_bank_set_first_order_low_pass(imu_filter, IMU_FILTER_ACCEL_Z, 0, ACCEL_Z_LOWPASS_CUTOFF_HZ,
+                                         ACCEL_Z_LOWPASS_SAMPLE_HZ);
+    filter_bank_set_first_order_low_pass(imu_filter, IMU_FILTER_GYRO_X, 0, GYRO_X_LOWPASS_CUTOFF_HZ,
+                                         GYRO_X_LOWPASS_SAMPLE_HZ);
+    filter_bank_set_first_order_low_pass(imu_filter, IMU_FILTER_GYRO_Y, 0, GYRO_Y_LOWPASS_CUTOFF_HZ,
+                                         GYRO_Y_LOWPASS_SAMPLE_HZ);
+    filter_bank_set_first_order_low_pass(imu_filter, IMU_FILTER_GYRO_Z, 0, GYRO_Z_LOWPASS_CUTOFF_HZ,
+                                         GYRO_Z_LOWPASS_SAMPLE_HZ);
+    filter_bank_set_first_order_low_pass(imu_filter, IMU_FILTER_TEMPERATURE, 0, TEMP_LOWPASS_CUTOFF_HZ,
+                                         TEMP_LOWPASS_SAMPLE_HZ);
 }
 
 void icm42688_init(imu_filter_t *imu_filter)
@@ -63,11 +69,8 @@ void icm_who_am_i(void)
     printf("icm42688 i2c address: 0x%x \r\n", icm42688_i2c_address);
 }
 
-void icm_read_sensor(sensor_imu_t *imu_raw_data)
+static void icm_parse_fifo_packet(const uint8_t *fifo_data, sensor_imu_t *imu_raw_data)
 {
-    uint8_t fifo_data[16];
-    dev_i2c_read_nbyte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_FIFO_DATA, fifo_data, 16);
-
     imu_raw_data->accel[0].element.msb = fifo_data[1];
     imu_raw_data->accel[0].element.lsb = fifo_data[2];
     imu_raw_data->accel[1].element.msb = fifo_data[3];
@@ -82,29 +85,252 @@ void icm_read_sensor(sensor_imu_t *imu_raw_data)
     imu_raw_data->gyro[2].element.msb = fifo_data[11];
     imu_raw_data->gyro[2].element.lsb = fifo_data[12];
 
-    imu_raw_data->temperature = fifo_data[13];
+    imu_raw_data->temperature = (int8_t)fifo_data[13];
+    imu_raw_data->timestamp = (uint16_t)((fifo_data[14] << 8) | fifo_data[15]);
+}
+
+void icm_read_sensor(sensor_imu_t *imu_raw_data)
+{
+    uint8_t fifo_data[ICM_FIFO_PACKET_SIZE];
+    dev_i2c_read_nbyte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_FIFO_DATA, fifo_data, ICM_FIFO_PACKET_SIZE);
+
+    icm_parse_fifo_packet(fifo_data, imu_raw_data);
+}
+
+/**
+ * Read every packet queued in the FIFO (up to max_count) in one I2C transfer.
+ * Returns the number of packets written to imu_raw_data, oldest first.
+ */
+uint16_t icm_read_fifo_burst(sensor_imu_t *imu_raw_data, uint16_t max_count)
+{
+    static uint8_t fifo_data[ICM_FIFO_BURST_MAX * ICM_FIFO_PACKET_SIZE];
+    uint8_t fifo_count[2];
+
+    // FIFO_COUNT is big endian and counts bytes by default
+    dev_i2c_read_nbyte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_FIFO_COUNTH, fifo_count, 2);
+    uint16_t count = (uint16_t)((fifo_count[0] << 8) | fifo_count[1]) / ICM_FIFO_PACKET_SIZE;
+    if (count > max_count)
+    {
+        count = max_count;
+    }
+    if (count > ICM_FIFO_BURST_MAX)
+    {
+        count = ICM_FIFO_BURST_MAX;
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    dev_i2c_read_nbyte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_FIFO_DATA, fifo_data, count * ICM_FIFO_PACKET_SIZE);
+
+    uint16_t valid = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        const uint8_t *packet = &fifo_data[i * ICM_FIFO_PACKET_SIZE];
+        if (packet[0] & ICM_FIFO_HEADER_EMPTY)
+        {
+            break;
+        }
+        icm_parse_fifo_packet(packet, &imu_raw_data[valid++]);
+    }
+    return valid;
+}
+
+static bool icm_odr_code(uint16_t sample_hz, uint8_t *odr)
+{
+    switch (sample_hz)
+    {
+    case 8000:
+        *odr = 0x03;
+        break;
+    case 4000:
+        *odr = 0x04;
+        break;
+    case 2000:
+        *odr = 0x05;
+        break;
+    case 1000:
+        *odr = 0x06;
+        break;
+    case 500:
+        *odr = 0x0F;
+        break;
+    case 200:
+        *odr = 0x07;
+        break;
+    case 100:
+        *odr = 0x08;
+        break;
+    case 50:
+        *odr = 0x09;
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Set the gyroscope and accelerometer output data rate, keeping the full
+ * scale ranges and the on-chip filters. Returns false for a rate the sensor
+ * does not support.
+ */
+bool icm_set_odr(uint16_t sample_hz)
+{
+    uint8_t odr;
+    if (!icm_odr_code(sample_hz, &odr))
+    {
+        return false;
+    }
+
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_GYRO_CONFIG0, ICM_GYRO_FS_SEL_250DPS | odr);
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_ACCEL_CONFIG0, ICM_ACCEL_FS_SEL_2G | odr);
+    return true;
+}
+
+static int8_t icm_find_aaf(uint16_t aaf_hz)
+{
+    for (uint8_t i = 0; i < sizeof(icm_aaf_table) / sizeof(icm_aaf_table[0]); i++)
+    {
+        if (icm_aaf_table[i].hz == aaf_hz)
+        {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Return the 3 dB bandwidth in Hz of a filter profile, the lower of the UI
+ * filter and anti-alias filter bandwidths. Returns 0 for a profile the sensor
+ * cannot run or that would alias, with the bandwidth above ODR / 2.
+ */
+float icm_filter_profile_bandwidth_hz(const icm_filter_profile_t *profile)
+{
+    static const uint8_t divisors[] = {2, 4, 5, 8, 10, 16, 20, 40};
+    uint8_t odr;
+    const int8_t aaf = icm_find_aaf(profile->aaf_hz);
+    if (!icm_odr_code(profile->odr_hz, &odr) || (aaf < 0) || (profile->ui_filter_order < 1) ||
+        (profile->ui_filter_order > 3))
+    {
+        return 0.0f;
+    }
+
+    float bandwidth = (float)profile->aaf_hz;
+    if (profile->ui_filter_bw <= ICM_UI_FILTER_BW_ODR_40)
+    {
+        // The divided settings run from max(400 Hz, ODR), so slow rates need the wider divisors
+        const uint16_t base =
+            ((profile->ui_filter_bw == ICM_UI_FILTER_BW_ODR_2) || (profile->odr_hz > 400)) ? profile->odr_hz : 400;
+        const float ui_bandwidth = (float)base / (float)divisors[profile->ui_filter_bw];
+        if (ui_bandwidth < bandwidth)
+        {
+            bandwidth = ui_bandwidth;
+        }
+    }
+    else if ((profile->ui_filter_bw != ICM_UI_FILTER_BW_LOW_LATENCY) &&
+             (profile->ui_filter_bw != ICM_UI_FILTER_BW_LOW_LATENCY_8X))
+    {
+        return 0.0f;
+    }
+    return (bandwidth <= 0.5f * (float)profile->odr_hz) ? bandwidth : 0.0f;
+}
+
+/**
+ * Apply the output data rate, anti-alias filter and UI filter order and
+ * bandwidth of both the gyroscope and the accelerometer as one profile, with
+ * the sensors briefly off. Returns false, leaving the sensor untouched, for a
+ * profile icm_filter_profile_bandwidth_hz() rejects. Once applied,
+ * icm_filter_sensor_data() bypasses the MCU low-pass filter.
+ */
+bool icm_set_filter_profile(const icm_filter_profile_t *profile)
+{
+    uint8_t odr;
+    if ((icm_filter_profile_bandwidth_hz(profile) == 0.0f) || !icm_odr_code(profile->odr_hz, &odr))
+    {
+        return false;
+    }
+    const int8_t aaf = icm_find_aaf(profile->aaf_hz);
+    const uint8_t delt = icm_aaf_table[aaf].delt;
+    const uint16_t deltsqr = icm_aaf_table[aaf].deltsqr;
+    const uint8_t bitshift = icm_aaf_table[aaf].bitshift;
+    const uint8_t order = profile->ui_filter_order - 1;
+    const uint8_t bw = (uint8_t)profile->ui_filter_bw;
+
+    // Filter settings are changed with the sensors off, no writes for 200 us after
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_POWER_MGMT, ICM_POWER_SENSORS_OFF);
+    dev_delay_ms(1);
+
+    uint8_t gyro_static2 = 0;
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_BANK_SEL, 1);
+    dev_i2c_read_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_BANK1_GYRO_CONFIG_STATIC2, &gyro_static2);
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_BANK1_GYRO_CONFIG_STATIC2,
+                       gyro_static2 & (uint8_t)~ICM_GYRO_AAF_DIS);
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_BANK1_GYRO_CONFIG_STATIC3, delt);
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_BANK1_GYRO_CONFIG_STATIC4, deltsqr & 0xFF);
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_BANK1_GYRO_CONFIG_STATIC5,
+                       (uint8_t)((bitshift << 4) | (deltsqr >> 8)));
+
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_BANK_SEL, 2);
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_BANK2_ACCEL_CONFIG_STATIC2, (uint8_t)(delt << 1));
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_BANK2_ACCEL_CONFIG_STATIC3, deltsqr & 0xFF);
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_BANK2_ACCEL_CONFIG_STATIC4,
+                       (uint8_t)((bitshift << 4) | (deltsqr >> 8)));
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_BANK_SEL, 0);
+
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_GYRO_CONFIG0, ICM_GYRO_FS_SEL_250DPS | odr);
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_ACCEL_CONFIG0, ICM_ACCEL_FS_SEL_2G | odr);
+    uint8_t gyro_config1 = 0;
+    uint8_t accel_config1 = 0;
+    dev_i2c_read_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_GYRO_CONFIG1, &gyro_config1);
+    dev_i2c_read_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_ACCEL_CONFIG1, &accel_config1);
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_GYRO_CONFIG1,
+                       (uint8_t)((gyro_config1 & ~ICM_GYRO_CONFIG1_FILT_MASK) | (order << 2) | ICM_DEC2_M2_ORD_3));
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_ACCEL_CONFIG1,
+                       (uint8_t)((accel_config1 & ~ICM_ACCEL_CONFIG1_FILT_MASK) | (order << 3) |
+                                 (ICM_DEC2_M2_ORD_3 << 1)));
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_GYRO_ACCEL_CONFIG0, (uint8_t)((bw << 4) | bw));
+
+    // Gyroscope start-up time is 45 ms
+    dev_i2c_write_byte(I2C_IMU_PORT, ICM42688_ADDRESS, REG_POWER_MGMT, ICM_POWER_LOW_NOISE);
+    dev_delay_ms(50);
+
+    icm_ui_filter_active = true;
+    return true;
 }
 
 void icm_filter_sensor_data(sensor_imu_t *const imu_raw_data, imu_filter_t *imu_filter)
 {
+    int32_t input[IMU_FILTER_CHANNELS];
     for (uint8_t i = 0; i < 3; i++)
     {
-        low_pass_filter_calc((int32_t) imu_raw_data->accel[i].data, &imu_filter->accel[i]);
-        low_pass_filter_calc((int32_t) imu_raw_data->gyro[i].data, &imu_filter->gyro[i]);
+        input[IMU_FILTER_ACCEL_X + i] = (int32_t)imu_raw_data->accel[i].data;
+        input[IMU_FILTER_GYRO_X + i] = (int32_t)imu_raw_data->gyro[i].data;
     }
-    low_pass_filter_calc((int32_t) imu_raw_data->temperature, &imu_filter->temperature);
+    input[IMU_FILTER_TEMPERATURE] = (int32_t)imu_raw_data->temperature;
+
+    // The sensor already band-limits with a filter profile applied, so the output follows the input
+    if (icm_ui_filter_active)
+    {
+        filter_bank_reset(imu_filter, input);
+        return;
+    }
+
+    // All seven channels in one call, multiply-shift only
+    filter_bank_update(imu_filter, input);
 }
 
 void icm_filtered_int_to_float(imu_filter_t *imu_filter, sensor_imu_float_t *imu_filtered_data)
 {
     for (int8_t i = 0; i < 3; i++)
     {
-        imu_filtered_data->accel[i] = (float)imu_filter->accel[i].previous_output *
+        imu_filtered_data->accel[i] = filter_bank_output_float(imu_filter, IMU_FILTER_ACCEL_X + i) *
                                       ACCEL_FULL_SCALE_RANGE / 32768.0;
     }
     for (int8_t i = 0; i < 3; i++)
     {
-        imu_filtered_data->gyro[i] = (float)imu_filter->gyro[i].previous_output *
+        imu_filtered_data->gyro[i] = filter_bank_output_float(imu_filter, IMU_FILTER_GYRO_X + i) *
                                      GYRO_FULL_SCALE_RANGE / 32768.0;
     }
 }
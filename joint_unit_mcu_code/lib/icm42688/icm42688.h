@@ -5,27 +5,28 @@
 #include <stdio.h>
 
 #include "common_utils.h"
-#include "first_order_filter.h"
+#include "filter_bank.h"
 
 #include "dev_config.h"
 
-#define ACCEL_X_LOWPASS_TAU       150
+// First-order low-pass cutoffs, 1 / (2 * pi * tau) for the former tau = 150 ms
+#define ACCEL_X_LOWPASS_CUTOFF_HZ 1.06f
 #define ACCEL_X_LOWPASS_SAMPLE_HZ 200
-#define ACCEL_Y_LOWPASS_TAU       150
+#define ACCEL_Y_LOWPASS_CUTOFF_HZ 1.06f
 #define ACCEL_Y_LOWPASS_SAMPLE_HZ 200
-#define ACCEL_Z_LOWPASS_TAU       150
+#define ACCEL_Z_LOWPASS_CUTOFF_HZ 1.06f
 #define ACCEL_Z_LOWPASS_SAMPLE_HZ 200
-#define GYRO_X_LOWPASS_TAU        150
+#define GYRO_X_LOWPASS_CUTOFF_HZ  1.06f
 #define GYRO_X_LOWPASS_SAMPLE_HZ  200
-#define GYRO_Y_LOWPASS_TAU        150
+#define GYRO_Y_LOWPASS_CUTOFF_HZ  1.06f
 #define GYRO_Y_LOWPASS_SAMPLE_HZ  200
-#define GYRO_Z_LOWPASS_TAU        150
+#define GYRO_Z_LOWPASS_CUTOFF_HZ  1.06f
 #define GYRO_Z_LOWPASS_SAMPLE_HZ  200
-#define TEMP_LOWPASS_TAU          150
+#define TEMP_LOWPASS_CUTOFF_HZ    1.06f
 #define TEMP_LOWPASS_SAMPLE_HZ    200
 
-#define ACCEL_FULL_SCALE_RANGE 250.0// [dps]
-#define GYRO_FULL_SCALE_RANGE 2.0// [g]
+#define ACCEL_FULL_SCALE_RANGE 2.0// [g]
+#define GYRO_FULL_SCALE_RANGE 250.0// [dps]
 
 #define ICM42688_ADDRESS 0x68 //AP_AD0 grounded
 
@@ -60,20 +61,78 @@
 
 #define REG_FIFO_CONFIG_INIT 0x16
 #define REG_FIFO_CONFIGURATION 0x5F
+#define REG_FIFO_COUNTH 0x2E
+#define REG_FIFO_COUNTL 0x2F
 #define REG_FIFO_DATA 0x30
 
+#define ICM_FIFO_PACKET_SIZE 16   // header, accel, gyro, temperature, timestamp
+#define ICM_FIFO_TIMESTAMP_US 1   // TMST_CONFIG reset value: ODR timestamp in 1 us of the sensor clock
+#define ICM_FIFO_HEADER_EMPTY 0x80
+#define ICM_FIFO_BURST_MAX 16     // packets read per burst
+#define ICM_FIFO_TEMPERATURE_TO_CELSIUS(raw) ((float)(raw) / 2.07f + 25.0f)
+#define ICM_GYRO_FS_SEL_250DPS 0x60 // GYRO_CONFIG0[7:5], see GYRO_FULL_SCALE_RANGE
+#define ICM_ACCEL_FS_SEL_2G 0x60    // ACCEL_CONFIG0[7:5], see ACCEL_FULL_SCALE_RANGE
+
+// Anti-alias filter registers, GYRO_CONFIG_STATIC2..5 in bank 1 and ACCEL_CONFIG_STATIC2..4 in bank 2
+#define REG_BANK1_GYRO_CONFIG_STATIC2 0x0B // [1] GYRO_AAF_DIS, [0] GYRO_NF_DIS
+#define REG_BANK1_GYRO_CONFIG_STATIC3 0x0C // [5:0] GYRO_AAF_DELT
+#define REG_BANK1_GYRO_CONFIG_STATIC4 0x0D // GYRO_AAF_DELTSQR[7:0]
+#define REG_BANK1_GYRO_CONFIG_STATIC5 0x0E // [7:4] GYRO_AAF_BITSHIFT, [3:0] GYRO_AAF_DELTSQR[11:8]
+#define REG_BANK2_ACCEL_CONFIG_STATIC2 0x03 // [6:1] ACCEL_AAF_DELT, [0] ACCEL_AAF_DIS
+#define REG_BANK2_ACCEL_CONFIG_STATIC3 0x04 // ACCEL_AAF_DELTSQR[7:0]
+#define REG_BANK2_ACCEL_CONFIG_STATIC4 0x05 // [7:4] ACCEL_AAF_BITSHIFT, [3:0] ACCEL_AAF_DELTSQR[11:8]
+#define ICM_GYRO_AAF_DIS 0x02
+#define ICM_DEC2_M2_ORD_3 0x02 // GYRO_CONFIG1[1:0] and ACCEL_CONFIG1[2:1], the only valid value
+#define ICM_GYRO_CONFIG1_FILT_MASK 0x0F  // UI filter order and DEC2_M2_ORD, other bits kept
+#define ICM_ACCEL_CONFIG1_FILT_MASK 0x1E // UI filter order and DEC2_M2_ORD, reserved bit 0 (reset 1) kept
+#define ICM_POWER_SENSORS_OFF 0x10 // temperature sensor and RC oscillator on, gyroscope and accelerometer off
+#define ICM_POWER_LOW_NOISE 0x1F   // temperature sensor and RC oscillator on, gyroscope and accelerometer low noise
+
+// UI filter bandwidth, GYRO_ACCEL_CONFIG0 ACCEL_UI_FILT_BW[7:4] and GYRO_UI_FILT_BW[3:0] in low noise mode
+typedef enum
+{
+    ICM_UI_FILTER_BW_ODR_2 = 0,   // ODR / 2
+    ICM_UI_FILTER_BW_ODR_4 = 1,   // max(400 Hz, ODR) / 4, the reset value
+    ICM_UI_FILTER_BW_ODR_5 = 2,   // max(400 Hz, ODR) / 5
+    ICM_UI_FILTER_BW_ODR_8 = 3,   // max(400 Hz, ODR) / 8
+    ICM_UI_FILTER_BW_ODR_10 = 4,  // max(400 Hz, ODR) / 10
+    ICM_UI_FILTER_BW_ODR_16 = 5,  // max(400 Hz, ODR) / 16
+    ICM_UI_FILTER_BW_ODR_20 = 6,  // max(400 Hz, ODR) / 20
+    ICM_UI_FILTER_BW_ODR_40 = 7,  // max(400 Hz, ODR) / 40
+    ICM_UI_FILTER_BW_LOW_LATENCY = 14,    // decimation only, the anti-alias filter limits the band
+    ICM_UI_FILTER_BW_LOW_LATENCY_8X = 15, // as above with the decimator at max(200 Hz, 8 * ODR)
+} icm_ui_filter_bw_t;
+
+// Output data rate and on-chip filtering applied together, see icm_set_filter_profile()
 typedef struct
 {
-    first_order_filter_object_t accel[3];
-    first_order_filter_object_t gyro[3];
-    first_order_filter_object_t temperature;
-} imu_filter_t;
+    uint16_t odr_hz;                 // 50 Hz to 8 kHz, see icm_set_odr()
+    uint16_t aaf_hz;                 // anti-alias filter 3 dB bandwidth, 42 Hz to 734 Hz, see icm42688.c
+    uint8_t ui_filter_order;         // 1 to 3
+    icm_ui_filter_bw_t ui_filter_bw; // must stay at or below ODR / 2
+} icm_filter_profile_t;
+
+// Channels of the IMU filter bank
+enum
+{
+    IMU_FILTER_ACCEL_X = 0,
+    IMU_FILTER_ACCEL_Y,
+    IMU_FILTER_ACCEL_Z,
+    IMU_FILTER_GYRO_X,
+    IMU_FILTER_GYRO_Y,
+    IMU_FILTER_GYRO_Z,
+    IMU_FILTER_TEMPERATURE,
+    IMU_FILTER_CHANNELS
+};
+
+typedef filter_bank_t imu_filter_t;
 
 typedef struct
 {
     data16_t gyro[3];
     data16_t accel[3];
-    uint8_t temperature;
+    int8_t temperature; // FIFO format, see ICM_FIFO_TEMPERATURE_TO_CELSIUS
+    uint16_t timestamp; // sensor clock, see ICM_FIFO_TIMESTAMP_US, wraps every 65.536 ms
 } sensor_imu_t;
 
 typedef struct
@@ -86,6 +145,10 @@ typedef struct
 void icm42688_init(imu_filter_t *imu_filter);
 void icm_who_am_i(void);
 void icm_read_sensor(sensor_imu_t *imu_raw_data);
+uint16_t icm_read_fifo_burst(sensor_imu_t *imu_raw_data, uint16_t max_count);
+bool icm_set_odr(uint16_t sample_hz);
+float icm_filter_profile_bandwidth_hz(const icm_filter_profile_t *profile);
+bool icm_set_filter_profile(const icm_filter_profile_t *profile);
 void icm_filter_sensor_data(sensor_imu_t *const imu_raw_data, imu_filter_t *imu_filter);
 void icm_filtered_int_to_float(imu_filter_t *imu_filter, sensor_imu_float_t *imu_filtered_data);
 
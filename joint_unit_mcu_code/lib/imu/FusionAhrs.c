@@ -10,7 +10,7 @@
 
 #include "FusionAhrs.h"
 #include <float.h> // FLT_MAX
-#include <math.h>  // atan2f, cosf, fabsf, powf, sinf
+#include <math.h>  // fabsf, powf, sinf
 
 //------------------------------------------------------------------------------
 // Definitions
@@ -36,6 +36,13 @@ static inline FusionVector Feedback(const FusionVector sensor, const FusionVecto
 
 static inline int Clamp(const int value, const int min, const int max);
 
+static inline void CheckGyroscopeRange(fusion_ahrs_t *const ahrs, const FusionVector gyroscope);
+
+static inline void RampGain(fusion_ahrs_t *const ahrs, const float deltaTime);
+
+static inline FusionVector AccelerometerFeedback(fusion_ahrs_t *const ahrs, const FusionVector halfGravity,
+                                                 const FusionVector accelerometer, const int samples);
+
 //------------------------------------------------------------------------------
 // Functions
 
@@ -55,6 +62,7 @@ void fusion_ahrs_init(fusion_ahrs_t *const ahrs, uint16_t sample_rate)
         .accelerationRejection = 90.0f,
         .magneticRejection = 90.0f,
         .recoveryTriggerPeriod = 0,
+        .accelerometerDecimation = 1,
     };
     fusionAhrs_set_settings(ahrs, &settings);
     fusion_ahrs_reset(ahrs);
@@ -74,6 +82,8 @@ void fusion_ahrs_reset(fusion_ahrs_t *const ahrs)
     ahrs->angularRateRecovery = false;
     ahrs->halfAccelerometerFeedback = FUSION_VECTOR_ZERO;
     ahrs->halfMagnetometerFeedback = FUSION_VECTOR_ZERO;
+    ahrs->accelerometerSum = FUSION_VECTOR_ZERO;
+    ahrs->accelerometerSamples = 0;
     ahrs->accelerometerIgnored = false;
     ahrs->accelerationRecoveryTrigger = 0;
     ahrs->accelerationRecoveryTimeout = ahrs->settings.recoveryTriggerPeriod;
@@ -101,6 +111,7 @@ void fusionAhrs_set_settings(fusion_ahrs_t *const ahrs, const FusionAhrsSettings
                                            ? FLT_MAX
                                            : powf(0.5f * sinf(FusionDegreesToRadians(settings->magneticRejection)), 2);
     ahrs->settings.recoveryTriggerPeriod = settings->recoveryTriggerPeriod;
+    ahrs->settings.accelerometerDecimation = settings->accelerometerDecimation;
     ahrs->accelerationRecoveryTimeout = ahrs->settings.recoveryTriggerPeriod;
     ahrs->magneticRecoveryTimeout = ahrs->settings.recoveryTriggerPeriod;
     if ((settings->gain == 0.0f) || (settings->recoveryTriggerPeriod == 0))
@@ -133,71 +144,16 @@ void fusion_ahrs_update(fusion_ahrs_t *const ahrs, const FusionVector gyroscope,
     ahrs->accelerometer = accelerometer;
 
     // Reinitialise if gyroscope range exceeded
-    if ((fabsf(gyroscope.axis.x) > ahrs->settings.gyroscopeRange) ||
-        (fabsf(gyroscope.axis.y) > ahrs->settings.gyroscopeRange) ||
-        (fabsf(gyroscope.axis.z) > ahrs->settings.gyroscopeRange))
-    {
-        const FusionQuaternion quaternion = ahrs->quaternion;
-        fusion_ahrs_reset(ahrs);
-        ahrs->quaternion = quaternion;
-        ahrs->angularRateRecovery = true;
-    }
+    CheckGyroscopeRange(ahrs, gyroscope);
 
     // Ramp down gain during initialisation
-    if (ahrs->initialising)
-    {
-        ahrs->rampedGain -= ahrs->rampedGainStep * deltaTime;
-        if ((ahrs->rampedGain < ahrs->settings.gain) || (ahrs->settings.gain == 0.0f))
-        {
-            ahrs->rampedGain = ahrs->settings.gain;
-            ahrs->initialising = false;
-            ahrs->angularRateRecovery = false;
-        }
-    }
+    RampGain(ahrs, deltaTime);
 
     // Calculate direction of gravity indicated by algorithm
     const FusionVector halfGravity = HalfGravity(ahrs);
 
     // Calculate accelerometer feedback
-    FusionVector halfAccelerometerFeedback = FUSION_VECTOR_ZERO;
-    ahrs->accelerometerIgnored = false;
-    if (FusionVectorIsZero(accelerometer) == false)
-    {
-
-        // Calculate accelerometer feedback scaled by 0.5
-        ahrs->halfAccelerometerFeedback = Feedback(halfGravity, FusionVectorNormalise(accelerometer));
-
-        // Don't ignore accelerometer if acceleration error below threshold
-        if (ahrs->initialising ||
-            ((FusionVectorMagnitudeSquared(ahrs->halfAccelerometerFeedback) <= ahrs->settings.accelerationRejection)))
-        {
-            ahrs->accelerometerIgnored = false;
-            ahrs->accelerationRecoveryTrigger -= 9;
-        }
-        else
-        {
-            ahrs->accelerationRecoveryTrigger += 1;
-        }
-
-        // Don't ignore accelerometer during acceleration recovery
-        if (ahrs->accelerationRecoveryTrigger > ahrs->accelerationRecoveryTimeout)
-        {
-            ahrs->accelerationRecoveryTimeout = 0;
-            ahrs->accelerometerIgnored = false;
-        }
-        else
-        {
-            ahrs->accelerationRecoveryTimeout = ahrs->settings.recoveryTriggerPeriod;
-        }
-        ahrs->accelerationRecoveryTrigger =
-            Clamp(ahrs->accelerationRecoveryTrigger, 0, ahrs->settings.recoveryTriggerPeriod);
-
-        // Apply accelerometer feedback
-        if (ahrs->accelerometerIgnored == false)
-        {
-            halfAccelerometerFeedback = ahrs->halfAccelerometerFeedback;
-        }
-    }
+    const FusionVector halfAccelerometerFeedback = AccelerometerFeedback(ahrs, halfGravity, accelerometer, 1);
 
     // Calculate magnetometer feedback
     FusionVector halfMagnetometerFeedback = FUSION_VECTOR_ZERO;
@@ -372,6 +328,101 @@ static inline int Clamp(const int value, const int min, const int max)
     return value;
 }
 
+/**
+ * @brief Reinitialises the algorithm, keeping the orientation, if the
+ * gyroscope range is exceeded.
+ * @param ahrs AHRS algorithm structure.
+ * @param gyroscope Gyroscope measurement in degrees per second.
+ */
+static inline void CheckGyroscopeRange(fusion_ahrs_t *const ahrs, const FusionVector gyroscope)
+{
+    if ((fabsf(gyroscope.axis.x) > ahrs->settings.gyroscopeRange) ||
+        (fabsf(gyroscope.axis.y) > ahrs->settings.gyroscopeRange) ||
+        (fabsf(gyroscope.axis.z) > ahrs->settings.gyroscopeRange))
+    {
+        const FusionQuaternion quaternion = ahrs->quaternion;
+        fusion_ahrs_reset(ahrs);
+        ahrs->quaternion = quaternion;
+        ahrs->angularRateRecovery = true;
+    }
+}
+
+/**
+ * @brief Ramps down the gain during initialisation.
+ * @param ahrs AHRS algorithm structure.
+ * @param deltaTime Delta time in seconds.
+ */
+static inline void RampGain(fusion_ahrs_t *const ahrs, const float deltaTime)
+{
+    if (ahrs->initialising)
+    {
+        ahrs->rampedGain -= ahrs->rampedGainStep * deltaTime;
+        if ((ahrs->rampedGain < ahrs->settings.gain) || (ahrs->settings.gain == 0.0f))
+        {
+            ahrs->rampedGain = ahrs->settings.gain;
+            ahrs->initialising = false;
+            ahrs->angularRateRecovery = false;
+        }
+    }
+}
+
+/**
+ * @brief Calculates the accelerometer feedback and updates the acceleration
+ * recovery state.
+ * @param ahrs AHRS algorithm structure.
+ * @param halfGravity Direction of gravity scaled by 0.5.
+ * @param accelerometer Accelerometer measurement, or the sum of several
+ * measurements, in g.
+ * @param samples Number of samples the measurement represents.  The recovery
+ * trigger counts samples so that recoveryTriggerPeriod does not depend on the
+ * feedback rate.
+ * @return Accelerometer feedback scaled by 0.5, or zero if ignored.
+ */
+static inline FusionVector AccelerometerFeedback(fusion_ahrs_t *const ahrs, const FusionVector halfGravity,
+                                                 const FusionVector accelerometer, const int samples)
+{
+    FusionVector halfAccelerometerFeedback = FUSION_VECTOR_ZERO;
+    ahrs->accelerometerIgnored = false;
+    if (FusionVectorIsZero(accelerometer) == false)
+    {
+
+        // Calculate accelerometer feedback scaled by 0.5
+        ahrs->halfAccelerometerFeedback = Feedback(FusionVectorNormalise(accelerometer), halfGravity);
+
+        // Don't ignore accelerometer if acceleration error below threshold
+        if (ahrs->initialising ||
+            ((FusionVectorMagnitudeSquared(ahrs->halfAccelerometerFeedback) <= ahrs->settings.accelerationRejection)))
+        {
+            ahrs->accelerometerIgnored = false;
+            ahrs->accelerationRecoveryTrigger -= 9 * samples;
+        }
+        else
+        {
+            ahrs->accelerationRecoveryTrigger += samples;
+        }
+
+        // Don't ignore accelerometer during acceleration recovery
+        if (ahrs->accelerationRecoveryTrigger > ahrs->accelerationRecoveryTimeout)
+        {
+            ahrs->accelerationRecoveryTimeout = 0;
+            ahrs->accelerometerIgnored = false;
+        }
+        else
+        {
+            ahrs->accelerationRecoveryTimeout = ahrs->settings.recoveryTriggerPeriod;
+        }
+        ahrs->accelerationRecoveryTrigger =
+            Clamp(ahrs->accelerationRecoveryTrigger, 0, ahrs->settings.recoveryTriggerPeriod);
+
+        // Apply accelerometer feedback
+        if (ahrs->accelerometerIgnored == false)
+        {
+            halfAccelerometerFeedback = ahrs->halfAccelerometerFeedback;
+        }
+    }
+    return halfAccelerometerFeedback;
+}
+
 /**
  * @brief Updates the AHRS algorithm using the gyroscope and accelerometer
  * measurements only.
@@ -394,6 +445,78 @@ void fusion_ahrs_update_no_magnetometer(fusion_ahrs_t *const ahrs, const FusionV
     }
 }
 
+/**
+ * @brief Updates the AHRS algorithm using a burst of consecutive gyroscope and
+ * accelerometer measurements, such as one read of the IMU FIFO.  Every
+ * gyroscope sample is integrated, while the accelerometer samples are summed
+ * and the accelerometer feedback is applied once per
+ * settings.accelerometerDecimation samples.  The quaternion is normalised once
+ * per call.
+ * @param ahrs AHRS algorithm structure.
+ * @param gyroscope Gyroscope measurements in degrees per second.
+ * @param accelerometer Accelerometer measurements in g.
+ * @param count Number of measurements.
+ * @param deltaTime Delta time between two measurements in seconds.
+ */
+void fusion_ahrs_update_batch_no_magnetometer(fusion_ahrs_t *const ahrs, const FusionVector *const gyroscope,
+                                              const FusionVector *const accelerometer, const unsigned int count,
+                                              const float deltaTime)
+{
+    const unsigned int decimation =
+        ahrs->settings.accelerometerDecimation == 0 ? 1 : ahrs->settings.accelerometerDecimation;
+
+    // Convert gyroscope to half of the angle turned per sample
+    const float halfDegreesToRadiansDeltaTime = FusionDegreesToRadians(0.5f) * deltaTime;
+
+    for (unsigned int index = 0; index < count; index++)
+    {
+
+        // Reinitialise if gyroscope range exceeded
+        CheckGyroscopeRange(ahrs, gyroscope[index]);
+
+        // Integrate gyroscope
+        const FusionVector halfGyroscopeDelta =
+            FusionVectorMultiplyScalar(gyroscope[index], halfDegreesToRadiansDeltaTime);
+        ahrs->quaternion =
+            FusionQuaternionAdd(ahrs->quaternion, FusionQuaternionMultiplyVector(ahrs->quaternion, halfGyroscopeDelta));
+
+        // Accumulate accelerometer until the next feedback step
+        ahrs->accelerometerSum = FusionVectorAdd(ahrs->accelerometerSum, accelerometer[index]);
+        ahrs->accelerometerSamples++;
+        if (ahrs->accelerometerSamples < decimation)
+        {
+            continue;
+        }
+
+        // Apply accelerometer feedback over the samples accumulated since the last feedback step
+        const float feedbackTime = deltaTime * (float)ahrs->accelerometerSamples;
+        RampGain(ahrs, feedbackTime);
+        const FusionVector halfAccelerometerFeedback =
+            AccelerometerFeedback(ahrs, HalfGravity(ahrs), ahrs->accelerometerSum, (int)ahrs->accelerometerSamples);
+        const FusionVector halfFeedbackDelta =
+            FusionVectorMultiplyScalar(halfAccelerometerFeedback, ahrs->rampedGain * feedbackTime);
+        ahrs->quaternion =
+            FusionQuaternionAdd(ahrs->quaternion, FusionQuaternionMultiplyVector(ahrs->quaternion, halfFeedbackDelta));
+        ahrs->accelerometerSum = FUSION_VECTOR_ZERO;
+        ahrs->accelerometerSamples = 0;
+    }
+
+    // Store the latest accelerometer for the linear and Earth acceleration getters
+    if (count > 0)
+    {
+        ahrs->accelerometer = accelerometer[count - 1];
+    }
+
+    // Normalise quaternion
+    ahrs->quaternion = FusionQuaternionNormalise(ahrs->quaternion);
+
+    // Zero heading during initialisation
+    if (ahrs->initialising)
+    {
+        FusionAhrsSetHeading(ahrs, 0.0f);
+    }
+}
+
 /**
  * @brief Updates the AHRS algorithm using the gyroscope, accelerometer, and
  * heading measurements.
@@ -409,15 +532,15 @@ void FusionAhrsUpdateExternalHeading(fusion_ahrs_t *const ahrs, const FusionVect
 #define Q ahrs->quaternion.element
 
     // Calculate roll
-    const float roll = atan2f(Q.w * Q.x + Q.y * Q.z, 0.5f - Q.y * Q.y - Q.x * Q.x);
+    const float roll = fusion_math_atan2(Q.w * Q.x + Q.y * Q.z, 0.5f - Q.y * Q.y - Q.x * Q.x);
 
     // Calculate magnetometer
     const float headingRadians = FusionDegreesToRadians(heading);
-    const float sinHeadingRadians = sinf(headingRadians);
+    const float sinHeadingRadians = fusion_math_sin(headingRadians);
     const FusionVector magnetometer = {.axis = {
-                                           .x = cosf(headingRadians),
-                                           .y = -1.0f * cosf(roll) * sinHeadingRadians,
-                                           .z = sinHeadingRadians * sinf(roll),
+                                           .x = fusion_math_cos(headingRadians),
+                                           .y = -1.0f * fusion_math_cos(roll) * sinHeadingRadians,
+                                           .z = sinHeadingRadians * fusion_math_sin(roll),
                                        }};
 
     // Update AHRS algorithm
@@ -576,13 +699,13 @@ FusionAhrsFlags FusionAhrsGetFlags(const fusion_ahrs_t *const ahrs)
 void FusionAhrsSetHeading(fusion_ahrs_t *const ahrs, const float heading)
 {
 #define Q ahrs->quaternion.element
-    const float yaw = atan2f(Q.w * Q.z + Q.x * Q.y, 0.5f - Q.y * Q.y - Q.z * Q.z);
+    const float yaw = fusion_math_atan2(Q.w * Q.z + Q.x * Q.y, 0.5f - Q.y * Q.y - Q.z * Q.z);
     const float halfYawMinusHeading = 0.5f * (yaw - FusionDegreesToRadians(heading));
     const FusionQuaternion rotation = {.element = {
-                                           .w = cosf(halfYawMinusHeading),
+                                           .w = fusion_math_cos(halfYawMinusHeading),
                                            .x = 0.0f,
                                            .y = 0.0f,
-                                           .z = -1.0f * sinf(halfYawMinusHeading),
+                                           .z = -1.0f * fusion_math_sin(halfYawMinusHeading),
                                        }};
     ahrs->quaternion = FusionQuaternionMultiply(rotation, ahrs->quaternion);
 #undef Q
@@ -20,6 +20,19 @@
 //------------------------------------------------------------------------------
 // Definitions
 
+/**
+ * @brief Include this definition or add as a preprocessor definition to run
+ * the application on the fixed-point AHRS build (fusion_ahrs_q.h).
+ */
+//#define FUSION_USE_FIXED_POINT
+
+/**
+ * @brief Include this definition or add as a preprocessor definition to run
+ * the IMU pipeline on the error-state EKF (fusion_ekf.h) instead of
+ * fusion_ahrs_t.
+ */
+//#define FUSION_USE_EKF
+
 /**
  * @brief AHRS algorithm settings.
  */
@@ -33,6 +46,7 @@ typedef struct
     float accelerationRejection;
     float magneticRejection;
     unsigned int recoveryTriggerPeriod;
+    unsigned int accelerometerDecimation; // gyroscope samples per accelerometer feedback step in batch updates
 } FusionAhrsSettings;
 
 /**
@@ -52,6 +66,8 @@ typedef struct
     bool angularRateRecovery;
     FusionVector halfAccelerometerFeedback;
     FusionVector halfMagnetometerFeedback;
+    FusionVector accelerometerSum;
+    unsigned int accelerometerSamples;
     bool accelerometerIgnored;
     int accelerationRecoveryTrigger;
     int accelerationRecoveryTimeout;
@@ -99,6 +115,10 @@ void fusion_ahrs_update(fusion_ahrs_t *const ahrs, const FusionVector gyroscope,
 void fusion_ahrs_update_no_magnetometer(fusion_ahrs_t *const ahrs, const FusionVector gyroscope,
                                     const FusionVector accelerometer, const float deltaTime);
 
+void fusion_ahrs_update_batch_no_magnetometer(fusion_ahrs_t *const ahrs, const FusionVector *const gyroscope,
+                                              const FusionVector *const accelerometer, const unsigned int count,
+                                              const float deltaTime);
+
 void FusionAhrsUpdateExternalHeading(fusion_ahrs_t *const ahrs, const FusionVector gyroscope,
                                      const FusionVector accelerometer, const float heading, const float deltaTime);
 
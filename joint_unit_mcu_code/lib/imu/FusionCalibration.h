@@ -10,8 +10,22 @@
 //------------------------------------------------------------------------------
 // Includes
 
+#include "FusionAxes.h"
 #include "math_utils.h"
 
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Gyroscope or accelerometer calibration folded into a single
+ * transform: calibrated = matrix * uncalibrated - offset.
+ */
+typedef struct
+{
+    FusionMatrix matrix;
+    FusionVector offset;
+} fusion_calibration_inertial_t;
+
 //------------------------------------------------------------------------------
 // Inline functions
 
@@ -30,6 +44,53 @@ static inline FusionVector FusionCalibrationInertial(const FusionVector uncalibr
         misalignment, FusionVectorHadamardProduct(fusion_vector_subtract(uncalibrated, offset), sensitivity));
 }
 
+/**
+ * @brief Pre-multiplies the axes alignment, misalignment, and sensitivity into
+ * one matrix and the offset into one vector so that
+ * fusion_calibration_inertial_apply() is equivalent to
+ * FusionAxesSwap(FusionCalibrationInertial(...), alignment).
+ * @param misalignment Misalignment matrix.
+ * @param sensitivity Sensitivity.
+ * @param offset Offset.
+ * @param alignment Axes alignment.
+ * @return Fused calibration.
+ */
+static inline fusion_calibration_inertial_t fusion_calibration_inertial_init(const FusionMatrix misalignment,
+                                                                             const FusionVector sensitivity,
+                                                                             const FusionVector offset,
+                                                                             const FusionAxesAlignment alignment)
+{
+    fusion_calibration_inertial_t calibration;
+    for (int column = 0; column < 3; column++)
+    {
+        // Column of alignment * misalignment * diag(sensitivity)
+        const FusionVector misalignmentColumn = {.axis = {
+                                                     .x = misalignment.array[0][column] * sensitivity.array[column],
+                                                     .y = misalignment.array[1][column] * sensitivity.array[column],
+                                                     .z = misalignment.array[2][column] * sensitivity.array[column],
+                                                 }};
+        const FusionVector alignedColumn = FusionAxesSwap(misalignmentColumn, alignment);
+        for (int row = 0; row < 3; row++)
+        {
+            calibration.matrix.array[row][column] = alignedColumn.array[row];
+        }
+    }
+    calibration.offset = FusionMatrixMultiplyVector(calibration.matrix, offset);
+    return calibration;
+}
+
+/**
+ * @brief Applies the fused gyroscope or accelerometer calibration.
+ * @param calibration Fused calibration.
+ * @param uncalibrated Uncalibrated measurement.
+ * @return Calibrated measurement.
+ */
+static inline FusionVector fusion_calibration_inertial_apply(const fusion_calibration_inertial_t *const calibration,
+                                                             const FusionVector uncalibrated)
+{
+    return fusion_vector_subtract(FusionMatrixMultiplyVector(calibration->matrix, uncalibrated), calibration->offset);
+}
+
 /**
  * @brief Magnetometer calibration model.
  * @param uncalibrated Uncalibrated measurement.
@@ -17,6 +17,7 @@
 #include "FusionConvention.h"
 #include "math_utils.h"
 #include "fusion_offset.h"
+#include "fusion_ahrs_q.h"
 
 #endif
 //------------------------------------------------------------------------------
@@ -0,0 +1,384 @@
+/**
+ * @file fusion_ahrs_q.c
+ * @brief Fixed-point (Q-format) build of the AHRS algorithm for the FPU-less
+ * RP2040.  Settings are converted from float once; the update path only uses
+ * integer arithmetic.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "fusion_ahrs_q.h"
+#include <math.h> // powf, sinf
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Initial gain used during the initialisation in Q16.
+ */
+#define INITIAL_GAIN (10 * FUSION_Q16_ONE)
+
+/**
+ * @brief Initialisation period in seconds.
+ */
+#define INITIALISATION_PERIOD (3)
+
+/**
+ * @brief Half of the degrees to radians conversion, pi / 360, in Q30.
+ */
+#define HALF_DEGREES_TO_RADIANS_Q30 (9370046)
+
+/**
+ * @brief Radians in Q15 to phase (2^32 is a full turn) multiplier, shifted by 15.
+ */
+#define Q15_RADIANS_TO_PHASE (683565276)
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+static inline fusion_vector_q_t HalfGravity(const fusion_ahrs_q_t *const ahrs);
+
+static inline fusion_vector_q_t Feedback(const fusion_vector_q_t sensor, const fusion_vector_q_t reference);
+
+static inline int Clamp(const int value, const int min, const int max);
+
+static inline int32_t Absolute(const int32_t value);
+
+static void SetHeading(fusion_ahrs_q_t *const ahrs, const int32_t heading);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises the AHRS algorithm structure.
+ * @param ahrs AHRS algorithm structure.
+ * @param sample_rate Sample rate in Hz.
+ */
+void fusion_ahrs_q_init(fusion_ahrs_q_t *const ahrs, uint16_t sample_rate)
+{
+    const FusionAhrsSettings settings = {
+        .convention = FusionConventionNwu,
+        .sample_rate = sample_rate,
+        .sample_period = 1.0f / (float)sample_rate,
+        .gain = 0.5f,
+        .gyroscopeRange = 0.0f,
+        .accelerationRejection = 90.0f,
+        .magneticRejection = 90.0f,
+        .recoveryTriggerPeriod = 0,
+    };
+    ahrs->initialising = true;
+    fusion_ahrs_q_set_settings(ahrs, &settings);
+    fusion_ahrs_q_reset(ahrs);
+}
+
+/**
+ * @brief Resets the AHRS algorithm while maintaining the current settings.
+ * @param ahrs AHRS algorithm structure.
+ */
+void fusion_ahrs_q_reset(fusion_ahrs_q_t *const ahrs)
+{
+    ahrs->quaternion = FUSION_IDENTITY_QUATERNION_Q;
+    ahrs->accelerometer = FUSION_VECTOR_Q_ZERO;
+    ahrs->initialising = true;
+    ahrs->rampedGain = INITIAL_GAIN;
+    ahrs->angularRateRecovery = false;
+    ahrs->halfAccelerometerFeedback = FUSION_VECTOR_Q_ZERO;
+    ahrs->accelerometerIgnored = false;
+    ahrs->accelerationRecoveryTrigger = 0;
+    ahrs->accelerationRecoveryTimeout = ahrs->recoveryTriggerPeriod;
+}
+
+/**
+ * @brief Sets the AHRS algorithm settings.  The float settings are converted
+ * to fixed point here so that the update path is free of float operations.
+ * Magnetic rejection is ignored because this build has no magnetometer input.
+ * @param ahrs AHRS algorithm structure.
+ * @param settings Settings.
+ */
+void fusion_ahrs_q_set_settings(fusion_ahrs_q_t *const ahrs, const FusionAhrsSettings *const settings)
+{
+    ahrs->convention = settings->convention;
+    ahrs->gain = FUSION_FLOAT_TO_Q16(settings->gain);
+    ahrs->gyroscopeRange =
+        settings->gyroscopeRange == 0.0f ? INT32_MAX : FUSION_FLOAT_TO_Q16(0.98f * settings->gyroscopeRange);
+    ahrs->accelerationRejection =
+        settings->accelerationRejection == 0.0f
+            ? INT32_MAX
+            : FUSION_FLOAT_TO_Q30(powf(0.5f * sinf(FusionDegreesToRadians(settings->accelerationRejection)), 2));
+    ahrs->recoveryTriggerPeriod = settings->recoveryTriggerPeriod;
+    ahrs->accelerationRecoveryTimeout = ahrs->recoveryTriggerPeriod;
+    if ((settings->gain == 0.0f) || (settings->recoveryTriggerPeriod == 0))
+    { // disable acceleration rejection features if gain is zero
+        ahrs->accelerationRejection = INT32_MAX;
+    }
+    if (ahrs->initialising == false)
+    {
+        ahrs->rampedGain = ahrs->gain;
+    }
+    ahrs->rampedGainStep = (INITIAL_GAIN - ahrs->gain) / INITIALISATION_PERIOD;
+}
+
+/**
+ * @brief Updates the AHRS algorithm using the gyroscope and accelerometer
+ * measurements only.
+ * @param ahrs AHRS algorithm structure.
+ * @param gyroscope Gyroscope measurement in Q16 degrees per second.
+ * @param accelerometer Accelerometer measurement in Q16 g.
+ * @param deltaTime Delta time in Q30 seconds.  Must be less than 0.1 s.
+ */
+void fusion_ahrs_q_update_no_magnetometer(fusion_ahrs_q_t *const ahrs, const fusion_vector_q_t gyroscope,
+                                          const fusion_vector_q_t accelerometer, const int32_t deltaTime)
+{
+    // Store accelerometer
+    ahrs->accelerometer = accelerometer;
+
+    // Reinitialise if gyroscope range exceeded
+    if ((Absolute(gyroscope.axis.x) > ahrs->gyroscopeRange) || (Absolute(gyroscope.axis.y) > ahrs->gyroscopeRange) ||
+        (Absolute(gyroscope.axis.z) > ahrs->gyroscopeRange))
+    {
+        const fusion_quaternion_q_t quaternion = ahrs->quaternion;
+        fusion_ahrs_q_reset(ahrs);
+        ahrs->quaternion = quaternion;
+        ahrs->angularRateRecovery = true;
+    }
+
+    // Ramp down gain during initialisation
+    if (ahrs->initialising)
+    {
+        ahrs->rampedGain -= fusion_q_multiply(ahrs->rampedGainStep, deltaTime, 30);
+        if ((ahrs->rampedGain < ahrs->gain) || (ahrs->gain == 0))
+        {
+            ahrs->rampedGain = ahrs->gain;
+            ahrs->initialising = false;
+            ahrs->angularRateRecovery = false;
+        }
+    }
+
+    // Calculate direction of gravity indicated by algorithm
+    const fusion_vector_q_t halfGravity = HalfGravity(ahrs);
+
+    // Calculate accelerometer feedback
+    fusion_vector_q_t halfAccelerometerFeedback = FUSION_VECTOR_Q_ZERO;
+    ahrs->accelerometerIgnored = false;
+    if (fusion_vector_q_is_zero(accelerometer) == false)
+    {
+
+        // Calculate accelerometer feedback scaled by 0.5
+        ahrs->halfAccelerometerFeedback = Feedback(fusion_vector_q_normalise(accelerometer), halfGravity);
+
+        // Don't ignore accelerometer if acceleration error below threshold
+        if (ahrs->initialising ||
+            (fusion_vector_q_magnitude_squared(ahrs->halfAccelerometerFeedback) <= ahrs->accelerationRejection))
+        {
+            ahrs->accelerometerIgnored = false;
+            ahrs->accelerationRecoveryTrigger -= 9;
+        }
+        else
+        {
+            ahrs->accelerationRecoveryTrigger += 1;
+        }
+
+        // Don't ignore accelerometer during acceleration recovery
+        if (ahrs->accelerationRecoveryTrigger > ahrs->accelerationRecoveryTimeout)
+        {
+            ahrs->accelerationRecoveryTimeout = 0;
+            ahrs->accelerometerIgnored = false;
+        }
+        else
+        {
+            ahrs->accelerationRecoveryTimeout = ahrs->recoveryTriggerPeriod;
+        }
+        ahrs->accelerationRecoveryTrigger = Clamp(ahrs->accelerationRecoveryTrigger, 0, ahrs->recoveryTriggerPeriod);
+
+        // Apply accelerometer feedback
+        if (ahrs->accelerometerIgnored == false)
+        {
+            halfAccelerometerFeedback = ahrs->halfAccelerometerFeedback;
+        }
+    }
+
+    // Convert gyroscope to half of the angle turned during deltaTime in Q30 radians
+    const int32_t halfDegreesToRadiansDeltaTime =
+        (int32_t)(((int64_t)deltaTime * HALF_DEGREES_TO_RADIANS_Q30) >> 20); // Q40
+    const fusion_vector_q_t halfGyroscopeDelta =
+        fusion_vector_q_multiply_scalar(gyroscope, halfDegreesToRadiansDeltaTime, 26);
+
+    // Apply feedback to gyroscope
+    const int32_t gainDeltaTime = fusion_q_multiply(ahrs->rampedGain, deltaTime, 16); // Q30
+    const fusion_vector_q_t adjustedHalfGyroscopeDelta = fusion_vector_q_add(
+        halfGyroscopeDelta, fusion_vector_q_multiply_scalar(halfAccelerometerFeedback, gainDeltaTime, 30));
+
+    // Integrate rate of change of quaternion
+    ahrs->quaternion = fusion_quaternion_q_add(
+        ahrs->quaternion, fusion_quaternion_q_multiply_vector(ahrs->quaternion, adjustedHalfGyroscopeDelta));
+
+    // Normalise quaternion
+    ahrs->quaternion = fusion_quaternion_q_normalise(ahrs->quaternion);
+
+    // Zero heading during initialisation
+    if (ahrs->initialising)
+    {
+        SetHeading(ahrs, 0);
+    }
+}
+
+/**
+ * @brief Returns the direction of gravity scaled by 0.5.
+ * @param ahrs AHRS algorithm structure.
+ * @return Direction of gravity scaled by 0.5 in Q30.
+ */
+static inline fusion_vector_q_t HalfGravity(const fusion_ahrs_q_t *const ahrs)
+{
+#define Q ahrs->quaternion.element
+    switch (ahrs->convention)
+    {
+    case FusionConventionNwu:
+    case FusionConventionEnu:
+    {
+        const fusion_vector_q_t halfGravity = {
+            .axis = {
+                .x = (int32_t)(((int64_t)Q.x * Q.z - (int64_t)Q.w * Q.y) >> 30),
+                .y = (int32_t)(((int64_t)Q.y * Q.z + (int64_t)Q.w * Q.x) >> 30),
+                .z = (int32_t)(((int64_t)Q.w * Q.w + (int64_t)Q.z * Q.z) >> 30) - (FUSION_Q30_ONE >> 1),
+            }}; // third column of transposed rotation matrix scaled by 0.5
+        return halfGravity;
+    }
+    case FusionConventionNed:
+    {
+        const fusion_vector_q_t halfGravity = {
+            .axis = {
+                .x = (int32_t)(((int64_t)Q.w * Q.y - (int64_t)Q.x * Q.z) >> 30),
+                .y = (int32_t)((-(int64_t)Q.y * Q.z - (int64_t)Q.w * Q.x) >> 30),
+                .z = (FUSION_Q30_ONE >> 1) - (int32_t)(((int64_t)Q.w * Q.w + (int64_t)Q.z * Q.z) >> 30),
+            }}; // third column of transposed rotation matrix scaled by -0.5
+        return halfGravity;
+    }
+    }
+    return FUSION_VECTOR_Q_ZERO; // avoid compiler warning
+#undef Q
+}
+
+/**
+ * @brief Returns the feedback.
+ * @param sensor Sensor.
+ * @param reference Reference.
+ * @return Feedback.
+ */
+static inline fusion_vector_q_t Feedback(const fusion_vector_q_t sensor, const fusion_vector_q_t reference)
+{
+    if (fusion_vector_q_dot_product(sensor, reference) < 0)
+    { // if error is >90 degrees
+        return fusion_vector_q_normalise(fusion_vector_q_cross_product(sensor, reference));
+    }
+    return fusion_vector_q_cross_product(sensor, reference);
+}
+
+/**
+ * @brief Returns a value limited to maximum and minimum.
+ * @param value Value.
+ * @param min Minimum value.
+ * @param max Maximum value.
+ * @return Value limited to maximum and minimum.
+ */
+static inline int Clamp(const int value, const int min, const int max)
+{
+    if (value < min)
+    {
+        return min;
+    }
+    if (value > max)
+    {
+        return max;
+    }
+    return value;
+}
+
+/**
+ * @brief Returns the absolute value, saturated for INT32_MIN.
+ * @param value Value.
+ * @return Absolute value.
+ */
+static inline int32_t Absolute(const int32_t value)
+{
+    if (value == INT32_MIN)
+    {
+        return INT32_MAX;
+    }
+    return value < 0 ? -value : value;
+}
+
+/**
+ * @brief Sets the heading of the orientation measurement.
+ * @param ahrs AHRS algorithm structure.
+ * @param heading Heading angle in Q15 radians.
+ */
+static void SetHeading(fusion_ahrs_q_t *const ahrs, const int32_t heading)
+{
+#define Q ahrs->quaternion.element
+    const int32_t yaw = sin_table_atan2_q15(
+        (int32_t)(((int64_t)Q.w * Q.z + (int64_t)Q.x * Q.y) >> 30),
+        (FUSION_Q30_ONE >> 1) - (int32_t)(((int64_t)Q.y * Q.y + (int64_t)Q.z * Q.z) >> 30));
+    const uint32_t halfYawMinusHeading = (uint32_t)(((int64_t)(yaw - heading) * Q15_RADIANS_TO_PHASE) >> 16);
+    const fusion_quaternion_q_t rotation = {.element = {
+                                                .w = (int32_t)sin_table_cos_q15(halfYawMinusHeading) * (1 << 15),
+                                                .x = 0,
+                                                .y = 0,
+                                                .z = -(int32_t)sin_table_sin_q15(halfYawMinusHeading) * (1 << 15),
+                                            }};
+    ahrs->quaternion = fusion_quaternion_q_multiply(rotation, ahrs->quaternion);
+#undef Q
+}
+
+/**
+ * @brief Returns the quaternion describing the sensor relative to the Earth.
+ * @param ahrs AHRS algorithm structure.
+ * @return Quaternion describing the sensor relative to the Earth.
+ */
+FusionQuaternion fusion_ahrs_q_get_quaternion(const fusion_ahrs_q_t *const ahrs)
+{
+    return fusion_quaternion_q_to_float(ahrs->quaternion);
+}
+
+/**
+ * @brief Sets the quaternion describing the sensor relative to the Earth.
+ * @param ahrs AHRS algorithm structure.
+ * @param quaternion Quaternion describing the sensor relative to the Earth.
+ */
+void fusion_ahrs_q_set_quaternion(fusion_ahrs_q_t *const ahrs, const FusionQuaternion quaternion)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        ahrs->quaternion.array[i] = FUSION_FLOAT_TO_Q30(quaternion.array[i]);
+    }
+    ahrs->quaternion = fusion_quaternion_q_normalise(ahrs->quaternion);
+}
+
+/**
+ * @brief Returns the AHRS algorithm flags.
+ * @param ahrs AHRS algorithm structure.
+ * @return AHRS algorithm flags.
+ */
+FusionAhrsFlags fusion_ahrs_q_get_flags(const fusion_ahrs_q_t *const ahrs)
+{
+    const FusionAhrsFlags flags = {
+        .initialising = ahrs->initialising,
+        .angularRateRecovery = ahrs->angularRateRecovery,
+        .accelerationRecovery = ahrs->accelerationRecoveryTrigger > ahrs->accelerationRecoveryTimeout,
+        .magneticRecovery = false,
+    };
+    return flags;
+}
+
+/**
+ * @brief Sets the heading of the orientation measurement.
+ * @param ahrs AHRS algorithm structure.
+ * @param heading Heading angle in degrees.
+ */
+void fusion_ahrs_q_set_heading(fusion_ahrs_q_t *const ahrs, const float heading)
+{
+    SetHeading(ahrs, (int32_t)(FusionDegreesToRadians(heading) * 32768.0f));
+}
+
+//------------------------------------------------------------------------------
+// End of file
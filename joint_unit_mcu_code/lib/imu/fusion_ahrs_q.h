@@ -0,0 +1,74 @@
+/**
+ * @file fusion_ahrs_q.h
+ * @brief Fixed-point (Q-format) build of the AHRS algorithm for the FPU-less
+ * RP2040.  Follows FusionAhrs.c step for step (quaternion integration,
+ * accelerometer feedback, gain ramp and recovery logic) without floating-point
+ * operations in the update path.
+ */
+
+#ifndef _FUSION_AHRS_Q_H_
+#define _FUSION_AHRS_Q_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdbool.h>
+
+#include "FusionAhrs.h"
+#include "math_utils_q.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Delta time in Q30 seconds for a sample rate in Hz.
+ */
+#define FUSION_DELTA_TIME_Q30(sample_rate) ((int32_t)(FUSION_Q30_ONE / (sample_rate)))
+
+/**
+ * @brief Fixed-point AHRS algorithm structure.  Structure members are used
+ * internally and must not be accessed by the application.
+ */
+typedef struct
+{
+    FusionConvention convention;
+    int32_t gain;                  // Q16
+    int32_t gyroscopeRange;        // Q16 degrees per second
+    int32_t accelerationRejection; // Q30
+    unsigned int recoveryTriggerPeriod;
+    fusion_quaternion_q_t quaternion; // Q30
+    fusion_vector_q_t accelerometer;  // Q16 g
+    bool initialising;
+    int32_t rampedGain;     // Q16
+    int32_t rampedGainStep; // Q16 per second
+    bool angularRateRecovery;
+    fusion_vector_q_t halfAccelerometerFeedback; // Q30
+    bool accelerometerIgnored;
+    int accelerationRecoveryTrigger;
+    int accelerationRecoveryTimeout;
+} fusion_ahrs_q_t;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+void fusion_ahrs_q_init(fusion_ahrs_q_t *const ahrs, uint16_t sample_rate);
+
+void fusion_ahrs_q_reset(fusion_ahrs_q_t *const ahrs);
+
+void fusion_ahrs_q_set_settings(fusion_ahrs_q_t *const ahrs, const FusionAhrsSettings *const settings);
+
+void fusion_ahrs_q_update_no_magnetometer(fusion_ahrs_q_t *const ahrs, const fusion_vector_q_t gyroscope,
+                                          const fusion_vector_q_t accelerometer, const int32_t deltaTime);
+
+FusionQuaternion fusion_ahrs_q_get_quaternion(const fusion_ahrs_q_t *const ahrs);
+
+void fusion_ahrs_q_set_quaternion(fusion_ahrs_q_t *const ahrs, const FusionQuaternion quaternion);
+
+FusionAhrsFlags fusion_ahrs_q_get_flags(const fusion_ahrs_q_t *const ahrs);
+
+void fusion_ahrs_q_set_heading(fusion_ahrs_q_t *const ahrs, const float heading);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
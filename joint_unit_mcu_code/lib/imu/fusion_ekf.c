@@ -0,0 +1,473 @@
+/**
+ * @file fusion_ekf.c
+ * @brief Error-state extended Kalman filter with attitude and gyroscope bias
+ * states.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "fusion_ekf.h"
+#include <math.h>   // fabsf, sqrtf
+#include <string.h> // memset
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief 3x3 matrix as used for the covariance blocks.
+ */
+typedef float matrix3_t[3][3];
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+static inline FusionVector Gravity(const fusion_ekf_t *const ekf);
+
+static void Align(fusion_ekf_t *const ekf, const FusionVector accelerometer);
+
+static void Predict(fusion_ekf_t *const ekf, const FusionVector rate, const float deltaTime);
+
+static void Correct(fusion_ekf_t *const ekf, const FusionVector accelerometer);
+
+static void Multiply(const matrix3_t a, const matrix3_t b, matrix3_t result);
+
+static void MultiplyTransposed(const matrix3_t a, const matrix3_t b, matrix3_t result);
+
+static void Symmetrise(matrix3_t a);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises the EKF.
+ * @param ekf EKF structure.
+ * @param settings Settings.
+ */
+void fusion_ekf_init(fusion_ekf_t *const ekf, const fusion_ekf_settings_t *const settings)
+{
+    ekf->settings = *settings;
+    if (ekf->settings.accelerometerDecimation == 0)
+    {
+        ekf->settings.accelerometerDecimation = 1;
+    }
+    fusion_ekf_reset(ekf);
+}
+
+/**
+ * @brief Resets the EKF while maintaining the current settings.  The attitude
+ * is aligned to the first accelerometer feedback step with zero heading.
+ * @param ekf EKF structure.
+ */
+void fusion_ekf_reset(fusion_ekf_t *const ekf)
+{
+    ekf->quaternion = FUSION_IDENTITY_QUATERNION;
+    ekf->bias = FUSION_VECTOR_ZERO;
+    memset(ekf->attitudeCovariance, 0, sizeof(ekf->attitudeCovariance));
+    memset(ekf->crossCovariance, 0, sizeof(ekf->crossCovariance));
+    memset(ekf->biasCovariance, 0, sizeof(ekf->biasCovariance));
+    const float biasUncertainty = FusionDegreesToRadians(ekf->settings.initialBiasUncertainty);
+    for (int i = 0; i < 3; i++)
+    {
+        ekf->biasCovariance[i][i] = biasUncertainty * biasUncertainty;
+    }
+    ekf->gyroscopeSum = FUSION_VECTOR_ZERO;
+    ekf->accelerometerSum = FUSION_VECTOR_ZERO;
+    ekf->accelerometerSamples = 0;
+    ekf->initialising = true;
+    ekf->accelerometerIgnored = false;
+}
+
+/**
+ * @brief Updates the EKF with one gyroscope and accelerometer sample.
+ * @param ekf EKF structure.
+ * @param gyroscope Gyroscope measurement in degrees per second.
+ * @param accelerometer Accelerometer measurement in g.
+ * @param deltaTime Delta time in seconds.
+ */
+void fusion_ekf_update_no_magnetometer(fusion_ekf_t *const ekf, const FusionVector gyroscope,
+                                       const FusionVector accelerometer, const float deltaTime)
+{
+    fusion_ekf_update_batch_no_magnetometer(ekf, &gyroscope, &accelerometer, 1, deltaTime);
+}
+
+/**
+ * @brief Updates the EKF with consecutive samples.  Every gyroscope sample is
+ * integrated into the nominal quaternion, while the covariance prediction and
+ * the accelerometer correction run once per settings.accelerometerDecimation
+ * samples on the mean rate and the mean accelerometer.
+ * @param ekf EKF structure.
+ * @param gyroscope Gyroscope measurements in degrees per second.
+ * @param accelerometer Accelerometer measurements in g.
+ * @param count Number of samples.
+ * @param deltaTime Sample period in seconds.
+ */
+void fusion_ekf_update_batch_no_magnetometer(fusion_ekf_t *const ekf, const FusionVector *const gyroscope,
+                                             const FusionVector *const accelerometer, const unsigned int count,
+                                             const float deltaTime)
+{
+    for (unsigned int index = 0; index < count; index++)
+    {
+        // Integrate the bias corrected gyroscope
+        const FusionVector radians = FusionVectorMultiplyScalar(gyroscope[index], FusionDegreesToRadians(1.0f));
+        const FusionVector rate = fusion_vector_subtract(radians, ekf->bias);
+        if (ekf->initialising == false)
+        {
+            ekf->quaternion = FusionQuaternionAdd(
+                ekf->quaternion,
+                FusionQuaternionMultiplyVector(ekf->quaternion, FusionVectorMultiplyScalar(rate, 0.5f * deltaTime)));
+        }
+
+        // Accumulate until the next feedback step
+        ekf->gyroscopeSum = FusionVectorAdd(ekf->gyroscopeSum, rate);
+        ekf->accelerometerSum = FusionVectorAdd(ekf->accelerometerSum, accelerometer[index]);
+        ekf->accelerometerSamples++;
+        if (ekf->accelerometerSamples < ekf->settings.accelerometerDecimation)
+        {
+            continue;
+        }
+
+        const float samplesReciprocal = 1.0f / (float)ekf->accelerometerSamples;
+        const FusionVector meanRate = FusionVectorMultiplyScalar(ekf->gyroscopeSum, samplesReciprocal);
+        const FusionVector meanAccelerometer = FusionVectorMultiplyScalar(ekf->accelerometerSum, samplesReciprocal);
+        const float stepTime = deltaTime * (float)ekf->accelerometerSamples;
+        ekf->gyroscopeSum = FUSION_VECTOR_ZERO;
+        ekf->accelerometerSum = FUSION_VECTOR_ZERO;
+        ekf->accelerometerSamples = 0;
+
+        if (ekf->initialising)
+        {
+            Align(ekf, meanAccelerometer);
+            continue;
+        }
+        Predict(ekf, meanRate, stepTime);
+
+        // Skip the correction while the specific force is not dominated by gravity
+        const float magnitude = FusionVectorMagnitude(meanAccelerometer);
+        ekf->accelerometerIgnored = fabsf(magnitude - 1.0f) > ekf->settings.accelerationRejection;
+        if (ekf->accelerometerIgnored == false)
+        {
+            Correct(ekf, FusionVectorMultiplyScalar(meanAccelerometer, 1.0f / magnitude));
+        }
+    }
+
+    ekf->quaternion = FusionQuaternionNormalise(ekf->quaternion);
+}
+
+/**
+ * @brief Returns the quaternion describing the sensor relative to the Earth.
+ * @param ekf EKF structure.
+ * @return Quaternion.
+ */
+FusionQuaternion fusion_ekf_get_quaternion(const fusion_ekf_t *const ekf)
+{
+    return ekf->quaternion;
+}
+
+/**
+ * @brief Returns the estimated gyroscope bias.
+ * @param ekf EKF structure.
+ * @return Gyroscope bias in degrees per second.
+ */
+FusionVector fusion_ekf_get_gyroscope_bias(const fusion_ekf_t *const ekf)
+{
+    return FusionVectorMultiplyScalar(ekf->bias, FusionRadiansToDegrees(1.0f));
+}
+
+/**
+ * @brief Returns the error-state covariance.  Rows and columns 0 to 2 are the
+ * attitude error in radians, in the sensor frame, and 3 to 5 the gyroscope
+ * bias error in radians per second.
+ * @param ekf EKF structure.
+ * @param covariance Covariance.
+ */
+void fusion_ekf_get_covariance(const fusion_ekf_t *const ekf, float covariance[FUSION_EKF_STATES][FUSION_EKF_STATES])
+{
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            covariance[row][column] = ekf->attitudeCovariance[row][column];
+            covariance[row][3 + column] = ekf->crossCovariance[row][column];
+            covariance[3 + column][row] = ekf->crossCovariance[row][column];
+            covariance[3 + row][3 + column] = ekf->biasCovariance[row][column];
+        }
+    }
+}
+
+/**
+ * @brief Returns true if the last accelerometer feedback step was skipped.
+ * @param ekf EKF structure.
+ * @return True if the accelerometer was ignored.
+ */
+bool fusion_ekf_is_accelerometer_ignored(const fusion_ekf_t *const ekf)
+{
+    return ekf->accelerometerIgnored;
+}
+
+//------------------------------------------------------------------------------
+// Functions - Filter steps
+
+/**
+ * @brief Returns the direction of gravity in the sensor frame as measured by
+ * the accelerometer.
+ */
+static inline FusionVector Gravity(const fusion_ekf_t *const ekf)
+{
+#define Q ekf->quaternion.element
+    const FusionVector up = {.axis = {
+                                 .x = 2.0f * (Q.x * Q.z - Q.w * Q.y),
+                                 .y = 2.0f * (Q.y * Q.z + Q.w * Q.x),
+                                 .z = 2.0f * (Q.w * Q.w - 0.5f + Q.z * Q.z),
+                             }}; // third column of transposed rotation matrix
+    return (ekf->settings.convention == FusionConventionNed) ? FusionVectorMultiplyScalar(up, -1.0f) : up;
+#undef Q
+}
+
+/**
+ * @brief Sets the attitude to the shortest rotation between the accelerometer
+ * and gravity, which leaves the heading near zero.
+ */
+static void Align(fusion_ekf_t *const ekf, const FusionVector accelerometer)
+{
+    const float magnitude = FusionVectorMagnitude(accelerometer);
+    if (magnitude < 0.5f)
+    {
+        return;
+    }
+    FusionVector measured = FusionVectorMultiplyScalar(accelerometer, 1.0f / magnitude);
+    if (ekf->settings.convention == FusionConventionNed)
+    {
+        measured = FusionVectorMultiplyScalar(measured, -1.0f);
+    }
+    if (measured.axis.z < -0.999f)
+    {
+        ekf->quaternion = (FusionQuaternion){.array = {0.0f, 1.0f, 0.0f, 0.0f}};
+    }
+    else
+    {
+        ekf->quaternion = FusionQuaternionNormalise(
+            (FusionQuaternion){.array = {1.0f + measured.axis.z, measured.axis.y, -measured.axis.x, 0.0f}});
+    }
+
+    const float noise = ekf->settings.accelerometerNoise;
+    ekf->attitudeCovariance[0][0] = noise * noise;
+    ekf->attitudeCovariance[1][1] = noise * noise;
+    ekf->initialising = false;
+}
+
+/**
+ * @brief Propagates the covariance over one feedback step.  With the error
+ * transition [[M, -T I], [0, I]] and M = I - [rate T]x, the blocks are
+ * B' = M B - T C, A' = (M A - T B^T) M^T - T B' and C' = C.
+ */
+static void Predict(fusion_ekf_t *const ekf, const FusionVector rate, const float deltaTime)
+{
+    const FusionVector angle = FusionVectorMultiplyScalar(rate, deltaTime);
+    const matrix3_t transition = {
+        {1.0f, angle.axis.z, -angle.axis.y},
+        {-angle.axis.z, 1.0f, angle.axis.x},
+        {angle.axis.y, -angle.axis.x, 1.0f},
+    };
+
+    matrix3_t attitude;
+    matrix3_t cross;
+    Multiply(transition, ekf->attitudeCovariance, attitude);
+    Multiply(transition, ekf->crossCovariance, cross);
+    // B^T is read from the old cross-covariance, so finish with it before B' is written
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            attitude[row][column] -= deltaTime * ekf->crossCovariance[column][row];
+        }
+    }
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            ekf->crossCovariance[row][column] = cross[row][column] - deltaTime * ekf->biasCovariance[row][column];
+        }
+    }
+    MultiplyTransposed(attitude, transition, ekf->attitudeCovariance);
+
+    const float gyroscopeNoise = FusionDegreesToRadians(ekf->settings.gyroscopeNoise);
+    const float biasStability = FusionDegreesToRadians(ekf->settings.gyroscopeBiasStability);
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            ekf->attitudeCovariance[row][column] -= deltaTime * ekf->crossCovariance[row][column];
+        }
+        ekf->attitudeCovariance[row][row] += gyroscopeNoise * gyroscopeNoise * deltaTime;
+        ekf->biasCovariance[row][row] += biasStability * biasStability * deltaTime;
+    }
+    Symmetrise(ekf->attitudeCovariance);
+}
+
+/**
+ * @brief Corrects the attitude and bias with the accelerometer direction.
+ * The measurement Jacobian of the attitude error is [g]x, where g is the
+ * predicted gravity direction, and zero for the bias.
+ */
+static void Correct(fusion_ekf_t *const ekf, const FusionVector accelerometer)
+{
+    const FusionVector gravity = Gravity(ekf);
+    const FusionVector innovation = fusion_vector_subtract(accelerometer, gravity);
+#define G gravity.axis
+    const matrix3_t jacobian = {
+        {0.0f, -G.z, G.y},
+        {G.z, 0.0f, -G.x},
+        {-G.y, G.x, 0.0f},
+    };
+#undef G
+
+    // P H^T as its attitude and bias blocks
+    matrix3_t attitudeGain;
+    matrix3_t biasGain;
+    matrix3_t crossTransposed;
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            crossTransposed[row][column] = ekf->crossCovariance[column][row];
+        }
+    }
+    matrix3_t attitudeProjection;
+    matrix3_t biasProjection;
+    MultiplyTransposed(ekf->attitudeCovariance, jacobian, attitudeProjection);
+    MultiplyTransposed(crossTransposed, jacobian, biasProjection);
+
+    // Innovation covariance and its inverse from the cofactors
+    matrix3_t innovationCovariance;
+    Multiply(jacobian, attitudeProjection, innovationCovariance);
+    const float noise = ekf->settings.accelerometerNoise;
+    for (int i = 0; i < 3; i++)
+    {
+        innovationCovariance[i][i] += noise * noise;
+    }
+#define S innovationCovariance
+    const matrix3_t cofactor = {
+        {S[1][1] * S[2][2] - S[1][2] * S[2][1], S[0][2] * S[2][1] - S[0][1] * S[2][2],
+         S[0][1] * S[1][2] - S[0][2] * S[1][1]},
+        {S[1][2] * S[2][0] - S[1][0] * S[2][2], S[0][0] * S[2][2] - S[0][2] * S[2][0],
+         S[0][2] * S[1][0] - S[0][0] * S[1][2]},
+        {S[1][0] * S[2][1] - S[1][1] * S[2][0], S[0][1] * S[2][0] - S[0][0] * S[2][1],
+         S[0][0] * S[1][1] - S[0][1] * S[1][0]},
+    };
+    const float determinant = S[0][0] * cofactor[0][0] + S[0][1] * cofactor[1][0] + S[0][2] * cofactor[2][0];
+#undef S
+    if (determinant <= 0.0f)
+    {
+        return;
+    }
+    matrix3_t inverse;
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            inverse[row][column] = cofactor[row][column] * (1.0f / determinant);
+        }
+    }
+
+    // Reject outliers such as linear acceleration; the covariance keeps growing until they pass the gate
+    float normalisedInnovation = 0.0f;
+    for (int row = 0; row < 3; row++)
+    {
+        normalisedInnovation += innovation.array[row] * (inverse[row][0] * innovation.array[0] +
+                                                         inverse[row][1] * innovation.array[1] +
+                                                         inverse[row][2] * innovation.array[2]);
+    }
+    if ((ekf->settings.innovationRejection > 0.0f) && (normalisedInnovation > ekf->settings.innovationRejection))
+    {
+        ekf->accelerometerIgnored = true;
+        return;
+    }
+
+    // Kalman gain, error state and covariance P - K (P H^T)^T
+    Multiply(attitudeProjection, inverse, attitudeGain);
+    Multiply(biasProjection, inverse, biasGain);
+    FusionVector attitudeError;
+    FusionVector biasError;
+    for (int row = 0; row < 3; row++)
+    {
+        attitudeError.array[row] = attitudeGain[row][0] * innovation.array[0] +
+                                   attitudeGain[row][1] * innovation.array[1] +
+                                   attitudeGain[row][2] * innovation.array[2];
+        biasError.array[row] = biasGain[row][0] * innovation.array[0] + biasGain[row][1] * innovation.array[1] +
+                               biasGain[row][2] * innovation.array[2];
+    }
+    matrix3_t attitudeUpdate;
+    matrix3_t crossUpdate;
+    matrix3_t biasUpdate;
+    MultiplyTransposed(attitudeGain, attitudeProjection, attitudeUpdate);
+    MultiplyTransposed(attitudeGain, biasProjection, crossUpdate);
+    MultiplyTransposed(biasGain, biasProjection, biasUpdate);
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            ekf->attitudeCovariance[row][column] -= attitudeUpdate[row][column];
+            ekf->crossCovariance[row][column] -= crossUpdate[row][column];
+            ekf->biasCovariance[row][column] -= biasUpdate[row][column];
+        }
+    }
+    Symmetrise(ekf->attitudeCovariance);
+    Symmetrise(ekf->biasCovariance);
+
+    // Inject the error into the nominal state
+    ekf->quaternion = FusionQuaternionNormalise(FusionQuaternionAdd(
+        ekf->quaternion,
+        FusionQuaternionMultiplyVector(ekf->quaternion, FusionVectorMultiplyScalar(attitudeError, 0.5f))));
+    ekf->bias = FusionVectorAdd(ekf->bias, biasError);
+}
+
+//------------------------------------------------------------------------------
+// Functions - 3x3 matrix operations
+
+/**
+ * @brief result = a b.  result must not alias a or b.
+ */
+static void Multiply(const matrix3_t a, const matrix3_t b, matrix3_t result)
+{
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            result[row][column] = a[row][0] * b[0][column] + a[row][1] * b[1][column] + a[row][2] * b[2][column];
+        }
+    }
+}
+
+/**
+ * @brief result = a b^T.  result must not alias a or b.
+ */
+static void MultiplyTransposed(const matrix3_t a, const matrix3_t b, matrix3_t result)
+{
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = 0; column < 3; column++)
+        {
+            result[row][column] = a[row][0] * b[column][0] + a[row][1] * b[column][1] + a[row][2] * b[column][2];
+        }
+    }
+}
+
+/**
+ * @brief Averages the off-diagonal elements to remove rounding asymmetry.
+ */
+static void Symmetrise(matrix3_t a)
+{
+    for (int row = 0; row < 3; row++)
+    {
+        for (int column = row + 1; column < 3; column++)
+        {
+            const float mean = 0.5f * (a[row][column] + a[column][row]);
+            a[row][column] = mean;
+            a[column][row] = mean;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,82 @@
+/**
+ * @file fusion_ekf.h
+ * @brief Error-state extended Kalman filter with attitude and gyroscope bias
+ * states, an alternative to fusion_ahrs_t that also estimates the gyroscope
+ * bias and reports its covariance.  The nominal quaternion is integrated for
+ * every gyroscope sample and the six-state covariance is propagated and
+ * corrected once per accelerometer feedback step.  All matrices are fixed
+ * size 3x3 blocks, so there is no heap and no general matrix inverse.
+ */
+
+#ifndef _FUSION_EKF_H_
+#define _FUSION_EKF_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdbool.h>
+#include "FusionConvention.h"
+#include "math_utils.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Number of error states: attitude then gyroscope bias.
+ */
+#define FUSION_EKF_STATES (6)
+
+/**
+ * @brief EKF settings.
+ */
+typedef struct
+{
+    FusionConvention convention;
+    float gyroscopeNoise;                 // degrees per second per root Hz
+    float gyroscopeBiasStability;         // bias random walk, degrees per second per root second
+    float accelerometerNoise;             // g per feedback step, including vibration and linear acceleration
+    float accelerationRejection;          // g, feedback is skipped if the magnitude differs from 1 g by more
+    float innovationRejection;            // feedback is skipped above this normalised innovation squared
+    float initialBiasUncertainty;         // degrees per second, one sigma
+    unsigned int accelerometerDecimation; // gyroscope samples per accelerometer feedback step in batch updates
+} fusion_ekf_settings_t;
+
+/**
+ * @brief EKF structure.  The covariance is kept as three 3x3 blocks of the
+ * symmetric 6x6 matrix.  Structure members are used internally and must not
+ * be accessed by the application.
+ */
+typedef struct
+{
+    fusion_ekf_settings_t settings;
+    FusionQuaternion quaternion;
+    FusionVector bias;              // radians per second
+    float attitudeCovariance[3][3]; // radians squared
+    float crossCovariance[3][3];    // attitude rows, bias columns
+    float biasCovariance[3][3];     // radians per second squared
+    FusionVector gyroscopeSum;      // bias corrected, radians per second
+    FusionVector accelerometerSum;  // g
+    unsigned int accelerometerSamples;
+    bool initialising;
+    bool accelerometerIgnored;
+} fusion_ekf_t;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+void fusion_ekf_init(fusion_ekf_t *const ekf, const fusion_ekf_settings_t *const settings);
+void fusion_ekf_reset(fusion_ekf_t *const ekf);
+void fusion_ekf_update_no_magnetometer(fusion_ekf_t *const ekf, const FusionVector gyroscope,
+                                       const FusionVector accelerometer, const float deltaTime);
+void fusion_ekf_update_batch_no_magnetometer(fusion_ekf_t *const ekf, const FusionVector *const gyroscope,
+                                             const FusionVector *const accelerometer, const unsigned int count,
+                                             const float deltaTime);
+FusionQuaternion fusion_ekf_get_quaternion(const fusion_ekf_t *const ekf);
+FusionVector fusion_ekf_get_gyroscope_bias(const fusion_ekf_t *const ekf);
+void fusion_ekf_get_covariance(const fusion_ekf_t *const ekf, float covariance[FUSION_EKF_STATES][FUSION_EKF_STATES]);
+bool fusion_ekf_is_accelerometer_ignored(const fusion_ekf_t *const ekf);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -2,7 +2,9 @@
  * @file fusion_offset.c
  * @author Seb Madgwick
  * @brief Gyroscope offset correction algorithm for run-time calibration of the
- * gyroscope offset.
+ * gyroscope offset.  The offset is modelled as a linear function of the IMU
+ * temperature and both coefficients are learnt by recursive least squares
+ * while the gyroscope is stationary.
  */
 
 //------------------------------------------------------------------------------
@@ -15,9 +17,9 @@
 // Definitions
 
 /**
- * @brief Cutoff frequency in Hz.
+ * @brief Memory of the least squares estimate in seconds of stationary data.
  */
-#define CUTOFF_FREQUENCY (0.02f)
+#define MEMORY (300.0f)
 
 /**
  * @brief Timeout in seconds.
@@ -29,6 +31,29 @@
  */
 #define THRESHOLD (3.0f)
 
+/**
+ * @brief Reference temperature in degrees Celsius.  The ICM-42688 temperature
+ * output is zero at this temperature.
+ */
+#define REFERENCE_TEMPERATURE (25.0f)
+
+/**
+ * @brief Initial, and maximum, offset variance in (degrees per second)^2.
+ */
+#define OFFSET_VARIANCE (1.0f)
+
+/**
+ * @brief Initial, and maximum, slope variance in (degrees per second per
+ * degree Celsius)^2.
+ */
+#define SLOPE_VARIANCE (0.01f)
+
+/**
+ * @brief Stationary time in seconds after which the model is considered
+ * converged.
+ */
+#define CONVERGENCE_PERIOD (30)
+
 //------------------------------------------------------------------------------
 // Functions
 
@@ -39,45 +64,124 @@
  */
 void fusion_offset_init(fusion_offset_t *const offset, const uint16_t sampleRate)
 {
-    offset->filterCoefficient = 2.0f * (float)M_PI * CUTOFF_FREQUENCY * (1.0f / (float)sampleRate);
+    offset->forgettingFactor = 1.0f - 1.0f / (MEMORY * (float)sampleRate);
     offset->timeout = TIMEOUT * sampleRate;
     offset->timer = 0;
-    offset->gyroscopeOffset = FUSION_VECTOR_ZERO;
+    offset->model.offset = FUSION_VECTOR_ZERO;
+    offset->model.slope = FUSION_VECTOR_ZERO;
+    offset->model.referenceTemperature = REFERENCE_TEMPERATURE;
+    offset->covariance[0] = OFFSET_VARIANCE;
+    offset->covariance[1] = 0.0f;
+    offset->covariance[2] = SLOPE_VARIANCE;
+    offset->learnedSamples = 0;
 }
 
 /**
  * @brief Updates the gyroscope offset algorithm and returns the corrected
- * gyroscope measurement.
+ * gyroscope measurement.  The temperature is assumed to be the reference
+ * temperature, so only the offset is learnt.
  * @param offset Gyroscope offset algorithm structure.
  * @param gyroscope Gyroscope measurement in degrees per second.
  * @return Corrected gyroscope measurement in degrees per second.
  */
 FusionVector fusion_offset_update(fusion_offset_t *const offset, FusionVector gyroscope)
 {
+    return fusion_offset_update_temperature(offset, gyroscope, offset->model.referenceTemperature);
+}
+
+/**
+ * @brief Updates the gyroscope offset algorithm and returns the
+ * temperature-compensated gyroscope measurement.
+ * @param offset Gyroscope offset algorithm structure.
+ * @param gyroscope Gyroscope measurement in degrees per second.
+ * @param temperature IMU temperature in degrees Celsius.
+ * @return Corrected gyroscope measurement in degrees per second.
+ */
+FusionVector fusion_offset_update_temperature(fusion_offset_t *const offset, FusionVector gyroscope,
+                                              const float temperature)
+{
+    const float deltaTemperature = temperature - offset->model.referenceTemperature;
 
     // Subtract offset from gyroscope measurement
-    gyroscope = fusion_vector_subtract(gyroscope, offset->gyroscopeOffset);
-
-    // // Reset timer if gyroscope not stationary
-    // if ((fabsf(gyroscope.axis.x) > THRESHOLD) || (fabsf(gyroscope.axis.y) > THRESHOLD) ||
-    //     (fabsf(gyroscope.axis.z) > THRESHOLD))
-    // {
-    //     offset->timer = 0;
-    //     return gyroscope;
-    // }
-
-    // // Increment timer while gyroscope stationary
-    // if (offset->timer < offset->timeout)
-    // {
-    //     offset->timer++;
-    //     return gyroscope;
-    // }
-
-    // // Adjust offset if timer has elapsed
-    // offset->gyroscopeOffset =
-    //     FusionVectorAdd(offset->gyroscopeOffset, FusionVectorMultiplyScalar(gyroscope, offset->filterCoefficient));
+    gyroscope = fusion_vector_subtract(
+        gyroscope,
+        FusionVectorAdd(offset->model.offset, FusionVectorMultiplyScalar(offset->model.slope, deltaTemperature)));
+
+    // Reset timer if gyroscope not stationary
+    if ((fabsf(gyroscope.axis.x) > THRESHOLD) || (fabsf(gyroscope.axis.y) > THRESHOLD) ||
+        (fabsf(gyroscope.axis.z) > THRESHOLD))
+    {
+        offset->timer = 0;
+        return gyroscope;
+    }
+
+    // Increment timer while gyroscope stationary
+    if (offset->timer < offset->timeout)
+    {
+        offset->timer++;
+        return gyroscope;
+    }
+
+    // Adjust model if timer has elapsed.  The regressor [1, deltaTemperature]
+    // is shared by the three axes, so they share one covariance.
+    float *const p = offset->covariance;
+    const float pPhi0 = p[0] + p[1] * deltaTemperature;
+    const float pPhi1 = p[1] + p[2] * deltaTemperature;
+    const float denominator = offset->forgettingFactor + pPhi0 + pPhi1 * deltaTemperature;
+    const float gain0 = pPhi0 / denominator;
+    const float gain1 = pPhi1 / denominator;
+    offset->model.offset = FusionVectorAdd(offset->model.offset, FusionVectorMultiplyScalar(gyroscope, gain0));
+    offset->model.slope = FusionVectorAdd(offset->model.slope, FusionVectorMultiplyScalar(gyroscope, gain1));
+
+    // Forget old data unless the covariance has grown back to its initial value
+    const float forgetting = ((p[0] < OFFSET_VARIANCE) && (p[2] < SLOPE_VARIANCE)) ? offset->forgettingFactor : 1.0f;
+    p[0] = (p[0] - gain0 * pPhi0) / forgetting;
+    p[1] = (p[1] - gain0 * pPhi1) / forgetting;
+    p[2] = (p[2] - gain1 * pPhi1) / forgetting;
+
+    if (offset->learnedSamples < offset->timeout * (CONVERGENCE_PERIOD / TIMEOUT))
+    {
+        offset->learnedSamples++;
+    }
     return gyroscope;
 }
 
+/**
+ * @brief Returns the learnt gyroscope offset model.
+ * @param offset Gyroscope offset algorithm structure.
+ * @return Gyroscope offset model.
+ */
+fusion_offset_model_t fusion_offset_get_model(const fusion_offset_t *const offset)
+{
+    return offset->model;
+}
+
+/**
+ * @brief Sets the gyroscope offset model, e.g. one restored from flash.  The
+ * covariance is reduced so that the restored model is refined rather than
+ * relearnt, and the model is reported as converged.
+ * @param offset Gyroscope offset algorithm structure.
+ * @param model Gyroscope offset model.
+ */
+void fusion_offset_set_model(fusion_offset_t *const offset, const fusion_offset_model_t *const model)
+{
+    offset->model = *model;
+    offset->covariance[0] = 0.01f * OFFSET_VARIANCE;
+    offset->covariance[1] = 0.0f;
+    offset->covariance[2] = 0.01f * SLOPE_VARIANCE;
+    offset->learnedSamples = offset->timeout * (CONVERGENCE_PERIOD / TIMEOUT);
+}
+
+/**
+ * @brief Returns true once the model has been learnt from enough stationary
+ * data, or restored with fusion_offset_set_model().
+ * @param offset Gyroscope offset algorithm structure.
+ * @return True if the model is converged.
+ */
+bool fusion_offset_is_converged(const fusion_offset_t *const offset)
+{
+    return (offset->timeout > 0) && (offset->learnedSamples >= offset->timeout * (CONVERGENCE_PERIOD / TIMEOUT));
+}
+
 //------------------------------------------------------------------------------
 // End of file
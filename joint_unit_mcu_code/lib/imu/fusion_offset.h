@@ -4,21 +4,35 @@
 //------------------------------------------------------------------------------
 // Includes
 
+#include <stdbool.h>
 #include "math_utils.h"
 
 //------------------------------------------------------------------------------
 // Definitions
 
+/**
+ * @brief Gyroscope offset model.  The offset at temperature T is
+ * offset + slope * (T - referenceTemperature).
+ */
+typedef struct
+{
+    FusionVector offset;        // degrees per second
+    FusionVector slope;         // degrees per second per degree Celsius
+    float referenceTemperature; // degrees Celsius
+} fusion_offset_model_t;
+
 /**
  * @brief Gyroscope offset algorithm structure.  Structure members are used
  * internally and must not be accessed by the application.
  */
 typedef struct
 {
-    float filterCoefficient;
+    float forgettingFactor;
     unsigned int timeout;
     unsigned int timer;
-    FusionVector gyroscopeOffset;
+    fusion_offset_model_t model;
+    float covariance[3]; // offset, cross and slope terms of the symmetric 2x2 covariance
+    unsigned int learnedSamples;
 } fusion_offset_t;
 
 //------------------------------------------------------------------------------
@@ -26,6 +40,11 @@ typedef struct
 
 void fusion_offset_init(fusion_offset_t *const offset, const uint16_t sampleRate);
 FusionVector fusion_offset_update(fusion_offset_t *const offset, FusionVector gyroscope);
+FusionVector fusion_offset_update_temperature(fusion_offset_t *const offset, FusionVector gyroscope,
+                                              const float temperature);
+fusion_offset_model_t fusion_offset_get_model(const fusion_offset_t *const offset);
+void fusion_offset_set_model(fusion_offset_t *const offset, const fusion_offset_model_t *const model);
+bool fusion_offset_is_converged(const fusion_offset_t *const offset);
 
 #endif
 
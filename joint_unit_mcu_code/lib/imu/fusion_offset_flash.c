@@ -0,0 +1,178 @@
+/**
+ * @file fusion_offset_flash.c
+ * @brief Per-unit persistence of the learnt gyroscope offset model in flash.
+ * The model is stored in its own sector at FLASH_GYRO_OFFSET_OFFSET, next to
+ * the CAN ID sector written by protocol.c.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "fusion_offset_flash.h"
+#include <math.h>   // fabsf
+#include <string.h> // memcpy
+
+#include "dev_config.h"
+#include "hardware/sync.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Record marker, "GOFS".
+ */
+#define MAGIC (0x53464F47u)
+
+/**
+ * @brief Minimum interval between two writes in microseconds.
+ */
+#define SAVE_INTERVAL (10ull * 60ull * 1000000ull)
+
+/**
+ * @brief Offset change in degrees per second that triggers a write.
+ */
+#define OFFSET_TOLERANCE (0.02f)
+
+/**
+ * @brief Slope change in degrees per second per degree Celsius that triggers
+ * a write.
+ */
+#define SLOPE_TOLERANCE (0.002f)
+
+/**
+ * @brief Flash record.
+ */
+typedef struct
+{
+    uint32_t magic;
+    fusion_offset_model_t model;
+    uint32_t checksum;
+} fusion_offset_record_t;
+
+//------------------------------------------------------------------------------
+// Variables
+
+static const fusion_offset_record_t *const storedRecord =
+    (const fusion_offset_record_t *)(XIP_BASE + FLASH_GYRO_OFFSET_OFFSET);
+
+static uint64_t lastSaveTime = 0;
+
+static bool loadAttempted = false;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+static uint32_t Checksum(const fusion_offset_model_t *const model);
+
+static bool IsValid(const fusion_offset_record_t *const record);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Restores the gyroscope offset model from flash.  Call after
+ * fusion_offset_init().
+ * @param offset Gyroscope offset algorithm structure.
+ * @return True if a valid model was found.
+ */
+bool fusion_offset_flash_load(fusion_offset_t *const offset)
+{
+    loadAttempted = true;
+    if (IsValid(storedRecord) == false)
+    {
+        return false;
+    }
+    fusion_offset_model_t model;
+    memcpy(&model, &storedRecord->model, sizeof(model));
+    fusion_offset_set_model(offset, &model);
+    return true;
+}
+
+/**
+ * @brief Writes the gyroscope offset model to flash.  Interrupts are disabled
+ * for the erase and program (tens of milliseconds), so this must be called
+ * from the main loop and not from a timer callback.
+ * @param offset Gyroscope offset algorithm structure.
+ * @return True if the record reads back correctly.
+ */
+bool fusion_offset_flash_save(const fusion_offset_t *const offset)
+{
+    static uint8_t page[FLASH_PAGE_SIZE];
+    fusion_offset_record_t record = {
+        .magic = MAGIC,
+        .model = fusion_offset_get_model(offset),
+    };
+    record.checksum = Checksum(&record.model);
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, &record, sizeof(record));
+
+    const uint32_t interrupts = save_and_disable_interrupts();
+    flash_range_erase(FLASH_GYRO_OFFSET_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(FLASH_GYRO_OFFSET_OFFSET, page, FLASH_PAGE_SIZE);
+    restore_interrupts(interrupts);
+
+    lastSaveTime = time_us_64();
+    return IsValid(storedRecord);
+}
+
+/**
+ * @brief Writes the gyroscope offset model to flash if it is converged, has
+ * moved away from the stored model, and the last write is at least
+ * SAVE_INTERVAL old.  Intended to be polled from the main loop.  Nothing is
+ * written before fusion_offset_flash_load() has run, so a stored model is
+ * never replaced by one that was learnt without it.
+ * @param offset Gyroscope offset algorithm structure.
+ * @return True if the model was written.
+ */
+bool fusion_offset_flash_update(const fusion_offset_t *const offset)
+{
+    if ((loadAttempted == false) || (fusion_offset_is_converged(offset) == false) ||
+        ((time_us_64() - lastSaveTime) < SAVE_INTERVAL))
+    {
+        return false;
+    }
+    if (IsValid(storedRecord))
+    {
+        const fusion_offset_model_t model = fusion_offset_get_model(offset);
+        bool changed = false;
+        for (int i = 0; i < 3; i++)
+        {
+            changed |= fabsf(model.offset.array[i] - storedRecord->model.offset.array[i]) > OFFSET_TOLERANCE;
+            changed |= fabsf(model.slope.array[i] - storedRecord->model.slope.array[i]) > SLOPE_TOLERANCE;
+        }
+        if (changed == false)
+        {
+            return false;
+        }
+    }
+    return fusion_offset_flash_save(offset);
+}
+
+/**
+ * @brief Returns the FNV-1a hash of the model.
+ * @param model Gyroscope offset model.
+ * @return Checksum.
+ */
+static uint32_t Checksum(const fusion_offset_model_t *const model)
+{
+    const uint8_t *const bytes = (const uint8_t *)model;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(*model); i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Returns true if the record holds a model written by this module.
+ * @param record Flash record.
+ * @return True if the record is valid.
+ */
+static bool IsValid(const fusion_offset_record_t *const record)
+{
+    return (record->magic == MAGIC) && (record->checksum == Checksum(&record->model));
+}
+
+//------------------------------------------------------------------------------
+// End of file
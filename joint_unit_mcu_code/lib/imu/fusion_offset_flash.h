@@ -0,0 +1,26 @@
+/**
+ * @file fusion_offset_flash.h
+ * @brief Per-unit persistence of the learnt gyroscope offset model in flash so
+ * that warm restarts start from the last model instead of zero.
+ */
+
+#ifndef _FUSION_OFFSET_FLASH_H_
+#define _FUSION_OFFSET_FLASH_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdbool.h>
+#include "fusion_offset.h"
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+bool fusion_offset_flash_load(fusion_offset_t *const offset);
+bool fusion_offset_flash_save(const fusion_offset_t *const offset);
+bool fusion_offset_flash_update(const fusion_offset_t *const offset);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,290 @@
+/**
+ * @file imu_pipeline.c
+ * @brief Multi-rate IMU pipeline.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "imu_pipeline.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Fixed-point scales of the decimator inputs.  Vectors are Q16 so that
+ * 2000 degrees per second still fits in an int32_t, quaternions are Q30.
+ */
+#define VECTOR_SCALE (65536.0f)
+#define QUATERNION_SCALE (1073741824.0f)
+
+/**
+ * @brief Relative spread of the sample periods that share one attitude update.
+ * The FIFO timestamps resolve 1 us, so periods jitter by about 0.1 % at 1 kHz,
+ * while a lost sample doubles the period.
+ */
+#define PERIOD_TOLERANCE (0.01f)
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises the pipeline.  The calibration defaults to the identity,
+ * so imu_pipeline_set_calibration() must be called before the outputs are in
+ * degrees per second and g.
+ * @param pipeline IMU pipeline structure.
+ * @param rates Sample, fusion and output rates.
+ * @param attitude_settings AHRS or EKF settings.  The accelerometer
+ * decimation, and for the AHRS the sample rate and period, are derived from
+ * rates.
+ * @param notch_settings Accelerometer notch settings.  The sample rate is
+ * taken from rates.
+ * @return False if the rates are inconsistent.
+ */
+bool imu_pipeline_init(imu_pipeline_t *const pipeline, const imu_pipeline_rates_t *const rates,
+                       const imu_pipeline_attitude_settings_t *const attitude_settings,
+                       const adaptive_notch_settings_t *const notch_settings)
+{
+    if ((rates->sample_hz == 0) || (rates->fusion_hz == 0) || (rates->output_hz == 0) ||
+        (rates->sample_hz % rates->fusion_hz != 0) || (rates->fusion_hz % rates->output_hz != 0))
+    {
+        return false;
+    }
+    pipeline->rates = *rates;
+
+    if ((cic_decimator_init(&pipeline->sensor_decimator, 6, rates->sample_hz / rates->output_hz) == false) ||
+        (cic_decimator_init(&pipeline->attitude_decimator, 4, rates->fusion_hz / rates->output_hz) == false))
+    {
+        return false;
+    }
+
+    imu_pipeline_attitude_settings_t settings = *attitude_settings;
+    settings.accelerometerDecimation = rates->sample_hz / rates->fusion_hz;
+#ifdef FUSION_USE_EKF
+    fusion_ekf_init(&pipeline->ekf, &settings);
+    fusion_offset_init(&pipeline->offset, rates->sample_hz);
+#else
+    fusion_ahrs_init(&pipeline->ahrs, rates->sample_hz);
+    settings.sample_rate = rates->sample_hz;
+    settings.sample_period = 1.0f / (float)rates->sample_hz;
+    fusionAhrs_set_settings(&pipeline->ahrs, &settings);
+#endif
+    pipeline->fusion_decimation = settings.accelerometerDecimation;
+    pipeline->fusion_phase = 0;
+    imu_preintegration_init(&pipeline->preintegration);
+    imu_timestamp_init(&pipeline->timestamp, rates->sample_hz);
+
+    adaptive_notch_settings_t notch = *notch_settings;
+    notch.sample_hz = (float)rates->sample_hz;
+    adaptive_notch_init(&pipeline->accel_notch, &notch, 3);
+
+    pipeline->gyro_calibration.matrix = FUSION_IDENTITY_MATRIX;
+    pipeline->gyro_calibration.offset = FUSION_VECTOR_ZERO;
+    pipeline->accel_calibration = pipeline->gyro_calibration;
+
+    pipeline->output.quaternion = FUSION_IDENTITY_QUATERNION;
+    pipeline->output.gyroscope = FUSION_VECTOR_ZERO;
+    pipeline->output.accelerometer = FUSION_VECTOR_ZERO;
+    return true;
+}
+
+/**
+ * @brief Sets the calibration applied to the raw sensor counts.
+ * @param pipeline IMU pipeline structure.
+ * @param gyro_calibration Gyroscope calibration, counts to degrees per second.
+ * @param accel_calibration Accelerometer calibration, counts to g.
+ */
+void imu_pipeline_set_calibration(imu_pipeline_t *const pipeline,
+                                  const fusion_calibration_inertial_t *const gyro_calibration,
+                                  const fusion_calibration_inertial_t *const accel_calibration)
+{
+    pipeline->gyro_calibration = *gyro_calibration;
+    pipeline->accel_calibration = *accel_calibration;
+}
+
+/**
+ * @brief Passes the vibration frequency expected from the motor command to the
+ * accelerometer notch, see adaptive_notch_set_hint().
+ * @param pipeline IMU pipeline structure.
+ * @param hint_hz Expected frequency in Hz, or zero.
+ */
+void imu_pipeline_set_motor_hint(imu_pipeline_t *const pipeline, const float hint_hz)
+{
+    adaptive_notch_set_hint(&pipeline->accel_notch, hint_hz);
+}
+
+/**
+ * @brief Processes consecutive FIFO samples.  The gyroscope is integrated for
+ * every sample over its period from the FIFO timestamps, and the AHRS is
+ * updated in chunks that end on the fusion steps, so that the attitude
+ * decimator sees the quaternion at the fusion rate.
+ * @param pipeline IMU pipeline structure.
+ * @param samples FIFO samples, oldest first.
+ * @param count Number of samples, at most ICM_FIFO_BURST_MAX.
+ * @param read_us MCU time in microseconds when the samples were read, for the
+ * sensor clock drift.
+ * @return True if a new output is available.
+ */
+bool imu_pipeline_update(imu_pipeline_t *const pipeline, const sensor_imu_t *const samples, const uint16_t count,
+                         const uint64_t read_us)
+{
+    const uint16_t length = (count < ICM_FIFO_BURST_MAX) ? count : ICM_FIFO_BURST_MAX;
+    FusionVector gyroscope[ICM_FIFO_BURST_MAX];
+    FusionVector accelerometer[ICM_FIFO_BURST_MAX];
+    float periods[ICM_FIFO_BURST_MAX];
+    imu_timestamp_update(&pipeline->timestamp, samples, length, read_us, periods);
+
+    // Calibrate every sample, preintegrate it and decimate the sensor streams
+    for (uint16_t n = 0; n < length; n++)
+    {
+        const FusionVector gyroscope_raw = {.axis = {
+                                                .x = (float)samples[n].gyro[0].data,
+                                                .y = (float)samples[n].gyro[1].data,
+                                                .z = (float)samples[n].gyro[2].data,
+                                            }};
+        const int32_t accelerometer_counts[3] = {
+            samples[n].accel[0].data,
+            samples[n].accel[1].data,
+            samples[n].accel[2].data,
+        };
+        adaptive_notch_update(&pipeline->accel_notch, accelerometer_counts);
+        const FusionVector accelerometer_raw = {.axis = {
+                                                    .x = adaptive_notch_output(&pipeline->accel_notch, 0),
+                                                    .y = adaptive_notch_output(&pipeline->accel_notch, 1),
+                                                    .z = adaptive_notch_output(&pipeline->accel_notch, 2),
+                                                }};
+        gyroscope[n] = fusion_calibration_inertial_apply(&pipeline->gyro_calibration, gyroscope_raw);
+        accelerometer[n] = fusion_calibration_inertial_apply(&pipeline->accel_calibration, accelerometer_raw);
+        gyroscope[n] = fusion_offset_update_temperature(imu_pipeline_get_offset(pipeline), gyroscope[n],
+                                                        ICM_FIFO_TEMPERATURE_TO_CELSIUS(samples[n].temperature));
+        imu_preintegration_update(&pipeline->preintegration, gyroscope[n], accelerometer[n], periods[n]);
+
+        const int32_t sensor[6] = {
+            (int32_t)(gyroscope[n].axis.x * VECTOR_SCALE),     (int32_t)(gyroscope[n].axis.y * VECTOR_SCALE),
+            (int32_t)(gyroscope[n].axis.z * VECTOR_SCALE),     (int32_t)(accelerometer[n].axis.x * VECTOR_SCALE),
+            (int32_t)(accelerometer[n].axis.y * VECTOR_SCALE), (int32_t)(accelerometer[n].axis.z * VECTOR_SCALE),
+        };
+        if (cic_decimator_update(&pipeline->sensor_decimator, sensor))
+        {
+            for (uint8_t i = 0; i < 3; i++)
+            {
+                pipeline->output.gyroscope.array[i] =
+                    cic_decimator_output(&pipeline->sensor_decimator, i) * (1.0f / VECTOR_SCALE);
+                pipeline->output.accelerometer.array[i] =
+                    cic_decimator_output(&pipeline->sensor_decimator, 3 + i) * (1.0f / VECTOR_SCALE);
+            }
+        }
+    }
+
+    // Sensor fusion, one chunk per accelerometer feedback step, split where the
+    // sample period changes by more than PERIOD_TOLERANCE.  Each chunk is
+    // integrated over its mean period, which keeps its total time.
+    const unsigned int decimation = pipeline->fusion_decimation;
+    bool output_ready = false;
+    uint16_t index = 0;
+    while (index < length)
+    {
+        uint16_t limit = (uint16_t)(decimation - pipeline->fusion_phase);
+        if (limit > length - index)
+        {
+            limit = length - index;
+        }
+        const float tolerance = PERIOD_TOLERANCE * periods[index];
+        float duration = periods[index];
+        uint16_t chunk = 1;
+        while ((chunk < limit) && (fabsf(periods[index + chunk] - periods[index]) <= tolerance))
+        {
+            duration += periods[index + chunk];
+            chunk++;
+        }
+        const float period = duration / (float)chunk;
+#ifdef FUSION_USE_EKF
+        fusion_ekf_update_batch_no_magnetometer(&pipeline->ekf, &gyroscope[index], &accelerometer[index], chunk,
+                                                period);
+#else
+        fusion_ahrs_update_batch_no_magnetometer(&pipeline->ahrs, &gyroscope[index], &accelerometer[index], chunk,
+                                                 period);
+#endif
+        index += chunk;
+        pipeline->fusion_phase += chunk;
+        if (pipeline->fusion_phase < decimation)
+        {
+            continue;
+        }
+        pipeline->fusion_phase = 0;
+
+#ifdef FUSION_USE_EKF
+        const FusionQuaternion quaternion = fusion_ekf_get_quaternion(&pipeline->ekf);
+#else
+        const FusionQuaternion quaternion = FusionAhrsGetQuaternion(&pipeline->ahrs);
+#endif
+        const int32_t attitude[4] = {
+            (int32_t)(quaternion.element.w * QUATERNION_SCALE),
+            (int32_t)(quaternion.element.x * QUATERNION_SCALE),
+            (int32_t)(quaternion.element.y * QUATERNION_SCALE),
+            (int32_t)(quaternion.element.z * QUATERNION_SCALE),
+        };
+        if (cic_decimator_update(&pipeline->attitude_decimator, attitude))
+        {
+            FusionQuaternion average;
+            for (uint8_t i = 0; i < 4; i++)
+            {
+                average.array[i] = cic_decimator_output(&pipeline->attitude_decimator, i);
+            }
+            pipeline->output.quaternion = FusionQuaternionNormalise(average);
+            output_ready = true;
+        }
+    }
+    return output_ready;
+}
+
+/**
+ * @brief Returns the latest decimated output.
+ * @param pipeline IMU pipeline structure.
+ * @return Output.
+ */
+const imu_pipeline_output_t *imu_pipeline_get_output(const imu_pipeline_t *const pipeline)
+{
+    return &pipeline->output;
+}
+
+/**
+ * @brief Returns the coning and sculling compensated increment accumulated
+ * since the previous call, see imu_preintegration_take().  Must not be
+ * interrupted by imu_pipeline_update().
+ * @param pipeline IMU pipeline structure.
+ * @return Increment.
+ */
+imu_increment_t imu_pipeline_take_increment(imu_pipeline_t *const pipeline)
+{
+    return imu_preintegration_take(&pipeline->preintegration);
+}
+
+/**
+ * @brief Returns the gyroscope offset algorithm of the pipeline, e.g. for
+ * fusion_offset_flash_update().
+ * @param pipeline IMU pipeline structure.
+ * @return Gyroscope offset algorithm structure.
+ */
+fusion_offset_t *imu_pipeline_get_offset(imu_pipeline_t *const pipeline)
+{
+#ifdef FUSION_USE_EKF
+    return &pipeline->offset;
+#else
+    return &pipeline->ahrs.offset;
+#endif
+}
+
+/**
+ * @brief Returns the sensor clock drift against the MCU clock, see
+ * imu_timestamp_get_drift_ppm().
+ * @param pipeline IMU pipeline structure.
+ * @return Drift in parts per million.
+ */
+float imu_pipeline_get_clock_drift_ppm(const imu_pipeline_t *const pipeline)
+{
+    return imu_timestamp_get_drift_ppm(&pipeline->timestamp);
+}
+
+//------------------------------------------------------------------------------
+// End of file
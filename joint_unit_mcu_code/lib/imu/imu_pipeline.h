@@ -0,0 +1,107 @@
+/**
+ * @file imu_pipeline.h
+ * @brief Multi-rate IMU pipeline.  Every FIFO sample is calibrated, notched and
+ * integrated at the sensor output data rate, the accelerometer feedback runs
+ * at the fusion rate, and CIC decimators bring the gyroscope, accelerometer
+ * and attitude streams down to the output rate.  All three rates are run-time
+ * parameters.  The calibrated samples are also preintegrated into delta
+ * angles and delta velocities that the application reads at its own rate.
+ * Every sample is integrated over its own period from the FIFO timestamps.
+ */
+
+#ifndef _IMU_PIPELINE_H_
+#define _IMU_PIPELINE_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdbool.h>
+#include "FusionAhrs.h"
+#include "FusionCalibration.h"
+#include "fusion_ekf.h"
+#include "adaptive_notch.h"
+#include "cic_decimator.h"
+#include "icm42688.h"
+#include "imu_preintegration.h"
+#include "imu_timestamp.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Attitude engine settings, fusion_ekf_t if FUSION_USE_EKF is defined
+ * and fusion_ahrs_t otherwise.
+ */
+#ifdef FUSION_USE_EKF
+typedef fusion_ekf_settings_t imu_pipeline_attitude_settings_t;
+#else
+typedef FusionAhrsSettings imu_pipeline_attitude_settings_t;
+#endif
+
+/**
+ * @brief Pipeline rates in Hz.  sample_hz must be an ICM-42688 output data
+ * rate, fusion_hz must divide sample_hz and output_hz must divide fusion_hz.
+ */
+typedef struct
+{
+    uint16_t sample_hz; // sensor output data rate, gyroscope integration
+    uint16_t fusion_hz; // accelerometer feedback
+    uint16_t output_hz; // decimated output streams
+} imu_pipeline_rates_t;
+
+/**
+ * @brief Decimated output of the pipeline.
+ */
+typedef struct
+{
+    FusionQuaternion quaternion;
+    FusionVector gyroscope;     // degrees per second
+    FusionVector accelerometer; // g
+} imu_pipeline_output_t;
+
+/**
+ * @brief IMU pipeline structure.  Structure members are used internally and
+ * must not be accessed by the application.
+ */
+typedef struct
+{
+    imu_pipeline_rates_t rates;
+#ifdef FUSION_USE_EKF
+    fusion_ekf_t ekf;
+    fusion_offset_t offset;
+#else
+    fusion_ahrs_t ahrs;
+#endif
+    fusion_calibration_inertial_t gyro_calibration;
+    fusion_calibration_inertial_t accel_calibration;
+    adaptive_notch_t accel_notch;
+    unsigned int fusion_decimation;
+    unsigned int fusion_phase;
+    cic_decimator_t sensor_decimator;   // gyroscope and accelerometer at sample_hz
+    cic_decimator_t attitude_decimator; // quaternion at fusion_hz
+    imu_preintegration_t preintegration;
+    imu_timestamp_t timestamp;
+    imu_pipeline_output_t output;
+} imu_pipeline_t;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+bool imu_pipeline_init(imu_pipeline_t *const pipeline, const imu_pipeline_rates_t *const rates,
+                       const imu_pipeline_attitude_settings_t *const attitude_settings,
+                       const adaptive_notch_settings_t *const notch_settings);
+void imu_pipeline_set_calibration(imu_pipeline_t *const pipeline,
+                                  const fusion_calibration_inertial_t *const gyro_calibration,
+                                  const fusion_calibration_inertial_t *const accel_calibration);
+void imu_pipeline_set_motor_hint(imu_pipeline_t *const pipeline, const float hint_hz);
+bool imu_pipeline_update(imu_pipeline_t *const pipeline, const sensor_imu_t *const samples, const uint16_t count,
+                         const uint64_t read_us);
+const imu_pipeline_output_t *imu_pipeline_get_output(const imu_pipeline_t *const pipeline);
+imu_increment_t imu_pipeline_take_increment(imu_pipeline_t *const pipeline);
+fusion_offset_t *imu_pipeline_get_offset(imu_pipeline_t *const pipeline);
+float imu_pipeline_get_clock_drift_ppm(const imu_pipeline_t *const pipeline);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
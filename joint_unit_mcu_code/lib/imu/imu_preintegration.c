@@ -0,0 +1,99 @@
+/**
+ * @file imu_preintegration.c
+ * @brief Coning and sculling compensated delta-angle and delta-velocity
+ * preintegration.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "imu_preintegration.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Standard gravity in metres per second squared per g.
+ */
+#define STANDARD_GRAVITY (9.80665f)
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises the preintegration with an empty interval.
+ * @param preintegration Preintegration structure.
+ */
+void imu_preintegration_init(imu_preintegration_t *const preintegration)
+{
+    preintegration->last_delta_angle = FUSION_VECTOR_ZERO;
+    preintegration->last_delta_velocity = FUSION_VECTOR_ZERO;
+    imu_preintegration_take(preintegration);
+}
+
+/**
+ * @brief Accumulates one sample.  The coning and sculling terms are the
+ * two-sample recursive forms of Savage, which use the previous sample to
+ * model the rate and specific force as linear across the sample.
+ * @param preintegration Preintegration structure.
+ * @param gyroscope Gyroscope in degrees per second.
+ * @param accelerometer Accelerometer in g.
+ * @param sample_period Time since the previous sample in seconds.
+ */
+void imu_preintegration_update(imu_preintegration_t *const preintegration, const FusionVector gyroscope,
+                               const FusionVector accelerometer, const float sample_period)
+{
+    const FusionVector delta_angle = FusionVectorMultiplyScalar(gyroscope, FusionDegreesToRadians(sample_period));
+    const FusionVector delta_velocity = FusionVectorMultiplyScalar(accelerometer, STANDARD_GRAVITY * sample_period);
+
+    // Sums up to the previous sample, plus a sixth of the previous sample
+    const FusionVector alpha = FusionVectorAdd(
+        preintegration->alpha, FusionVectorMultiplyScalar(preintegration->last_delta_angle, 1.0f / 6.0f));
+    const FusionVector nu = FusionVectorAdd(
+        preintegration->nu, FusionVectorMultiplyScalar(preintegration->last_delta_velocity, 1.0f / 6.0f));
+
+    preintegration->coning = FusionVectorAdd(
+        preintegration->coning, FusionVectorMultiplyScalar(FusionVectorCrossProduct(alpha, delta_angle), 0.5f));
+    preintegration->sculling =
+        FusionVectorAdd(preintegration->sculling,
+                        FusionVectorMultiplyScalar(FusionVectorAdd(FusionVectorCrossProduct(alpha, delta_velocity),
+                                                                   FusionVectorCrossProduct(nu, delta_angle)),
+                                                   0.5f));
+
+    preintegration->alpha = FusionVectorAdd(preintegration->alpha, delta_angle);
+    preintegration->nu = FusionVectorAdd(preintegration->nu, delta_velocity);
+    preintegration->last_delta_angle = delta_angle;
+    preintegration->last_delta_velocity = delta_velocity;
+    preintegration->samples++;
+    preintegration->duration += sample_period;
+}
+
+/**
+ * @brief Returns the increment since the previous call and starts a new
+ * interval.  The delta velocity is rotated to the start of the interval to
+ * first order with half the cross product of the sums.
+ * @param preintegration Preintegration structure.
+ * @return Increment.
+ */
+imu_increment_t imu_preintegration_take(imu_preintegration_t *const preintegration)
+{
+    imu_increment_t increment;
+    increment.delta_angle = FusionVectorAdd(preintegration->alpha, preintegration->coning);
+    increment.delta_velocity = FusionVectorAdd(
+        FusionVectorAdd(preintegration->nu, preintegration->sculling),
+        FusionVectorMultiplyScalar(FusionVectorCrossProduct(preintegration->alpha, preintegration->nu), 0.5f));
+    increment.samples = preintegration->samples;
+    increment.duration = preintegration->duration;
+
+    // The previous sample is kept, it still describes the motion entering the next interval
+    preintegration->alpha = FUSION_VECTOR_ZERO;
+    preintegration->nu = FUSION_VECTOR_ZERO;
+    preintegration->coning = FUSION_VECTOR_ZERO;
+    preintegration->sculling = FUSION_VECTOR_ZERO;
+    preintegration->samples = 0;
+    preintegration->duration = 0.0f;
+    return increment;
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,61 @@
+/**
+ * @file imu_preintegration.h
+ * @brief Coning and sculling compensated delta-angle and delta-velocity
+ * preintegration.  Calibrated gyroscope and accelerometer samples are
+ * accumulated at the sample rate and read out as increments over arbitrary
+ * intervals, so a host-side estimator receives the motion between two
+ * messages instead of rates that alias at the message rate.
+ */
+
+#ifndef _IMU_PREINTEGRATION_H_
+#define _IMU_PREINTEGRATION_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdint.h>
+#include "math_utils.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Increment over one interval, expressed in the sensor frame at the
+ * start of the interval.
+ */
+typedef struct
+{
+    FusionVector delta_angle;    // radians, rotation vector
+    FusionVector delta_velocity; // metres per second, specific force including gravity
+    uint32_t samples;            // samples in the interval
+    float duration;              // seconds
+} imu_increment_t;
+
+/**
+ * @brief Preintegration structure.  Structure members are used internally and
+ * must not be accessed by the application.
+ */
+typedef struct
+{
+    float duration;        // sum of sample periods
+    FusionVector alpha;    // sum of delta angles
+    FusionVector nu;       // sum of delta velocities
+    FusionVector coning;   // coning correction of alpha
+    FusionVector sculling; // sculling correction of nu
+    FusionVector last_delta_angle;
+    FusionVector last_delta_velocity;
+    uint32_t samples;
+} imu_preintegration_t;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+void imu_preintegration_init(imu_preintegration_t *const preintegration);
+void imu_preintegration_update(imu_preintegration_t *const preintegration, const FusionVector gyroscope,
+                               const FusionVector accelerometer, const float sample_period);
+imu_increment_t imu_preintegration_take(imu_preintegration_t *const preintegration);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,145 @@
+/**
+ * @file imu_timestamp.c
+ * @brief Per-sample periods from the ICM-42688 FIFO timestamps.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "imu_timestamp.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Drift baseline in MCU microseconds.  The newest sample is up to one
+ * period plus the I2C transfer older than its read time, so the baseline sets
+ * how much of that latency jitter reaches the scale.
+ */
+#define DRIFT_BASELINE_US (4000000u)
+
+/**
+ * @brief Weight of each new baseline in the scale estimate.
+ */
+#define DRIFT_WEIGHT (0.25f)
+
+/**
+ * @brief Largest sensor to MCU clock ratio error accepted, well beyond the
+ * sensor clock tolerance, so a baseline corrupted by a stall is discarded.
+ */
+#define DRIFT_LIMIT (0.05f)
+
+/**
+ * @brief Longest period reported for one sample, in seconds.  Bounds the step
+ * after the FIFO has been left unread, e.g. while the flash is written.
+ */
+#define MAXIMUM_PERIOD (0.25f)
+
+/**
+ * @brief Range of the 16-bit FIFO timestamp in microseconds.
+ */
+#define TIMESTAMP_RANGE (65536u)
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises the timestamps.  The sensor and MCU clocks are assumed
+ * equal until the first drift baseline completes.
+ * @param timestamp Timestamp structure.
+ * @param sample_hz Sensor output data rate.
+ */
+void imu_timestamp_init(imu_timestamp_t *const timestamp, const uint16_t sample_hz)
+{
+    timestamp->nominal_period_us = 1000000u / sample_hz;
+    timestamp->scale = 1.0f;
+    timestamp->scale_valid = false;
+    timestamp->started = false;
+}
+
+/**
+ * @brief Returns the period of every sample of a burst, the time from the
+ * previous sample in MCU seconds.  A gap longer than the 16-bit timestamp
+ * range is resolved with the MCU time between reads.
+ * @param timestamp Timestamp structure.
+ * @param samples FIFO samples, oldest first.
+ * @param count Number of samples.
+ * @param read_us MCU time in microseconds when the burst was read.
+ * @param periods Period of each sample in seconds.
+ */
+void imu_timestamp_update(imu_timestamp_t *const timestamp, const sensor_imu_t *const samples, const uint16_t count,
+                          const uint64_t read_us, float *const periods)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const bool first_burst = (timestamp->started == false);
+    for (uint16_t n = 0; n < count; n++)
+    {
+        uint32_t delta_us = (uint16_t)(samples[n].timestamp - timestamp->last_timestamp);
+        if (timestamp->started == false)
+        {
+            delta_us = timestamp->nominal_period_us;
+            timestamp->started = true;
+            timestamp->sensor_us = 0;
+        }
+        else if (n == 0)
+        {
+            // Whole wraps elapsed before the first sample of the burst, from the MCU time between reads
+            const float elapsed_us = (float)(read_us - timestamp->read_us) / timestamp->scale;
+            const float expected_us = elapsed_us - (float)(count - 1) * (float)timestamp->nominal_period_us;
+            if (expected_us > (float)delta_us)
+            {
+                const uint32_t wraps = (uint32_t)((expected_us - (float)delta_us) / (float)TIMESTAMP_RANGE + 0.5f);
+                delta_us += wraps * TIMESTAMP_RANGE;
+            }
+        }
+        timestamp->last_timestamp = samples[n].timestamp;
+        timestamp->sensor_us += delta_us;
+
+        const float period = (float)delta_us * timestamp->scale * 1e-6f;
+        periods[n] = (period < MAXIMUM_PERIOD) ? period : MAXIMUM_PERIOD;
+    }
+    timestamp->read_us = read_us;
+
+    // The baseline starts at the last sample of the first burst, the one read at read_us
+    if (first_burst)
+    {
+        timestamp->anchor_sensor_us = timestamp->sensor_us;
+        timestamp->anchor_read_us = read_us;
+        return;
+    }
+
+    // Compare the sensor and MCU clocks over the baseline
+    const uint64_t read_elapsed_us = read_us - timestamp->anchor_read_us;
+    if (read_elapsed_us < DRIFT_BASELINE_US)
+    {
+        return;
+    }
+    const uint64_t sensor_elapsed_us = timestamp->sensor_us - timestamp->anchor_sensor_us;
+    const float ratio = (sensor_elapsed_us == 0) ? 0.0f : (float)read_elapsed_us / (float)sensor_elapsed_us;
+    if ((ratio > 1.0f - DRIFT_LIMIT) && (ratio < 1.0f + DRIFT_LIMIT))
+    {
+        timestamp->scale = timestamp->scale_valid ? timestamp->scale + DRIFT_WEIGHT * (ratio - timestamp->scale)
+                                                  : ratio;
+        timestamp->scale_valid = true;
+    }
+    timestamp->anchor_sensor_us = timestamp->sensor_us;
+    timestamp->anchor_read_us = read_us;
+}
+
+/**
+ * @brief Returns the estimated rate of the sensor clock relative to the MCU
+ * clock, positive if the sensor runs fast.
+ * @param timestamp Timestamp structure.
+ * @return Drift in parts per million.
+ */
+float imu_timestamp_get_drift_ppm(const imu_timestamp_t *const timestamp)
+{
+    return (1.0f / timestamp->scale - 1.0f) * 1e6f;
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,51 @@
+/**
+ * @file imu_timestamp.h
+ * @brief Per-sample periods from the ICM-42688 FIFO timestamps.  The 16-bit
+ * timestamps count microseconds of the sensor clock, so consecutive samples
+ * give the real spacing whether they are read one at a time or in bursts,
+ * including samples lost to a full FIFO.  The sensor clock is scaled to the
+ * MCU clock with a drift estimate from the time each burst is read.
+ */
+
+#ifndef _IMU_TIMESTAMP_H_
+#define _IMU_TIMESTAMP_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "icm42688.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Timestamp structure.  Structure members are used internally and must
+ * not be accessed by the application.
+ */
+typedef struct
+{
+    uint32_t nominal_period_us; // sensor microseconds per sample at the output data rate
+    float scale;                // MCU microseconds per sensor microsecond
+    bool scale_valid;
+    bool started;
+    uint16_t last_timestamp;
+    uint64_t sensor_us;        // unwrapped sensor time of the newest sample
+    uint64_t read_us;          // MCU time the newest sample was read
+    uint64_t anchor_sensor_us; // start of the drift baseline
+    uint64_t anchor_read_us;
+} imu_timestamp_t;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+void imu_timestamp_init(imu_timestamp_t *const timestamp, const uint16_t sample_hz);
+void imu_timestamp_update(imu_timestamp_t *const timestamp, const sensor_imu_t *const samples, const uint16_t count,
+                          const uint64_t read_us, float *const periods);
+float imu_timestamp_get_drift_ppm(const imu_timestamp_t *const timestamp);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,337 @@
+/**
+ * @file attitude_codec.h
+ * @brief Single-frame CAN encoding of a unit attitude quaternion, shared by
+ * the firmware encoder and the host decoder.  This header only depends on
+ * the C standard library so the host can include it as is.
+ *
+ * Key frame, 8 bytes:
+ * [0..1] stamp, big endian, incremented once per attitude output
+ * [2..7] 48 bits, most significant first:
+ *        1 bit  0 (key frame)
+ *        2 bits index of the largest component (w, x, y, z), made positive
+ *        3 x 15 bits the other three components in order, two's complement,
+ *        scaled by sqrt(2) * ATTITUDE_CODEC_KEY_SCALE
+ *
+ * Delta frame, 7 bytes:
+ * [0..1] stamp, which must follow the previous frame
+ * [2..6] 40 bits, most significant first:
+ *        1 bit  1 (delta frame)
+ *        3 x 13 bits x, y and z of the rotation from the previous attitude,
+ *        q = previous * delta with delta w positive, two's complement, scaled
+ *        by ATTITUDE_CODEC_DELTA_SCALE
+ *
+ * The decoded attitude is rebuilt from the fields in Q30 integer arithmetic,
+ * and the encoder takes its delta reference from the same code, so encoder
+ * and decoder hold bit-identical references on any platform.
+ */
+
+#ifndef _ATTITUDE_CODEC_H_
+#define _ATTITUDE_CODEC_H_
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief CAN identifier of the attitude stream of a unit.
+ */
+#define ATTITUDE_CODEC_CAN_ID(unit_id) (0x400 | (unit_id))
+
+/**
+ * @brief Frame lengths in bytes.
+ */
+#define ATTITUDE_CODEC_KEY_LENGTH (8)
+#define ATTITUDE_CODEC_DELTA_LENGTH (7)
+
+/**
+ * @brief Field scales.  Key frame components are at most 1/sqrt(2), so about
+ * 4.3e-5 per LSB.  Delta components are sin(angle / 2), so 2^-17 per LSB and
+ * at most 3.6 degrees of rotation between frames.
+ */
+#define ATTITUDE_CODEC_KEY_SCALE (16383)
+#define ATTITUDE_CODEC_DELTA_SCALE (131072)
+#define ATTITUDE_CODEC_DELTA_LIMIT (4095)
+
+/**
+ * @brief Reference attitude shared by the encoder and the decoder.  Start
+ * with valid = false, so the first frame is a key frame.
+ */
+typedef struct
+{
+    int32_t quaternion[4]; // w, x, y, z in Q30
+    uint16_t stamp;
+    bool valid;
+} attitude_codec_state_t;
+
+//------------------------------------------------------------------------------
+// Inline functions - Fixed point helpers
+
+/**
+ * @brief Returns the integer square root, rounded down.
+ */
+static inline uint64_t attitude_codec_sqrt(uint64_t value)
+{
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/**
+ * @brief Returns sqrt(1 - a^2 - b^2 - c^2) in Q30 for Q30 inputs, or zero if
+ * the inputs are outside the unit sphere.
+ */
+static inline int32_t attitude_codec_complete(const int32_t a, const int32_t b, const int32_t c)
+{
+    const int64_t sum = (int64_t)a * a + (int64_t)b * b + (int64_t)c * c;
+    const int64_t one = (int64_t)1 << 60;
+    return (sum >= one) ? 0 : (int32_t)attitude_codec_sqrt((uint64_t)(one - sum));
+}
+
+/**
+ * @brief Sign extends a two's complement field of the given width.
+ */
+static inline int32_t attitude_codec_field(const uint64_t bits, const uint8_t shift, const uint8_t width)
+{
+    const uint32_t field = (uint32_t)(bits >> shift) & ((1u << width) - 1u);
+    return (field & (1u << (width - 1))) ? (int32_t)field - (int32_t)(1u << width) : (int32_t)field;
+}
+
+/**
+ * @brief Rebuilds the reference from the fields of a key frame.
+ */
+static inline void attitude_codec_apply_key(attitude_codec_state_t *const state, const uint8_t largest,
+                                            const int32_t *const fields)
+{
+    // 2^30 / (sqrt(2) * ATTITUDE_CODEC_KEY_SCALE)
+    const int32_t scale = 46345;
+    int32_t others[3];
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        others[i] = fields[i] * scale;
+    }
+    uint8_t field = 0;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        state->quaternion[i] = (i == largest) ? attitude_codec_complete(others[0], others[1], others[2])
+                                              : others[field++];
+    }
+    state->valid = true;
+}
+
+/**
+ * @brief Rotates the reference by the delta of a delta frame and
+ * renormalises it.
+ */
+static inline void attitude_codec_apply_delta(attitude_codec_state_t *const state, const int32_t *const fields)
+{
+    const int64_t dx = (int64_t)fields[0] * (1 << (30 - 17));
+    const int64_t dy = (int64_t)fields[1] * (1 << (30 - 17));
+    const int64_t dz = (int64_t)fields[2] * (1 << (30 - 17));
+    const int64_t dw = attitude_codec_complete((int32_t)dx, (int32_t)dy, (int32_t)dz);
+    const int64_t w = state->quaternion[0];
+    const int64_t x = state->quaternion[1];
+    const int64_t y = state->quaternion[2];
+    const int64_t z = state->quaternion[3];
+    int64_t product[4] = {
+        (w * dw - x * dx - y * dy - z * dz) >> 30,
+        (w * dx + x * dw + y * dz - z * dy) >> 30,
+        (w * dy - x * dz + y * dw + z * dx) >> 30,
+        (w * dz + x * dy - y * dx + z * dw) >> 30,
+    };
+    const uint64_t norm =
+        attitude_codec_sqrt((uint64_t)(product[0] * product[0] + product[1] * product[1] + product[2] * product[2] +
+                                       product[3] * product[3]));
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        state->quaternion[i] = (norm == 0) ? 0 : (int32_t)((product[i] * ((int64_t)1 << 30)) / (int64_t)norm);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Inline functions - Encoder and decoder
+
+/**
+ * @brief Encodes a unit quaternion into a frame and advances the reference.
+ * A delta frame is used if allowed, the reference is valid and the rotation
+ * since the reference fits, otherwise a key frame.
+ * @param state Encoder reference.
+ * @param quaternion Quaternion w, x, y, z.
+ * @param stamp Stamp of this frame.
+ * @param allow_delta False to force a key frame, e.g. periodically so that
+ * receivers can join and recover from lost frames.
+ * @param frame Frame, ATTITUDE_CODEC_KEY_LENGTH bytes.
+ * @return Frame length in bytes.
+ */
+static inline uint8_t attitude_codec_encode(attitude_codec_state_t *const state, const float *const quaternion,
+                                            const uint16_t stamp, const bool allow_delta, uint8_t *const frame)
+{
+    frame[0] = (uint8_t)(stamp >> 8);
+    frame[1] = (uint8_t)(stamp & 0xFF);
+
+    if (allow_delta && state->valid)
+    {
+        // delta = conjugate(reference) * quaternion
+        const float scale = 1.0f / (float)(1 << 30);
+        const float w = (float)state->quaternion[0] * scale;
+        const float x = -(float)state->quaternion[1] * scale;
+        const float y = -(float)state->quaternion[2] * scale;
+        const float z = -(float)state->quaternion[3] * scale;
+        const float *const q = quaternion;
+        const float delta[4] = {
+            w * q[0] - x * q[1] - y * q[2] - z * q[3],
+            w * q[1] + x * q[0] + y * q[3] - z * q[2],
+            w * q[2] - x * q[3] + y * q[0] + z * q[1],
+            w * q[3] + x * q[2] - y * q[1] + z * q[0],
+        };
+        const float sign = (delta[0] < 0.0f) ? -1.0f : 1.0f;
+        int32_t fields[3];
+        bool fits = true;
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            const float value = sign * delta[1 + i] * (float)ATTITUDE_CODEC_DELTA_SCALE;
+            fields[i] = (int32_t)((value < 0.0f) ? (value - 0.5f) : (value + 0.5f));
+            fits = fits && (fields[i] >= -ATTITUDE_CODEC_DELTA_LIMIT) && (fields[i] <= ATTITUDE_CODEC_DELTA_LIMIT);
+        }
+        if (fits)
+        {
+            const uint64_t bits = ((uint64_t)1 << 39) | ((uint64_t)(fields[0] & 0x1FFF) << 26) |
+                                  ((uint64_t)(fields[1] & 0x1FFF) << 13) | (uint64_t)(fields[2] & 0x1FFF);
+            for (uint8_t i = 0; i < 5; i++)
+            {
+                frame[2 + i] = (uint8_t)(bits >> (8 * (4 - i)));
+            }
+            attitude_codec_apply_delta(state, fields);
+            state->stamp = stamp;
+            return ATTITUDE_CODEC_DELTA_LENGTH;
+        }
+    }
+
+    // Smallest three, with the largest component made positive
+    uint8_t largest = 0;
+    for (uint8_t i = 1; i < 4; i++)
+    {
+        const float magnitude = (quaternion[i] < 0.0f) ? -quaternion[i] : quaternion[i];
+        const float largest_magnitude = (quaternion[largest] < 0.0f) ? -quaternion[largest] : quaternion[largest];
+        if (magnitude > largest_magnitude)
+        {
+            largest = i;
+        }
+    }
+    const float scale =
+        ((quaternion[largest] < 0.0f) ? -1.0f : 1.0f) * 1.41421356f * (float)ATTITUDE_CODEC_KEY_SCALE;
+    int32_t fields[3];
+    uint8_t field = 0;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        if (i == largest)
+        {
+            continue;
+        }
+        float value = quaternion[i] * scale;
+        value = (value > (float)ATTITUDE_CODEC_KEY_SCALE) ? (float)ATTITUDE_CODEC_KEY_SCALE : value;
+        value = (value < -(float)ATTITUDE_CODEC_KEY_SCALE) ? -(float)ATTITUDE_CODEC_KEY_SCALE : value;
+        fields[field++] = (int32_t)((value < 0.0f) ? (value - 0.5f) : (value + 0.5f));
+    }
+    const uint64_t bits = ((uint64_t)largest << 45) | ((uint64_t)(fields[0] & 0x7FFF) << 30) |
+                          ((uint64_t)(fields[1] & 0x7FFF) << 15) | (uint64_t)(fields[2] & 0x7FFF);
+    for (uint8_t i = 0; i < 6; i++)
+    {
+        frame[2 + i] = (uint8_t)(bits >> (8 * (5 - i)));
+    }
+    attitude_codec_apply_key(state, largest, fields);
+    state->stamp = stamp;
+    return ATTITUDE_CODEC_KEY_LENGTH;
+}
+
+/**
+ * @brief Decodes a frame into the reference.  A delta frame is only applied
+ * on a valid reference with the previous stamp, otherwise the reference is
+ * invalidated until the next key frame.
+ * @param state Decoder reference.
+ * @param frame Frame.
+ * @param length Frame length in bytes.
+ * @param quaternion Decoded quaternion w, x, y, z.
+ * @param stamp Stamp of the frame.
+ * @return True if quaternion was updated.
+ */
+static inline bool attitude_codec_decode(attitude_codec_state_t *const state, const uint8_t *const frame,
+                                         const uint8_t length, float *const quaternion, uint16_t *const stamp)
+{
+    if (length < 2)
+    {
+        return false;
+    }
+    *stamp = (uint16_t)((frame[0] << 8) | frame[1]);
+
+    if ((length == ATTITUDE_CODEC_KEY_LENGTH) && ((frame[2] & 0x80) == 0))
+    {
+        uint64_t bits = 0;
+        for (uint8_t i = 0; i < 6; i++)
+        {
+            bits = (bits << 8) | frame[2 + i];
+        }
+        const int32_t fields[3] = {
+            attitude_codec_field(bits, 30, 15),
+            attitude_codec_field(bits, 15, 15),
+            attitude_codec_field(bits, 0, 15),
+        };
+        attitude_codec_apply_key(state, (uint8_t)((bits >> 45) & 0x03), fields);
+    }
+    else if ((length == ATTITUDE_CODEC_DELTA_LENGTH) && (frame[2] & 0x80))
+    {
+        if ((state->valid == false) || (*stamp != (uint16_t)(state->stamp + 1)))
+        {
+            state->valid = false;
+            return false;
+        }
+        uint64_t bits = 0;
+        for (uint8_t i = 0; i < 5; i++)
+        {
+            bits = (bits << 8) | frame[2 + i];
+        }
+        const int32_t fields[3] = {
+            attitude_codec_field(bits, 26, 13),
+            attitude_codec_field(bits, 13, 13),
+            attitude_codec_field(bits, 0, 13),
+        };
+        attitude_codec_apply_delta(state, fields);
+    }
+    else
+    {
+        return false;
+    }
+    state->stamp = *stamp;
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        quaternion[i] = (float)state->quaternion[i] * (1.0f / (float)(1 << 30));
+    }
+    return true;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -125,4 +125,120 @@ bool protocol_init(unit_status_t *unit_status)
     // pico_get_unique_board_id(&board_id);
 
     return true;
-}
\ No newline at end of file
+}
+
+#define ATTITUDE_KEY_INTERVAL 10 // 1 disables delta frames
+
+static uint16_t protocol_saturate_u16(float value)
+{
+    if (value <= 0.0f)
+    {
+        return 0;
+    }
+    if (value >= 65535.0f)
+    {
+        return 65535;
+    }
+    return (uint16_t)(value + 0.5f);
+}
+
+static int16_t protocol_saturate_s16(float value)
+{
+    if (value <= -32768.0f)
+    {
+        return -32768;
+    }
+    if (value >= 32767.0f)
+    {
+        return 32767;
+    }
+    return (int16_t)((value < 0.0f) ? (value - 0.5f) : (value + 0.5f));
+}
+
+/**
+ * Publish a vibration spectrum summary as 5 frames:
+ * [0] axis, [1] frame index, [2] 0x04 (Report), [3] 0x0A (Vibration),
+ * [4..5] and [6..7] two big endian uint16 values:
+ * frame 0: peak frequency [0.01 Hz], peak RMS [LSB]
+ * frame 1: total RMS [LSB], band 0 RMS [LSB]
+ * frame 2..4: band 1..5 RMS [LSB]
+ */
+void protocol_send_vibration_summary(unit_status_t *unit_status, const vibration_summary_t *summary)
+{
+    uint16_t values[2 + 1 + VIBRATION_MONITOR_BANDS + 1] = {0};
+    values[0] = protocol_saturate_u16(summary->peak_hz * 100.0f);
+    values[1] = protocol_saturate_u16(summary->peak_rms);
+    values[2] = protocol_saturate_u16(summary->rms);
+    for (uint8_t b = 0; b < VIBRATION_MONITOR_BANDS; b++)
+    {
+        values[3 + b] = protocol_saturate_u16(summary->band_rms[b]);
+    }
+
+    for (uint8_t frame = 0; frame < sizeof(values) / sizeof(values[0]) / 2; frame++)
+    {
+        uint8_t msg[8];
+        msg[0] = summary->axis;
+        msg[1] = frame;
+        msg[2] = 0x04; /* Report */
+        msg[3] = 0x0A; /* Vibration Summary */
+        msg[4] = values[2 * frame] >> 8;
+        msg[5] = values[2 * frame] & 0xFF;
+        msg[6] = values[2 * frame + 1] >> 8;
+        msg[7] = values[2 * frame + 1] & 0xFF;
+        mcp2515_send(unit_status->unit_id, msg, 8);
+    }
+}
+
+/**
+ * Publish a preintegrated IMU increment as 4 frames:
+ * [0] sequence, [1] frame index, [2] 0x04 (Report), [3] 0x0B (IMU Increment),
+ * [4..5] and [6..7] two big endian int16 values:
+ * frame 0: delta angle x, y [2^-15 rad]
+ * frame 1: delta angle z [2^-15 rad], delta velocity x [2^-13 m/s]
+ * frame 2: delta velocity y, z [2^-13 m/s]
+ * frame 3: duration [us], samples
+ * Delta angles and velocities are in the sensor frame at the start of the interval.
+ */
+void protocol_send_imu_increment(unit_status_t *unit_status, const imu_increment_t *increment)
+{
+    static uint8_t sequence = 0;
+    int16_t values[8];
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        values[i] = protocol_saturate_s16(increment->delta_angle.array[i] * 32768.0f);
+        values[3 + i] = protocol_saturate_s16(increment->delta_velocity.array[i] * 8192.0f);
+    }
+    values[6] = (int16_t)protocol_saturate_u16(increment->duration * 1000000.0f);
+    values[7] = (int16_t)protocol_saturate_u16((float)increment->samples);
+
+    for (uint8_t frame = 0; frame < sizeof(values) / sizeof(values[0]) / 2; frame++)
+    {
+        uint8_t msg[8];
+        msg[0] = sequence;
+        msg[1] = frame;
+        msg[2] = 0x04; /* Report */
+        msg[3] = 0x0B; /* IMU Increment */
+        msg[4] = (uint16_t)values[2 * frame] >> 8;
+        msg[5] = (uint16_t)values[2 * frame] & 0xFF;
+        msg[6] = (uint16_t)values[2 * frame + 1] >> 8;
+        msg[7] = (uint16_t)values[2 * frame + 1] & 0xFF;
+        mcp2515_send(unit_status->unit_id, msg, 8);
+    }
+    sequence++;
+}
+
+/**
+ * Publish the attitude as one frame on ATTITUDE_CODEC_CAN_ID(unit_id), see attitude_codec.h.
+ * Every ATTITUDE_KEY_INTERVAL frames is a key frame so receivers can join or recover
+ * from a lost frame; the others are delta frames when the rotation fits.
+ */
+void protocol_send_attitude(unit_status_t *unit_status, const FusionQuaternion quaternion)
+{
+    static attitude_codec_state_t state = {.valid = false};
+    static uint16_t stamp = 0;
+    uint8_t msg[ATTITUDE_CODEC_KEY_LENGTH];
+    const uint8_t length =
+        attitude_codec_encode(&state, quaternion.array, stamp, (stamp % ATTITUDE_KEY_INTERVAL) != 0, msg);
+    mcp2515_send(ATTITUDE_CODEC_CAN_ID(unit_status->unit_id), msg, length);
+    stamp++;
+}
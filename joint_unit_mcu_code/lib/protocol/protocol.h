@@ -6,15 +6,21 @@
 #include "pico/stdlib.h"
 #include "robot_config.h"
 
+#include "attitude_codec.h"
 #include "dev_config.h"
 #include "dynamixel.h"
 #include "icm42688.h"
+#include "imu_preintegration.h"
 #include "mcp2515.h"
+#include "vibration_monitor.h"
 
 #define HEAD_UNIT_ID 1
 #define TAIL_UNIT_ID 2
 
 bool protocol_init(unit_status_t *unit_status);
 bool protocol_update(unit_status_t *unit_status);
+void protocol_send_vibration_summary(unit_status_t *unit_status, const vibration_summary_t *summary);
+void protocol_send_imu_increment(unit_status_t *unit_status, const imu_increment_t *increment);
+void protocol_send_attitude(unit_status_t *unit_status, const FusionQuaternion quaternion);
 
 #endif
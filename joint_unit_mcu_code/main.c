@@ -6,14 +6,26 @@
 #include "controller.h"
 #include "dynamixel.h"
 #include "fusion.h"
+#include "fusion_offset_flash.h"
+#include "hardware/sync.h"
 #include "icm42688.h"
+#include "imu_pipeline.h"
 #include "protocol.h"
+#include "vibration_monitor.h"
 
 #define LED_SAMPLE_HZ 3
 #define CAN_SAMPLE_HZ 99
 #define CTRL_SAMPLE_HZ 51
 #define IMU_SAMPLE_HZ 200
 #define IMU_PERIOD_SECOND 1.0f / (float)IMU_SAMPLE_HZ
+#define IMU_GYRO_COUNT_TO_Q16 500 // 250 dps / 32768 in Q16
+#define IMU_ACCEL_COUNT_TO_Q16 4  // 2 g / 32768 in Q16
+
+// The IMU is off at boot, as the controller and CAN timers are; 1 (or -DIMU_ENABLE=1) initialises the ICM-42688,
+// applies the filter profile, sets up the attitude pipeline and starts the IMU timer together
+#ifndef IMU_ENABLE
+#define IMU_ENABLE 0
+#endif
 
 unit_status_t unit_status = {
     .head = 0,
@@ -24,9 +36,65 @@ unit_status_t unit_status = {
     .dynamixel_enable[DXL_2] = false,
 };
 
-fusion_ahrs_t ahrs;
+#ifdef FUSION_USE_FIXED_POINT
+fusion_ahrs_q_t ahrs;
+#else
+// Sample, fusion and output rates; trade CPU for accuracy per deployment here
+imu_pipeline_rates_t imu_rates = {
+    .sample_hz = 1000,
+    .fusion_hz = 200,
+    .output_hz = 100,
+};
 
-const FusionVector gyro_offset = {0.0f, 0.0f, 0.0f};
+// On-chip anti-aliasing and UI filter, which lets the driver bypass the MCU low-pass; odr_hz comes from imu_rates
+icm_filter_profile_t imu_filter_profile = {
+    .aaf_hz = 348,
+    .ui_filter_order = 2,
+    .ui_filter_bw = ICM_UI_FILTER_BW_ODR_4,
+};
+imu_pipeline_t imu_pipeline;
+imu_pipeline_output_t imu_output;
+volatile bool imu_output_ready = false;
+
+// Accelerometer decimation, and for the AHRS the sample rate and period, come from imu_rates
+#ifdef FUSION_USE_EKF
+const fusion_ekf_settings_t attitude_settings = {
+    .convention = FusionConventionNwu,
+    .gyroscopeNoise = 0.0028f, // ICM-42688 datasheet
+    .gyroscopeBiasStability = 0.002f,
+    .accelerometerNoise = 0.05f, // covers residual vibration after the notch
+    .accelerationRejection = 0.1f,
+    .innovationRejection = 11.3f, // 99 % for three degrees of freedom
+    .initialBiasUncertainty = 1.0f,
+};
+#else
+const FusionAhrsSettings attitude_settings = {
+    .convention = FusionConventionNwu,
+    .gain = 0.5f,
+    .gyroscopeRange = 250.0f,
+    .accelerationRejection = 90.0f,
+    .magneticRejection = 90.0f,
+    .recoveryTriggerPeriod = 0,
+};
+#endif
+#endif
+
+// Accelerometer notch following motor and servo vibration, run at the sample rate
+const adaptive_notch_settings_t accel_notch_settings = {
+    .min_hz = 20.0f,
+    .max_hz = 400.0f,
+    .q = 3.0f,
+    .hint_span_hz = 30.0f,
+    .min_amplitude = 100.0f, // [LSB], about 6 mg
+    .harmonic = true,
+};
+
+// Spectrum of the accelerometer decimated to 500 Hz, one axis per 512-point FFT
+vibration_monitor_t vibration_monitor;
+vibration_monitor_settings_t vibration_monitor_settings = {
+    .decimation = 2,
+    .band_edges_hz = {2.0f, 10.0f, 25.0f, 50.0f, 100.0f, 175.0f, 250.0f},
+};
 
 bool led_timer_callback(struct repeating_timer *t)
 {
@@ -59,30 +127,121 @@ bool ctrl_timer_callback(struct repeating_timer *t)
 
 bool imu_timer_callback(struct repeating_timer *t)
 {
+#ifdef FUSION_USE_FIXED_POINT
     // Read imu data
     icm_read_sensor(&unit_status.imu_raw_data);
     icm_filter_sensor_data(&unit_status.imu_raw_data, &unit_status.imu_filter);
-    icm_filtered_int_to_float(&unit_status.imu_filter, &unit_status.imu_filtered_data);
 
-    // Convert data type
-    FusionVector gyroscope = {.axis = {
-                                  .x = unit_status.imu_filtered_data.gyro[0],
-                                  .y = unit_status.imu_filtered_data.gyro[1],
-                                  .z = unit_status.imu_filtered_data.gyro[2],
-                              }};
-    FusionVector accelerometer = {.axis = {
-                                      .x = unit_status.imu_filtered_data.accel[0],
-                                      .y = unit_status.imu_filtered_data.accel[1],
-                                      .z = unit_status.imu_filtered_data.accel[2],
-                                  }};
+    // Convert filtered counts to Q16 without going through float
+    fusion_vector_q_t gyroscope;
+    fusion_vector_q_t accelerometer;
+    for (int8_t i = 0; i < 3; i++)
+    {
+        gyroscope.array[i] = filter_bank_output(&unit_status.imu_filter, IMU_FILTER_GYRO_X + i) * IMU_GYRO_COUNT_TO_Q16;
+        accelerometer.array[i] =
+            filter_bank_output(&unit_status.imu_filter, IMU_FILTER_ACCEL_X + i) * IMU_ACCEL_COUNT_TO_Q16;
+    }
 
     // Sensor fusion
-    gyroscope = fusion_offset_update(&ahrs.offset, gyroscope);
-    fusion_ahrs_update_no_magnetometer(&ahrs, gyroscope, accelerometer, IMU_PERIOD_SECOND);
+    fusion_ahrs_q_update_no_magnetometer(&ahrs, gyroscope, accelerometer, FUSION_DELTA_TIME_Q30(IMU_SAMPLE_HZ));
+#else
+    // Narrow the notch search around the vibration expected from the motor command
+    int16_t motor_command = 0;
+    for (int8_t i = 0; i < 2; i++)
+    {
+        const int16_t command = (int8_t)unit_status.cmd_motor[i];
+        const int16_t magnitude = (command < 0) ? -command : command;
+        if (magnitude > motor_command)
+        {
+            motor_command = magnitude;
+        }
+    }
+    imu_pipeline_set_motor_hint(&imu_pipeline, (float)motor_command * MOTOR_VIBRATION_HZ_PER_COMMAND);
+
+    // Drain the FIFO, so the tick rate only sets the latency and not the sample rate
+    sensor_imu_t imu_burst[ICM_FIFO_BURST_MAX];
+    uint16_t count;
+    do
+    {
+        count = icm_read_fifo_burst(imu_burst, ICM_FIFO_BURST_MAX);
+        if (count == 0)
+        {
+            break;
+        }
+        const uint64_t read_us = time_us_64();
+
+        for (uint16_t n = 0; n < count; n++)
+        {
+            const int32_t accelerometer_counts[3] = {
+                imu_burst[n].accel[0].data,
+                imu_burst[n].accel[1].data,
+                imu_burst[n].accel[2].data,
+            };
+            vibration_monitor_add_sample(&vibration_monitor, accelerometer_counts);
+        }
+
+        // Integrate at the sample rate, fuse at the fusion rate, decimate to the output rate
+        if (imu_pipeline_update(&imu_pipeline, imu_burst, count, read_us))
+        {
+            imu_output = *imu_pipeline_get_output(&imu_pipeline);
+            imu_output_ready = true;
+        }
+
+        // The newest sample feeds the low-pass copy used by the rest of the application
+        unit_status.imu_raw_data = imu_burst[count - 1];
+    } while (count == ICM_FIFO_BURST_MAX);
+
+    icm_filter_sensor_data(&unit_status.imu_raw_data, &unit_status.imu_filter);
+    icm_filtered_int_to_float(&unit_status.imu_filter, &unit_status.imu_filtered_data);
+#endif
 
     return true;
 }
 
+#if DEBUG && IMU_ENABLE && !defined(FUSION_USE_FIXED_POINT)
+// Time the attitude engine alone on one feedback step of synthetic samples, against the fusion_hz budget
+static void attitude_benchmark(void)
+{
+    const unsigned int decimation = imu_rates.sample_hz / imu_rates.fusion_hz;
+    const float sample_period = 1.0f / (float)imu_rates.sample_hz;
+    FusionVector gyroscope[ICM_FIFO_BURST_MAX];
+    FusionVector accelerometer[ICM_FIFO_BURST_MAX];
+    for (unsigned int n = 0; n < decimation; n++)
+    {
+        gyroscope[n] = (FusionVector){.axis = {.x = 3.0f, .y = -2.0f, .z = 1.0f}};
+        accelerometer[n] = (FusionVector){.axis = {.x = 0.05f, .y = -0.03f, .z = 0.99f}};
+    }
+#ifdef FUSION_USE_EKF
+    fusion_ekf_t engine;
+    fusion_ekf_settings_t settings = attitude_settings;
+    settings.accelerometerDecimation = decimation;
+    fusion_ekf_init(&engine, &settings);
+#else
+    fusion_ahrs_t engine;
+    FusionAhrsSettings settings = attitude_settings;
+    settings.sample_rate = imu_rates.sample_hz;
+    settings.sample_period = sample_period;
+    settings.accelerometerDecimation = decimation;
+    fusion_ahrs_init(&engine, imu_rates.sample_hz);
+    fusionAhrs_set_settings(&engine, &settings);
+#endif
+
+    const uint32_t steps = 1000;
+    const uint64_t start = time_us_64();
+    for (uint32_t step = 0; step < steps; step++)
+    {
+#ifdef FUSION_USE_EKF
+        fusion_ekf_update_batch_no_magnetometer(&engine, gyroscope, accelerometer, decimation, sample_period);
+#else
+        fusion_ahrs_update_batch_no_magnetometer(&engine, gyroscope, accelerometer, decimation, sample_period);
+#endif
+    }
+    const uint32_t step_us = (uint32_t)((time_us_64() - start) / steps);
+    Debug("attitude engine: %lu us per feedback step, %lu %% of %u Hz\r\n", (unsigned long)step_us,
+          (unsigned long)(step_us * imu_rates.fusion_hz / 10000), imu_rates.fusion_hz);
+}
+#endif
+
 void uart2can_receive_irq(void)
 {
     while (uart_is_readable(UART_CAN_PORT))
@@ -106,14 +265,44 @@ int main(void)
     // Wait external device to startup
     dev_delay_ms(200);
     dev_module_init(uart2can_receive_irq);
-    // dev_delay_ms(10);
-    // icm42688_init(&unit_status.imu_filter);
+#if IMU_ENABLE
+    dev_delay_ms(10);
+    icm42688_init(&unit_status.imu_filter);
+#endif
 
     protocol_init(&unit_status);
     dev_delay_ms(5);
     // controller_init(&unit_status);
     // dev_delay_ms(5);
-    // fusion_ahrs_init(&ahrs, IMU_SAMPLE_HZ);
+#if IMU_ENABLE
+#ifdef FUSION_USE_FIXED_POINT
+    fusion_ahrs_q_init(&ahrs, IMU_SAMPLE_HZ);
+#else
+    imu_filter_profile.odr_hz = imu_rates.sample_hz;
+    if (!icm_set_filter_profile(&imu_filter_profile))
+    {
+        icm_set_odr(imu_rates.sample_hz);
+    }
+    imu_pipeline_init(&imu_pipeline, &imu_rates, &attitude_settings, &accel_notch_settings);
+    const FusionMatrix gyro_misalignment = IMU_GYRO_MISALIGNMENT;
+    const FusionVector gyro_sensitivity = IMU_GYRO_SENSITIVITY;
+    const FusionVector gyro_offset = IMU_GYRO_OFFSET;
+    const FusionMatrix accel_misalignment = IMU_ACCEL_MISALIGNMENT;
+    const FusionVector accel_sensitivity = IMU_ACCEL_SENSITIVITY;
+    const FusionVector accel_offset = IMU_ACCEL_OFFSET;
+    const fusion_calibration_inertial_t gyro_calibration =
+        fusion_calibration_inertial_init(gyro_misalignment, gyro_sensitivity, gyro_offset, IMU_AXES_ALIGNMENT);
+    const fusion_calibration_inertial_t accel_calibration =
+        fusion_calibration_inertial_init(accel_misalignment, accel_sensitivity, accel_offset, IMU_AXES_ALIGNMENT);
+    imu_pipeline_set_calibration(&imu_pipeline, &gyro_calibration, &accel_calibration);
+    fusion_offset_flash_load(imu_pipeline_get_offset(&imu_pipeline));
+    vibration_monitor_settings.sample_hz = imu_rates.sample_hz;
+    vibration_monitor_init(&vibration_monitor, &vibration_monitor_settings);
+#if DEBUG
+    attitude_benchmark();
+#endif
+#endif
+#endif
     // dev_delay_ms(5);
 
     // Use 199 and 9 for avoiding triggering interrupt at the same time
@@ -123,11 +312,41 @@ int main(void)
     // add_repeating_timer_ms(-1000 / CAN_SAMPLE_HZ, can_timer_callback, NULL, &can_timer);
     // struct repeating_timer ctrl_timer;
     // add_repeating_timer_ms(-1000 / CTRL_SAMPLE_HZ, ctrl_timer_callback, NULL, &ctrl_timer);
-    // struct repeating_timer imu_timer;
-    // add_repeating_timer_ms(-1000 / IMU_SAMPLE_HZ, imu_timer_callback, NULL, &imu_timer);
+#if IMU_ENABLE
+    struct repeating_timer imu_timer;
+#ifdef FUSION_USE_FIXED_POINT
+    add_repeating_timer_ms(-1000 / IMU_SAMPLE_HZ, imu_timer_callback, NULL, &imu_timer);
+#else
+    add_repeating_timer_us(-1000000 / imu_rates.fusion_hz, imu_timer_callback, NULL, &imu_timer);
+#endif
+#endif
 
     while (1)
+    {
+#if IMU_ENABLE && !defined(FUSION_USE_FIXED_POINT)
+        // Flash writes disable interrupts, so persist the gyroscope offset model here
+        fusion_offset_flash_update(imu_pipeline_get_offset(&imu_pipeline));
+
+        // Preintegrated increments go out at the output rate, so the host sees no aliasing of the rates
+        if (imu_output_ready)
+        {
+            const uint32_t interrupts = save_and_disable_interrupts();
+            const imu_increment_t increment = imu_pipeline_take_increment(&imu_pipeline);
+            const FusionQuaternion quaternion = imu_output.quaternion;
+            imu_output_ready = false;
+            restore_interrupts(interrupts);
+            protocol_send_imu_increment(&unit_status, &increment);
+            protocol_send_attitude(&unit_status, quaternion);
+        }
+
+        // Condition monitoring runs in idle time and publishes about once a second per axis
+        if (vibration_monitor_process(&vibration_monitor))
+        {
+            protocol_send_vibration_summary(&unit_status, vibration_monitor_get_summary(&vibration_monitor));
+        }
+#endif
         tight_loop_contents();
+    }
 
     return 0;
 }
@@ -4,7 +4,7 @@
 #include "pico/stdlib.h"
 
 #include "common_utils.h"
-#include "first_order_filter.h"
+#include "filter_bank.h"
 
 #include "icm42688.h"
 
@@ -0,0 +1,222 @@
+/**
+ * @file ahrs_q_compare.c
+ * @brief Host tool that runs fusion_ahrs_t and the fixed-point fusion_ahrs_q_t
+ * on the same synthetic trajectory, with the settings and rate used by main.c,
+ * and reports the tilt error of both against the true attitude and the time
+ * per update.
+ *
+ * The trajectory rotates about all three axes with rates up to 60 dps; the
+ * gyroscope sees a constant bias and white noise, the accelerometer gravity
+ * plus white noise.  Both engines get identical inputs, the fixed-point build
+ * converted to Q16 once per sample as main.c does.
+ *
+ * Build and run from joint_unit_mcu_code:
+ *     gcc -std=gnu11 -O2 -Ilib/common -Ilib/imu -o ahrs_q_compare tools/ahrs_q_compare.c \
+ *         lib/imu/FusionAhrs.c lib/imu/fusion_ahrs_q.c lib/imu/fusion_offset.c lib/common/sin_table.c -lm
+ *     ./ahrs_q_compare [seconds] [bias_dps]
+ *
+ * Host timings only rank the two builds; on the RP2040 the float build runs
+ * soft-float routines, so the fixed-point advantage is larger there.
+ *
+ * The two builds have only been compared on this synthetic trajectory, not
+ * on a recorded capture, and their cycle counts have not been measured on
+ * the RP2040; the tool has no input for recorded data.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "FusionAhrs.h"
+#include "fusion_ahrs_q.h"
+
+#define SAMPLE_HZ (200) // IMU_SAMPLE_HZ in main.c
+#define GYRO_NOISE_DPS (0.05)
+#define ACCEL_NOISE_G (0.005)
+
+static volatile float sink;
+
+static double seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + 1e-9 * (double)now.tv_nsec;
+}
+
+// Zero mean, unit variance pseudo-random noise (sum of uniforms)
+static double noise(uint32_t *const seed)
+{
+    double sum = 0.0;
+    for (int i = 0; i < 12; i++)
+    {
+        *seed = *seed * 1664525u + 1013904223u;
+        sum += (double)(*seed >> 8) * (1.0 / 16777216.0);
+    }
+    return sum - 6.0;
+}
+
+// Earth Z axis in the body frame, the direction the accelerometer sees at rest
+static void gravity(const double q[4], double g[3])
+{
+    g[0] = 2.0 * (q[1] * q[3] - q[0] * q[2]);
+    g[1] = 2.0 * (q[2] * q[3] + q[0] * q[1]);
+    g[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+}
+
+// Angle between the estimated and the true gravity direction in degrees
+static double tilt_error(const FusionQuaternion estimate, const double truth[4])
+{
+    const double q[4] = {estimate.element.w, estimate.element.x, estimate.element.y, estimate.element.z};
+    double a[3];
+    double b[3];
+    gravity(q, a);
+    gravity(truth, b);
+    double dot = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) /
+                 sqrt((a[0] * a[0] + a[1] * a[1] + a[2] * a[2]) * (b[0] * b[0] + b[1] * b[1] + b[2] * b[2]));
+    dot = dot > 1.0 ? 1.0 : (dot < -1.0 ? -1.0 : dot);
+    return acos(dot) * 180.0 / M_PI;
+}
+
+int main(int argc, char *argv[])
+{
+    const double duration = (argc > 1) ? atof(argv[1]) : 600.0;
+    const double bias = (argc > 2) ? atof(argv[2]) : 0.3;
+    if (duration <= 0.0)
+    {
+        fprintf(stderr, "usage: %s [seconds] [bias_dps]\n", argv[0]);
+        return 1;
+    }
+    const float samplePeriod = 1.0f / (float)SAMPLE_HZ;
+    const unsigned long samples = (unsigned long)(duration * SAMPLE_HZ);
+
+    const FusionAhrsSettings settings = {
+        .convention = FusionConventionNwu,
+        .sample_rate = SAMPLE_HZ,
+        .sample_period = samplePeriod,
+        .gain = 0.5f,
+        .gyroscopeRange = 250.0f,
+        .accelerationRejection = 90.0f,
+        .magneticRejection = 90.0f,
+        .recoveryTriggerPeriod = 0,
+        .accelerometerDecimation = 1,
+    };
+    fusion_ahrs_t ahrs;
+    fusion_ahrs_init(&ahrs, SAMPLE_HZ);
+    fusionAhrs_set_settings(&ahrs, &settings);
+    fusion_ahrs_q_t ahrsQ;
+    fusion_ahrs_q_init(&ahrsQ, SAMPLE_HZ);
+    fusion_ahrs_q_set_settings(&ahrsQ, &settings);
+
+    // Generate the inputs first so the timed loops only run the engines
+    FusionVector *const gyroscope = malloc(samples * sizeof(FusionVector));
+    FusionVector *const accelerometer = malloc(samples * sizeof(FusionVector));
+    double(*const truth)[4] = malloc(samples * sizeof(*truth));
+    if ((gyroscope == NULL) || (accelerometer == NULL) || (truth == NULL))
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    double q[4] = {1.0, 0.0, 0.0, 0.0};
+    uint32_t seed = 1;
+    for (unsigned long n = 0; n < samples; n++)
+    {
+        const double t = (double)n / SAMPLE_HZ;
+        const double rate[3] = {60.0 * sin(2.0 * M_PI * 0.11 * t), 45.0 * sin(2.0 * M_PI * 0.07 * t + 1.0),
+                                30.0 * sin(2.0 * M_PI * 0.05 * t + 2.0)};
+
+        // Integrate the true attitude over the sample with small sub-steps
+        for (int step = 0; step < 10; step++)
+        {
+            const double h = 0.5 * (M_PI / 180.0) / (10.0 * SAMPLE_HZ);
+            const double w = rate[0] * h, x = rate[1] * h, y = rate[2] * h;
+            const double next[4] = {
+                q[0] - q[1] * w - q[2] * x - q[3] * y,
+                q[1] + q[0] * w + q[2] * y - q[3] * x,
+                q[2] + q[0] * x - q[1] * y + q[3] * w,
+                q[3] + q[0] * y + q[1] * x - q[2] * w,
+            };
+            const double norm = sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+            for (int i = 0; i < 4; i++)
+            {
+                q[i] = next[i] / norm;
+            }
+        }
+        for (int i = 0; i < 4; i++)
+        {
+            truth[n][i] = q[i];
+        }
+        double g[3];
+        gravity(q, g);
+        for (int i = 0; i < 3; i++)
+        {
+            gyroscope[n].array[i] = (float)(rate[i] + bias + GYRO_NOISE_DPS * noise(&seed));
+            accelerometer[n].array[i] = (float)(g[i] + ACCEL_NOISE_G * noise(&seed));
+        }
+    }
+
+    double sum[2] = {0.0, 0.0};
+    double maximum[2] = {0.0, 0.0};
+    double elapsed[2] = {0.0, 0.0};
+    const unsigned long settle = 10 * SAMPLE_HZ; // skip the initialisation ramp
+    for (unsigned long n = 0; n < samples; n++)
+    {
+        fusion_ahrs_update_no_magnetometer(&ahrs, gyroscope[n], accelerometer[n], samplePeriod);
+        if (n >= settle)
+        {
+            const double error = tilt_error(FusionAhrsGetQuaternion(&ahrs), truth[n]);
+            sum[0] += error;
+            maximum[0] = error > maximum[0] ? error : maximum[0];
+        }
+    }
+    for (unsigned long n = 0; n < samples; n++)
+    {
+        fusion_vector_q_t gyroscopeQ;
+        fusion_vector_q_t accelerometerQ;
+        for (int i = 0; i < 3; i++)
+        {
+            gyroscopeQ.array[i] = FUSION_FLOAT_TO_Q16(gyroscope[n].array[i]);
+            accelerometerQ.array[i] = FUSION_FLOAT_TO_Q16(accelerometer[n].array[i]);
+        }
+        fusion_ahrs_q_update_no_magnetometer(&ahrsQ, gyroscopeQ, accelerometerQ, FUSION_DELTA_TIME_Q30(SAMPLE_HZ));
+        if (n >= settle)
+        {
+            const double error = tilt_error(fusion_ahrs_q_get_quaternion(&ahrsQ), truth[n]);
+            sum[1] += error;
+            maximum[1] = error > maximum[1] ? error : maximum[1];
+        }
+    }
+
+    // Time the engines alone over the same inputs, from reset
+    fusion_ahrs_reset(&ahrs);
+    double start = seconds();
+    for (unsigned long n = 0; n < samples; n++)
+    {
+        fusion_ahrs_update_no_magnetometer(&ahrs, gyroscope[n], accelerometer[n], samplePeriod);
+    }
+    elapsed[0] = seconds() - start;
+    fusion_ahrs_q_reset(&ahrsQ);
+    start = seconds();
+    for (unsigned long n = 0; n < samples; n++)
+    {
+        fusion_vector_q_t gyroscopeQ;
+        fusion_vector_q_t accelerometerQ;
+        for (int i = 0; i < 3; i++)
+        {
+            gyroscopeQ.array[i] = FUSION_FLOAT_TO_Q16(gyroscope[n].array[i]);
+            accelerometerQ.array[i] = FUSION_FLOAT_TO_Q16(accelerometer[n].array[i]);
+        }
+        fusion_ahrs_q_update_no_magnetometer(&ahrsQ, gyroscopeQ, accelerometerQ, FUSION_DELTA_TIME_Q30(SAMPLE_HZ));
+    }
+    elapsed[1] = seconds() - start;
+    sink = FusionAhrsGetQuaternion(&ahrs).element.w + fusion_ahrs_q_get_quaternion(&ahrsQ).element.w;
+
+    const double scored = (samples > settle) ? (double)(samples - settle) : 1.0;
+    printf("%lu samples at %d Hz, gyroscope bias %.2f dps\n", samples, SAMPLE_HZ, bias);
+    printf("%-12s %14s %14s %10s\n", "engine", "mean tilt deg", "max tilt deg", "ns/update");
+    printf("%-12s %14.4f %14.4f %10.1f\n", "float", sum[0] / scored, maximum[0], 1e9 * elapsed[0] / samples);
+    printf("%-12s %14.4f %14.4f %10.1f\n", "fixed point", sum[1] / scored, maximum[1], 1e9 * elapsed[1] / samples);
+    free(gyroscope);
+    free(accelerometer);
+    free(truth);
+    return 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file attitude_compare.c
+ * @brief Host tool that runs fusion_ahrs_t and fusion_ekf_t over the same
+ * recorded IMU data, with the settings used by main.c, and prints both
+ * attitudes and the EKF bias and uncertainty.
+ *
+ * Input: CSV with a header row and columns
+ *     time,gx,gy,gz,ax,ay,az
+ * with time in seconds, the calibrated gyroscope in degrees per second and the
+ * accelerometer in g, one row per FIFO sample.  Each sample is integrated
+ * over the time since the previous row; the first two rows also set the
+ * nominal rate the engines are initialised with.
+ *
+ * Output: one CSV row per accelerometer feedback step on stdout, and the RMS
+ * roll and pitch difference between the two engines and the final EKF bias on
+ * stderr.
+ *
+ * Build and run from joint_unit_mcu_code:
+ *     gcc -std=gnu11 -O2 -Ilib/common -Ilib/imu -o attitude_compare tools/attitude_compare.c \
+ *         lib/imu/FusionAhrs.c lib/imu/fusion_offset.c lib/imu/fusion_ekf.c lib/common/sin_table.c -lm
+ *     ./attitude_compare capture.csv [decimation] > attitude.csv
+ *
+ * Only synthetic captures have been run through this tool so far; no FIFO
+ * recording from the sensor has been compared yet.  The EKF cost per
+ * feedback step has not been measured on the RP2040 either: the ~0.6 ms
+ * figure quoted with the EKF is an estimate from its operation count, and
+ * attitude_benchmark() in main.c (DEBUG builds) is the measurement to run.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "FusionAhrs.h"
+#include "fusion_ekf.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s capture.csv [decimation]\n", argv[0]);
+        return 1;
+    }
+    FILE *file = fopen(argv[1], "r");
+    if (file == NULL)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    const long decimation = (argc > 2) ? strtol(argv[2], NULL, 10) : 5;
+    if (decimation < 1)
+    {
+        fprintf(stderr, "decimation must be at least 1\n");
+        return 1;
+    }
+
+    // Skip the header, then use the first two rows for the nominal sample period
+    char line[256];
+    if (fgets(line, sizeof(line), file) == NULL)
+    {
+        return 1;
+    }
+    const long start = ftell(file);
+    double time[2] = {0.0, 0.0};
+    for (int i = 0; i < 2; i++)
+    {
+        if ((fgets(line, sizeof(line), file) == NULL) || (sscanf(line, "%lf", &time[i]) != 1))
+        {
+            fprintf(stderr, "need at least two samples\n");
+            return 1;
+        }
+    }
+    fseek(file, start, SEEK_SET);
+    const float samplePeriod = (float)(time[1] - time[0]);
+    const uint16_t sampleRate = (uint16_t)lroundf(1.0f / samplePeriod);
+
+    fusion_ahrs_t ahrs;
+    fusion_ahrs_init(&ahrs, sampleRate);
+    const FusionAhrsSettings ahrsSettings = {
+        .convention = FusionConventionNwu,
+        .sample_rate = sampleRate,
+        .sample_period = samplePeriod,
+        .gain = 0.5f,
+        .gyroscopeRange = 250.0f,
+        .accelerationRejection = 90.0f,
+        .magneticRejection = 90.0f,
+        .recoveryTriggerPeriod = 0,
+        .accelerometerDecimation = (unsigned int)decimation,
+    };
+    fusionAhrs_set_settings(&ahrs, &ahrsSettings);
+
+    fusion_ekf_t ekf;
+    const fusion_ekf_settings_t ekfSettings = {
+        .convention = FusionConventionNwu,
+        .gyroscopeNoise = 0.0028f,
+        .gyroscopeBiasStability = 0.002f,
+        .accelerometerNoise = 0.05f,
+        .accelerationRejection = 0.1f,
+        .innovationRejection = 11.3f,
+        .initialBiasUncertainty = 1.0f,
+        .accelerometerDecimation = (unsigned int)decimation,
+    };
+    fusion_ekf_init(&ekf, &ekfSettings);
+
+    printf("time,ahrs_roll,ahrs_pitch,ahrs_yaw,ekf_roll,ekf_pitch,ekf_yaw,"
+           "bias_x,bias_y,bias_z,sigma_roll,sigma_pitch,sigma_yaw,sigma_bias_x,sigma_bias_y,sigma_bias_z\n");
+    double sumSquares = 0.0;
+    unsigned long steps = 0;
+    unsigned long samples = 0;
+    double t;
+    double previousTime = time[0] - samplePeriod;
+    FusionVector gyroscope;
+    FusionVector accelerometer;
+    while ((fgets(line, sizeof(line), file) != NULL) &&
+           (sscanf(line, "%lf,%f,%f,%f,%f,%f,%f", &t, &gyroscope.axis.x, &gyroscope.axis.y, &gyroscope.axis.z,
+                   &accelerometer.axis.x, &accelerometer.axis.y, &accelerometer.axis.z) == 7))
+    {
+        // Use the recorded interval; a repeated or backwards timestamp falls back to the nominal period
+        const float deltaTime = (t > previousTime) ? (float)(t - previousTime) : samplePeriod;
+        previousTime = t;
+        fusion_ahrs_update_batch_no_magnetometer(&ahrs, &gyroscope, &accelerometer, 1, deltaTime);
+        fusion_ekf_update_batch_no_magnetometer(&ekf, &gyroscope, &accelerometer, 1, deltaTime);
+        if (++samples % decimation != 0)
+        {
+            continue;
+        }
+
+        const FusionEuler ahrsEuler = FusionQuaternionToEuler(FusionAhrsGetQuaternion(&ahrs));
+        const FusionEuler ekfEuler = FusionQuaternionToEuler(fusion_ekf_get_quaternion(&ekf));
+        const FusionVector bias = fusion_ekf_get_gyroscope_bias(&ekf);
+        float covariance[FUSION_EKF_STATES][FUSION_EKF_STATES];
+        fusion_ekf_get_covariance(&ekf, covariance);
+        printf("%.4f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.4f,%.4f,%.4f", t, ahrsEuler.angle.roll, ahrsEuler.angle.pitch,
+               ahrsEuler.angle.yaw, ekfEuler.angle.roll, ekfEuler.angle.pitch, ekfEuler.angle.yaw, bias.axis.x,
+               bias.axis.y, bias.axis.z);
+        for (int i = 0; i < FUSION_EKF_STATES; i++)
+        {
+            printf(",%.4f", FusionRadiansToDegrees(sqrtf(covariance[i][i])));
+        }
+        printf("\n");
+
+        const double roll = ahrsEuler.angle.roll - ekfEuler.angle.roll;
+        const double pitch = ahrsEuler.angle.pitch - ekfEuler.angle.pitch;
+        sumSquares += roll * roll + pitch * pitch;
+        steps++;
+    }
+    fclose(file);
+
+    const FusionVector bias = fusion_ekf_get_gyroscope_bias(&ekf);
+    fprintf(stderr, "%lu samples at %u Hz, feedback every %ld\n", samples, sampleRate, decimation);
+    fprintf(stderr, "RMS roll/pitch difference: %.3f deg\n", (steps > 0) ? sqrt(sumSquares / (2.0 * steps)) : 0.0);
+    fprintf(stderr, "EKF gyroscope bias: %.4f %.4f %.4f deg/s\n", bias.axis.x, bias.axis.y, bias.axis.z);
+    return 0;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file filter_bank_report.c
+ * @brief Host frequency-response and timing report for filter_bank.c.  Each
+ * case drives a sine through the Q28 bank, measures the steady-state gain by
+ * correlating the output over a whole number of cycles and compares it with
+ * the analytic response of the same design evaluated in double precision.
+ * The seven-channel update is then timed against the divide-per-sample
+ * first-order filter that the bank replaced in icm42688.c.
+ *
+ * Build and run from joint_unit_mcu_code:
+ *     gcc -std=gnu11 -O2 -Ilib/common -o filter_bank_report tools/filter_bank_report.c lib/common/filter_bank.c -lm
+ *     ./filter_bank_report
+ *
+ * Host timings do not carry over to the target: x86 divides in hardware,
+ * while the RP2040 core has neither a divide instruction nor a 64-bit
+ * multiply, so the two filters trade different costs there.  Confirm the
+ * cycle counts on the RP2040 before relying on the ratio.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include "filter_bank.h"
+
+#define AMPLITUDE (8192.0)
+#define SETTLE_SECONDS (4)
+#define MEASURE_SECONDS (4)
+#define CHANNELS (7)
+#define TIMING_SAMPLES (4096)
+#define REPEATS (2000)
+
+typedef enum
+{
+    SECTION_FIRST_ORDER,
+    SECTION_LOW_PASS,
+    SECTION_NOTCH,
+} section_type_t;
+
+typedef struct
+{
+    const char *name;
+    section_type_t type;
+    double frequency;
+    double q;
+    double sample;
+} response_case_t;
+
+static volatile int32_t sink;
+
+static double seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + 1e-9 * (double)now.tv_nsec;
+}
+
+// Analytic gain of the section designed by filter_bank.c, in double precision
+static double analytic_gain(const response_case_t *const c, const double f)
+{
+    const double complex z1 = cexp(-I * 2.0 * M_PI * f / c->sample);
+    const double complex z2 = z1 * z1;
+    if (c->type == SECTION_FIRST_ORDER)
+    {
+        const double k = tan(M_PI * c->frequency / c->sample);
+        return cabs(k * (1.0 + z1) / ((1.0 + k) + (k - 1.0) * z1));
+    }
+    const double omega = 2.0 * M_PI * c->frequency / c->sample;
+    const double cosine = cos(omega);
+    const double alpha = sin(omega) / (2.0 * c->q);
+    const double complex denominator = (1.0 + alpha) - 2.0 * cosine * z1 + (1.0 - alpha) * z2;
+    if (c->type == SECTION_LOW_PASS)
+    {
+        return cabs(0.5 * (1.0 - cosine) * (1.0 + 2.0 * z1 + z2) / denominator);
+    }
+    return cabs((1.0 - 2.0 * cosine * z1 + z2) / denominator);
+}
+
+// Steady-state gain of the bank at f, from the in-phase and quadrature sums
+static double measured_gain(const response_case_t *const c, const double f)
+{
+    filter_bank_t bank;
+    filter_bank_init(&bank, 1);
+    switch (c->type)
+    {
+        case SECTION_FIRST_ORDER:
+            filter_bank_set_first_order_low_pass(&bank, 0, 0, (float)c->frequency, (float)c->sample);
+            break;
+        case SECTION_LOW_PASS:
+            filter_bank_set_low_pass(&bank, 0, 0, (float)c->frequency, (float)c->q, (float)c->sample);
+            break;
+        case SECTION_NOTCH:
+            filter_bank_set_notch(&bank, 0, 0, (float)c->frequency, (float)c->q, (float)c->sample);
+            break;
+    }
+    const long settle = (long)(SETTLE_SECONDS * c->sample);
+    const long measure = (long)(MEASURE_SECONDS * c->sample);
+    double inPhase = 0.0;
+    double quadrature = 0.0;
+    for (long n = 0; n < settle + measure; n++)
+    {
+        const double phase = 2.0 * M_PI * f * (double)n / c->sample;
+        const int32_t input = (int32_t)lround(AMPLITUDE * sin(phase));
+        filter_bank_update(&bank, &input);
+        if (n >= settle)
+        {
+            const double output = filter_bank_output_float(&bank, 0);
+            inPhase += output * sin(phase);
+            quadrature += output * cos(phase);
+        }
+    }
+    return 2.0 * sqrt(inPhase * inPhase + quadrature * quadrature) / ((double)measure * AMPLITUDE);
+}
+
+// The first-order filter the bank replaced, with one division per sample
+typedef struct
+{
+    int32_t gain;
+    int32_t gx3;
+    int32_t previousInput;
+    int32_t previousOutput;
+} legacy_filter_t;
+
+static void legacy_update(legacy_filter_t *const filter, const int32_t input)
+{
+    filter->previousOutput =
+        (1000 * input + 1000 * filter->previousInput - filter->gx3 * filter->previousOutput) / (1000 + filter->gain);
+    filter->previousInput = input;
+}
+
+int main(void)
+{
+    // The icm42688.c configuration, then the biquad and notch of the README
+    // example; the test frequencies are whole multiples of 1 / MEASURE_SECONDS
+    const response_case_t cases[] = {
+        {"low-pass 1.06 Hz", SECTION_FIRST_ORDER, 1.06, 0.0, 200.0},
+        {"biquad 20 Hz", SECTION_LOW_PASS, 20.0, 0.7071, 1000.0},
+        {"notch 80 Hz Q=2", SECTION_NOTCH, 80.0, 2.0, 1000.0},
+    };
+    const double ratios[] = {0.25, 0.5, 1.0, 2.0, 4.0};
+
+    printf("%-18s %10s %12s %12s %12s\n", "section", "Hz", "analytic", "measured", "error");
+    double worst = 0.0;
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        for (size_t r = 0; r < sizeof(ratios) / sizeof(ratios[0]); r++)
+        {
+            const double f = round(cases[c].frequency * ratios[r] * MEASURE_SECONDS) / MEASURE_SECONDS;
+            if ((f <= 0.0) || (f >= 0.5 * cases[c].sample))
+            {
+                continue;
+            }
+            const double analytic = analytic_gain(&cases[c], f);
+            const double measured = measured_gain(&cases[c], f);
+            const double error = fabs(measured - analytic);
+            worst = error > worst ? error : worst;
+            printf("%-18s %10.2f %12.6f %12.6f %12.3e\n", cases[c].name, f, analytic, measured, error);
+        }
+    }
+    printf("worst gain error %.3e\n\n", worst);
+
+    // Seven channels per sample, as icm42688.c filters them
+    static int32_t input[TIMING_SAMPLES][CHANNELS];
+    uint32_t seed = 1;
+    for (int i = 0; i < TIMING_SAMPLES; i++)
+    {
+        for (int channel = 0; channel < CHANNELS; channel++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            input[i][channel] = (int32_t)(seed >> 16) - 32768;
+        }
+    }
+    filter_bank_t bank;
+    filter_bank_init(&bank, CHANNELS);
+    legacy_filter_t legacy[CHANNELS];
+    for (int channel = 0; channel < CHANNELS; channel++)
+    {
+        filter_bank_set_first_order_low_pass(&bank, channel, 0, 1.06f, 200.0f);
+        // tau 150 ms at 200 Hz, the former ACCEL_X_LOWPASS_TAU and _SAMPLE_HZ
+        legacy[channel] = (legacy_filter_t){.gain = 2 * 150 * 200, .gx3 = 1000 - 2 * 150 * 200};
+    }
+
+    double start = seconds();
+    for (int r = 0; r < REPEATS; r++)
+    {
+        for (int i = 0; i < TIMING_SAMPLES; i++)
+        {
+            for (int channel = 0; channel < CHANNELS; channel++)
+            {
+                legacy_update(&legacy[channel], input[i][channel]);
+            }
+            sink = legacy[0].previousOutput;
+        }
+    }
+    const double legacyNs = 1e9 * (seconds() - start) / ((double)REPEATS * TIMING_SAMPLES);
+    start = seconds();
+    for (int r = 0; r < REPEATS; r++)
+    {
+        for (int i = 0; i < TIMING_SAMPLES; i++)
+        {
+            filter_bank_update(&bank, input[i]);
+            sink = bank.output[0];
+        }
+    }
+    const double bankNs = 1e9 * (seconds() - start) / ((double)REPEATS * TIMING_SAMPLES);
+    printf("%-18s %12s\n", "filter", "ns/sample");
+    printf("%-18s %12.1f\n", "first_order_filter", legacyNs);
+    printf("%-18s %12.1f\n", "filter_bank", bankNs);
+    return 0;
+}
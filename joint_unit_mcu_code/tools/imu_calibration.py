@@ -0,0 +1,161 @@
+"""Per-unit ICM-42688 inertial calibration.
+
+Fits the misalignment, sensitivity and offset of the accelerometer from a
+six-position static capture, and the gyroscope offset from the same capture,
+then writes them into the unit's robot_parameters.h. The firmware folds these
+values and the axes alignment into one matrix and offset at boot
+(fusion_calibration_inertial_init()).
+
+Capture format: CSV with a header row and columns
+    position,gx,gy,gz,ax,ay,az
+in raw sensor counts. position names the sensor axis pointing up:
++x, -x, +y, -y, +z or -z. Keep the unit still for a few seconds in each.
+
+Usage:
+    python3 tools/imu_calibration.py capture.csv
+    python3 tools/imu_calibration.py capture.csv --write \
+        individual_parameters/asr_sdm_v1_001/unit_1/robot_parameters.h
+"""
+
+import argparse
+import csv
+import re
+import sys
+
+import numpy as np
+
+GYRO_NOMINAL_SENSITIVITY = 250.0 / 32768.0  # [dps/LSB], GYRO_CONFIG0 = 0x66
+ACCEL_NOMINAL_SENSITIVITY = 2.0 / 32768.0  # [g/LSB], ACCEL_CONFIG0 = 0x66
+
+POSITIONS = {
+    "+x": (1.0, 0.0, 0.0),
+    "-x": (-1.0, 0.0, 0.0),
+    "+y": (0.0, 1.0, 0.0),
+    "-y": (0.0, -1.0, 0.0),
+    "+z": (0.0, 0.0, 1.0),
+    "-z": (0.0, 0.0, -1.0),
+}
+
+BEGIN_MARKER = "// IMU calibration begin"
+END_MARKER = "// IMU calibration end"
+
+
+def load_capture(path):
+    gyro = {}
+    accel = {}
+    with open(path, newline="") as f:
+        for row in csv.DictReader(f):
+            position = row["position"].strip().lower()
+            if position not in POSITIONS:
+                sys.exit(f"unknown position '{position}'")
+            gyro.setdefault(position, []).append([float(row[k]) for k in ("gx", "gy", "gz")])
+            accel.setdefault(position, []).append([float(row[k]) for k in ("ax", "ay", "az")])
+    missing = set(POSITIONS) - set(accel)
+    if missing:
+        sys.exit(f"missing positions: {', '.join(sorted(missing))}")
+    return gyro, accel
+
+
+def fit_accelerometer(accel):
+    """Least squares fit of g = A x + c over the six position means, then
+    split A into misalignment (unit diagonal) times diag(sensitivity) and c
+    into an offset in counts so that g = misalignment diag(s) (x - offset)."""
+    x = np.array([np.mean(accel[p], axis=0) for p in POSITIONS])
+    g = np.array([POSITIONS[p] for p in POSITIONS])
+    design = np.hstack([x, np.ones((len(x), 1))])
+    solution, *_ = np.linalg.lstsq(design, g, rcond=None)
+    a = solution[:3].T
+    c = solution[3]
+    sensitivity = np.diag(a).copy()
+    misalignment = a / sensitivity
+    offset = -np.linalg.solve(a, c)
+    residual = np.linalg.norm(design @ solution - g, axis=1)
+    return misalignment, sensitivity, offset, residual
+
+
+def fit_gyroscope(gyro, accel_misalignment, use_accel_misalignment):
+    samples = np.vstack([gyro[p] for p in POSITIONS])
+    offset = samples.mean(axis=0)
+    noise = samples.std(axis=0)
+    misalignment = accel_misalignment if use_accel_misalignment else np.eye(3)
+    sensitivity = np.full(3, GYRO_NOMINAL_SENSITIVITY)
+    return misalignment, sensitivity, offset, noise
+
+
+def c_float(value):
+    return f"{value:.8e}f"
+
+
+def c_matrix(m):
+    rows = ", ".join("{" + ", ".join(c_float(v) for v in row) + "}" for row in m)
+    return "{.array = {" + rows + "}}"
+
+
+def c_vector(v):
+    return "{.axis = {" + ", ".join(c_float(x) for x in v) + "}}"
+
+
+def render(alignment, gyro, accel, source):
+    g_mis, g_sens, g_off = gyro
+    a_mis, a_sens, a_off = accel
+    return "\n".join(
+        [
+            f"{BEGIN_MARKER} (generated by tools/imu_calibration.py)",
+            f"// Source: {source}",
+            f"#define IMU_AXES_ALIGNMENT {alignment}",
+            f"#define IMU_GYRO_MISALIGNMENT {c_matrix(g_mis)}",
+            f"#define IMU_GYRO_SENSITIVITY {c_vector(g_sens)} // [dps/LSB]",
+            f"#define IMU_GYRO_OFFSET {c_vector(g_off)} // [LSB]",
+            f"#define IMU_ACCEL_MISALIGNMENT {c_matrix(a_mis)}",
+            f"#define IMU_ACCEL_SENSITIVITY {c_vector(a_sens)} // [g/LSB]",
+            f"#define IMU_ACCEL_OFFSET {c_vector(a_off)} // [LSB]",
+            END_MARKER,
+        ]
+    )
+
+
+def write_parameters(path, block):
+    with open(path, newline="") as f:
+        text = f.read()
+    newline = "\r\n" if "\r\n" in text else "\n"
+    block = block.replace("\n", newline)
+    pattern = re.compile(re.escape(BEGIN_MARKER) + r".*?" + re.escape(END_MARKER), re.S)
+    if pattern.search(text):
+        text = pattern.sub(lambda _: block, text)
+    else:
+        text = text.replace("#endif", block + newline + newline + "#endif", 1)
+    with open(path, "w", newline="") as f:
+        f.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="six-position static capture (CSV)")
+    parser.add_argument("--alignment", default="FusionAxesAlignmentPXPYPZ", help="FusionAxesAlignment of the sensor")
+    parser.add_argument(
+        "--gyro-misalignment-from-accel",
+        action="store_true",
+        help="reuse the accelerometer misalignment for the gyroscope (same die)",
+    )
+    parser.add_argument("--write", metavar="ROBOT_PARAMETERS_H", help="update the calibration block in place")
+    args = parser.parse_args()
+
+    gyro_samples, accel_samples = load_capture(args.capture)
+    a_mis, a_sens, a_off, residual = fit_accelerometer(accel_samples)
+    g_mis, g_sens, g_off, g_noise = fit_gyroscope(gyro_samples, a_mis, args.gyro_misalignment_from_accel)
+
+    print(f"accelerometer sensitivity / nominal: {np.array2string(a_sens / ACCEL_NOMINAL_SENSITIVITY, precision=4)}",
+          file=sys.stderr)
+    print(f"accelerometer fit residual [g]: {np.array2string(residual, precision=4)}", file=sys.stderr)
+    print(f"gyroscope offset [dps]: {np.array2string(g_off * GYRO_NOMINAL_SENSITIVITY, precision=4)}", file=sys.stderr)
+    print(f"gyroscope noise [dps]: {np.array2string(g_noise * GYRO_NOMINAL_SENSITIVITY, precision=4)}", file=sys.stderr)
+
+    block = render(args.alignment, (g_mis, g_sens, g_off), (a_mis, a_sens, a_off), args.capture)
+    if args.write:
+        write_parameters(args.write, block)
+    else:
+        print(block)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,145 @@
+/**
+ * @file imu_pipeline_report.c
+ * @brief Host check of imu_pipeline.c with the rates of main.c.  FIFO bursts
+ * of 1 to ICM_FIFO_BURST_MAX samples carry a constant yaw rate, gravity on +Z
+ * and a vibration tone on Z for the accelerometer notch; the timestamps
+ * advance by the nominal period with the +-1 us jitter of the 1 us FIFO
+ * timestamp resolution.  After the run the yaw turned over the second half,
+ * the tilt, the decimated gyroscope and accelerometer, the preintegrated yaw
+ * and the notch frequency are compared with the input.
+ *
+ * Build and run once per math backend and attitude engine from
+ * joint_unit_mcu_code (dev_config.h is skipped, the pipeline does not use
+ * the board interface):
+ *     for b in LIBM FAST FAST_INT_SQRT; do for e in -UFUSION_USE_EKF -DFUSION_USE_EKF; do
+ *         gcc -std=gnu11 -O2 -D_DEV_CONFIG_H_ -DFUSION_MATH_BACKEND=FUSION_MATH_BACKEND_$b $e \
+ *             -Ilib/common -Ilib/config -Ilib/imu -Ilib/icm42688 -o imu_pipeline_report tools/imu_pipeline_report.c \
+ *             lib/imu/imu_pipeline.c lib/imu/imu_timestamp.c lib/imu/imu_preintegration.c lib/imu/FusionAhrs.c \
+ *             lib/imu/fusion_ekf.c lib/imu/fusion_offset.c lib/common/adaptive_notch.c lib/common/filter_bank.c \
+ *             lib/common/cic_decimator.c lib/common/sin_table.c -lm && ./imu_pipeline_report $b
+ *     done; done
+ *
+ * The exit status is non-zero if any quantity is out of tolerance.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include "imu_pipeline.h"
+
+#define SAMPLE_HZ (1000)
+#define FUSION_HZ (200)
+#define OUTPUT_HZ (100)
+#define SECONDS (24)
+#define YAW_DPS (10.0)
+#define TONE_HZ (137.0)
+#define TONE_COUNTS (2000.0)
+#define PERIOD_US (1000000 / SAMPLE_HZ)
+#define GYRO_LSB_PER_DPS (131.0f)    // +-250 dps
+#define ACCEL_LSB_PER_G (16384.0f)   // +-2 g
+#define YAW_TOLERANCE (0.05)         // degrees
+#define RATE_TOLERANCE (0.01)        // degrees per second
+#define ACCEL_TOLERANCE (0.002)      // g
+#define NOTCH_TOLERANCE (2.0)        // Hz
+
+static int check(const char *const name, const double value, const double expected, const double tolerance)
+{
+    const int pass = fabs(value - expected) <= tolerance;
+    printf("%-22s %12.4f %12.4f %s\n", name, value, expected, pass ? "ok" : "FAIL");
+    return pass;
+}
+
+int main(int argc, char *argv[])
+{
+    const imu_pipeline_rates_t rates = {.sample_hz = SAMPLE_HZ, .fusion_hz = FUSION_HZ, .output_hz = OUTPUT_HZ};
+#ifdef FUSION_USE_EKF
+    const char *const engine = "EKF";
+    const imu_pipeline_attitude_settings_t settings = {
+        .convention = FusionConventionNwu,
+        .gyroscopeNoise = 0.0028f,
+        .gyroscopeBiasStability = 0.002f,
+        .accelerometerNoise = 0.05f,
+        .accelerationRejection = 0.1f,
+        .innovationRejection = 11.3f,
+        .initialBiasUncertainty = 1.0f,
+    };
+#else
+    const char *const engine = "AHRS";
+    const imu_pipeline_attitude_settings_t settings = {
+        .convention = FusionConventionNwu,
+        .gain = 0.5f,
+        .gyroscopeRange = 2000.0f,
+        .accelerationRejection = 90.0f,
+        .magneticRejection = 90.0f,
+        .recoveryTriggerPeriod = 0,
+    };
+#endif
+    const adaptive_notch_settings_t notch = {
+        .min_hz = 20.0f,
+        .max_hz = 400.0f,
+        .q = 3.0f,
+        .hint_span_hz = 30.0f,
+        .min_amplitude = 100.0f,
+        .harmonic = true,
+    };
+    static imu_pipeline_t pipeline;
+    if (imu_pipeline_init(&pipeline, &rates, &settings, &notch) == false)
+    {
+        fprintf(stderr, "imu_pipeline_init failed\n");
+        return 1;
+    }
+    fusion_calibration_inertial_t gyroscope = {.matrix = FUSION_IDENTITY_MATRIX, .offset = FUSION_VECTOR_ZERO};
+    fusion_calibration_inertial_t accelerometer = gyroscope;
+    for (int i = 0; i < 3; i++)
+    {
+        gyroscope.matrix.array[i][i] = 1.0f / GYRO_LSB_PER_DPS;
+        accelerometer.matrix.array[i][i] = 1.0f / ACCEL_LSB_PER_G;
+    }
+    imu_pipeline_set_calibration(&pipeline, &gyroscope, &accelerometer);
+
+    // Burst lengths cycle through 1..ICM_FIFO_BURST_MAX so chunks straddle the fusion steps
+    const long total = (long)SECONDS * SAMPLE_HZ;
+    sensor_imu_t burst[ICM_FIFO_BURST_MAX];
+    double increment = 0.0;
+    double half_yaw = 0.0;
+    long half_n = 0;
+    long n = 0;
+    for (int b = 0; n < total; b++)
+    {
+        int count = 1 + (b * 7) % ICM_FIFO_BURST_MAX;
+        count = (count > total - n) ? (int)(total - n) : count;
+        for (int k = 0; k < count; k++, n++)
+        {
+            const double t = (double)n / SAMPLE_HZ;
+            burst[k] = (sensor_imu_t){0};
+            burst[k].gyro[2].data = (int16_t)lround(YAW_DPS * GYRO_LSB_PER_DPS);
+            burst[k].accel[2].data = (int16_t)lround(ACCEL_LSB_PER_G + TONE_COUNTS * sin(2.0 * M_PI * TONE_HZ * t));
+            burst[k].timestamp = (uint16_t)(n * PERIOD_US + (n % 3) - 1);
+        }
+        imu_pipeline_update(&pipeline, burst, (uint16_t)count, (uint64_t)n * PERIOD_US);
+        increment += imu_pipeline_take_increment(&pipeline).delta_angle.axis.z;
+        if ((half_n == 0) && (n >= total / 2))
+        {
+            half_yaw = FusionQuaternionToEuler(imu_pipeline_get_output(&pipeline)->quaternion).angle.yaw;
+            half_n = n;
+        }
+    }
+
+    const imu_pipeline_output_t *const output = imu_pipeline_get_output(&pipeline);
+    const FusionEuler euler = FusionQuaternionToEuler(output->quaternion);
+    // Yaw turned over the second half, clear of the AHRS initialisation, which
+    // holds the heading at zero for its first 3 s, and of the CIC delay
+    const double turned = fmod(euler.angle.yaw - half_yaw + 540.0, 360.0) - 180.0;
+    const double expected = fmod(YAW_DPS * (double)(n - half_n) / SAMPLE_HZ + 180.0, 360.0) - 180.0;
+    printf("%s %s, %ld samples\n", argc > 1 ? argv[1] : "", engine, n);
+    printf("%-22s %12s %12s\n", "quantity", "value", "expected");
+    int pass = 1;
+    pass &= check("yaw turned (deg)", turned, expected, YAW_TOLERANCE);
+    pass &= check("roll (deg)", euler.angle.roll, 0.0, YAW_TOLERANCE);
+    pass &= check("pitch (deg)", euler.angle.pitch, 0.0, YAW_TOLERANCE);
+    // The first sample has no previous timestamp and is integrated over the nominal period
+    pass &= check("increment yaw (deg)", increment * 180.0 / M_PI, YAW_DPS * SECONDS, YAW_TOLERANCE);
+    pass &= check("gyroscope z (dps)", output->gyroscope.axis.z, YAW_DPS, RATE_TOLERANCE);
+    pass &= check("accelerometer z (g)", output->accelerometer.axis.z, 1.0, ACCEL_TOLERANCE);
+    pass &= check("notch (Hz)", adaptive_notch_get_frequency(&pipeline.accel_notch), TONE_HZ, NOTCH_TOLERANCE);
+    return pass ? 0 : 1;
+}
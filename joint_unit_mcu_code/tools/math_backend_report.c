@@ -0,0 +1,214 @@
+/**
+ * @file math_backend_report.c
+ * @brief Host micro-benchmark and accuracy report for the math_backend.h
+ * kernels.  Each primitive and the vector/quaternion helpers built on them are
+ * timed over a fixed set of inputs and compared against double precision libm.
+ *
+ * Build and run once per backend from joint_unit_mcu_code:
+ *     for b in LIBM FAST FAST_INT_SQRT; do
+ *         gcc -std=gnu11 -O2 -DFUSION_MATH_BACKEND=FUSION_MATH_BACKEND_$b -Ilib/common -o math_$b \
+ *             tools/math_backend_report.c lib/common/sin_table.c -lm && ./math_$b
+ *     done
+ *
+ * Host timings only rank the backends relative to each other; on the RP2040
+ * the LIBM backend runs the ROM float routines and the FAST_INT_SQRT backend
+ * the SIO divider, so measure on the target (attitude_benchmark() in main.c)
+ * before choosing one.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include "math_utils.h"
+
+#define SAMPLES (4096)
+#define REPEATS (2000)
+
+static const char *const backendNames[] = {"", "LIBM", "FAST", "FAST_INT_SQRT"};
+
+static float inputA[SAMPLES];
+static float inputB[SAMPLES];
+static volatile float sink;
+
+typedef struct
+{
+    double maximumAbsolute;
+    double maximumRelative;
+    double sumSquares;
+} error_t;
+
+static double seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + 1e-9 * (double)now.tv_nsec;
+}
+
+static void accumulate(error_t *const error, const double value, const double reference)
+{
+    const double absolute = fabs(value - reference);
+    if (absolute > error->maximumAbsolute)
+    {
+        error->maximumAbsolute = absolute;
+    }
+    if ((fabs(reference) > 1e-6) && ((absolute / fabs(reference)) > error->maximumRelative))
+    {
+        error->maximumRelative = absolute / fabs(reference);
+    }
+    error->sumSquares += absolute * absolute;
+}
+
+static void report(const char *const name, const double nanoseconds, const error_t *const error, const int count)
+{
+    printf("%-22s %8.2f %12.3e %12.3e %12.3e\n", name, nanoseconds, error->maximumAbsolute, error->maximumRelative,
+           sqrt(error->sumSquares / count));
+}
+
+// Fills the inputs with a deterministic pseudo-random sequence in [low, high)
+static void fill(float *const input, const float low, const float high, uint32_t seed)
+{
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        input[i] = low + (high - low) * (float)(seed >> 8) * (1.0f / 16777216.0f);
+    }
+}
+
+#define TIME(expression)                                                                                               \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        const double start = seconds();                                                                                \
+        for (int r = 0; r < REPEATS; r++)                                                                              \
+        {                                                                                                              \
+            for (int i = 0; i < SAMPLES; i++)                                                                          \
+            {                                                                                                          \
+                sink = (expression);                                                                                   \
+            }                                                                                                          \
+        }                                                                                                              \
+        nanoseconds = 1e9 * (seconds() - start) / ((double)REPEATS * SAMPLES);                                         \
+    } while (0)
+
+int main(void)
+{
+    double nanoseconds;
+    printf("backend %s\n", backendNames[FUSION_MATH_BACKEND]);
+    printf("%-22s %8s %12s %12s %12s\n", "function", "ns/op", "max abs", "max rel", "rms abs");
+
+    // Square root and inverse square root over the magnitudes the filters see
+    fill(inputA, 1e-3f, 4.0f, 1);
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, fusion_math_sqrt(inputA[i]), sqrt((double)inputA[i]));
+        }
+        TIME(fusion_math_sqrt(inputA[i]));
+        report("sqrt", nanoseconds, &error, SAMPLES);
+    }
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, fusion_math_inverse_sqrt(inputA[i]), 1.0 / sqrt((double)inputA[i]));
+        }
+        TIME(fusion_math_inverse_sqrt(inputA[i]));
+        report("inverse_sqrt", nanoseconds, &error, SAMPLES);
+    }
+
+    // Trigonometry over the angles the filters see
+    fill(inputA, -(float)M_PI, (float)M_PI, 2);
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, fusion_math_sin(inputA[i]), sin((double)inputA[i]));
+        }
+        TIME(fusion_math_sin(inputA[i]));
+        report("sin", nanoseconds, &error, SAMPLES);
+    }
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, fusion_math_cos(inputA[i]), cos((double)inputA[i]));
+        }
+        TIME(fusion_math_cos(inputA[i]));
+        report("cos", nanoseconds, &error, SAMPLES);
+    }
+    fill(inputA, -1.0f, 1.0f, 3);
+    fill(inputB, -1.0f, 1.0f, 4);
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, fusion_math_atan2(inputA[i], inputB[i]), atan2((double)inputA[i], (double)inputB[i]));
+        }
+        TIME(fusion_math_atan2(inputA[i], inputB[i]));
+        report("atan2", nanoseconds, &error, SAMPLES);
+    }
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, fusion_math_asin(inputA[i]), asin((double)inputA[i]));
+        }
+        TIME(fusion_math_asin(inputA[i]));
+        report("asin", nanoseconds, &error, SAMPLES);
+    }
+
+    // Quaternion normalisation, the hot path of every filter update, as the
+    // unit-norm error after normalising a slightly perturbed quaternion
+    fill(inputA, -1.0f, 1.0f, 5);
+    fill(inputB, 0.9f, 1.1f, 6);
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            const FusionQuaternion q = {.array = {inputA[i], inputA[(i + 1) % SAMPLES], inputA[(i + 2) % SAMPLES],
+                                                  inputB[i]}};
+            const FusionQuaternion n = FusionQuaternionNormalise(q);
+            accumulate(&error,
+                       sqrt((double)n.array[0] * n.array[0] + (double)n.array[1] * n.array[1] +
+                            (double)n.array[2] * n.array[2] + (double)n.array[3] * n.array[3]),
+                       1.0);
+        }
+        TIME(FusionQuaternionNormalise((FusionQuaternion){.array = {inputA[i], 0.1f, 0.2f, inputB[i]}}).array[0]);
+        report("quaternion_normalise", nanoseconds, &error, SAMPLES);
+    }
+
+    // Euler conversion of random unit quaternions, error in degrees on the
+    // angle wrapped to (-180, 180]
+    {
+        error_t error = {0};
+        int count = 0;
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            const FusionQuaternion q = FusionQuaternionNormalise(
+                (FusionQuaternion){.array = {inputA[i], inputA[(i + 1) % SAMPLES], inputA[(i + 2) % SAMPLES],
+                                             inputA[(i + 3) % SAMPLES]}});
+            const double w = q.element.w, x = q.element.x, y = q.element.y, z = q.element.z;
+            const double halfMinusYSquared = 0.5 - y * y;
+            const double sinPitch = 2.0 * (w * y - z * x);
+            if (fabs(sinPitch) > 0.99)
+            {
+                continue; // gimbal lock makes roll and yaw ill-conditioned
+            }
+            const double reference[3] = {
+                atan2(w * x + y * z, halfMinusYSquared - x * x) * 180.0 / M_PI,
+                asin(sinPitch) * 180.0 / M_PI,
+                atan2(w * z + x * y, halfMinusYSquared - z * z) * 180.0 / M_PI,
+            };
+            const FusionEuler euler = FusionQuaternionToEuler(q);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                double difference = euler.array[axis] - reference[axis];
+                difference -= 360.0 * floor((difference + 180.0) / 360.0);
+                accumulate(&error, reference[axis] + difference, reference[axis]);
+                count++;
+            }
+        }
+        TIME(FusionQuaternionToEuler((FusionQuaternion){.array = {inputA[i], 0.1f, 0.2f, inputB[i]}}).array[0]);
+        report("quaternion_to_euler", nanoseconds, &error, count);
+    }
+    return 0;
+}
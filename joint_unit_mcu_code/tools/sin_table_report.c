@@ -0,0 +1,188 @@
+/**
+ * @file sin_table_report.c
+ * @brief Host micro-benchmark and accuracy report for the Q15 quarter-wave
+ * kernel in sin_table.c against libm sinf, cosf and atan2f.  The integer
+ * kernels are timed on phases directly, the float wrappers on radians, and
+ * every result is compared against double precision libm.
+ *
+ * Build and run from joint_unit_mcu_code:
+ *     gcc -std=gnu11 -O2 -Ilib/common -o sin_table_report tools/sin_table_report.c lib/common/sin_table.c -lm
+ *     ./sin_table_report
+ *
+ * Host timings only rank the kernels relative to each other; on the RP2040
+ * sinf runs the ROM float routines and the table lookup executes from XIP
+ * flash, so confirm on the target before relying on the ratio.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include "sin_table.h"
+
+#define SAMPLES (4096)
+#define REPEATS (2000)
+
+static float inputA[SAMPLES];
+static float inputB[SAMPLES];
+static uint32_t phases[SAMPLES];
+static volatile float sink;
+static volatile int32_t sinkQ15;
+
+typedef struct
+{
+    double maximumAbsolute;
+    double sumSquares;
+} error_t;
+
+static double seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + 1e-9 * (double)now.tv_nsec;
+}
+
+static void accumulate(error_t *const error, const double value, const double reference)
+{
+    const double absolute = fabs(value - reference);
+    if (absolute > error->maximumAbsolute)
+    {
+        error->maximumAbsolute = absolute;
+    }
+    error->sumSquares += absolute * absolute;
+}
+
+static void report(const char *const name, const double nanoseconds, const double reference, const error_t *const error)
+{
+    printf("%-18s %8.2f %8.2fx %12.3e %12.3e\n", name, nanoseconds, reference / nanoseconds, error->maximumAbsolute,
+           sqrt(error->sumSquares / SAMPLES));
+}
+
+// Fills the inputs with a deterministic pseudo-random sequence in [low, high)
+static void fill(float *const input, const float low, const float high, uint32_t seed)
+{
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        input[i] = low + (high - low) * (float)(seed >> 8) * (1.0f / 16777216.0f);
+    }
+}
+
+#define TIME(result, sinkVariable, expression)                                                                        \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        const double start = seconds();                                                                                \
+        for (int r = 0; r < REPEATS; r++)                                                                              \
+        {                                                                                                              \
+            for (int i = 0; i < SAMPLES; i++)                                                                          \
+            {                                                                                                          \
+                sinkVariable = (expression);                                                                           \
+            }                                                                                                          \
+        }                                                                                                              \
+        result = 1e9 * (seconds() - start) / ((double)REPEATS * SAMPLES);                                              \
+    } while (0)
+
+int main(void)
+{
+    double libm;
+    double table;
+    printf("%-18s %8s %9s %12s %12s\n", "function", "ns/op", "vs libm", "max abs", "rms abs");
+
+    fill(inputA, -(float)M_PI, (float)M_PI, 1);
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        phases[i] = sin_table_radians_to_phase(inputA[i]);
+    }
+
+    // Sine: libm, the float wrapper and the integer kernel on the same angles
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, sinf(inputA[i]), sin((double)inputA[i]));
+        }
+        TIME(libm, sink, sinf(inputA[i]));
+        report("sinf", libm, libm, &error);
+    }
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, sin_table_sinf(inputA[i]), sin((double)inputA[i]));
+        }
+        TIME(table, sink, sin_table_sinf(inputA[i]));
+        report("sin_table_sinf", table, libm, &error);
+    }
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, sin_table_sin_q15(phases[i]) / 32768.0, sin((double)inputA[i]));
+        }
+        TIME(table, sinkQ15, sin_table_sin_q15(phases[i]));
+        report("sin_q15", table, libm, &error);
+    }
+
+    // Cosine
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, cosf(inputA[i]), cos((double)inputA[i]));
+        }
+        TIME(libm, sink, cosf(inputA[i]));
+        report("cosf", libm, libm, &error);
+    }
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, sin_table_cosf(inputA[i]), cos((double)inputA[i]));
+        }
+        TIME(table, sink, sin_table_cosf(inputA[i]));
+        report("sin_table_cosf", table, libm, &error);
+    }
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, sin_table_cos_q15(phases[i]) / 32768.0, cos((double)inputA[i]));
+        }
+        TIME(table, sinkQ15, sin_table_cos_q15(phases[i]));
+        report("cos_q15", table, libm, &error);
+    }
+
+    // Arc tangent over the unit square
+    fill(inputA, -1.0f, 1.0f, 2);
+    fill(inputB, -1.0f, 1.0f, 3);
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, atan2f(inputA[i], inputB[i]), atan2((double)inputA[i], (double)inputB[i]));
+        }
+        TIME(libm, sink, atan2f(inputA[i], inputB[i]));
+        report("atan2f", libm, libm, &error);
+    }
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            accumulate(&error, sin_table_atan2f(inputA[i], inputB[i]), atan2((double)inputA[i], (double)inputB[i]));
+        }
+        TIME(table, sink, sin_table_atan2f(inputA[i], inputB[i]));
+        report("sin_table_atan2f", table, libm, &error);
+    }
+    {
+        error_t error = {0};
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            const int32_t y = (int32_t)lroundf(inputA[i] * 32767.0f);
+            const int32_t x = (int32_t)lroundf(inputB[i] * 32767.0f);
+            accumulate(&error, sin_table_atan2_q15(y, x) / 32768.0, atan2((double)y, (double)x));
+        }
+        TIME(table, sinkQ15, sin_table_atan2_q15((int32_t)(inputA[i] * 32767.0f), (int32_t)(inputB[i] * 32767.0f)));
+        report("atan2_q15", table, libm, &error);
+    }
+    return 0;
+}
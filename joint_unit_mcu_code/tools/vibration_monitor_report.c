@@ -0,0 +1,73 @@
+/**
+ * @file vibration_monitor_report.c
+ * @brief Host check of vibration_monitor.c over the input range.  A tone on
+ * a gravity offset is fed at amplitudes from a few counts, where the block is
+ * scaled up before the FFT, to full scale, where it is scaled down, and the
+ * summary is compared with the tone: peak frequency within half a bin, peak
+ * and total RMS within the stated tolerance of amplitude / sqrt(2).
+ *
+ * Build with the undefined behaviour sanitizer and run from joint_unit_mcu_code:
+ *     gcc -std=gnu11 -O2 -fsanitize=undefined -fno-sanitize-recover -Ilib/common -o vibration_monitor_report tools/vibration_monitor_report.c lib/common/vibration_monitor.c lib/common/fft_q15.c lib/common/sin_table.c -lm
+ *     ./vibration_monitor_report
+ *
+ * The exit status is non-zero if any case is out of tolerance.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "vibration_monitor.h"
+
+#define SAMPLE_HZ (1000.0f)
+#define DECIMATION (2)
+#define TONE_HZ (61.3)
+
+typedef struct
+{
+    double amplitude; // counts
+    double offset;    // counts
+    double tolerance; // relative, on the RMS values
+} report_case_t;
+
+int main(void)
+{
+    // As main.c: 1 kHz decimated to 500 Hz.  The two smallest amplitudes are
+    // dominated by rounding to whole counts, hence the wider tolerance.
+    const vibration_monitor_settings_t settings = {
+        .sample_hz = SAMPLE_HZ,
+        .decimation = DECIMATION,
+        .band_edges_hz = {2.0f, 10.0f, 25.0f, 50.0f, 100.0f, 175.0f, 250.0f},
+    };
+    const report_case_t cases[] = {
+        {2.0, 2048.0, 0.25},     {12.0, 2048.0, 0.05},     {300.0, 2048.0, 0.01},  {8000.0, 2048.0, 0.01},
+        {16000.0, -2048.0, 0.01}, {30000.0, 0.0, 0.01},    {32767.0, 0.0, 0.01},
+    };
+    const double bin_hz = SAMPLE_HZ / (DECIMATION * VIBRATION_MONITOR_POINTS);
+    static vibration_monitor_t monitor;
+    int failures = 0;
+
+    printf("%10s %8s %10s %12s %12s %12s %s\n", "amplitude", "offset", "peak Hz", "peak rms", "rms", "expected",
+           "result");
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        vibration_monitor_init(&monitor, &settings);
+        for (long n = 0; !vibration_monitor_process(&monitor); n++)
+        {
+            const double phase = 2.0 * M_PI * TONE_HZ * (double)n / SAMPLE_HZ;
+            const int32_t value = (int32_t)lround(cases[c].offset + cases[c].amplitude * sin(phase));
+            const int32_t sample[VIBRATION_MONITOR_AXES] = {value, value, value};
+            vibration_monitor_add_sample(&monitor, sample);
+        }
+        const vibration_summary_t *const summary = vibration_monitor_get_summary(&monitor);
+
+        // Averaging two samples attenuates the tone by cos(pi f / fs)
+        const double expected = cases[c].amplitude * cos(M_PI * TONE_HZ / SAMPLE_HZ) / sqrt(2.0);
+        const int pass = (fabs(summary->peak_hz - TONE_HZ) < 0.5 * bin_hz) &&
+                         (fabs(summary->peak_rms - expected) <= cases[c].tolerance * expected) &&
+                         (fabs(summary->rms - expected) <= cases[c].tolerance * expected);
+        failures += !pass;
+        printf("%10.0f %8.0f %10.2f %12.3f %12.3f %12.3f %s\n", cases[c].amplitude, cases[c].offset,
+               summary->peak_hz, summary->peak_rms, summary->rms, expected, pass ? "ok" : "FAIL");
+    }
+    return failures == 0 ? 0 : 1;
+}
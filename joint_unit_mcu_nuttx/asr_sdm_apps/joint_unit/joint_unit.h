@@ -0,0 +1,184 @@
+/****************************************************************************
+ * apps/joint_unit/joint_unit.h
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_JOINT_UNIT_JOINT_UNIT_H
+#define __APPS_JOINT_UNIT_JOINT_UNIT_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "FusionAhrs.h"
+#include "imu_preintegration.h"
+#include "vibration_monitor.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Joints driven by one unit, in the order of the CAN joint commands */
+
+#define JU_JOINTS             2
+
+/* DYNAMIXEL X-series control table */
+
+#define JU_DXL_TORQUE_ENABLE  64
+#define JU_DXL_GOAL_POSITION  116
+#define JU_DXL_PRESENT_POSITION 132
+
+/* Path below /proc of the timing report (CONFIG_FS_PROCFS_REGISTER) */
+
+#define JU_PROCFS_NAME        "joint_unit"
+
+/* Timing histogram: bucket 0 counts below 8 us, bucket i [2^(i+2), 2^(i+3))
+ * us and the last bucket everything longer.
+ */
+
+#define JU_STATS_BUCKETS      12
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Real-time tasks whose timing is recorded */
+
+enum ju_task_e
+{
+  JU_TASK_IMU = 0,  /* woken by each sample of /dev/imu0 */
+  JU_TASK_CTRL,     /* periodic, absolute deadlines */
+  JU_TASK_CAN,      /* woken by each IMU output */
+  JU_TASK_COUNT
+};
+
+/* Timing of one task.  "latency" is the wake-up delay after the release
+ * time (the absolute deadline of a periodic task, the publish time of an
+ * event); for the IMU task, woken by the driver, it is the deviation of
+ * the sample period from nominal.  "exec" is the time from wake-up to the
+ * end of the cycle, an overrun a cycle that finished after the next
+ * release time.
+ */
+
+struct ju_stats_s
+{
+  FAR const char *name;
+  uint32_t period_us;       /* nominal */
+  uint32_t count;
+  uint32_t overruns;
+  uint32_t period_min_us;
+  uint32_t period_max_us;
+  uint32_t latency_min_us;
+  uint32_t latency_max_us;
+  uint64_t latency_sum_us;
+  uint32_t exec_max_us;
+  uint64_t exec_sum_us;
+  uint32_t hist[JU_STATS_BUCKETS];
+  uint64_t last_wake_us;
+};
+
+/* Unit state shared between the tasks, guarded by lock */
+
+struct joint_unit_s
+{
+  pthread_mutex_t lock;
+  volatile bool running;
+  uint32_t unit_id;           /* standard CAN ID of this unit */
+
+  /* CAN commands */
+
+  bool led_enable;
+  int8_t cmd_motor[2];        /* -100..+100, recorded only */
+  int32_t goal_position[JU_JOINTS];
+  bool goal_valid[JU_JOINTS];
+  bool torque_enable[JU_JOINTS];
+  bool torque_dirty[JU_JOINTS];
+
+  /* Control task results */
+
+  int32_t present_position[JU_JOINTS];
+  int16_t dxl_result[JU_JOINTS];
+
+  /* IMU task results, taken by the CAN task at the output rate */
+
+  imu_preintegration_t preintegration;
+  FusionQuaternion quaternion;
+  uint32_t output_seq;
+  uint64_t output_us;
+
+  vibration_monitor_t vibration;
+
+  struct ju_stats_s stats[JU_TASK_COUNT];
+  pthread_mutex_t stats_lock;
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+EXTERN struct joint_unit_s g_joint_unit;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/* joint_unit_stats.c */
+
+uint64_t ju_now_us(void);
+void ju_stats_init(enum ju_task_e task, FAR const char *name,
+                   uint32_t period_us);
+void ju_stats_wake(enum ju_task_e task, uint64_t release_us,
+                   uint64_t wake_us);
+void ju_stats_done(enum ju_task_e task, uint64_t wake_us,
+                   uint64_t next_release_us, uint64_t done_us);
+void ju_stats_reset(void);
+size_t ju_stats_format(FAR char *buf, size_t len);
+int ju_procfs_register(void);
+
+/* joint_unit_protocol.c */
+
+int ju_can_open(FAR const char *devpath);
+void ju_can_close(void);
+void ju_protocol_receive(void);
+void ju_protocol_send_imu_increment(FAR const imu_increment_t *increment);
+void ju_protocol_send_attitude(FusionQuaternion quaternion);
+void ju_protocol_send_vibration_summary(
+  FAR const vibration_summary_t *summary);
+
+int joint_unit_main(int argc, char *argv[]);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __APPS_JOINT_UNIT_JOINT_UNIT_H */
@@ -0,0 +1,1251 @@
+/****************************************************************************
+ * apps/joint_unit/joint_unit_main.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* The joint unit firmware of joint_unit_mcu_code/main.c on NuttX.  The
+ * repeating timers of the bare-metal build become SCHED_FIFO threads with
+ * explicit priorities:
+ *
+ *  - imu:  woken by every sample of /dev/imu0; preintegrates each sample,
+ *          runs the AHRS at the fusion rate and publishes at the output rate
+ *  - ctrl: periodic on absolute deadlines; one batched DYNAMIXEL submit per
+ *          cycle (torque changes, goal positions, present positions)
+ *  - can:  sends the IMU increment and attitude of each output, and a
+ *          second thread at the same priority applies received commands
+ *
+ * The main task keeps the idle-loop work of the bare-metal build (LED,
+ * vibration spectrum) at the task priority.  Timing of the three
+ * real-time tasks is exported as /proc/joint_unit.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <nuttx/leds/userled.h>
+#include <nuttx/i2c/i2c_master.h>
+#include <nuttx/irq.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <time.h>
+#include <sys/ioctl.h>
+
+#include "dynamixel.h"
+#include "icm42688.h"
+#include "joint_unit.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define JU_SAMPLE_HZ     CONFIG_EXAMPLES_JOINT_UNIT_SAMPLE_HZ
+#define JU_FUSION_HZ     CONFIG_EXAMPLES_JOINT_UNIT_FUSION_HZ
+#define JU_OUTPUT_HZ     CONFIG_EXAMPLES_JOINT_UNIT_OUTPUT_HZ
+#define JU_CTRL_HZ       CONFIG_EXAMPLES_JOINT_UNIT_CTRL_HZ
+
+#if (JU_SAMPLE_HZ % JU_FUSION_HZ) != 0 || (JU_FUSION_HZ % JU_OUTPUT_HZ) != 0
+#  error "FUSION_HZ must divide SAMPLE_HZ and OUTPUT_HZ must divide FUSION_HZ"
+#endif
+
+/* Samples per AHRS feedback step and feedback steps per output */
+
+#define JU_FUSION_DECIMATION (JU_SAMPLE_HZ / JU_FUSION_HZ)
+#define JU_OUTPUT_DECIMATION (JU_FUSION_HZ / JU_OUTPUT_HZ)
+
+/* Status timeout of each servo, well inside one control period */
+
+#define JU_DXL_TIMEOUT_MS    5
+
+/* Main task: LED toggled at 3 Hz as in the bare-metal build, vibration
+ * spectrum checked every 50 ms
+ */
+
+#define JU_LED_PERIOD_US     (1000000 / 3)
+#define JU_IDLE_PERIOD_US    50000
+
+#define JU_LED_DEVPATH       "/dev/userleds"
+
+/* "joint_unit bench": default number of control cycles */
+
+#define JU_BENCH_CYCLES      500
+
+/* "joint_unit imucheck": two seconds, one period of the synthetic 0.5 Hz
+ * yaw sweep of icm42688_sim.c, which has a 20 dps amplitude
+ */
+
+#define JU_CHECK_SAMPLES     (2 * JU_SAMPLE_HZ)
+#define JU_CHECK_YAW_DPS     20.0f
+#define JU_CHECK_ACCEL_TOL   0.02f  /* g */
+#define JU_CHECK_YAW_TOL     1.0f   /* dps */
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* Mutexes use priority inheritance when CONFIG_PRIORITY_INHERITANCE is
+ * set, so the can and main tasks cannot hold up imu or ctrl for longer than
+ * their short critical sections.
+ */
+
+struct joint_unit_s g_joint_unit =
+{
+  .lock       = PTHREAD_MUTEX_INITIALIZER,
+  .stats_lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const uint8_t g_ju_dxl_ids[JU_JOINTS] =
+{
+  CONFIG_EXAMPLES_JOINT_UNIT_DXL_ID1, CONFIG_EXAMPLES_JOINT_UNIT_DXL_ID2
+};
+
+static int g_imu_fd = -1;
+static int g_dxl_fd = -1;
+static sem_t g_output_sem;
+
+/* "joint_unit bench": control cycles run by a thread with the stack size
+ * and priority of ju_ctrl; the main task reads the thread's stack
+ * high-water mark between done and release, before the thread exits.
+ */
+
+struct ju_bench_s
+{
+  int cycles;
+  int failures;           /* servo reads that failed */
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t sum_us;
+  pid_t tid;
+  sem_t done;
+  sem_t release;
+};
+
+static struct ju_bench_s g_bench;
+
+/* Conversion of the raw samples, from ICM_IOCTL_GET_SCALES */
+
+static float g_accel_lsb_per_g;
+static float g_gyro_lsb_per_dps;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifndef CONFIG_ASR_SDM_DRIVERS_ICM42688_SIM
+/* RP23xx board-specific I2C initialization entry point */
+
+extern struct i2c_master_s *rp23xx_i2cbus_initialize(int port);
+#endif
+
+#if !defined(CONFIG_ASR_SDM_DRIVERS_ICM42688_SIM) && \
+    CONFIG_EXAMPLES_JOINT_UNIT_INT1_GPIO >= 0
+/* RP23xx GPIO interrupt entry points (arch/arm/src/rp23xx/rp23xx_gpio.h) */
+
+#define RP23XX_GPIO_INTR_EDGE_HIGH 3
+extern void rp23xx_gpio_init(uint32_t gpio);
+extern int rp23xx_gpio_irq_attach(uint32_t gpio, uint32_t intrmode,
+                                  xcpt_t isr, void *arg);
+extern void rp23xx_gpio_enable_irq(uint32_t gpio);
+extern void rp23xx_gpio_disable_irq(uint32_t gpio);
+
+/****************************************************************************
+ * Name: ju_imu_attach
+ *
+ * Description:
+ *   Attach the driver's INT1 handler to the rising edge of the INT1 GPIO,
+ *   so read() returns as each sample lands in the FIFO.
+ *
+ ****************************************************************************/
+
+static int ju_imu_attach(xcpt_t isr, FAR void *arg)
+{
+  const uint32_t pin = CONFIG_EXAMPLES_JOINT_UNIT_INT1_GPIO;
+  int ret;
+
+  if (isr == NULL)
+    {
+      rp23xx_gpio_disable_irq(pin);
+      return rp23xx_gpio_irq_attach(pin, RP23XX_GPIO_INTR_EDGE_HIGH,
+                                    NULL, NULL);
+    }
+
+  rp23xx_gpio_init(pin);
+  ret = rp23xx_gpio_irq_attach(pin, RP23XX_GPIO_INTR_EDGE_HIGH, isr, arg);
+  if (ret == 0)
+    {
+      rp23xx_gpio_enable_irq(pin);
+    }
+
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: ju_us_to_timespec
+ ****************************************************************************/
+
+static void ju_us_to_timespec(uint64_t us, FAR struct timespec *ts)
+{
+  ts->tv_sec = (time_t)(us / 1000000);
+  ts->tv_nsec = (long)(us % 1000000) * 1000;
+}
+
+/****************************************************************************
+ * Name: ju_imu_open
+ *
+ * Description:
+ *   Register the ICM-42688 unless the board already did, open it, set the
+ *   sample rate with the on-chip filter profile of the bare-metal build and
+ *   read the conversion scales.
+ *
+ ****************************************************************************/
+
+static int ju_imu_open(void)
+{
+  struct icm42688_filter_profile_s profile;
+  struct icm42688_config_s cfg;
+  uint32_t scales[2];
+  int ret;
+
+  g_imu_fd = open(CONFIG_EXAMPLES_JOINT_UNIT_IMU_DEVPATH, O_RDONLY);
+  if (g_imu_fd < 0)
+    {
+#ifdef CONFIG_ASR_SDM_DRIVERS_ICM42688_SIM
+      /* Emulated sensor at 0x68, INT1 emulated by a timer */
+
+      cfg.i2c = icm42688_sim_initialize();
+      cfg.addr = 0x68;
+      cfg.freq = 400000;
+      cfg.attach = icm42688_sim_attach;
+#else
+      cfg.i2c = rp23xx_i2cbus_initialize(
+                  CONFIG_EXAMPLES_JOINT_UNIT_I2C_PORT);
+      cfg.addr = CONFIG_EXAMPLES_JOINT_UNIT_I2C_ADDR;
+      cfg.freq = 400000;
+#  if CONFIG_EXAMPLES_JOINT_UNIT_INT1_GPIO >= 0
+      cfg.attach = ju_imu_attach;
+#  else
+      cfg.attach = NULL; /* driver re-checks the FIFO once per sample */
+#  endif
+#endif
+      if (cfg.i2c == NULL)
+        {
+          return -ENODEV;
+        }
+
+      ret = icm42688_register(CONFIG_EXAMPLES_JOINT_UNIT_IMU_DEVPATH, &cfg);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      g_imu_fd = open(CONFIG_EXAMPLES_JOINT_UNIT_IMU_DEVPATH, O_RDONLY);
+      if (g_imu_fd < 0)
+        {
+          return -errno;
+        }
+    }
+
+  /* The AHRS and the preintegration step every sample by 1 / SAMPLE_HZ,
+   * so the sensor must run at exactly that rate.
+   */
+
+  profile.odr_hz = JU_SAMPLE_HZ;
+  profile.aaf_hz = 348;
+  profile.ui_filter_order = 2;
+  profile.ui_filter_bw = 1; /* max(400 Hz, ODR) / 4 */
+  if (ioctl(g_imu_fd, ICM_IOCTL_SET_FILTER_PROFILE,
+            (unsigned long)&profile) < 0)
+    {
+      if (ioctl(g_imu_fd, ICM_IOCTL_GET_FILTER_PROFILE,
+                (unsigned long)&profile) < 0 ||
+          profile.odr_hz != JU_SAMPLE_HZ)
+        {
+          printf("joint_unit: cannot run the IMU at %d Hz\n", JU_SAMPLE_HZ);
+          return -EINVAL;
+        }
+    }
+
+  if (ioctl(g_imu_fd, ICM_IOCTL_GET_SCALES, (unsigned long)scales) < 0)
+    {
+      return -errno;
+    }
+
+  g_accel_lsb_per_g = (float)scales[0];
+  g_gyro_lsb_per_dps = (float)scales[1] / 10.0f;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ju_imu_thread
+ ****************************************************************************/
+
+static FAR void *ju_imu_thread(FAR void *arg)
+{
+  FAR struct joint_unit_s *ju = &g_joint_unit;
+  const float period = 1.0f / (float)JU_SAMPLE_HZ;
+  const uint32_t period_us = 1000000 / JU_SAMPLE_HZ;
+  FusionVector gyroscope[JU_FUSION_DECIMATION];
+  FusionVector accelerometer[JU_FUSION_DECIMATION];
+  FusionAhrsSettings settings;
+  fusion_ahrs_t ahrs;
+  unsigned int batch = 0;
+  unsigned int fusion_count = 0;
+
+  UNUSED(arg);
+
+  /* AHRS settings of the bare-metal build, with the gyroscope range taken
+   * from the full scale the driver reports
+   */
+
+  fusion_ahrs_init(&ahrs, JU_SAMPLE_HZ);
+  settings.convention = FusionConventionNwu;
+  settings.sample_rate = JU_SAMPLE_HZ;
+  settings.sample_period = period;
+  settings.gain = 0.5f;
+  settings.gyroscopeRange = 32768.0f / g_gyro_lsb_per_dps;
+  settings.accelerationRejection = 90.0f;
+  settings.magneticRejection = 90.0f;
+  settings.recoveryTriggerPeriod = 0;
+  settings.accelerometerDecimation = JU_FUSION_DECIMATION;
+  fusionAhrs_set_settings(&ahrs, &settings);
+
+  while (ju->running)
+    {
+      struct icm42688_sample_s s;
+      int32_t counts[3];
+      uint64_t wake;
+      ssize_t n;
+
+      n = read(g_imu_fd, &s, sizeof(s));
+      wake = ju_now_us();
+      if (n != (ssize_t)sizeof(s))
+        {
+          if (n < 0 && errno != EINTR)
+            {
+              /* Bus error: back off instead of retrying at once */
+
+              usleep(10000);
+            }
+
+          continue;
+        }
+
+      ju_stats_wake(JU_TASK_IMU, 0, wake);
+
+      counts[0] = s.accel_x;
+      counts[1] = s.accel_y;
+      counts[2] = s.accel_z;
+      vibration_monitor_add_sample(&ju->vibration, counts);
+
+      gyroscope[batch].axis.x = (float)s.gyro_x / g_gyro_lsb_per_dps;
+      gyroscope[batch].axis.y = (float)s.gyro_y / g_gyro_lsb_per_dps;
+      gyroscope[batch].axis.z = (float)s.gyro_z / g_gyro_lsb_per_dps;
+      gyroscope[batch] = fusion_offset_update(&ahrs.offset, gyroscope[batch]);
+      accelerometer[batch].axis.x = (float)s.accel_x / g_accel_lsb_per_g;
+      accelerometer[batch].axis.y = (float)s.accel_y / g_accel_lsb_per_g;
+      accelerometer[batch].axis.z = (float)s.accel_z / g_accel_lsb_per_g;
+
+      pthread_mutex_lock(&ju->lock);
+      imu_preintegration_update(&ju->preintegration, gyroscope[batch],
+                                accelerometer[batch], period);
+      pthread_mutex_unlock(&ju->lock);
+
+      /* Integrate at the sample rate, fuse at the fusion rate */
+
+      if (++batch == JU_FUSION_DECIMATION)
+        {
+          fusion_ahrs_update_batch_no_magnetometer(&ahrs, gyroscope,
+                                                   accelerometer, batch,
+                                                   period);
+          batch = 0;
+
+          if (++fusion_count == JU_OUTPUT_DECIMATION)
+            {
+              fusion_count = 0;
+
+              pthread_mutex_lock(&ju->lock);
+              ju->quaternion = FusionAhrsGetQuaternion(&ahrs);
+              ju->output_seq++;
+              ju->output_us = ju_now_us();
+              pthread_mutex_unlock(&ju->lock);
+              sem_post(&g_output_sem);
+            }
+        }
+
+      ju_stats_done(JU_TASK_IMU, wake, wake + period_us, ju_now_us());
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: ju_ctrl_cycle
+ *
+ * Description:
+ *   One control cycle as a single DXL_IOCTL_SUBMIT, so its packets go out
+ *   back to back: pending torque changes, the goal positions of the joints
+ *   with torque on and a goal, then a sync read of the present positions.
+ *
+ ****************************************************************************/
+
+static void ju_ctrl_cycle(void)
+{
+  FAR struct joint_unit_s *ju = &g_joint_unit;
+  uint8_t torque[JU_JOINTS];
+  uint8_t goal[JU_JOINTS * 5];
+  uint8_t present[JU_JOINTS][4];
+  struct dxl_read_slot_s slots[JU_JOINTS];
+  struct dxl_op_s ops[JU_JOINTS + 2];
+  struct dxl_ioctl_batch_s batch;
+  int torque_op[JU_JOINTS];
+  uint16_t goal_len = 0;
+  int nops = 0;
+  int i;
+
+  memset(ops, 0, sizeof(ops));
+
+  pthread_mutex_lock(&ju->lock);
+  for (i = 0; i < JU_JOINTS; i++)
+    {
+      torque_op[i] = -1;
+      if (ju->torque_dirty[i])
+        {
+          torque[i] = ju->torque_enable[i];
+          ju->torque_dirty[i] = false;
+
+          torque_op[i] = nops;
+          ops[nops].type = DXL_OP_WRITE;
+          ops[nops].id = g_ju_dxl_ids[i];
+          ops[nops].address = JU_DXL_TORQUE_ENABLE;
+          ops[nops].length = 1;
+          ops[nops].timeout_ms = JU_DXL_TIMEOUT_MS;
+          ops[nops].data = &torque[i];
+          nops++;
+        }
+
+      if (ju->torque_enable[i] && ju->goal_valid[i])
+        {
+          uint32_t position = (uint32_t)ju->goal_position[i];
+
+          goal[goal_len++] = g_ju_dxl_ids[i];
+          goal[goal_len++] = position & 0xff;
+          goal[goal_len++] = (position >> 8) & 0xff;
+          goal[goal_len++] = (position >> 16) & 0xff;
+          goal[goal_len++] = (position >> 24) & 0xff;
+        }
+    }
+
+  pthread_mutex_unlock(&ju->lock);
+
+  if (goal_len > 0)
+    {
+      ops[nops].type = DXL_OP_SYNC_WRITE;
+      ops[nops].address = JU_DXL_GOAL_POSITION;
+      ops[nops].length = 4;
+      ops[nops].data_len = goal_len;
+      ops[nops].data = goal;
+      nops++;
+    }
+
+  for (i = 0; i < JU_JOINTS; i++)
+    {
+      memset(&slots[i], 0, sizeof(slots[i]));
+      slots[i].id = g_ju_dxl_ids[i];
+      slots[i].data = present[i];
+    }
+
+  ops[nops].type = DXL_OP_SYNC_READ;
+  ops[nops].address = JU_DXL_PRESENT_POSITION;
+  ops[nops].length = 4;
+  ops[nops].timeout_ms = JU_DXL_TIMEOUT_MS;
+  ops[nops].slots = slots;
+  ops[nops].nslots = JU_JOINTS;
+  nops++;
+
+  batch.ops = ops;
+  batch.count = nops;
+  batch.flags = 0;
+  batch.completed = 0;
+  (void)ioctl(g_dxl_fd, DXL_IOCTL_SUBMIT, (unsigned long)&batch);
+
+  pthread_mutex_lock(&ju->lock);
+  for (i = 0; i < JU_JOINTS; i++)
+    {
+      /* Retry a torque change that did not reach the servo */
+
+      if (torque_op[i] >= 0 && ops[torque_op[i]].result != 0 &&
+          !ju->torque_dirty[i])
+        {
+          ju->torque_dirty[i] = true;
+        }
+
+      ju->dxl_result[i] = slots[i].result;
+      if (slots[i].result == 0)
+        {
+          ju->present_position[i] = (int32_t)((uint32_t)present[i][0] |
+                                              (uint32_t)present[i][1] << 8 |
+                                              (uint32_t)present[i][2] << 16 |
+                                              (uint32_t)present[i][3] << 24);
+        }
+    }
+
+  pthread_mutex_unlock(&ju->lock);
+}
+
+/****************************************************************************
+ * Name: ju_dxl_open
+ *
+ * Description:
+ *   Register the DYNAMIXEL bus unless the board already did and open it.
+ *
+ ****************************************************************************/
+
+static int ju_dxl_open(void)
+{
+  int ret;
+
+  g_dxl_fd = open(DXL_DEVICE_PATH, O_RDWR);
+  if (g_dxl_fd < 0)
+    {
+      ret = dynamixel_register_device(CONFIG_EXAMPLES_JOINT_UNIT_DXL_UART);
+      g_dxl_fd = ret < 0 ? -1 : open(DXL_DEVICE_PATH, O_RDWR);
+      if (g_dxl_fd < 0)
+        {
+          printf("joint_unit: DYNAMIXEL init failed: %d\n", ret);
+          return ret < 0 ? ret : -ENODEV;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ju_ctrl_thread
+ ****************************************************************************/
+
+static FAR void *ju_ctrl_thread(FAR void *arg)
+{
+  const uint64_t period_us = 1000000 / JU_CTRL_HZ;
+  uint64_t release = ju_now_us() + period_us;
+
+  UNUSED(arg);
+
+  while (g_joint_unit.running)
+    {
+      struct timespec ts;
+      uint64_t wake;
+      uint64_t done;
+
+      ju_us_to_timespec(release, &ts);
+      if (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0)
+        {
+          continue;
+        }
+
+      wake = ju_now_us();
+      ju_stats_wake(JU_TASK_CTRL, release, wake);
+
+      ju_ctrl_cycle();
+
+      done = ju_now_us();
+      ju_stats_done(JU_TASK_CTRL, wake, release + period_us, done);
+
+      /* Skip the releases already missed rather than running late cycles
+       * back to back; each shows up as an overrun.
+       */
+
+      do
+        {
+          release += period_us;
+        }
+      while (release <= done);
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: ju_can_tx_thread
+ ****************************************************************************/
+
+static FAR void *ju_can_tx_thread(FAR void *arg)
+{
+  FAR struct joint_unit_s *ju = &g_joint_unit;
+  const uint32_t period_us = 1000000 / JU_OUTPUT_HZ;
+
+  UNUSED(arg);
+
+  while (ju->running)
+    {
+      imu_increment_t increment;
+      FusionQuaternion quaternion;
+      uint64_t release;
+      uint64_t wake;
+
+      if (sem_wait(&g_output_sem) < 0 || !ju->running)
+        {
+          continue;
+        }
+
+      wake = ju_now_us();
+
+      pthread_mutex_lock(&ju->lock);
+      increment = imu_preintegration_take(&ju->preintegration);
+      quaternion = ju->quaternion;
+      release = ju->output_us;
+      pthread_mutex_unlock(&ju->lock);
+
+      ju_stats_wake(JU_TASK_CAN, release, wake);
+
+      /* Preintegrated increments go out at the output rate, so the host
+       * sees no aliasing of the rates
+       */
+
+      ju_protocol_send_imu_increment(&increment);
+      ju_protocol_send_attitude(quaternion);
+
+      ju_stats_done(JU_TASK_CAN, wake, release + period_us, ju_now_us());
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: ju_can_rx_thread
+ ****************************************************************************/
+
+static FAR void *ju_can_rx_thread(FAR void *arg)
+{
+  UNUSED(arg);
+
+  while (g_joint_unit.running)
+    {
+      ju_protocol_receive();
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: ju_thread_create
+ *
+ * Description:
+ *   Start a SCHED_FIFO thread at an explicit priority, not inherited from
+ *   the NSH task that ran joint_unit.
+ *
+ ****************************************************************************/
+
+static int ju_thread_create(FAR pthread_t *thread, FAR const char *name,
+                            int priority, pthread_startroutine_t entry)
+{
+  struct sched_param param;
+  pthread_attr_t attr;
+  int ret;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr,
+                            CONFIG_EXAMPLES_JOINT_UNIT_THREAD_STACKSIZE);
+  pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+  pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+  param.sched_priority = priority;
+  pthread_attr_setschedparam(&attr, &param);
+
+  ret = pthread_create(thread, &attr, entry, NULL);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+    {
+      printf("joint_unit: %s thread failed: %d\n", name, ret);
+      return -ret;
+    }
+
+  pthread_setname_np(*thread, name);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ju_led_set
+ *
+ * Description:
+ *   Drive the user LED, which is active-low on the XIAO RP2350.
+ *
+ ****************************************************************************/
+
+static void ju_led_set(int fd, bool on)
+{
+  struct userled_s led;
+
+  if (fd < 0)
+    {
+      return;
+    }
+
+  led.ul_led = 0;
+  led.ul_on = !on;
+  (void)ioctl(fd, ULEDIOC_SETLED, (unsigned long)&led);
+}
+
+/****************************************************************************
+ * Name: ju_run
+ *
+ * Description:
+ *   Open the devices, start the real-time threads and run the idle work
+ *   until "joint_unit stop".
+ *
+ ****************************************************************************/
+
+static int ju_run(void)
+{
+  static const vibration_monitor_settings_t vibration_settings =
+  {
+    .sample_hz = JU_SAMPLE_HZ,
+    .decimation = 2,
+    .band_edges_hz =
+    {
+      2.0f, 10.0f, 25.0f, 50.0f, 100.0f, 175.0f, 250.0f
+    },
+  };
+
+  FAR struct joint_unit_s *ju = &g_joint_unit;
+  pthread_t threads[4];
+  int nthreads = 0;
+  uint64_t next_led;
+  bool led_on = false;
+  int led_fd;
+  int ret;
+  int i;
+
+  ju->unit_id = CONFIG_EXAMPLES_JOINT_UNIT_ID;
+  ju->led_enable = true;
+  for (i = 0; i < JU_JOINTS; i++)
+    {
+      ju->goal_valid[i] = false;
+      ju->torque_enable[i] = false;
+      ju->torque_dirty[i] = false;
+    }
+
+  imu_preintegration_init(&ju->preintegration);
+  ju->quaternion = FUSION_IDENTITY_QUATERNION;
+  vibration_monitor_init(&ju->vibration, &vibration_settings);
+
+  ju_stats_init(JU_TASK_IMU, "imu", 1000000 / JU_SAMPLE_HZ);
+  ju_stats_init(JU_TASK_CTRL, "ctrl", 1000000 / JU_CTRL_HZ);
+  ju_stats_init(JU_TASK_CAN, "can", 1000000 / JU_OUTPUT_HZ);
+
+  ret = ju_imu_open();
+  if (ret < 0)
+    {
+      printf("joint_unit: IMU init failed: %d\n", ret);
+      goto errout;
+    }
+
+  ret = ju_dxl_open();
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  ret = ju_can_open(CONFIG_EXAMPLES_JOINT_UNIT_CAN_DEVPATH);
+  if (ret < 0)
+    {
+      printf("joint_unit: open %s failed: %d\n",
+             CONFIG_EXAMPLES_JOINT_UNIT_CAN_DEVPATH, ret);
+      goto errout;
+    }
+
+  ret = ju_procfs_register();
+  if (ret < 0 && ret != -ENOSYS)
+    {
+      printf("joint_unit: /proc/%s not available: %d\n",
+             JU_PROCFS_NAME, ret);
+    }
+
+  sem_init(&g_output_sem, 0, 0);
+  ju->running = true;
+
+  if (ju_thread_create(&threads[nthreads], "ju_imu",
+                       CONFIG_EXAMPLES_JOINT_UNIT_IMU_PRIORITY,
+                       ju_imu_thread) == OK)
+    {
+      nthreads++;
+    }
+
+  if (ju_thread_create(&threads[nthreads], "ju_ctrl",
+                       CONFIG_EXAMPLES_JOINT_UNIT_CTRL_PRIORITY,
+                       ju_ctrl_thread) == OK)
+    {
+      nthreads++;
+    }
+
+  if (ju_thread_create(&threads[nthreads], "ju_can_tx",
+                       CONFIG_EXAMPLES_JOINT_UNIT_CAN_PRIORITY,
+                       ju_can_tx_thread) == OK)
+    {
+      nthreads++;
+    }
+
+  if (ju_thread_create(&threads[nthreads], "ju_can_rx",
+                       CONFIG_EXAMPLES_JOINT_UNIT_CAN_PRIORITY,
+                       ju_can_rx_thread) == OK)
+    {
+      nthreads++;
+    }
+
+  if (nthreads != 4)
+    {
+      ju->running = false;
+    }
+  else
+    {
+      printf("joint_unit: unit %lu running, IMU %d/%d/%d Hz, control %d Hz\n",
+             (unsigned long)ju->unit_id, JU_SAMPLE_HZ, JU_FUSION_HZ,
+             JU_OUTPUT_HZ, JU_CTRL_HZ);
+    }
+
+  /* Idle work of the bare-metal main loop */
+
+  led_fd = open(JU_LED_DEVPATH, O_WRONLY);
+  next_led = ju_now_us();
+  while (ju->running)
+    {
+      uint64_t now = ju_now_us();
+
+      if (now >= next_led)
+        {
+          bool enable;
+
+          pthread_mutex_lock(&ju->lock);
+          enable = ju->led_enable;
+          pthread_mutex_unlock(&ju->lock);
+
+          led_on = enable ? !led_on : true;
+          ju_led_set(led_fd, led_on);
+          next_led += JU_LED_PERIOD_US;
+        }
+
+      /* Condition monitoring publishes about once a second per axis */
+
+      if (vibration_monitor_process(&ju->vibration))
+        {
+          ju_protocol_send_vibration_summary(
+            vibration_monitor_get_summary(&ju->vibration));
+        }
+
+      usleep(JU_IDLE_PERIOD_US);
+    }
+
+  /* Wake the CAN transmit thread, the others time out by themselves */
+
+  sem_post(&g_output_sem);
+  for (i = 0; i < nthreads; i++)
+    {
+      pthread_join(threads[i], NULL);
+    }
+
+  if (led_fd >= 0)
+    {
+      close(led_fd);
+    }
+
+  sem_destroy(&g_output_sem);
+  ret = nthreads == 4 ? OK : -EAGAIN;
+
+errout:
+  ju_can_close();
+  if (g_dxl_fd >= 0)
+    {
+      close(g_dxl_fd);
+      g_dxl_fd = -1;
+    }
+
+  if (g_imu_fd >= 0)
+    {
+      close(g_imu_fd);
+      g_imu_fd = -1;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: ju_bench_thread
+ *
+ * Description:
+ *   Run the control cycle back to back and time each one.  From the first
+ *   successful read on, the present position is written back as the goal,
+ *   so every cycle carries the goal Sync Write and the present position
+ *   Sync Read of a running unit.  Torque is never written.
+ *
+ ****************************************************************************/
+
+static FAR void *ju_bench_thread(FAR void *arg)
+{
+  FAR struct joint_unit_s *ju = &g_joint_unit;
+  FAR struct ju_bench_s *bench = &g_bench;
+  int n;
+  int i;
+
+  UNUSED(arg);
+
+  bench->tid = gettid();
+  for (n = 0; n < bench->cycles; n++)
+    {
+      uint64_t start = ju_now_us();
+      uint32_t elapsed;
+
+      ju_ctrl_cycle();
+      elapsed = (uint32_t)(ju_now_us() - start);
+
+      bench->min_us = elapsed < bench->min_us ? elapsed : bench->min_us;
+      bench->max_us = elapsed > bench->max_us ? elapsed : bench->max_us;
+      bench->sum_us += elapsed;
+
+      pthread_mutex_lock(&ju->lock);
+      for (i = 0; i < JU_JOINTS; i++)
+        {
+          if (ju->dxl_result[i] != 0)
+            {
+              bench->failures++;
+            }
+          else if (!ju->goal_valid[i])
+            {
+              ju->goal_position[i] = ju->present_position[i];
+              ju->goal_valid[i] = true;
+              ju->torque_enable[i] = true;
+            }
+        }
+
+      pthread_mutex_unlock(&ju->lock);
+    }
+
+  sem_post(&bench->done);
+  while (sem_wait(&bench->release) < 0 && errno == EINTR)
+    {
+    }
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: ju_stack_used
+ *
+ * Description:
+ *   Return the stack high-water mark of a thread from /proc/<pid>/stack,
+ *   which reports StackUsed with CONFIG_STACK_COLORATION.
+ *
+ ****************************************************************************/
+
+static int ju_stack_used(pid_t pid, FAR unsigned long *used,
+                         FAR unsigned long *size)
+{
+  char path[32];
+  char line[64];
+  FAR FILE *file;
+  int found = 0;
+
+  snprintf(path, sizeof(path), "/proc/%d/stack", (int)pid);
+  file = fopen(path, "r");
+  if (file == NULL)
+    {
+      return -errno;
+    }
+
+  while (fgets(line, sizeof(line), file) != NULL)
+    {
+      if (sscanf(line, "StackSize: %lu", size) == 1 ||
+          sscanf(line, "StackUsed: %lu", used) == 1)
+        {
+          found++;
+        }
+    }
+
+  fclose(file);
+  return found == 2 ? OK : -ENOSYS;
+}
+
+/****************************************************************************
+ * Name: ju_bench
+ *
+ * Description:
+ *   Measure the DYNAMIXEL control cycle without the other tasks: the round
+ *   trip of each DXL_IOCTL_SUBMIT and the stack the driver path needs
+ *   inside a real-time thread.  On the sim, run sim/dxl_bus_emulator.py on
+ *   the bus first.
+ *
+ ****************************************************************************/
+
+static int ju_bench(int cycles)
+{
+  FAR struct joint_unit_s *ju = &g_joint_unit;
+  FAR struct ju_bench_s *bench = &g_bench;
+  unsigned long used = 0;
+  unsigned long size = 0;
+  pthread_t thread;
+  int stack;
+  int ret;
+  int i;
+
+  ret = ju_dxl_open();
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  memset(bench, 0, sizeof(*bench));
+  bench->cycles = cycles;
+  bench->min_us = UINT32_MAX;
+  sem_init(&bench->done, 0, 0);
+  sem_init(&bench->release, 0, 0);
+
+  ret = ju_thread_create(&thread, "ju_bench",
+                         CONFIG_EXAMPLES_JOINT_UNIT_CTRL_PRIORITY,
+                         ju_bench_thread);
+  if (ret == OK)
+    {
+      while (sem_wait(&bench->done) < 0 && errno == EINTR)
+        {
+        }
+      stack = ju_stack_used(bench->tid, &used, &size);
+      sem_post(&bench->release);
+      pthread_join(thread, NULL);
+
+      printf("joint_unit: %d control cycles, %d of %d servo reads failed\n",
+             cycles, bench->failures, cycles * JU_JOINTS);
+      printf("  cycle min/avg/max %lu/%lu/%lu us\n",
+             (unsigned long)bench->min_us,
+             (unsigned long)(bench->sum_us / cycles),
+             (unsigned long)bench->max_us);
+      if (stack == OK)
+        {
+          printf("  stack used %lu of %lu bytes\n", used, size);
+        }
+      else
+        {
+          printf("  stack not available (%d), enable "
+                 "CONFIG_STACK_COLORATION and CONFIG_FS_PROCFS\n", stack);
+        }
+    }
+
+  sem_destroy(&bench->done);
+  sem_destroy(&bench->release);
+
+  pthread_mutex_lock(&ju->lock);
+  for (i = 0; i < JU_JOINTS; i++)
+    {
+      ju->goal_valid[i] = false;
+      ju->torque_enable[i] = false;
+    }
+
+  pthread_mutex_unlock(&ju->lock);
+
+  close(g_dxl_fd);
+  g_dxl_fd = -1;
+  return ret;
+}
+
+#ifdef CONFIG_ASR_SDM_DRIVERS_ICM42688_SIM
+/****************************************************************************
+ * Name: ju_imu_check
+ *
+ * Description:
+ *   Read the synthetic stream of the emulated sensor through the driver and
+ *   convert it with ICM_IOCTL_GET_SCALES as ju_imu_thread does: the mean
+ *   |a| must be 1 g and the yaw rate, with its mean (the gyro bias)
+ *   removed, must have the 20 dps amplitude of the sweep.  The amplitude is
+ *   sqrt(2) times the RMS over the whole period.
+ *
+ ****************************************************************************/
+
+static int ju_imu_check(void)
+{
+  double accel_sum = 0.0;
+  double yaw_sum = 0.0;
+  double yaw_sq = 0.0;
+  float accel_g;
+  float yaw_dps;
+  int samples = 0;
+  int ret;
+
+  if (CONFIG_ASR_SDM_DRIVERS_ICM42688_SIM_REPLAY[0] != '\0')
+    {
+      printf("joint_unit: imucheck needs the synthetic stream, "
+             "not a replay\n");
+      return -EINVAL;
+    }
+
+  ret = ju_imu_open();
+  if (ret < 0)
+    {
+      printf("joint_unit: IMU open failed: %d\n", ret);
+      goto out;
+    }
+
+  while (samples < JU_CHECK_SAMPLES)
+    {
+      struct icm42688_sample_s s;
+      float ax;
+      float ay;
+      float az;
+      float gz;
+
+      if (read(g_imu_fd, &s, sizeof(s)) != (ssize_t)sizeof(s))
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          ret = -errno;
+          printf("joint_unit: IMU read failed: %d\n", ret);
+          goto out;
+        }
+
+      ax = (float)s.accel_x / g_accel_lsb_per_g;
+      ay = (float)s.accel_y / g_accel_lsb_per_g;
+      az = (float)s.accel_z / g_accel_lsb_per_g;
+      gz = (float)s.gyro_z / g_gyro_lsb_per_dps;
+      accel_sum += sqrtf(ax * ax + ay * ay + az * az);
+      yaw_sum += gz;
+      yaw_sq += (double)gz * gz;
+      samples++;
+    }
+
+  accel_g = (float)(accel_sum / samples);
+  yaw_dps = (float)sqrt(2.0 * (yaw_sq / samples -
+                               (yaw_sum / samples) * (yaw_sum / samples)));
+  ret = fabsf(accel_g - 1.0f) <= JU_CHECK_ACCEL_TOL &&
+        fabsf(yaw_dps - JU_CHECK_YAW_DPS) <= JU_CHECK_YAW_TOL ?
+        OK : -ERANGE;
+
+  printf("joint_unit: scales %.1f LSB/g %.1f LSB/dps, %d samples\n",
+         g_accel_lsb_per_g, g_gyro_lsb_per_dps, samples);
+  printf("  |a| %.3f g (1 +- %.2f), yaw amplitude %.2f dps "
+         "(%.0f +- %.0f): %s\n", accel_g, JU_CHECK_ACCEL_TOL, yaw_dps,
+         JU_CHECK_YAW_DPS, JU_CHECK_YAW_TOL, ret == OK ? "ok" : "FAIL");
+
+out:
+  if (g_imu_fd >= 0)
+    {
+      close(g_imu_fd);
+      g_imu_fd = -1;
+    }
+
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: main
+ *
+ * Command Line Usage:
+ *   joint_unit &           - Start the unit in the background
+ *   joint_unit stop        - Stop a running unit
+ *   joint_unit stats       - Print the timing report (/proc/joint_unit)
+ *   joint_unit reset       - Clear the timing statistics
+ *   joint_unit bench [n]   - Time n control cycles and report the stack
+ *                            high-water mark, with the unit stopped
+ *   joint_unit imucheck    - On sim, check the converted IMU samples
+ *                            against the synthetic stream
+ *
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  char report[1536];
+
+  if (argc > 1 && strcmp(argv[1], "stop") == 0)
+    {
+      if (!g_joint_unit.running)
+        {
+          printf("joint_unit: not running\n");
+          return EXIT_FAILURE;
+        }
+
+      g_joint_unit.running = false;
+      return EXIT_SUCCESS;
+    }
+
+  if (argc > 1 && strcmp(argv[1], "stats") == 0)
+    {
+      ju_stats_format(report, sizeof(report));
+      fputs(report, stdout);
+      return EXIT_SUCCESS;
+    }
+
+  if (argc > 1 && strcmp(argv[1], "reset") == 0)
+    {
+      ju_stats_reset();
+      return EXIT_SUCCESS;
+    }
+
+  if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+      int cycles = argc > 2 ? atoi(argv[2]) : JU_BENCH_CYCLES;
+
+      if (g_joint_unit.running || cycles < 1)
+        {
+          printf("joint_unit: bench needs a stopped unit and n >= 1\n");
+          return EXIT_FAILURE;
+        }
+
+      return ju_bench(cycles) < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+#ifdef CONFIG_ASR_SDM_DRIVERS_ICM42688_SIM
+  if (argc > 1 && strcmp(argv[1], "imucheck") == 0)
+    {
+      if (g_joint_unit.running)
+        {
+          printf("joint_unit: imucheck needs a stopped unit\n");
+          return EXIT_FAILURE;
+        }
+
+      return ju_imu_check() < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+#endif
+  if (argc > 1 && strcmp(argv[1], "start") != 0)
+    {
+      printf("Usage: joint_unit [start|stop|stats|reset|bench [n]]\n");
+      return EXIT_FAILURE;
+    }
+
+  if (g_joint_unit.running)
+    {
+      printf("joint_unit: already running\n");
+      return EXIT_FAILURE;
+    }
+
+  return ju_run() < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
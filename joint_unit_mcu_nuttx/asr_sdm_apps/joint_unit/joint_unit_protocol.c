@@ -0,0 +1,366 @@
+/****************************************************************************
+ * apps/joint_unit/joint_unit_protocol.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* The unit CAN protocol of joint_unit_mcu_code/lib/protocol/protocol.c on
+ * the NuttX CAN character driver.  Frame layouts are unchanged, so the host
+ * sees the same traffic from either build.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <nuttx/can/can.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+
+#include "attitude_codec.h"
+#include "joint_unit.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Every ATTITUDE_KEY_INTERVAL attitude frames is a key frame, 1 disables
+ * delta frames
+ */
+
+#define ATTITUDE_KEY_INTERVAL 10
+
+/* Receive timeout, bounds the time "joint_unit stop" waits for the task */
+
+#define JU_CAN_POLL_MS        100
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int g_can_fd = -1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ju_can_send
+ ****************************************************************************/
+
+static void ju_can_send(uint32_t id, FAR const uint8_t *data, uint8_t len)
+{
+  struct can_msg_s msg;
+
+  memset(&msg.cm_hdr, 0, sizeof(msg.cm_hdr));
+  msg.cm_hdr.ch_id = id;
+  msg.cm_hdr.ch_dlc = len;
+  memcpy(msg.cm_data, data, len);
+
+  (void)write(g_can_fd, &msg, CAN_MSGLEN(len));
+}
+
+/****************************************************************************
+ * Name: ju_saturate_u16 / ju_saturate_s16
+ ****************************************************************************/
+
+static uint16_t ju_saturate_u16(float value)
+{
+  if (value <= 0.0f)
+    {
+      return 0;
+    }
+
+  if (value >= 65535.0f)
+    {
+      return 65535;
+    }
+
+  return (uint16_t)(value + 0.5f);
+}
+
+static int16_t ju_saturate_s16(float value)
+{
+  if (value <= -32768.0f)
+    {
+      return -32768;
+    }
+
+  if (value >= 32767.0f)
+    {
+      return 32767;
+    }
+
+  return (int16_t)((value < 0.0f) ? (value - 0.5f) : (value + 0.5f));
+}
+
+/****************************************************************************
+ * Name: ju_protocol_update
+ *
+ * Description:
+ *   Apply one command frame addressed to this unit:
+ *   [2] 0x03 (Write), [3] command, [4..7] arguments.  Read requests
+ *   (0x02) have no replies in the bare-metal build either.
+ *
+ ****************************************************************************/
+
+static void ju_protocol_update(FAR const uint8_t *msg, uint8_t len)
+{
+  FAR struct joint_unit_s *ju = &g_joint_unit;
+  int joint;
+
+  if (len < 8 || msg[2] != 0x03)
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&ju->lock);
+
+  switch (msg[3])
+    {
+      case 0x03: /* LED: Enable / Disable */
+        if (msg[7] <= 1)
+          {
+            ju->led_enable = msg[7] == 1;
+          }
+        break;
+
+      case 0x05: /* Motor: Set Command: -100 ~ +100 */
+        ju->cmd_motor[0] = (int8_t)msg[6];
+        ju->cmd_motor[1] = (int8_t)msg[7];
+        break;
+
+      case 0x06: /* Joint 1: Set Command */
+      case 0x07: /* Joint 2: Set Command */
+        joint = msg[3] - 0x06;
+        ju->goal_position[joint] = (int32_t)((uint32_t)msg[4] << 24 |
+                                             (uint32_t)msg[5] << 16 |
+                                             (uint32_t)msg[6] << 8 |
+                                             msg[7]);
+        ju->goal_valid[joint] = true;
+        break;
+
+      case 0x08: /* Joint 1: Enable Torque */
+      case 0x09: /* Joint 2: Enable Torque */
+        joint = msg[3] - 0x08;
+        ju->torque_enable[joint] = msg[4] != 0;
+        ju->torque_dirty[joint] = true;
+        break;
+
+      default:
+        break;
+    }
+
+  pthread_mutex_unlock(&ju->lock);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ju_can_open
+ ****************************************************************************/
+
+int ju_can_open(FAR const char *devpath)
+{
+  g_can_fd = open(devpath, O_RDWR);
+  if (g_can_fd < 0)
+    {
+      return -errno;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ju_can_close
+ ****************************************************************************/
+
+void ju_can_close(void)
+{
+  if (g_can_fd >= 0)
+    {
+      close(g_can_fd);
+      g_can_fd = -1;
+    }
+}
+
+/****************************************************************************
+ * Name: ju_protocol_receive
+ *
+ * Description:
+ *   Wait up to JU_CAN_POLL_MS for frames and apply those sent to unit_id.
+ *
+ ****************************************************************************/
+
+void ju_protocol_receive(void)
+{
+  uint8_t buf[4 * sizeof(struct can_msg_s)];
+  struct pollfd fds;
+  ssize_t n;
+  size_t pos;
+
+  fds.fd = g_can_fd;
+  fds.events = POLLIN;
+  if (poll(&fds, 1, JU_CAN_POLL_MS) <= 0)
+    {
+      return;
+    }
+
+  n = read(g_can_fd, buf, sizeof(buf));
+  for (pos = 0; n > 0 && pos + CAN_MSGLEN(0) <= (size_t)n; )
+    {
+      FAR struct can_msg_s *msg = (FAR struct can_msg_s *)&buf[pos];
+
+      if (msg->cm_hdr.ch_id == g_joint_unit.unit_id && !msg->cm_hdr.ch_rtr)
+        {
+          ju_protocol_update(msg->cm_data, msg->cm_hdr.ch_dlc);
+        }
+
+      pos += CAN_MSGLEN(msg->cm_hdr.ch_dlc);
+    }
+}
+
+/****************************************************************************
+ * Name: ju_protocol_send_vibration_summary
+ *
+ * Description:
+ *   Publish a vibration spectrum summary as 5 frames:
+ *   [0] axis, [1] frame index, [2] 0x04 (Report), [3] 0x0A (Vibration),
+ *   [4..5] and [6..7] two big endian uint16 values:
+ *   frame 0: peak frequency [0.01 Hz], peak RMS [LSB]
+ *   frame 1: total RMS [LSB], band 0 RMS [LSB]
+ *   frame 2..4: band 1..5 RMS [LSB]
+ *
+ ****************************************************************************/
+
+void ju_protocol_send_vibration_summary(
+  FAR const vibration_summary_t *summary)
+{
+  uint16_t values[2 + 1 + VIBRATION_MONITOR_BANDS + 1] =
+  {
+    0
+  };
+
+  uint8_t frame;
+  uint8_t b;
+
+  values[0] = ju_saturate_u16(summary->peak_hz * 100.0f);
+  values[1] = ju_saturate_u16(summary->peak_rms);
+  values[2] = ju_saturate_u16(summary->rms);
+  for (b = 0; b < VIBRATION_MONITOR_BANDS; b++)
+    {
+      values[3 + b] = ju_saturate_u16(summary->band_rms[b]);
+    }
+
+  for (frame = 0; frame < sizeof(values) / sizeof(values[0]) / 2; frame++)
+    {
+      uint8_t msg[8];
+
+      msg[0] = summary->axis;
+      msg[1] = frame;
+      msg[2] = 0x04; /* Report */
+      msg[3] = 0x0a; /* Vibration Summary */
+      msg[4] = values[2 * frame] >> 8;
+      msg[5] = values[2 * frame] & 0xff;
+      msg[6] = values[2 * frame + 1] >> 8;
+      msg[7] = values[2 * frame + 1] & 0xff;
+      ju_can_send(g_joint_unit.unit_id, msg, 8);
+    }
+}
+
+/****************************************************************************
+ * Name: ju_protocol_send_imu_increment
+ *
+ * Description:
+ *   Publish a preintegrated IMU increment as 4 frames:
+ *   [0] sequence, [1] frame index, [2] 0x04 (Report), [3] 0x0B (IMU
+ *   Increment), [4..5] and [6..7] two big endian int16 values:
+ *   frame 0: delta angle x, y [2^-15 rad]
+ *   frame 1: delta angle z [2^-15 rad], delta velocity x [2^-13 m/s]
+ *   frame 2: delta velocity y, z [2^-13 m/s]
+ *   frame 3: duration [us], samples
+ *
+ ****************************************************************************/
+
+void ju_protocol_send_imu_increment(FAR const imu_increment_t *increment)
+{
+  static uint8_t sequence = 0;
+  int16_t values[8];
+  uint8_t frame;
+  uint8_t i;
+
+  for (i = 0; i < 3; i++)
+    {
+      values[i] = ju_saturate_s16(increment->delta_angle.array[i] *
+                                  32768.0f);
+      values[3 + i] = ju_saturate_s16(increment->delta_velocity.array[i] *
+                                      8192.0f);
+    }
+
+  values[6] = (int16_t)ju_saturate_u16(increment->duration * 1000000.0f);
+  values[7] = (int16_t)ju_saturate_u16((float)increment->samples);
+
+  for (frame = 0; frame < sizeof(values) / sizeof(values[0]) / 2; frame++)
+    {
+      uint8_t msg[8];
+
+      msg[0] = sequence;
+      msg[1] = frame;
+      msg[2] = 0x04; /* Report */
+      msg[3] = 0x0b; /* IMU Increment */
+      msg[4] = (uint16_t)values[2 * frame] >> 8;
+      msg[5] = (uint16_t)values[2 * frame] & 0xff;
+      msg[6] = (uint16_t)values[2 * frame + 1] >> 8;
+      msg[7] = (uint16_t)values[2 * frame + 1] & 0xff;
+      ju_can_send(g_joint_unit.unit_id, msg, 8);
+    }
+
+  sequence++;
+}
+
+/****************************************************************************
+ * Name: ju_protocol_send_attitude
+ *
+ * Description:
+ *   Publish the attitude as one frame on ATTITUDE_CODEC_CAN_ID(unit_id),
+ *   see attitude_codec.h.
+ *
+ ****************************************************************************/
+
+void ju_protocol_send_attitude(FusionQuaternion quaternion)
+{
+  static attitude_codec_state_t state =
+  {
+    .valid = false
+  };
+
+  static uint16_t stamp = 0;
+  uint8_t msg[ATTITUDE_CODEC_KEY_LENGTH];
+  uint8_t length;
+
+  length = attitude_codec_encode(&state, quaternion.array, stamp,
+                                 (stamp % ATTITUDE_KEY_INTERVAL) != 0, msg);
+  ju_can_send(ATTITUDE_CODEC_CAN_ID(g_joint_unit.unit_id), msg, length);
+  stamp++;
+}
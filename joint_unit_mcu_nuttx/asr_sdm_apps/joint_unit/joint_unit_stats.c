@@ -0,0 +1,600 @@
+/****************************************************************************
+ * apps/joint_unit/joint_unit_stats.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+
+#ifdef CONFIG_FS_PROCFS_REGISTER
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+#include <nuttx/kmalloc.h>
+#endif
+
+#include "dynamixel.h"
+#include "joint_unit.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Largest report, one header, one line per task and the bus timing */
+
+#define JU_REPORT_SIZE 1536
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_PROCFS_REGISTER
+/* Open /proc/joint_unit: a snapshot of the report taken at open() */
+
+struct ju_procfs_file_s
+{
+  struct procfs_file_s base;  /* Must be first */
+  size_t len;
+  char report[JU_REPORT_SIZE];
+};
+#endif
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_PROCFS_REGISTER
+static int ju_procfs_open(FAR struct file *filep, FAR const char *relpath,
+                          int oflags, mode_t mode);
+static int ju_procfs_close(FAR struct file *filep);
+static ssize_t ju_procfs_read(FAR struct file *filep, FAR char *buffer,
+                              size_t buflen);
+static ssize_t ju_procfs_write(FAR struct file *filep,
+                               FAR const char *buffer, size_t buflen);
+static int ju_procfs_dup(FAR const struct file *oldp,
+                         FAR struct file *newp);
+static int ju_procfs_stat(FAR const char *relpath, FAR struct stat *buf);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_PROCFS_REGISTER
+static const struct procfs_operations g_ju_procfs_ops =
+{
+  .open  = ju_procfs_open,
+  .close = ju_procfs_close,
+  .read  = ju_procfs_read,
+  .write = ju_procfs_write,
+  .dup   = ju_procfs_dup,
+  .stat  = ju_procfs_stat,
+};
+
+static const struct procfs_entry_s g_ju_procfs_entry =
+{
+  JU_PROCFS_NAME, &g_ju_procfs_ops, PROCFS_FILE_TYPE
+};
+
+static bool g_ju_procfs_registered;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ju_stats_bucket
+ *
+ * Description:
+ *   Histogram bucket of a time in microseconds, see JU_STATS_BUCKETS.
+ *
+ ****************************************************************************/
+
+static int ju_stats_bucket(uint32_t us)
+{
+  int bucket = 0;
+
+  us >>= 3;
+  while (us != 0 && bucket < JU_STATS_BUCKETS - 1)
+    {
+      us >>= 1;
+      bucket++;
+    }
+
+  return bucket;
+}
+
+/****************************************************************************
+ * Name: ju_stats_clear
+ *
+ * Description:
+ *   Clear the counters of one task, keeping its name and nominal period.
+ *   Called with stats_lock held.
+ *
+ ****************************************************************************/
+
+static void ju_stats_clear(FAR struct ju_stats_s *stats)
+{
+  FAR const char *name = stats->name;
+  uint32_t period_us = stats->period_us;
+
+  memset(stats, 0, sizeof(*stats));
+  stats->name = name;
+  stats->period_us = period_us;
+  stats->period_min_us = UINT32_MAX;
+  stats->latency_min_us = UINT32_MAX;
+}
+
+/****************************************************************************
+ * Name: ju_stats_printf
+ *
+ * Description:
+ *   Append to the report at *pos, truncating at the end of buf.
+ *
+ ****************************************************************************/
+
+static void ju_stats_printf(FAR char *buf, size_t len, FAR size_t *pos,
+                            FAR const IPTR char *fmt, ...)
+{
+  va_list ap;
+  int n;
+
+  if (*pos + 1 >= len)
+    {
+      return;
+    }
+
+  va_start(ap, fmt);
+  n = vsnprintf(&buf[*pos], len - *pos, fmt, ap);
+  va_end(ap);
+
+  if (n > 0)
+    {
+      *pos += (size_t)n < len - *pos ? (size_t)n : len - *pos - 1;
+    }
+}
+
+/****************************************************************************
+ * Name: ju_dxl_timing
+ *
+ * Description:
+ *   Read the bus timing through DXL_DEVICE_PATH, so the report also works
+ *   from a task that does not share the descriptors of the control task.
+ *
+ ****************************************************************************/
+
+static int ju_dxl_timing(FAR struct dxl_timing_s *timing, bool reset)
+{
+  struct dxl_ioctl_timing_s arg;
+  int ret;
+  int fd;
+
+  fd = open(DXL_DEVICE_PATH, O_RDWR);
+  if (fd < 0)
+    {
+      return -errno;
+    }
+
+  arg.reset = reset;
+  ret = ioctl(fd, DXL_IOCTL_GET_TIMING, (unsigned long)&arg);
+  if (ret < 0)
+    {
+      ret = -errno;
+    }
+  else if (timing != NULL)
+    {
+      *timing = arg.timing;
+    }
+
+  close(fd);
+  return ret;
+}
+
+#ifdef CONFIG_FS_PROCFS_REGISTER
+/****************************************************************************
+ * Name: ju_procfs_open
+ ****************************************************************************/
+
+static int ju_procfs_open(FAR struct file *filep, FAR const char *relpath,
+                          int oflags, mode_t mode)
+{
+  FAR struct ju_procfs_file_s *priv;
+
+  UNUSED(relpath);
+  UNUSED(oflags);
+  UNUSED(mode);
+
+  priv = kmm_zalloc(sizeof(*priv));
+  if (priv == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  priv->len = ju_stats_format(priv->report, sizeof(priv->report));
+  filep->f_priv = priv;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ju_procfs_close
+ ****************************************************************************/
+
+static int ju_procfs_close(FAR struct file *filep)
+{
+  kmm_free(filep->f_priv);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ju_procfs_read
+ ****************************************************************************/
+
+static ssize_t ju_procfs_read(FAR struct file *filep, FAR char *buffer,
+                              size_t buflen)
+{
+  FAR struct ju_procfs_file_s *priv = filep->f_priv;
+  size_t n;
+
+  if (filep->f_pos >= (off_t)priv->len)
+    {
+      return 0;
+    }
+
+  n = priv->len - (size_t)filep->f_pos;
+  if (n > buflen)
+    {
+      n = buflen;
+    }
+
+  memcpy(buffer, &priv->report[filep->f_pos], n);
+  filep->f_pos += n;
+  return n;
+}
+
+/****************************************************************************
+ * Name: ju_procfs_write
+ *
+ * Description:
+ *   "reset" clears the task and bus statistics.
+ *
+ ****************************************************************************/
+
+static ssize_t ju_procfs_write(FAR struct file *filep,
+                               FAR const char *buffer, size_t buflen)
+{
+  UNUSED(filep);
+
+  if (buflen < 5 || strncmp(buffer, "reset", 5) != 0)
+    {
+      return -EINVAL;
+    }
+
+  ju_stats_reset();
+  return buflen;
+}
+
+/****************************************************************************
+ * Name: ju_procfs_dup
+ ****************************************************************************/
+
+static int ju_procfs_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct ju_procfs_file_s *priv;
+
+  priv = kmm_malloc(sizeof(*priv));
+  if (priv == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  memcpy(priv, oldp->f_priv, sizeof(*priv));
+  newp->f_priv = priv;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ju_procfs_stat
+ ****************************************************************************/
+
+static int ju_procfs_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+  UNUSED(relpath);
+
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR | S_IWUSR;
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ju_now_us
+ *
+ * Description:
+ *   Monotonic time in microseconds.  The resolution is the system tick
+ *   unless the board runs tickless (CONFIG_SCHED_TICKLESS), so compare
+ *   jitter against the bare-metal build only on a tickless configuration.
+ *
+ ****************************************************************************/
+
+uint64_t ju_now_us(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: ju_stats_init
+ ****************************************************************************/
+
+void ju_stats_init(enum ju_task_e task, FAR const char *name,
+                   uint32_t period_us)
+{
+  FAR struct ju_stats_s *stats = &g_joint_unit.stats[task];
+
+  pthread_mutex_lock(&g_joint_unit.stats_lock);
+  stats->name = name;
+  stats->period_us = period_us;
+  ju_stats_clear(stats);
+  pthread_mutex_unlock(&g_joint_unit.stats_lock);
+}
+
+/****************************************************************************
+ * Name: ju_stats_wake
+ *
+ * Description:
+ *   Record the start of a cycle.  release_us is the time the cycle was due
+ *   to start, or 0 for a task woken by its device, whose latency is then
+ *   taken as the deviation of the period from nominal.
+ *
+ ****************************************************************************/
+
+void ju_stats_wake(enum ju_task_e task, uint64_t release_us,
+                   uint64_t wake_us)
+{
+  FAR struct ju_stats_s *stats = &g_joint_unit.stats[task];
+  uint32_t period = 0;
+  uint32_t latency;
+
+  pthread_mutex_lock(&g_joint_unit.stats_lock);
+
+  if (stats->last_wake_us != 0)
+    {
+      period = (uint32_t)(wake_us - stats->last_wake_us);
+      if (period < stats->period_min_us)
+        {
+          stats->period_min_us = period;
+        }
+
+      if (period > stats->period_max_us)
+        {
+          stats->period_max_us = period;
+        }
+    }
+
+  stats->last_wake_us = wake_us;
+
+  if (release_us != 0)
+    {
+      latency = wake_us > release_us ? (uint32_t)(wake_us - release_us) : 0;
+    }
+  else if (period != 0)
+    {
+      latency = period > stats->period_us ? period - stats->period_us
+                                          : stats->period_us - period;
+    }
+  else
+    {
+      pthread_mutex_unlock(&g_joint_unit.stats_lock);
+      return;
+    }
+
+  if (latency < stats->latency_min_us)
+    {
+      stats->latency_min_us = latency;
+    }
+
+  if (latency > stats->latency_max_us)
+    {
+      stats->latency_max_us = latency;
+    }
+
+  stats->latency_sum_us += latency;
+  stats->hist[ju_stats_bucket(latency)]++;
+  stats->count++;
+
+  pthread_mutex_unlock(&g_joint_unit.stats_lock);
+}
+
+/****************************************************************************
+ * Name: ju_stats_done
+ *
+ * Description:
+ *   Record the end of a cycle that started at wake_us.  A cycle ending
+ *   after next_release_us counts as an overrun.
+ *
+ ****************************************************************************/
+
+void ju_stats_done(enum ju_task_e task, uint64_t wake_us,
+                   uint64_t next_release_us, uint64_t done_us)
+{
+  FAR struct ju_stats_s *stats = &g_joint_unit.stats[task];
+  uint32_t exec = (uint32_t)(done_us - wake_us);
+
+  pthread_mutex_lock(&g_joint_unit.stats_lock);
+
+  if (exec > stats->exec_max_us)
+    {
+      stats->exec_max_us = exec;
+    }
+
+  stats->exec_sum_us += exec;
+  if (done_us > next_release_us)
+    {
+      stats->overruns++;
+    }
+
+  pthread_mutex_unlock(&g_joint_unit.stats_lock);
+}
+
+/****************************************************************************
+ * Name: ju_stats_reset
+ ****************************************************************************/
+
+void ju_stats_reset(void)
+{
+  int i;
+
+  pthread_mutex_lock(&g_joint_unit.stats_lock);
+  for (i = 0; i < JU_TASK_COUNT; i++)
+    {
+      ju_stats_clear(&g_joint_unit.stats[i]);
+    }
+
+  pthread_mutex_unlock(&g_joint_unit.stats_lock);
+
+  ju_dxl_timing(NULL, true);
+}
+
+/****************************************************************************
+ * Name: ju_stats_format
+ *
+ * Description:
+ *   Write the timing report to buf: one line per task with its period,
+ *   latency and execution time in microseconds and the latency histogram,
+ *   then the DYNAMIXEL bus round trips.
+ *
+ * Returned Value:
+ *   Length of the report, without the terminating NUL.
+ *
+ ****************************************************************************/
+
+size_t ju_stats_format(FAR char *buf, size_t len)
+{
+  struct ju_stats_s snapshot[JU_TASK_COUNT];
+  struct dxl_timing_s timing;
+  size_t pos = 0;
+  int i;
+  int b;
+
+  buf[0] = '\0';
+
+  pthread_mutex_lock(&g_joint_unit.stats_lock);
+  memcpy(snapshot, g_joint_unit.stats, sizeof(snapshot));
+  pthread_mutex_unlock(&g_joint_unit.stats_lock);
+
+  ju_stats_printf(buf, len, &pos,
+                  "%-5s %6s %8s %8s %13s %17s %11s  %s\n",
+                  "task", "period", "count", "overrun", "period_min/max",
+                  "latency_min/avg/max", "exec_avg/max",
+                  "latency hist <8,16,32..us");
+
+  for (i = 0; i < JU_TASK_COUNT; i++)
+    {
+      FAR const struct ju_stats_s *s = &snapshot[i];
+      uint32_t count = s->count != 0 ? s->count : 1;
+
+      if (s->name == NULL)
+        {
+          continue;
+        }
+
+      ju_stats_printf(buf, len, &pos,
+                      "%-5s %6lu %8lu %8lu %6lu/%-6lu %5lu/%5lu/%-5lu "
+                      "%5lu/%-5lu ",
+                      s->name, (unsigned long)s->period_us,
+                      (unsigned long)s->count, (unsigned long)s->overruns,
+                      (unsigned long)(s->count ? s->period_min_us : 0),
+                      (unsigned long)s->period_max_us,
+                      (unsigned long)(s->count ? s->latency_min_us : 0),
+                      (unsigned long)(s->latency_sum_us / count),
+                      (unsigned long)s->latency_max_us,
+                      (unsigned long)(s->exec_sum_us / count),
+                      (unsigned long)s->exec_max_us);
+
+      for (b = 0; b < JU_STATS_BUCKETS; b++)
+        {
+          ju_stats_printf(buf, len, &pos, " %lu",
+                          (unsigned long)s->hist[b]);
+        }
+
+      ju_stats_printf(buf, len, &pos, "\n");
+    }
+
+  if (ju_dxl_timing(&timing, false) == 0)
+    {
+      ju_stats_printf(buf, len, &pos,
+                      "dxl   %lu transactions, %lu timeouts, "
+                      "tx_max %lu us, rtt_max %lu us\n",
+                      (unsigned long)timing.count,
+                      (unsigned long)timing.timeouts,
+                      (unsigned long)timing.tx_max_us,
+                      (unsigned long)timing.rtt_max_us);
+    }
+
+  return pos;
+}
+
+/****************************************************************************
+ * Name: ju_procfs_register
+ *
+ * Description:
+ *   Publish the timing report as /proc/joint_unit.  procfs entries cannot
+ *   be removed, so the entry is registered once and outlives the tasks.
+ *
+ ****************************************************************************/
+
+int ju_procfs_register(void)
+{
+#ifdef CONFIG_FS_PROCFS_REGISTER
+  int ret;
+
+  if (g_ju_procfs_registered)
+    {
+      return OK;
+    }
+
+  ret = procfs_register(&g_ju_procfs_entry);
+  if (ret == OK)
+    {
+      g_ju_procfs_registered = true;
+    }
+
+  return ret;
+#else
+  return -ENOSYS;
+#endif
+}
@@ -0,0 +1,65 @@
+#!/bin/bash
+
+set -e
+
+# Paths
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+APP_DIR="$(cd "$SCRIPT_DIR/.." && pwd)"
+PROJ_ROOT="$(cd "$APP_DIR/../.." && pwd)"
+NUTTX_DIR="$PROJ_ROOT/nuttx"
+APPS_DIR="$PROJ_ROOT/apps"
+DRIVERS_DIR="$PROJ_ROOT/asr_sdm_drivers"
+
+echo "[INFO] Project root: $PROJ_ROOT"
+echo "[INFO] NuttX:        $NUTTX_DIR"
+echo "[INFO] apps:         $APPS_DIR"
+echo "[INFO] app:          $APP_DIR"
+
+if [ ! -d "$NUTTX_DIR" ] || [ ! -d "$APPS_DIR" ]; then
+  echo "[ERROR] Missing nuttx/apps under $PROJ_ROOT"
+  exit 1
+fi
+
+# The app uses the ICM-42688 and DYNAMIXEL drivers built by asr_sdm_drivers
+if [ ! -e "$APPS_DIR/asr_sdm_drivers" ]; then
+  ln -sf "$DRIVERS_DIR" "$APPS_DIR/asr_sdm_drivers"
+  echo "[OK] Linked: apps/asr_sdm_drivers -> $DRIVERS_DIR"
+fi
+
+# Link into apps/examples
+mkdir -p "$APPS_DIR/examples"
+if [ -L "$APPS_DIR/examples/joint_unit" ] || [ -e "$APPS_DIR/examples/joint_unit" ]; then
+  rm -rf "$APPS_DIR/examples/joint_unit"
+fi
+ln -sf "$APP_DIR" "$APPS_DIR/examples/joint_unit"
+echo "[OK] Linked: apps/examples/joint_unit -> $APP_DIR"
+
+# Re-gen Kconfig indices
+pushd "$APPS_DIR" >/dev/null
+./tools/mkkconfig.sh
+popd >/dev/null
+
+# Configure and enable app
+pushd "$NUTTX_DIR" >/dev/null
+if [ ! -f .config ]; then
+  ./tools/configure.sh xiao-rp2350:usbnsh
+fi
+
+# Drivers, CAN, procfs registration and a tickless clock for the timing report
+OPTIONS="CONFIG_ASR_SDM_DRIVERS_ICM42688 CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL
+         CONFIG_RP23XX_I2C CONFIG_RP23XX_I2C1 CONFIG_RP23XX_I2C_DRIVER
+         CONFIG_CAN CONFIG_FS_PROCFS CONFIG_FS_PROCFS_REGISTER
+         CONFIG_SCHED_TICKLESS CONFIG_PRIORITY_INHERITANCE
+         CONFIG_EXAMPLES_JOINT_UNIT"
+for option in $OPTIONS; do
+  if [ -x ./tools/kconfig-tweak ]; then
+    ./tools/kconfig-tweak -e "$option" || true
+  else
+    grep -q "^$option=y" .config || echo "$option=y" >> .config
+  fi
+done
+
+make olddefconfig
+make -j"$(nproc)"
+echo "[OK] Build done. Output: $NUTTX_DIR/nuttx.uf2"
+popd >/dev/null
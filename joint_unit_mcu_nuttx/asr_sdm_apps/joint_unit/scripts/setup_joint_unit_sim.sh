@@ -0,0 +1,96 @@
+#!/bin/bash
+
+set -e
+
+# Paths
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+APP_DIR="$(cd "$SCRIPT_DIR/.." && pwd)"
+PROJ_ROOT="$(cd "$APP_DIR/../.." && pwd)"
+NUTTX_DIR="$PROJ_ROOT/nuttx"
+APPS_DIR="$PROJ_ROOT/apps"
+DRIVERS_DIR="$PROJ_ROOT/asr_sdm_drivers"
+
+# Host side of the emulated buses: the pty of sim/dxl_bus_emulator.py and
+# the SocketCAN interface behind /dev/can0
+DXL_TTY="${DXL_TTY:-/dev/ttySIM0}"
+CAN_IFACE="${CAN_IFACE:-can0}"
+
+echo "[INFO] Project root: $PROJ_ROOT"
+echo "[INFO] NuttX:        $NUTTX_DIR"
+echo "[INFO] apps:         $APPS_DIR"
+echo "[INFO] app:          $APP_DIR"
+
+if [ ! -d "$NUTTX_DIR" ] || [ ! -d "$APPS_DIR" ]; then
+  echo "[ERROR] Missing nuttx/apps under $PROJ_ROOT"
+  exit 1
+fi
+
+# The app uses the ICM-42688 and DYNAMIXEL drivers built by asr_sdm_drivers
+if [ ! -e "$APPS_DIR/asr_sdm_drivers" ]; then
+  ln -sf "$DRIVERS_DIR" "$APPS_DIR/asr_sdm_drivers"
+  echo "[OK] Linked: apps/asr_sdm_drivers -> $DRIVERS_DIR"
+fi
+
+# Link into apps/examples
+mkdir -p "$APPS_DIR/examples"
+if [ -L "$APPS_DIR/examples/joint_unit" ] || [ -e "$APPS_DIR/examples/joint_unit" ]; then
+  rm -rf "$APPS_DIR/examples/joint_unit"
+fi
+ln -sf "$APP_DIR" "$APPS_DIR/examples/joint_unit"
+echo "[OK] Linked: apps/examples/joint_unit -> $APP_DIR"
+
+# Re-gen Kconfig indices
+pushd "$APPS_DIR" >/dev/null
+./tools/mkkconfig.sh
+popd >/dev/null
+
+# Configure for the simulator; a board .config is replaced
+pushd "$NUTTX_DIR" >/dev/null
+if [ ! -f .config ] || ! grep -q "^CONFIG_ARCH_SIM=y" .config; then
+  make distclean >/dev/null 2>&1 || true
+  ./tools/configure.sh sim:nsh
+fi
+
+# Drivers with the emulated ICM-42688, the DYNAMIXEL bus on a host tty,
+# CAN on host SocketCAN, procfs registration and a 100 us tick for the
+# timing report, stack coloration for "joint_unit bench". The sim UART has
+# no RS485 direction control.
+OPTIONS="CONFIG_ASR_SDM_DRIVERS_ICM42688 CONFIG_ASR_SDM_DRIVERS_ICM42688_SIM
+         CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL CONFIG_SERIAL_TERMIOS
+         CONFIG_CAN CONFIG_SIM_CANDEV CONFIG_SIM_CANDEV_CHAR
+         CONFIG_FS_PROCFS CONFIG_FS_PROCFS_REGISTER CONFIG_FS_HOSTFS
+         CONFIG_PRIORITY_INHERITANCE CONFIG_STACK_COLORATION
+         CONFIG_EXAMPLES_JOINT_UNIT"
+for option in $OPTIONS; do
+  if [ -x ./tools/kconfig-tweak ]; then
+    ./tools/kconfig-tweak -e "$option" || true
+  else
+    grep -q "^$option=y" .config || echo "$option=y" >> .config
+  fi
+done
+
+if [ -x ./tools/kconfig-tweak ]; then
+  ./tools/kconfig-tweak -d CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_HW_RS485
+  ./tools/kconfig-tweak --set-val CONFIG_USEC_PER_TICK 100
+  ./tools/kconfig-tweak --set-val CONFIG_SIM_UART_NUMBER 1
+  ./tools/kconfig-tweak --set-str CONFIG_SIM_UART0_NAME "$DXL_TTY"
+  ./tools/kconfig-tweak --set-str CONFIG_EXAMPLES_JOINT_UNIT_DXL_UART "$DXL_TTY"
+else
+  sed -i '/^CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_HW_RS485=/d;/^CONFIG_USEC_PER_TICK=/d;/^CONFIG_SIM_UART_NUMBER=/d;/^CONFIG_SIM_UART0_NAME=/d;/^CONFIG_EXAMPLES_JOINT_UNIT_DXL_UART=/d' .config
+  cat >> .config <<EOF
+# CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_HW_RS485 is not set
+CONFIG_USEC_PER_TICK=100
+CONFIG_SIM_UART_NUMBER=1
+CONFIG_SIM_UART0_NAME="$DXL_TTY"
+CONFIG_EXAMPLES_JOINT_UNIT_DXL_UART="$DXL_TTY"
+EOF
+fi
+
+make olddefconfig
+make -j"$(nproc)"
+echo "[OK] Build done. Output: $NUTTX_DIR/nuttx"
+popd >/dev/null
+
+echo "[INFO] Before running nuttx:"
+echo "       python3 $APP_DIR/sim/dxl_bus_emulator.py --link $DXL_TTY   (sudo for /dev)"
+echo "       sudo ip link add dev $CAN_IFACE type vcan && sudo ip link set up $CAN_IFACE"
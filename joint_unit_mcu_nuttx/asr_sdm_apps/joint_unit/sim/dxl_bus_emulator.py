@@ -0,0 +1,318 @@
+"""DYNAMIXEL Protocol 2.0 bus emulator for the NuttX simulator.
+
+Opens a pseudo terminal standing in for the half-duplex DYNAMIXEL bus and
+answers it as a chain of X-series servos (XL430-W250 control table subset):
+PING, READ, WRITE, SYNC READ, SYNC WRITE, BULK READ and FAST SYNC READ.
+With torque enabled, Present Position moves toward Goal Position at a fixed
+speed, so the joint_unit control loop sees moving joints.
+
+Timing follows a real bus: every byte of a status packet is paced at the
+baud rate, and each servo answers after its Return Delay Time (register 9,
+2 us units, initialised from --return-delay-us). Servos answering one
+broadcast or multi-servo read reply in turn, as on the wire.
+
+The NuttX sim UART opens its host device by name
+(CONFIG_SIM_UART0_NAME), so the pty is symlinked there. Writing /dev needs
+root; pick another path and set CONFIG_SIM_UART0_NAME to match instead.
+
+Usage:
+    sudo python3 sim/dxl_bus_emulator.py
+    python3 sim/dxl_bus_emulator.py --link /tmp/ttyDXL --ids 1 2 \
+        --baud 1000000 --return-delay-us 50
+"""
+
+import argparse
+import os
+import pty
+import select
+import sys
+import termios
+import time
+import tty
+
+HEADER = b"\xff\xff\xfd\x00"
+BROADCAST_ID = 0xFE
+
+INS_PING = 0x01
+INS_READ = 0x02
+INS_WRITE = 0x03
+INS_STATUS = 0x55
+INS_SYNC_READ = 0x82
+INS_SYNC_WRITE = 0x83
+INS_FAST_SYNC_READ = 0x8A
+INS_BULK_READ = 0x92
+
+ERR_INSTRUCTION = 0x02
+ERR_DATA_LENGTH = 0x05
+ERR_ACCESS = 0x07
+
+# Control table (XL430-W250, firmware 46)
+MODEL_NUMBER = 1060
+FIRMWARE_VERSION = 46
+TABLE_SIZE = 147
+ADDR_ID = 7
+ADDR_BAUD_RATE = 8
+ADDR_RETURN_DELAY = 9
+ADDR_TORQUE_ENABLE = 64
+ADDR_GOAL_POSITION = 116
+ADDR_MOVING = 122
+ADDR_PRESENT_VELOCITY = 128
+ADDR_PRESENT_POSITION = 132
+ADDR_PRESENT_VOLTAGE = 144
+ADDR_PRESENT_TEMPERATURE = 146
+
+# Registers the bus may not write (EEPROM identity, RAM status)
+READ_ONLY = set(range(0, 7)) | set(range(ADDR_MOVING, TABLE_SIZE))
+
+POSITION_SPEED = 2048  # [pulse/s], about 0.5 rev/s
+VELOCITY_UNIT = 0.229  # [rpm/LSB]
+
+
+def _crc_table():
+    table = []
+    for i in range(256):
+        crc = i << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x8005) if crc & 0x8000 else (crc << 1)
+        table.append(crc & 0xFFFF)
+    return table
+
+
+CRC_TABLE = _crc_table()
+
+
+def crc16(data, crc=0):
+    for byte in data:
+        crc = ((crc << 8) ^ CRC_TABLE[((crc >> 8) ^ byte) & 0xFF]) & 0xFFFF
+    return crc
+
+
+def u16(data, pos):
+    return data[pos] | data[pos + 1] << 8
+
+
+def status_packet(servo_id, error, params):
+    body = HEADER + bytes([servo_id]) + (len(params) + 4).to_bytes(2, "little")
+    body += bytes([INS_STATUS, error]) + params
+    return body + crc16(body).to_bytes(2, "little")
+
+
+class Servo:
+    def __init__(self, servo_id, return_delay_us):
+        self.table = bytearray(TABLE_SIZE)
+        self.table[0:2] = MODEL_NUMBER.to_bytes(2, "little")
+        self.table[6] = FIRMWARE_VERSION
+        self.table[ADDR_ID] = servo_id
+        self.table[ADDR_BAUD_RATE] = 1
+        self.table[ADDR_RETURN_DELAY] = min(254, return_delay_us // 2)
+        self.table[ADDR_PRESENT_VOLTAGE:ADDR_PRESENT_VOLTAGE + 2] = (120).to_bytes(2, "little")
+        self.table[ADDR_PRESENT_TEMPERATURE] = 30
+        self.position = 2048.0
+        self._store(ADDR_GOAL_POSITION, 2048)
+        self._store(ADDR_PRESENT_POSITION, 2048)
+
+    @property
+    def id(self):
+        return self.table[ADDR_ID]
+
+    @property
+    def return_delay(self):
+        return self.table[ADDR_RETURN_DELAY] * 2e-6
+
+    def _store(self, addr, value):
+        self.table[addr:addr + 4] = (value & 0xFFFFFFFF).to_bytes(4, "little")
+
+    def step(self, dt):
+        goal = int.from_bytes(self.table[ADDR_GOAL_POSITION:ADDR_GOAL_POSITION + 4], "little", signed=True)
+        velocity = 0.0
+        if self.table[ADDR_TORQUE_ENABLE]:
+            error = goal - self.position
+            move = max(-POSITION_SPEED * dt, min(POSITION_SPEED * dt, error))
+            self.position += move
+            velocity = move / dt if dt > 0 else 0.0
+        self.table[ADDR_MOVING] = 1 if abs(velocity) > 0 else 0
+        self._store(ADDR_PRESENT_VELOCITY, int(velocity * 60.0 / 4096.0 / VELOCITY_UNIT))
+        self._store(ADDR_PRESENT_POSITION, int(round(self.position)))
+
+    def read(self, addr, length):
+        if addr + length > TABLE_SIZE:
+            return ERR_ACCESS, b""
+        return 0, bytes(self.table[addr:addr + length])
+
+    def write(self, addr, data):
+        if addr + len(data) > TABLE_SIZE:
+            return ERR_ACCESS
+        if any(a in READ_ONLY for a in range(addr, addr + len(data))):
+            return ERR_ACCESS
+        if self.table[ADDR_TORQUE_ENABLE] and addr < ADDR_TORQUE_ENABLE:
+            return ERR_ACCESS  # EEPROM is locked while torque is on
+        self.table[addr:addr + len(data)] = data
+        return 0
+
+
+class Bus:
+    def __init__(self, fd, servos, baud, verbose):
+        self.fd = fd
+        self.servos = {s.id: s for s in servos}
+        self.baud = baud
+        self.verbose = verbose
+        self.rx = bytearray()
+        self.last_step = time.monotonic()
+
+    def _send(self, packet, delay):
+        """Transmit after 'delay' seconds, one byte time per byte."""
+        deadline = time.monotonic() + delay
+        byte_time = 10.0 / self.baud
+        for byte in packet:
+            while time.monotonic() < deadline:
+                pass
+            os.write(self.fd, bytes([byte]))
+            deadline += byte_time
+
+    def _reply(self, servo, error, params, delay=None):
+        self._send(status_packet(servo.id, error, params), servo.return_delay if delay is None else delay)
+
+    def step(self):
+        now = time.monotonic()
+        for servo in self.servos.values():
+            servo.step(now - self.last_step)
+        self.last_step = now
+
+    def feed(self, data):
+        self.rx += data
+        while True:
+            start = self.rx.find(HEADER)
+            if start < 0:
+                del self.rx[:-3]
+                return
+            del self.rx[:start]
+            if len(self.rx) < 7:
+                return
+            total = 7 + u16(self.rx, 5)
+            if len(self.rx) < total:
+                return
+            packet = bytes(self.rx[:total])
+            del self.rx[:total]
+            if crc16(packet[:-2]) != u16(packet, total - 2):
+                if self.verbose:
+                    print("crc error", packet.hex(" "), file=sys.stderr)
+                continue
+            self.step()
+            self.handle(packet[4], packet[7], packet[8:-2])
+
+    def handle(self, servo_id, ins, params):
+        if self.verbose:
+            print(f"id {servo_id} ins 0x{ins:02x} {params.hex(' ')}", file=sys.stderr)
+
+        if ins in (INS_SYNC_READ, INS_FAST_SYNC_READ, INS_SYNC_WRITE, INS_BULK_READ):
+            if servo_id == BROADCAST_ID:
+                getattr(self, f"_ins_0x{ins:02x}")(params)
+            return
+
+        if servo_id == BROADCAST_ID:
+            targets = sorted(self.servos.values(), key=lambda s: s.id)
+        elif servo_id in self.servos:
+            targets = [self.servos[servo_id]]
+        else:
+            return
+
+        for servo in targets:
+            if ins == INS_PING:
+                self._reply(servo, 0, MODEL_NUMBER.to_bytes(2, "little") + bytes([FIRMWARE_VERSION]))
+            elif ins == INS_READ and len(params) == 4:
+                error, data = servo.read(u16(params, 0), u16(params, 2))
+                if servo_id != BROADCAST_ID:
+                    self._reply(servo, error, data)
+            elif ins == INS_WRITE and len(params) >= 2:
+                error = servo.write(u16(params, 0), params[2:])
+                if servo_id != BROADCAST_ID:
+                    self._reply(servo, error, b"")
+            elif servo_id != BROADCAST_ID:
+                self._reply(servo, ERR_INSTRUCTION if ins not in (INS_READ, INS_WRITE) else ERR_DATA_LENGTH, b"")
+
+    # Sync Read: [ADDR LEN ID...], one status per listed servo, in order
+    def _ins_0x82(self, params):
+        addr, length = u16(params, 0), u16(params, 2)
+        for servo_id in params[4:]:
+            servo = self.servos.get(servo_id)
+            if servo is not None:
+                self._reply(servo, *servo.read(addr, length))
+
+    # Fast Sync Read: as Sync Read, answered by one status holding
+    # [ERR ID DATA CRC] per servo, the last CRC being the packet's
+    def _ins_0x8a(self, params):
+        addr, length = u16(params, 0), u16(params, 2)
+        servos = [self.servos[i] for i in params[4:] if i in self.servos]
+        if len(servos) != len(params[4:]) or not servos:
+            return  # a missing servo breaks the chain: no reply at all
+        body = HEADER + bytes([BROADCAST_ID]) + (1 + len(servos) * (length + 4)).to_bytes(2, "little")
+        body += bytes([INS_STATUS])
+        for servo in servos:
+            error, data = servo.read(addr, length)
+            body += bytes([error, servo.id]) + data.ljust(length, b"\0")
+            body += crc16(body).to_bytes(2, "little")
+        delay = sum(s.return_delay for s in servos)
+        self._send(body, delay)
+
+    # Sync Write: [ADDR LEN (ID DATA)...], no status
+    def _ins_0x83(self, params):
+        addr, length = u16(params, 0), u16(params, 2)
+        for pos in range(4, len(params) - length, length + 1):
+            servo = self.servos.get(params[pos])
+            if servo is not None:
+                servo.write(addr, params[pos + 1:pos + 1 + length])
+
+    # Bulk Read: [(ID ADDR LEN)...], one status per listed servo, in order
+    def _ins_0x92(self, params):
+        for pos in range(0, len(params) - 4, 5):
+            servo = self.servos.get(params[pos])
+            if servo is not None:
+                self._reply(servo, *servo.read(u16(params, pos + 1), u16(params, pos + 3)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--link", default="/dev/ttySIM0",
+                        help="symlink to the pty, the sim's CONFIG_SIM_UART0_NAME (default %(default)s)")
+    parser.add_argument("--ids", type=int, nargs="+", default=[1, 2],
+                        help="servo IDs on the bus (default %(default)s)")
+    parser.add_argument("--baud", type=int, default=57600,
+                        help="bus baud rate used for byte pacing (default %(default)s)")
+    parser.add_argument("--return-delay-us", type=int, default=250,
+                        help="Return Delay Time of every servo [us] (default %(default)s, the servo default)")
+    parser.add_argument("-v", "--verbose", action="store_true", help="log every instruction packet")
+    args = parser.parse_args()
+
+    master, slave = pty.openpty()
+    tty.setraw(slave)
+    attrs = termios.tcgetattr(slave)
+    attrs[3] &= ~termios.ECHO
+    termios.tcsetattr(slave, termios.TCSANOW, attrs)
+    slave_name = os.ttyname(slave)
+
+    if os.path.lexists(args.link):
+        os.unlink(args.link)
+    os.symlink(slave_name, args.link)
+    print(f"{args.link} -> {slave_name}: IDs {args.ids}, {args.baud} bps, "
+          f"return delay {args.return_delay_us} us")
+
+    bus = Bus(master, [Servo(i, args.return_delay_us) for i in args.ids], args.baud, args.verbose)
+    try:
+        while True:
+            ready, _, _ = select.select([master], [], [], 0.01)
+            if ready:
+                try:
+                    bus.feed(os.read(master, 4096))
+                except OSError:
+                    # The sim closed the port; the pty stays until it reopens
+                    time.sleep(0.1)
+            else:
+                bus.step()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        os.unlink(args.link)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,185 @@
+#ifndef __ASR_SDM_DRIVERS_DYNAMIXEL_H
+#define __ASR_SDM_DRIVERS_DYNAMIXEL_H
+
+#include <nuttx/config.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* Character device registered by dynamixel_register_device() */
+#define DXL_DEVICE_PATH "/dev/dynamixel"
+
+/* Special IDs */
+#define DXL_BROADCAST_ID 0xFE
+
+/* Status timeout used by the ioctls and by batch ops with timeout_ms == 0 */
+#define DXL_DEFAULT_TIMEOUT_MS 500
+
+/* Per-transaction timing: log2 histograms of the transmit phase (first byte
+ * queued to bus released) and of the round trip (to the last status byte).
+ * Bucket 0 counts times below 32 us, bucket i times in [2^(i+4), 2^(i+5)) us,
+ * and the last bucket everything longer.
+ */
+#define DXL_TIMING_BUCKETS 12
+
+struct dxl_timing_s
+{
+    uint32_t count;                          /* completed transactions */
+    uint32_t timeouts;                       /* transactions without a status */
+    uint32_t tx_max_us;
+    uint32_t rtt_max_us;
+    uint32_t tx_hist[DXL_TIMING_BUCKETS];
+    uint32_t rtt_hist[DXL_TIMING_BUCKETS];
+};
+
+/* One servo of a multi-servo read. Sync reads take address and length from
+ * the request; bulk reads take them from each slot.
+ */
+struct dxl_read_slot_s
+{
+    uint8_t  id;
+    uint8_t  error;       /* out: ERROR byte of this servo's status */
+    uint16_t address;     /* bulk read only */
+    uint16_t length;      /* bulk read only */
+    int16_t  result;      /* out: 0, -EIO if error != 0, -ETIMEDOUT, ... */
+    FAR uint8_t *data;    /* out: length bytes */
+};
+
+/* One queued bus operation for DXL_IOCTL_SUBMIT / dxl_submit() */
+enum dxl_op_e
+{
+    DXL_OP_PING = 0,
+    DXL_OP_READ,
+    DXL_OP_WRITE,
+    DXL_OP_SYNC_WRITE,
+    DXL_OP_SYNC_READ,      /* one status per servo, in slot order */
+    DXL_OP_BULK_READ,      /* as SYNC_READ, address/length per slot */
+    DXL_OP_FAST_SYNC_READ  /* one combined status for all servos */
+};
+
+struct dxl_op_s
+{
+    uint8_t  type;        /* enum dxl_op_e */
+    uint8_t  id;          /* servo ID (ignored by SYNC_WRITE, always broadcast) */
+    uint8_t  error;       /* out: ERROR byte of the status packet */
+    uint16_t address;     /* control table address (READ, WRITE, SYNC_WRITE) */
+    uint16_t length;      /* READ/WRITE: bytes at address; SYNC_WRITE: bytes per servo;
+                           * PING: size of data (model number L/H, firmware version) */
+    uint16_t data_len;    /* SYNC_WRITE: bytes at data, (1 + length) per servo */
+    uint16_t timeout_ms;  /* status timeout, 0 -> DXL_DEFAULT_TIMEOUT_MS;
+                           * multi-servo reads: per status packet */
+    FAR uint8_t *data;    /* READ/PING: filled in; WRITE: length bytes;
+                           * SYNC_WRITE: ID followed by length bytes, per servo */
+    FAR struct dxl_read_slot_s *slots; /* SYNC/BULK/FAST_SYNC_READ: per-servo results */
+    uint8_t  nslots;
+    int16_t  result;      /* out: 0, -EIO if error != 0, -ETIMEDOUT, ...;
+                           * multi-servo reads: the first failing slot's result */
+};
+
+/* Stop at the first failing op instead of running the rest of the batch */
+#define DXL_BATCH_STOP_ON_ERROR 0x01
+
+struct dxl_ioctl_batch_s
+{
+    FAR struct dxl_op_s *ops;
+    uint16_t count;
+    uint8_t  flags;       /* DXL_BATCH_* */
+    uint16_t completed;   /* out: ops executed (each has its result set) */
+};
+
+/* Single-operation ioctl arguments */
+struct dxl_ioctl_ping_s
+{
+    uint8_t id;
+    uint8_t err;
+    uint8_t params[64];
+    uint16_t params_len;
+};
+
+struct dxl_ioctl_read_s
+{
+    uint8_t id;
+    uint16_t address;
+    uint16_t length;
+    uint8_t data[256];
+};
+
+struct dxl_ioctl_write_s
+{
+    uint8_t id;
+    uint16_t address;
+    uint16_t length;
+    uint8_t data[256];
+};
+
+struct dxl_ioctl_sync_write_s
+{
+    uint16_t address;
+    uint16_t data_len;
+    uint8_t payload[512];
+    size_t payload_len;
+};
+
+/* DXL_IOCTL_SYNC_READ, _BULK_READ and _FAST_SYNC_READ */
+struct dxl_ioctl_multi_read_s
+{
+    uint16_t address;     /* sync reads only */
+    uint16_t length;      /* sync reads only */
+    uint16_t timeout_ms;  /* per status packet, 0 -> DXL_DEFAULT_TIMEOUT_MS */
+    uint8_t  count;
+    FAR struct dxl_read_slot_s *slots;
+};
+
+struct dxl_ioctl_timing_s
+{
+    uint8_t reset; /* clear the histograms after copying them */
+    struct dxl_timing_s timing;
+};
+
+/* IOCTL command definitions. DXL_IOCTL_SUBMIT runs every op of a
+ * struct dxl_ioctl_batch_s back to back under one bus lock and returns 0 if
+ * all succeeded, otherwise the result of the first that failed. The
+ * multi-servo reads set a result per slot and return the same way.
+ */
+#define DXL_IOCTL_PING           0x2001
+#define DXL_IOCTL_READ           0x2002
+#define DXL_IOCTL_WRITE          0x2003
+#define DXL_IOCTL_SYNC_WRITE     0x2004
+#define DXL_IOCTL_GET_TIMING     0x2005
+#define DXL_IOCTL_SUBMIT         0x2006
+#define DXL_IOCTL_SYNC_READ      0x2007
+#define DXL_IOCTL_BULK_READ      0x2008
+#define DXL_IOCTL_FAST_SYNC_READ 0x2009
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct file;
+
+/* Board hooks (weak defaults in dynamixel_protocol2.c) */
+void dxl_hw_set_de(bool enable);
+int dxl_hw_uart_open(FAR struct file *filep, FAR const char *devpath);
+
+int dxl_init_with_uart(FAR const char *uart_dev);
+int dxl_deinit(void);
+int dxl_ping(uint8_t id, FAR uint8_t *err, FAR uint8_t *params, FAR uint16_t *params_len, unsigned int timeout_ms);
+int dxl_read(uint8_t id, uint16_t address, uint16_t length, FAR uint8_t *out_buf, unsigned int timeout_ms);
+int dxl_write(uint8_t id, uint16_t address, FAR const uint8_t *data, uint16_t data_len, unsigned int timeout_ms);
+int dxl_sync_write(uint16_t address, uint16_t data_len, FAR const uint8_t *id_and_data, size_t id_and_data_len);
+int dxl_sync_read(uint16_t address, uint16_t length, FAR struct dxl_read_slot_s *slots, uint8_t count,
+                  unsigned int timeout_ms);
+int dxl_bulk_read(FAR struct dxl_read_slot_s *slots, uint8_t count, unsigned int timeout_ms);
+int dxl_fast_sync_read(uint16_t address, uint16_t length, FAR struct dxl_read_slot_s *slots, uint8_t count,
+                       unsigned int timeout_ms);
+int dxl_submit(FAR struct dxl_op_s *ops, uint16_t count, uint8_t flags, FAR uint16_t *completed);
+int dxl_get_timing(FAR struct dxl_timing_s *out, bool reset);
+
+int dynamixel_register_device(FAR const char *uart_dev);
+int dynamixel_unregister_device(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ASR_SDM_DRIVERS_DYNAMIXEL_H */
@@ -1,24 +1,40 @@
-/*
- * dynamixel_protocol2.c
+/****************************************************************************
+ * asr_sdm_drivers/dynamixel/dynamixel_protocol2.c
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
  *
- * DYNAMIXEL Protocol 2.0 driver skeleton for NuttX (half-duplex UART/RS485).
+ *   http://www.apache.org/licenses/LICENSE-2.0
  *
- * Features provided in this skeleton:
- *  - Packet builder / parser for Protocol 2.0 (Instruction / Status packets)
- *  - CRC-16 implementation matching Robotis specification (polynomial 0x8005)
- *  - Basic synchronous send/receive with DE/RE control pin callbacks (board-provided)
- *  - Convenience APIs: ping, read, write, reset, sync_write (skeleton)
- *  - A simple character-device wrapper (/dev/dynamixel) that user code can
- *    open() and issue ioctls to send commands to servos.
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/*
+ * DYNAMIXEL Protocol 2.0 driver for NuttX on a half-duplex UART/RS-485 bus.
  *
- * IMPORTANT: This is a portable, well-documented skeleton. You MUST adapt the
- * low-level UART open/read/write and GPIO DE/RE control callbacks to match
- * your board's NuttX API. The file contains CLEAR TODO markers where changes
- * are required.
+ * What this driver provides:
+ *  - Instruction packet builder and status packet parser, with the Robotis
+ *    CRC-16 (polynomial 0x8005).
+ *  - Ping, read, write, sync write and sync, fast sync and bulk read, each
+ *    as one transaction under the bus lock.
+ *  - A character driver (/dev/dynamixel) whose ioctls run single commands
+ *    or a whole batch of queued reads/writes under one bus lock, with
+ *    per-transaction timing statistics.
+ *  - Direction control by the UART (TIOCSRS485) or by the board's
+ *    dxl_hw_set_de() hook with Kconfig setup and hold times.
  *
- * License: BSD-3-Clause (suggested)
- * Author: ChatGPT (skeleton)
- * Date: 2025-10-06
+ * Board code may override the weak dxl_hw_set_de() and dxl_hw_uart_open()
+ * below; the defaults suit a transceiver that switches direction by itself
+ * and a /dev/ttySx that accepts the termios ioctls.
  */
 
 #include <nuttx/config.h>
@@ -26,24 +42,36 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
-#include <stdlib.h>
-#include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
-#include <pthread.h>
-#include <semaphore.h>
 #include <termios.h>
 #include <time.h>
 #include <syslog.h>
-
-/* Device path for the char device we will register */
-#define DXL_DEVICE_PATH "/dev/dynamixel"
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/mutex.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/serial/tioctl.h>
+
+#include "dynamixel.h"
+
+/* Guard times around the software DE switch (microseconds, see Kconfig) */
+#ifndef CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_DE_SETUP_US
+#define CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_DE_SETUP_US 0
+#endif
+#ifndef CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_DE_HOLD_US
+#define CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_DE_HOLD_US 0
+#endif
 
 /* Default UART device to open if board bringup doesn't provide one */
 #define DXL_DEFAULT_UART "/dev/ttyS1"
+#define DXL_DEFAULT_BAUD 57600
+#define DXL_DEFAULT_BAUD_CODE B57600
 
 /* Packet constants for Protocol 2.0 */
 #define DXL_HEADER0 0xFF
@@ -51,6 +79,21 @@
 #define DXL_HEADER2 0xFD
 #define DXL_RESERVED 0x00
 
+/* Bytes up to and including LEN_H; LENGTH counts everything after them */
+#define DXL_HEADER_LEN 7
+/* Smallest status packet: header + ERR + CRC(2) after the instruction byte */
+#define DXL_STATUS_MIN_LEN 11
+/* Parameters follow the header and instruction byte */
+#define DXL_PARAM_OFFSET 8
+/* Header, instruction and CRC around the parameters of a packet */
+#define DXL_PACKET_OVERHEAD 10
+
+/* Size of each of the preallocated TX and RX packet buffers (see Kconfig) */
+#ifndef CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_BUFSIZE
+#define CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_BUFSIZE 528
+#endif
+#define DXL_MAX_PARAMS (CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_BUFSIZE - DXL_PACKET_OVERHEAD)
+
 /* Instruction packet types (Protocol 2.0) */
 enum dxl_instruction_e
 {
@@ -64,13 +107,11 @@ enum dxl_instruction_e
     DXL_INS_STATUS = 0x55,
     DXL_INS_SYNC_READ = 0x82,
     DXL_INS_SYNC_WRITE = 0x83,
+    DXL_INS_FAST_SYNC_READ = 0x8A,
     DXL_INS_BULK_READ = 0x92,
     DXL_INS_BULK_WRITE = 0x93
 };
 
-/* Special IDs */
-#define DXL_BROADCAST_ID 0xFE
-
 /* CRC-16 table for polynomial 0x8005 (Robotis spec) */
 static const uint16_t dxl_crc_table[256] = {
     0x0000, 0x8005, 0x800F, 0x000A, 0x801B, 0x001E, 0x0014, 0x8011,
@@ -123,103 +164,93 @@ static uint16_t dxl_update_crc(uint16_t crc_accum, const uint8_t *data_blk_ptr,
  * driver must enable the transmitter (DE high). After sending it must wait
  * for the bytes to be transmitted and then re-enable receiver (DE low).
  *
- * Provide two callbacks below from board-specific bringup code:
+ * Board bringup may replace the two weak hooks below with non-weak ones:
  *   void dxl_hw_set_de(bool enable);     // control driver-enable GPIO
- *   int  dxl_hw_uart_open(const char *devpath); // open and return fd
+ *   int  dxl_hw_uart_open(FAR struct file *filep, const char *devpath);
  *
- * If your platform uses NuttX serial driver internals instead of open/termios
- * you can adapt the send/recv functions in this file accordingly.
+ * The UART is held as a kernel struct file (file_open/file_read/...) rather
+ * than a file descriptor: descriptors belong to the task group that opened
+ * them, while the ioctls below run in whichever task calls them.
  */
 
-/* Weak defaults so code compiles; override these in board bringup by
- * providing non-weak implementations that call your actual GPIO/UART APIs.
+/* Driver-enable hook, called around every transmission unless the UART
+ * does RS-485 direction control itself (CONFIG_..._DYNAMIXEL_HW_RS485 and
+ * TIOCSRS485 accepted).  'enable' true must switch the transceiver to
+ * transmit and false back to receive; dxl_uart_send() adds the DE setup
+ * time after true and waits for the last byte to leave the UART plus the
+ * DE hold time before false.  It runs in the caller's thread with the bus
+ * lock held, so a GPIO write is all it should do.  The default does
+ * nothing, for transceivers that switch direction on their own.
  */
 
 __attribute__((weak)) void dxl_hw_set_de(bool enable)
 {
-    /* TODO: implement on your board. Must assert (true) to enable tx driver,
-     * and de-assert (false) to enable receive. If you don't use RS485 driver
-     * enable pin, leave this empty.
-     */
     (void)enable;
 }
 
-__attribute__((weak)) int dxl_hw_uart_open(const char *devpath)
+__attribute__((weak)) int dxl_hw_uart_open(FAR struct file *filep, FAR const char *devpath)
 {
-    /* Default implementation uses termios open of /dev/ttySx. This works in
-     * many NuttX userspace builds. If you are writing a kernel driver, please
-     * replace the uart calls with appropriate NuttX serial driver APIs.
+    /* Default implementation opens /dev/ttySx non-blocking and sets it raw at
+     * the default baud through the TCGETS/TCSETS ioctls (what tcgetattr and
+     * tcsetattr do for a descriptor).
      */
-    int fd = open(devpath, O_RDWR | O_NOCTTY | O_NONBLOCK);
-    if (fd < 0)
-        return -errno;
+    int ret = file_open(filep, devpath, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (ret < 0)
+        return ret;
 
     struct termios tio;
-    if (tcgetattr(fd, &tio) != 0)
+    ret = file_ioctl(filep, TCGETS, (unsigned long)&tio);
+    if (ret < 0)
     {
-        close(fd);
-        return -errno;
+        file_close(filep);
+        return ret;
     }
 
     cfmakeraw(&tio);
-    cfsetispeed(&tio, B57600);
-    cfsetospeed(&tio, B57600);
+    cfsetispeed(&tio, DXL_DEFAULT_BAUD_CODE);
+    cfsetospeed(&tio, DXL_DEFAULT_BAUD_CODE);
     tio.c_cflag |= CREAD | CLOCAL;
     tio.c_cflag &= ~CSIZE;
     tio.c_cflag |= CS8;
-    tcsetattr(fd, TCSANOW, &tio);
+    file_ioctl(filep, TCSETS, (unsigned long)&tio);
 
-    return fd;
+    return OK;
 }
 
 /* --------- Packet helpers --------- */
 
-/* Build an instruction packet. Parameters:
- *  - id: 0x00-0xFD: servo ID (0xFE is broadcast)
- *  - instruction: instruction code
- *  - params: pointer to params
- *  - params_len: number of param bytes
- *  - out: buffer to receive packet. Must be large enough (params_len + 11)
- * Returns total packet length on success.
+/* Instruction packets are built in place in the transmit buffer:
+ * dxl_packet_begin() writes the header, ID and instruction and returns where
+ * the parameters go, the caller writes them there directly, and
+ * dxl_packet_finish() fills LENGTH and the CRC. 'out' must hold
+ * DXL_PACKET_OVERHEAD + params_len bytes.
  */
-static ssize_t dxl_make_packet(uint8_t id, uint8_t instruction,
-                               const uint8_t *params, uint16_t params_len,
-                               uint8_t *out, size_t outlen)
+static uint8_t *dxl_packet_begin(uint8_t *out, uint8_t id, uint8_t instruction)
 {
-    size_t pkt_len = 0;
-    uint16_t crc;
-
-    if (outlen < (size_t)(11 + params_len))
-        return -ENOMEM;
-
-    out[pkt_len++] = DXL_HEADER0;
-    out[pkt_len++] = DXL_HEADER1;
-    out[pkt_len++] = DXL_HEADER2;
-    out[pkt_len++] = DXL_RESERVED;
-    out[pkt_len++] = id;
+    out[0] = DXL_HEADER0;
+    out[1] = DXL_HEADER1;
+    out[2] = DXL_HEADER2;
+    out[3] = DXL_RESERVED;
+    out[4] = id;
+    out[7] = instruction;
+    return &out[DXL_PARAM_OFFSET];
+}
 
-    /* length = LEN_L, LEN_H where LEN = (instruction + params + CRC(2)) + 1?
-     * According to protocol 2.0: Length = Parameter length + 3 (Instruction + CRC(2) + ???)
-     * Standard definition: LENGTH = (parameter length) + 3 (Instruction(1) + CRC(2)).
-     */
+/* Returns the total packet length */
+static size_t dxl_packet_finish(uint8_t *out, uint16_t params_len)
+{
+    /* LENGTH = parameter length + 3 (Instruction(1) + CRC(2)) */
     uint16_t length = (uint16_t)(params_len + 3);
-    out[pkt_len++] = (uint8_t)(length & 0xFF);        /* LEN_L */
-    out[pkt_len++] = (uint8_t)((length >> 8) & 0xFF); /* LEN_H */
-
-    out[pkt_len++] = instruction;
-
-    if (params_len > 0 && params != NULL)
-    {
-        memcpy(&out[pkt_len], params, params_len);
-        pkt_len += params_len;
-    }
+    out[5] = (uint8_t)(length & 0xFF);        /* LEN_L */
+    out[6] = (uint8_t)((length >> 8) & 0xFF); /* LEN_H */
 
     /* Compute CRC on all bytes from 0xFF 0xFF 0xFD ... ID ... LEN_L LEN_H INST PARAMS */
-    crc = dxl_update_crc(0, out, (uint16_t)pkt_len);
+    size_t pkt_len = DXL_PARAM_OFFSET + params_len;
+    uint16_t crc = dxl_update_crc(0, out, (uint16_t)pkt_len);
     out[pkt_len++] = (uint8_t)(crc & 0xFF);        /* CRC_L */
     out[pkt_len++] = (uint8_t)((crc >> 8) & 0xFF); /* CRC_H */
 
-    return (ssize_t)pkt_len;
+    return pkt_len;
 }
 
 /* Parse a status packet in 'buf' of length 'len'. On success fills out
@@ -230,7 +261,7 @@ static int dxl_parse_status_packet(const uint8_t *buf, size_t len,
                                    uint8_t *out_id, uint8_t *out_error,
                                    const uint8_t **out_params, uint16_t *out_params_len)
 {
-    if (len < 11) /* minimum length */
+    if (len < DXL_STATUS_MIN_LEN)
         return -EINVAL;
 
     if (buf[0] != DXL_HEADER0 || buf[1] != DXL_HEADER1 || buf[2] != DXL_HEADER2)
@@ -238,14 +269,16 @@ static int dxl_parse_status_packet(const uint8_t *buf, size_t len,
 
     uint8_t id = buf[4];
     uint16_t length = (uint16_t)buf[5] | ((uint16_t)buf[6] << 8);
-    /* length includes instruction/error + params + CRC(2) */
-    size_t expected_len = 7 + length; /* header(4)+ID+LEN_L+LEN_H + length */
+    /* length includes instruction(0x55) + error + params + CRC(2) */
+    size_t expected_len = DXL_HEADER_LEN + length; /* header(4)+ID+LEN_L+LEN_H + length */
+    if (length < 4 || buf[7] != DXL_INS_STATUS)
+        return -EINVAL;
     if (len < expected_len)
         return -EAGAIN; /* partial packet */
 
-    uint8_t error = buf[7];
-    uint16_t params_len = (uint16_t)(length - 3); /* remove Instruction(1) + CRC(2) */
-    const uint8_t *params = &buf[8];
+    uint8_t error = buf[8];
+    uint16_t params_len = (uint16_t)(length - 4); /* remove Instruction(1) + Error(1) + CRC(2) */
+    const uint8_t *params = &buf[9];
 
     /* Validate CRC */
     uint16_t crc_calc = dxl_update_crc(0, buf, (uint16_t)(expected_len - 2));
@@ -270,136 +303,304 @@ static int dxl_parse_status_packet(const uint8_t *buf, size_t len,
 /* Structure holding driver state */
 struct dxl_dev_s
 {
-    int uart_fd;
-    pthread_mutex_t lock; /* serialises access */
+    struct file uart;
+    bool uart_open;
+    mutex_t lock;         /* serialises bus transactions */
+    bool hw_rs485;        /* UART drives DE itself (TIOCSRS485 accepted) */
+    uint32_t char_us;     /* one character (10 bits) on the wire */
+    struct dxl_timing_s timing;
+
+    /* Packet buffers, used under lock, so that no transaction needs them on
+     * the caller's stack
+     */
+    uint8_t tx[CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_BUFSIZE];
+    uint8_t rx[CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_BUFSIZE];
 };
 
-static struct dxl_dev_s g_dxl = {
-    .uart_fd = -1};
+static struct dxl_dev_s g_dxl;
+
+/* Microsecond timestamps for the histogram. The cycle counter is used when
+ * the architecture provides one; CLOCK_MONOTONIC is only as fine as the
+ * system tick unless the tickless/high-resolution timer is enabled.
+ */
+static uint64_t dxl_now_us(void)
+{
+#ifdef CONFIG_ARCH_PERF_EVENTS
+    static uint32_t last_cycles;
+    static uint64_t us, rem;
+    uint32_t cycles = (uint32_t)up_perf_gettime();
+    uint64_t delta = (uint64_t)(uint32_t)(cycles - last_cycles) * 1000000ull + rem;
+    unsigned long freq = up_perf_getfreq();
+    last_cycles = cycles;
+    us += delta / freq;
+    rem = delta % freq;
+    return us;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000ull + (uint64_t)now.tv_nsec / 1000u;
+#endif
+}
+
+static void dxl_timing_add(uint32_t *hist, uint32_t *max, uint32_t us)
+{
+    int bucket = 0;
+    while (bucket < DXL_TIMING_BUCKETS - 1 && us >= (32u << bucket))
+        bucket++;
+    hist[bucket]++;
+    if (us > *max)
+        *max = us;
+}
+
+/* Sleep until the UART reports one of 'events' or wait_ms passes. There is
+ * no poll() for a struct file, so the serial driver's poll slot is set up
+ * directly and poll_default_cb() posts the semaphore. Returns 0 on timeout,
+ * > 0 when ready or a negative errno.
+ */
+static int dxl_uart_wait(pollevent_t events, unsigned int wait_ms)
+{
+    struct pollfd fds;
+    sem_t sem;
+    clock_t ticks = MSEC2TICK(wait_ms);
+
+    nxsem_init(&sem, 0, 0);
+    memset(&fds, 0, sizeof(fds));
+    fds.events = events;
+    fds.arg = &sem;
+    fds.cb = poll_default_cb;
+
+    int ret = file_poll(&g_dxl.uart, &fds, true);
+    if (ret >= 0)
+    {
+        ret = 1;
+        if (fds.revents == 0)
+            ret = nxsem_tickwait(&sem, ticks > 0 ? ticks : 1);
+        file_poll(&g_dxl.uart, &fds, false);
+    }
+    nxsem_destroy(&sem);
+    if (ret == -ETIMEDOUT)
+        return 0;
+    return ret < 0 ? ret : 1;
+}
+
+/* Queue all of buf on the non-blocking UART, waiting for room if the serial
+ * TX buffer is smaller than the packet.
+ */
+static int dxl_write_all(const uint8_t *buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t w = file_write(&g_dxl.uart, buf, len);
+        if (w > 0)
+        {
+            buf += w;
+            len -= (size_t)w;
+            continue;
+        }
+        if (w < 0 && w != -EAGAIN && w != -EINTR)
+            return (int)w;
+        int ret = dxl_uart_wait(POLLOUT, 100);
+        if (ret == 0)
+            return -ETIMEDOUT;
+        if (ret < 0 && ret != -EINTR)
+            return ret;
+    }
+    return 0;
+}
 
-/* Send raw bytes on UART using DE control for RS485. This is blocking and
- * waits until the bytes are written. Returns 0 on success or negative errno.
+/* Send raw bytes on the half-duplex bus. With hardware RS-485 control the
+ * UART raises and drops DE itself, so the bytes are only queued. Otherwise DE
+ * is driven through dxl_hw_set_de(): raised a configurable setup time before
+ * the first byte and dropped once tcdrain() reports the TX buffer empty plus
+ * one character time (the last byte may still be in the shift register when
+ * the FIFO reports empty) and a configurable hold time. Returns 0 on success
+ * or negative errno.
  */
 static int dxl_uart_send(const uint8_t *buf, size_t len)
 {
-    if (g_dxl.uart_fd < 0)
+    if (!g_dxl.uart_open)
         return -ENODEV;
 
-    /* Enable driver */
+    if (g_dxl.hw_rs485)
+        return dxl_write_all(buf, len);
+
     dxl_hw_set_de(true);
-    usleep(1000); /* small settle time; adjust if needed */
+    if (CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_DE_SETUP_US > 0)
+        up_udelay(CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_DE_SETUP_US);
 
-    ssize_t w = write(g_dxl.uart_fd, buf, len);
-    if (w < 0)
+    int ret = dxl_write_all(buf, len);
+    if (ret == 0)
     {
-        dxl_hw_set_de(false);
-        return -errno;
+        file_ioctl(&g_dxl.uart, TCDRN, 0);
+        up_udelay(g_dxl.char_us + CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_DE_HOLD_US);
     }
 
-    /* Wait for physical transmission to finish. If termios supports TCSADRAIN
-     * or tcdrain, call it. tcdrain waits until output has been transmitted.
-     */
-    tcdrain(g_dxl.uart_fd);
-
     /* Disable driver to enable receive */
     dxl_hw_set_de(false);
-    return 0;
+    return ret;
 }
 
-/* Receive bytes from UART into buf up to maxlen or until timeout (ms). Returns
- * number of bytes read or negative errno.
+/* Milliseconds left until 'deadline', rounded up so a wait never returns
+ * before it; 0 once the deadline has passed.
+ */
+static int dxl_ms_until(const struct timespec *deadline)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t ns = (int64_t)(deadline->tv_sec - now.tv_sec) * 1000000000LL + (deadline->tv_nsec - now.tv_nsec);
+    if (ns <= 0)
+        return 0;
+    return (int)((ns + 999999) / 1000000);
+}
+
+/* Drop bytes in front of the first (possibly partial) FF FF FD header so
+ * that buf starts at a candidate packet. Returns the remaining length.
+ */
+static size_t dxl_frame_sync(uint8_t *buf, size_t len)
+{
+    static const uint8_t header[3] = {DXL_HEADER0, DXL_HEADER1, DXL_HEADER2};
+    size_t start = 0;
+    while (start < len)
+    {
+        size_t n = (len - start < sizeof(header)) ? len - start : sizeof(header);
+        if (memcmp(&buf[start], header, n) == 0)
+            break;
+        start++;
+    }
+    if (start > 0)
+        memmove(buf, &buf[start], len - start);
+    return len - start;
+}
+
+/* Receive one status packet into buf. The header and LENGTH are read first,
+ * then the rest of the packet in a single read, sleeping in dxl_uart_wait()
+ * between arrivals until an absolute deadline 'timeout_ms' from now. Noise in front
+ * of the header is skipped, and so is an instruction packet (the local echo
+ * on adapters that loop TX back to RX). Returns the packet length as soon as
+ * the packet is complete (the caller checks the CRC), or -ETIMEDOUT.
  */
 static ssize_t dxl_uart_recv(uint8_t *buf, size_t maxlen, unsigned int timeout_ms)
 {
-    if (g_dxl.uart_fd < 0)
+    if (!g_dxl.uart_open)
         return -ENODEV;
+    if (maxlen < DXL_STATUS_MIN_LEN)
+        return -EINVAL;
 
-    size_t idx = 0;
-    struct timespec ts_start, ts_now;
-    clock_gettime(CLOCK_MONOTONIC, &ts_start);
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
 
-    while (idx < maxlen)
+    size_t idx = 0;
+    size_t need = DXL_HEADER_LEN;
+    for (;;)
     {
-        uint8_t b;
-        ssize_t r = read(g_dxl.uart_fd, &b, 1);
-        if (r == 1)
-        {
-            buf[idx++] = b;
-            /* Heuristic: if we've read header and length, we can determine expected
-             * total and stop when complete. We'll let higher layer parse.
-             */
-            continue;
-        }
-        else if (r == 0)
-        {
-            /* no data; check timeout */
-        }
-        else
+        ssize_t r = file_read(&g_dxl.uart, &buf[idx], need - idx);
+        if (r > 0)
         {
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            idx = dxl_frame_sync(buf, idx + (size_t)r);
+            if (idx < DXL_HEADER_LEN)
             {
-                /* check timeout */
+                need = DXL_HEADER_LEN;
+                continue;
             }
-            else
+
+            uint16_t length = (uint16_t)buf[5] | ((uint16_t)buf[6] << 8);
+            size_t total = DXL_HEADER_LEN + (size_t)length;
+            if (length < 3 || total > maxlen)
             {
-                return -errno;
+                /* Not a plausible packet: resynchronise after this header */
+                memmove(buf, &buf[1], idx - 1);
+                idx = dxl_frame_sync(buf, idx - 1);
+                need = DXL_HEADER_LEN;
+                continue;
             }
-        }
-
-        clock_gettime(CLOCK_MONOTONIC, &ts_now);
-        long elapsed_ms = (ts_now.tv_sec - ts_start.tv_sec) * 1000L + (ts_now.tv_nsec - ts_start.tv_nsec) / 1000000L;
-        if (elapsed_ms > (long)timeout_ms)
-            break;
+            need = total;
+            if (idx < total)
+                continue; /* read the remainder straight away if it is there */
 
-        usleep(1000);
+            if (buf[7] != DXL_INS_STATUS)
+            {
+                /* Our own instruction echoed back: wait for the status */
+                idx = 0;
+                need = DXL_HEADER_LEN;
+                continue;
+            }
+            return (ssize_t)total;
+        }
+        if (r < 0 && r != -EAGAIN && r != -EINTR)
+            return r;
+
+        int wait_ms = dxl_ms_until(&deadline);
+        if (wait_ms == 0)
+            return -ETIMEDOUT;
+        int ret = dxl_uart_wait(POLLIN, (unsigned int)wait_ms);
+        if (ret < 0 && ret != -EINTR)
+            return ret;
     }
-
-    return (ssize_t)idx;
 }
 
-/* High-level send-instruction and wait for status packet. If id is broadcast,
- * no status will be returned (per Robotis). Returns 0 on success, and if
- * status is requested fills error & params. On bus errors returns negative.
+/* Send the instruction packet prepared in g_dxl.tx with dxl_packet_begin()
+ * and wait for its status packet. If the ID is broadcast, no status will be
+ * returned (per Robotis). Returns 0 on success, and if status is requested
+ * fills error & params. On bus errors returns negative. The caller holds
+ * g_dxl.lock.
+ */
+/* Finish and send the packet in g_dxl.tx, returning when the bus is
+ * released; 't_start' and 'tx_us' are for the timing histograms.
  */
-static int dxl_send_instruction_and_wait(uint8_t id, uint8_t instruction,
-                                         const uint8_t *params, uint16_t params_len,
-                                         uint8_t *status_error, uint8_t *status_params, uint16_t *status_params_len,
-                                         unsigned int timeout_ms)
-{
-    uint8_t pkt[512];
-    ssize_t pkt_len = dxl_make_packet(id, instruction, params, params_len, pkt, sizeof(pkt));
-    if (pkt_len < 0)
-        return (int)pkt_len;
-
-    pthread_mutex_lock(&g_dxl.lock);
-    int ret = dxl_uart_send(pkt, (size_t)pkt_len);
+static int dxl_send_prepared(uint16_t params_len, uint64_t *t_start, uint32_t *tx_us)
+{
+    size_t pkt_len = dxl_packet_finish(g_dxl.tx, params_len);
+
+    /* Late bytes from an earlier transaction must not be taken for this status */
+    file_ioctl(&g_dxl.uart, TCFLSH, TCIFLUSH);
+    *t_start = dxl_now_us();
+    int ret = dxl_uart_send(g_dxl.tx, pkt_len);
+    *tx_us = (uint32_t)(dxl_now_us() - *t_start);
+    return ret;
+}
+
+static int dxl_transact(uint16_t params_len,
+                        uint8_t *status_error, uint8_t *status_params, uint16_t *status_params_len,
+                        unsigned int timeout_ms)
+{
+    uint8_t id = g_dxl.tx[4];
+    uint64_t t_start;
+    uint32_t tx_us;
+    int ret = dxl_send_prepared(params_len, &t_start, &tx_us);
     if (ret < 0)
-    {
-        pthread_mutex_unlock(&g_dxl.lock);
         return ret;
-    }
 
     /* If broadcast, don't wait for status */
     if (id == DXL_BROADCAST_ID)
     {
-        pthread_mutex_unlock(&g_dxl.lock);
+        g_dxl.timing.count++;
+        dxl_timing_add(g_dxl.timing.tx_hist, &g_dxl.timing.tx_max_us, tx_us);
+        dxl_timing_add(g_dxl.timing.rtt_hist, &g_dxl.timing.rtt_max_us, tx_us);
         return 0;
     }
 
-    /* Read bytes into rx buffer until a full packet parsed or timeout */
-    uint8_t rx[512];
-    ssize_t rx_len = dxl_uart_recv(rx, sizeof(rx), timeout_ms);
+    /* Returns as soon as one complete status packet has arrived */
+    ssize_t rx_len = dxl_uart_recv(g_dxl.rx, sizeof(g_dxl.rx), timeout_ms);
     if (rx_len < 0)
     {
-        pthread_mutex_unlock(&g_dxl.lock);
+        g_dxl.timing.timeouts += (rx_len == -ETIMEDOUT);
         return (int)rx_len;
     }
+    g_dxl.timing.count++;
+    dxl_timing_add(g_dxl.timing.tx_hist, &g_dxl.timing.tx_max_us, tx_us);
+    dxl_timing_add(g_dxl.timing.rtt_hist, &g_dxl.timing.rtt_max_us, (uint32_t)(dxl_now_us() - t_start));
 
     uint8_t parsed_id, parsed_err;
     const uint8_t *parsed_params;
     uint16_t parsed_params_len;
-    int parse_ret = dxl_parse_status_packet(rx, (size_t)rx_len, &parsed_id, &parsed_err, &parsed_params, &parsed_params_len);
-    pthread_mutex_unlock(&g_dxl.lock);
+    int parse_ret = dxl_parse_status_packet(g_dxl.rx, (size_t)rx_len, &parsed_id, &parsed_err, &parsed_params, &parsed_params_len);
 
     if (parse_ret < 0)
         return parse_ret;
@@ -415,197 +616,551 @@ static int dxl_send_instruction_and_wait(uint8_t id, uint8_t instruction,
     return 0;
 }
 
+/* Store one servo's status in its slot: -EIO for a servo error, -EIO as
+ * well when the data is not the length asked for.
+ */
+static void dxl_slot_fill(FAR struct dxl_read_slot_s *slot, uint16_t length,
+                          uint8_t error, const uint8_t *data, uint16_t data_len)
+{
+    slot->error = error;
+    if (data_len != length)
+    {
+        slot->result = -EIO;
+        return;
+    }
+    memcpy(slot->data, data, length);
+    slot->result = (error != 0) ? -EIO : 0;
+}
+
+/* Receive the replies to the Sync Read, Bulk Read or Fast Sync Read packet
+ * prepared in g_dxl.tx. Sync and bulk reads get one status per servo, in
+ * slot order; each is matched to its slot by ID and the wait for the next
+ * one restarts at every arrival, so a silent servo costs one timeout and the
+ * servos answering after it are still collected. A fast sync read gets one
+ * status holding [ERR ID DATA CRC] per servo, the last CRC being the
+ * packet's; it arrives whole or not at all. Slots left without a status get
+ * -ETIMEDOUT. Returns 0 or the first failing slot's result.
+ */
+static int dxl_multi_read(FAR struct dxl_op_s *op, uint16_t params_len)
+{
+    unsigned int timeout_ms = op->timeout_ms ? op->timeout_ms : DXL_DEFAULT_TIMEOUT_MS;
+    uint64_t t_start;
+    uint32_t tx_us;
+    uint8_t received = 0;
+    uint8_t i;
+    int ret;
+
+    for (i = 0; i < op->nslots; i++)
+    {
+        op->slots[i].error = 0;
+        op->slots[i].result = -ETIMEDOUT;
+    }
+
+    ret = dxl_send_prepared(params_len, &t_start, &tx_us);
+    if (ret < 0)
+    {
+        for (i = 0; i < op->nslots; i++)
+            op->slots[i].result = (int16_t)ret;
+        return ret;
+    }
+
+    while (received < op->nslots)
+    {
+        ssize_t rx_len = dxl_uart_recv(g_dxl.rx, sizeof(g_dxl.rx), timeout_ms);
+        if (rx_len == -ETIMEDOUT)
+            break;
+        if (rx_len < 0)
+            return (int)rx_len;
+
+        uint8_t id, err;
+        const uint8_t *params;
+        uint16_t plen;
+        if (dxl_parse_status_packet(g_dxl.rx, (size_t)rx_len, &id, &err, &params, &plen) < 0)
+            continue; /* corrupted: its servo keeps -ETIMEDOUT */
+
+        if (op->type == DXL_OP_FAST_SYNC_READ)
+        {
+            /* params points past the first ERR byte; walk from that byte */
+            const uint8_t *blk = params - 1;
+            size_t left = (size_t)plen + 1;
+            size_t stride = (size_t)op->length + 4;
+            for (i = 0; i < op->nslots && left >= stride - 2; i++)
+            {
+                if (blk[1] == op->slots[i].id)
+                    dxl_slot_fill(&op->slots[i], op->length, blk[0], &blk[2], op->length);
+                blk += stride;
+                left = (left > stride) ? left - stride : 0;
+            }
+            received = op->nslots;
+            break;
+        }
+
+        for (i = 0; i < op->nslots; i++)
+        {
+            FAR struct dxl_read_slot_s *slot = &op->slots[i];
+            if (slot->id == id && slot->result == -ETIMEDOUT)
+            {
+                uint16_t length = (op->type == DXL_OP_BULK_READ) ? slot->length : op->length;
+                dxl_slot_fill(slot, length, err, params, plen);
+                received++;
+                break;
+            }
+        }
+    }
+
+    if (received > 0)
+    {
+        g_dxl.timing.count++;
+        dxl_timing_add(g_dxl.timing.tx_hist, &g_dxl.timing.tx_max_us, tx_us);
+        dxl_timing_add(g_dxl.timing.rtt_hist, &g_dxl.timing.rtt_max_us, (uint32_t)(dxl_now_us() - t_start));
+    }
+    if (received < op->nslots)
+        g_dxl.timing.timeouts++;
+
+    ret = 0;
+    for (i = 0; i < op->nslots && ret == 0; i++)
+        ret = op->slots[i].result;
+    return ret;
+}
+
+/* Validate the slots of a multi-servo read and build its parameters in
+ * g_dxl.tx. Returns the parameter length or a negative errno.
+ */
+static int dxl_multi_read_prepare(FAR struct dxl_op_s *op)
+{
+    size_t reply, params_len;
+    uint8_t *params;
+    uint8_t ins;
+    uint8_t i;
+
+    if (op->slots == NULL || op->nslots == 0)
+        return -EINVAL;
+
+    switch (op->type)
+    {
+    case DXL_OP_SYNC_READ:
+        ins = DXL_INS_SYNC_READ;
+        params_len = 4 + (size_t)op->nslots;
+        reply = DXL_STATUS_MIN_LEN + op->length;
+        break;
+    case DXL_OP_FAST_SYNC_READ:
+        ins = DXL_INS_FAST_SYNC_READ;
+        params_len = 4 + (size_t)op->nslots;
+        reply = DXL_HEADER_LEN + 1 + (size_t)op->nslots * ((size_t)op->length + 4);
+        break;
+    default:
+        ins = DXL_INS_BULK_READ;
+        params_len = 5 * (size_t)op->nslots;
+        reply = 0;
+        for (i = 0; i < op->nslots; i++)
+        {
+            if (DXL_STATUS_MIN_LEN + (size_t)op->slots[i].length > reply)
+                reply = DXL_STATUS_MIN_LEN + op->slots[i].length;
+        }
+        break;
+    }
+    if (params_len > DXL_MAX_PARAMS || reply > sizeof(g_dxl.rx))
+        return -EMSGSIZE;
+
+    params = dxl_packet_begin(g_dxl.tx, DXL_BROADCAST_ID, ins);
+    if (op->type != DXL_OP_BULK_READ)
+    {
+        params[0] = (uint8_t)(op->address & 0xFF);
+        params[1] = (uint8_t)((op->address >> 8) & 0xFF);
+        params[2] = (uint8_t)(op->length & 0xFF);
+        params[3] = (uint8_t)((op->length >> 8) & 0xFF);
+        params += 4;
+    }
+    for (i = 0; i < op->nslots; i++)
+    {
+        FAR const struct dxl_read_slot_s *slot = &op->slots[i];
+        if (slot->data == NULL)
+            return -EINVAL;
+        *params++ = slot->id;
+        if (op->type == DXL_OP_BULK_READ)
+        {
+            *params++ = (uint8_t)(slot->address & 0xFF);
+            *params++ = (uint8_t)((slot->address >> 8) & 0xFF);
+            *params++ = (uint8_t)(slot->length & 0xFF);
+            *params++ = (uint8_t)((slot->length >> 8) & 0xFF);
+        }
+    }
+    return (int)params_len;
+}
+
+/* Run one queued operation; the caller holds g_dxl.lock. A status packet
+ * with a non-zero ERROR byte fails a read or write with -EIO, while for a
+ * ping it is only reported in op->error. Multi-servo reads report per slot.
+ */
+static int dxl_op_run(FAR struct dxl_op_s *op)
+{
+    unsigned int timeout_ms = op->timeout_ms ? op->timeout_ms : DXL_DEFAULT_TIMEOUT_MS;
+    uint8_t *params;
+    uint16_t len;
+    int ret;
+
+    op->error = 0;
+    switch (op->type)
+    {
+    case DXL_OP_PING:
+        dxl_packet_begin(g_dxl.tx, op->id, DXL_INS_PING);
+        len = op->data ? op->length : 0;
+        ret = dxl_transact(0, &op->error, op->data, &len, timeout_ms);
+        if (ret == 0)
+            op->length = len;
+        return ret;
+
+    case DXL_OP_READ:
+        if (op->data == NULL)
+            return -EINVAL;
+        params = dxl_packet_begin(g_dxl.tx, op->id, DXL_INS_READ);
+        params[0] = (uint8_t)(op->address & 0xFF);
+        params[1] = (uint8_t)((op->address >> 8) & 0xFF);
+        params[2] = (uint8_t)(op->length & 0xFF);
+        params[3] = (uint8_t)((op->length >> 8) & 0xFF);
+        len = op->length;
+        ret = dxl_transact(4, &op->error, op->data, &len, timeout_ms);
+        break;
+
+    case DXL_OP_WRITE:
+        if (op->data == NULL && op->length > 0)
+            return -EINVAL;
+        if (2 + op->length > DXL_MAX_PARAMS)
+            return -EMSGSIZE;
+        params = dxl_packet_begin(g_dxl.tx, op->id, DXL_INS_WRITE);
+        params[0] = (uint8_t)(op->address & 0xFF);
+        params[1] = (uint8_t)((op->address >> 8) & 0xFF);
+        if (op->length > 0)
+            memcpy(&params[2], op->data, op->length);
+        len = 0;
+        ret = dxl_transact((uint16_t)(2 + op->length), &op->error, NULL, &len, timeout_ms);
+        break;
+
+    case DXL_OP_SYNC_WRITE:
+        /* params: address(2) + data_len(2) + (ID, data) per servo. A sync
+         * write goes to the broadcast ID and gets no status.
+         */
+        if (op->data == NULL && op->data_len > 0)
+            return -EINVAL;
+        if (4 + op->data_len > DXL_MAX_PARAMS)
+            return -EMSGSIZE;
+        params = dxl_packet_begin(g_dxl.tx, DXL_BROADCAST_ID, DXL_INS_SYNC_WRITE);
+        params[0] = (uint8_t)(op->address & 0xFF);
+        params[1] = (uint8_t)((op->address >> 8) & 0xFF);
+        params[2] = (uint8_t)(op->length & 0xFF);
+        params[3] = (uint8_t)((op->length >> 8) & 0xFF);
+        if (op->data_len > 0)
+            memcpy(&params[4], op->data, op->data_len);
+        ret = dxl_transact((uint16_t)(4 + op->data_len), NULL, NULL, NULL, timeout_ms);
+        break;
+
+    case DXL_OP_SYNC_READ:
+    case DXL_OP_BULK_READ:
+    case DXL_OP_FAST_SYNC_READ:
+        ret = dxl_multi_read_prepare(op);
+        if (ret < 0)
+            return ret;
+        return dxl_multi_read(op, (uint16_t)ret);
+
+    default:
+        return -EINVAL;
+    }
+
+    if (ret == 0 && op->error != 0)
+        return -EIO; /* servo reported error */
+    return ret;
+}
+
 /* --------- High-level convenience APIs --------- */
 
 int dxl_init_with_uart(const char *uart_dev)
 {
-    if (g_dxl.uart_fd >= 0)
+    if (g_dxl.uart_open)
         return 0;
 
-    int fd = dxl_hw_uart_open(uart_dev ? uart_dev : DXL_DEFAULT_UART);
-    if (fd < 0)
-        return fd;
+    int ret = dxl_hw_uart_open(&g_dxl.uart, uart_dev ? uart_dev : DXL_DEFAULT_UART);
+    if (ret < 0)
+        return ret;
 
-    g_dxl.uart_fd = fd;
-    pthread_mutex_init(&g_dxl.lock, NULL);
+    g_dxl.uart_open = true;
+    g_dxl.char_us = (10u * 1000000u + DXL_DEFAULT_BAUD - 1) / DXL_DEFAULT_BAUD;
+    g_dxl.hw_rs485 = false;
+#ifdef CONFIG_ASR_SDM_DRIVERS_DYNAMIXEL_HW_RS485
+    {
+        /* Let the UART drive DE (RTS) for the frame; fall back to the GPIO
+         * callback when the serial driver does not support it.
+         */
+        struct serial_rs485 rs485;
+        memset(&rs485, 0, sizeof(rs485));
+        rs485.flags = SER_RS485_ENABLED | SER_RS485_RTS_ON_SEND;
+        g_dxl.hw_rs485 = (file_ioctl(&g_dxl.uart, TIOCSRS485, (unsigned long)&rs485) >= 0);
+    }
+#endif
+    memset(&g_dxl.timing, 0, sizeof(g_dxl.timing));
+    nxmutex_init(&g_dxl.lock);
+    syslog(LOG_INFO, "dynamixel: DE %s\n", g_dxl.hw_rs485 ? "driven by UART (TIOCSRS485)" : "driven by GPIO");
+    return 0;
+}
+
+/* Copy the timing histograms, optionally clearing them */
+int dxl_get_timing(struct dxl_timing_s *out, bool reset)
+{
+    nxmutex_lock(&g_dxl.lock);
+    if (out)
+        *out = g_dxl.timing;
+    if (reset)
+        memset(&g_dxl.timing, 0, sizeof(g_dxl.timing));
+    nxmutex_unlock(&g_dxl.lock);
     return 0;
 }
 
 int dxl_deinit(void)
 {
-    if (g_dxl.uart_fd >= 0)
+    if (g_dxl.uart_open)
     {
-        close(g_dxl.uart_fd);
-        g_dxl.uart_fd = -1;
+        file_close(&g_dxl.uart);
+        g_dxl.uart_open = false;
     }
-    pthread_mutex_destroy(&g_dxl.lock);
+    nxmutex_destroy(&g_dxl.lock);
     return 0;
 }
 
+/* Run 'count' queued operations back to back under one acquisition of the
+ * bus lock, so no other caller's packets land between them. Every executed
+ * op gets its own result; with DXL_BATCH_STOP_ON_ERROR the batch ends at the
+ * first failure. Returns 0 if all executed ops succeeded, otherwise the
+ * first failing result, and the number executed through 'completed'.
+ */
+int dxl_submit(FAR struct dxl_op_s *ops, uint16_t count, uint8_t flags, FAR uint16_t *completed)
+{
+    uint16_t i;
+    int ret = OK;
+
+    if (completed)
+        *completed = 0;
+    if (ops == NULL && count > 0)
+        return -EINVAL;
+
+    int lret = nxmutex_lock(&g_dxl.lock);
+    if (lret < 0)
+        return lret;
+    for (i = 0; i < count; i++)
+    {
+        int r = dxl_op_run(&ops[i]);
+        ops[i].result = (int16_t)r;
+        if (r < 0 && ret == OK)
+            ret = r;
+        if (r < 0 && (flags & DXL_BATCH_STOP_ON_ERROR) != 0)
+        {
+            i++;
+            break;
+        }
+    }
+    nxmutex_unlock(&g_dxl.lock);
+
+    if (completed)
+        *completed = i;
+    return ret;
+}
+
 int dxl_ping(uint8_t id, uint8_t *err, uint8_t *params, uint16_t *params_len, unsigned int timeout_ms)
 {
-    return dxl_send_instruction_and_wait(id, DXL_INS_PING, NULL, 0, err, params, params_len, timeout_ms);
+    struct dxl_op_s op;
+    memset(&op, 0, sizeof(op));
+    op.type = DXL_OP_PING;
+    op.id = id;
+    op.timeout_ms = (uint16_t)timeout_ms;
+    op.data = params;
+    op.length = (params && params_len) ? *params_len : 0;
+    int ret = dxl_submit(&op, 1, 0, NULL);
+    if (err)
+        *err = op.error;
+    if (ret == 0 && params && params_len)
+        *params_len = op.length;
+    return ret;
 }
 
 int dxl_read(uint8_t id, uint16_t address, uint16_t length, uint8_t *out_buf, unsigned int timeout_ms)
 {
-    uint8_t params[4];
-    params[0] = (uint8_t)(address & 0xFF);
-    params[1] = (uint8_t)((address >> 8) & 0xFF);
-    params[2] = (uint8_t)(length & 0xFF);
-    params[3] = (uint8_t)((length >> 8) & 0xFF);
-    uint8_t err;
-    uint16_t out_len = (uint16_t)length;
-    int ret = dxl_send_instruction_and_wait(id, DXL_INS_READ, params, 4, &err, out_buf, &out_len, timeout_ms);
-    if (ret == 0 && err != 0)
-        return -EIO; /* servo reported error */
-    return ret;
+    struct dxl_op_s op;
+    memset(&op, 0, sizeof(op));
+    op.type = DXL_OP_READ;
+    op.id = id;
+    op.address = address;
+    op.length = length;
+    op.timeout_ms = (uint16_t)timeout_ms;
+    op.data = out_buf;
+    return dxl_submit(&op, 1, 0, NULL);
 }
 
 int dxl_write(uint8_t id, uint16_t address, const uint8_t *data, uint16_t data_len, unsigned int timeout_ms)
 {
-    uint8_t *params = malloc(2 + data_len);
-    if (!params)
-        return -ENOMEM;
-    params[0] = (uint8_t)(address & 0xFF);
-    params[1] = (uint8_t)((address >> 8) & 0xFF);
-    memcpy(&params[2], data, data_len);
-    uint8_t err;
-    uint16_t errlen = 0;
-    int ret = dxl_send_instruction_and_wait(id, DXL_INS_WRITE, params, (uint16_t)(2 + data_len), &err, NULL, &errlen, timeout_ms);
-    free(params);
-    if (ret == 0 && err != 0)
-        return -EIO;
-    return ret;
+    struct dxl_op_s op;
+    memset(&op, 0, sizeof(op));
+    op.type = DXL_OP_WRITE;
+    op.id = id;
+    op.address = address;
+    op.length = data_len;
+    op.timeout_ms = (uint16_t)timeout_ms;
+    op.data = (FAR uint8_t *)data;
+    return dxl_submit(&op, 1, 0, NULL);
 }
 
-/* Sync Write skeleton: compose parameters as [addr L addr H data_len L data_len H id1 data1 id2 data2 ...]
- * Use DXL_INS_SYNC_WRITE (0x83). A sync write to broadcast ID doesn't return status.
+/* Sync Write: id_and_data holds [id1 data1 id2 data2 ...] with data_len bytes
+ * per servo, sent as DXL_INS_SYNC_WRITE (0x83) to the broadcast ID.
  */
 int dxl_sync_write(uint16_t address, uint16_t data_len, const uint8_t *id_and_data, size_t id_and_data_len)
 {
-    /* params: address(2) + data_len(2) + id_and_data ... */
-    size_t params_len = 4 + id_and_data_len;
-    uint8_t *params = malloc(params_len);
-    if (!params)
-        return -ENOMEM;
-    params[0] = (uint8_t)(address & 0xFF);
-    params[1] = (uint8_t)((address >> 8) & 0xFF);
-    params[2] = (uint8_t)(data_len & 0xFF);
-    params[3] = (uint8_t)((data_len >> 8) & 0xFF);
-    memcpy(&params[4], id_and_data, id_and_data_len);
-
-    int ret = dxl_send_instruction_and_wait(DXL_BROADCAST_ID, DXL_INS_SYNC_WRITE, params, (uint16_t)params_len, NULL, NULL, NULL, 1000);
-    free(params);
-    return ret;
+    struct dxl_op_s op;
+    memset(&op, 0, sizeof(op));
+    op.type = DXL_OP_SYNC_WRITE;
+    op.address = address;
+    op.length = data_len;
+    op.data_len = (uint16_t)id_and_data_len;
+    op.data = (FAR uint8_t *)id_and_data;
+    return dxl_submit(&op, 1, 0, NULL);
 }
 
-/* --------- Character device interface (minimal) ---------
- * We expose a device node /dev/dynamixel that accepts ioctls to perform
- * operations. This allows user-space programs to use a single device file to
- * control the bus. The actual register_driver / file_operations binding must
- * be adapted to your NuttX version. The following section sketches the
- * expected API and ioctl definitions. Replace the register_driver() part with
- * your platform's implementation.
- */
-
-#define DXL_IOCTL_BASE 'D'
-#define DXL_IOCTL_PING _IOWR(DXL_IOCTL_BASE, 1, struct dxl_ioctl_ping_s)
-#define DXL_IOCTL_READ _IOWR(DXL_IOCTL_BASE, 2, struct dxl_ioctl_read_s)
-#define DXL_IOCTL_WRITE _IOW(DXL_IOCTL_BASE, 3, struct dxl_ioctl_write_s)
-#define DXL_IOCTL_SYNC_WRITE _IOW(DXL_IOCTL_BASE, 4, struct dxl_ioctl_sync_write_s)
-
-struct dxl_ioctl_ping_s
+static int dxl_multi_read_op(uint8_t type, uint16_t address, uint16_t length,
+                             FAR struct dxl_read_slot_s *slots, uint8_t count, unsigned int timeout_ms)
 {
-    uint8_t id;
-    uint8_t err;
-    uint8_t params[64];
-    uint16_t params_len;
-};
-struct dxl_ioctl_read_s
+    struct dxl_op_s op;
+    memset(&op, 0, sizeof(op));
+    op.type = type;
+    op.address = address;
+    op.length = length;
+    op.timeout_ms = (uint16_t)timeout_ms;
+    op.slots = slots;
+    op.nslots = count;
+    return dxl_submit(&op, 1, 0, NULL);
+}
+
+/* Sync Read (0x82): the same address and length from every servo in
+ * 'slots', one status packet each. Each slot gets its own result.
+ */
+int dxl_sync_read(uint16_t address, uint16_t length, FAR struct dxl_read_slot_s *slots, uint8_t count,
+                  unsigned int timeout_ms)
 {
-    uint8_t id;
-    uint16_t address;
-    uint16_t length;
-    uint8_t data[256];
-};
-struct dxl_ioctl_write_s
+    return dxl_multi_read_op(DXL_OP_SYNC_READ, address, length, slots, count, timeout_ms);
+}
+
+/* Bulk Read (0x92): address and length per slot */
+int dxl_bulk_read(FAR struct dxl_read_slot_s *slots, uint8_t count, unsigned int timeout_ms)
 {
-    uint8_t id;
-    uint16_t address;
-    uint16_t length;
-    uint8_t data[256];
-};
-struct dxl_ioctl_sync_write_s
+    return dxl_multi_read_op(DXL_OP_BULK_READ, 0, 0, slots, count, timeout_ms);
+}
+
+/* Fast Sync Read (0x8A): as Sync Read, answered by one combined status
+ * packet (shorter on the wire, but lost as a whole if any servo is silent).
+ */
+int dxl_fast_sync_read(uint16_t address, uint16_t length, FAR struct dxl_read_slot_s *slots, uint8_t count,
+                       unsigned int timeout_ms)
 {
-    uint16_t address;
-    uint16_t data_len;
-    uint8_t payload[512];
-    size_t payload_len;
-};
+    return dxl_multi_read_op(DXL_OP_FAST_SYNC_READ, address, length, slots, count, timeout_ms);
+}
+
+/* --------- Character device interface ---------
+ * /dev/dynamixel accepts the ioctls of dynamixel.h. There is one bus per
+ * system, so every open file shares g_dxl. In the flat build the ioctl
+ * argument is a pointer into the caller's memory and is used directly.
+ */
 
-/* Placeholder file operations callbacks - adapt to NuttX struct file_operations */
-static int dxl_dev_open(void)
+static int dxl_open_f(FAR struct file *filep)
 {
-    return 0;
+    UNUSED(filep);
+    return OK;
 }
-static int dxl_dev_close(void)
+
+static int dxl_close_f(FAR struct file *filep)
 {
-    return 0;
+    UNUSED(filep);
+    return OK;
 }
-static ssize_t dxl_dev_read(char *buffer, size_t len)
+
+static ssize_t dxl_read_f(FAR struct file *filep, FAR char *buffer, size_t len)
 {
-    /* For simplicity, driver read is not implemented here. Use ioctls instead. */
+    /* Not implemented; use the ioctls */
+    UNUSED(filep);
+    UNUSED(buffer);
+    UNUSED(len);
     return -ENOSYS;
 }
-static int dxl_dev_ioctl(int cmd, unsigned long arg)
+
+static int dxl_ioctl_f(FAR struct file *filep, int cmd, unsigned long arg)
 {
+    UNUSED(filep);
+    if ((FAR void *)arg == NULL)
+        return -EINVAL;
+
     switch (cmd)
     {
     case DXL_IOCTL_PING:
     {
-        struct dxl_ioctl_ping_s p;
-        if (copy_from_user(&p, (const void *)arg, sizeof(p)))
-            return -EFAULT;
-        uint16_t params_len = sizeof(p.params);
-        int ret = dxl_ping(p.id, &p.err, p.params, &params_len, 500);
-        p.params_len = params_len;
-        if (copy_to_user((void *)arg, &p, sizeof(p)))
-            return -EFAULT;
+        FAR struct dxl_ioctl_ping_s *p = (FAR struct dxl_ioctl_ping_s *)arg;
+        uint16_t params_len = sizeof(p->params);
+        int ret = dxl_ping(p->id, &p->err, p->params, &params_len, DXL_DEFAULT_TIMEOUT_MS);
+        p->params_len = (ret == 0) ? params_len : 0;
         return ret;
     }
     case DXL_IOCTL_READ:
     {
-        struct dxl_ioctl_read_s r;
-        if (copy_from_user(&r, (const void *)arg, sizeof(r)))
-            return -EFAULT;
-        int ret = dxl_read(r.id, r.address, r.length, r.data, 500);
-        if (ret == 0)
-        {
-            if (copy_to_user((void *)arg, &r, sizeof(r)))
-                return -EFAULT;
-        }
-        return ret;
+        FAR struct dxl_ioctl_read_s *r = (FAR struct dxl_ioctl_read_s *)arg;
+        if (r->length > sizeof(r->data))
+            return -EINVAL;
+        return dxl_read(r->id, r->address, r->length, r->data, DXL_DEFAULT_TIMEOUT_MS);
     }
     case DXL_IOCTL_WRITE:
     {
-        struct dxl_ioctl_write_s w;
-        if (copy_from_user(&w, (const void *)arg, sizeof(w)))
-            return -EFAULT;
-        return dxl_write(w.id, w.address, w.data, w.length, 500);
+        FAR struct dxl_ioctl_write_s *w = (FAR struct dxl_ioctl_write_s *)arg;
+        if (w->length > sizeof(w->data))
+            return -EINVAL;
+        return dxl_write(w->id, w->address, w->data, w->length, DXL_DEFAULT_TIMEOUT_MS);
     }
     case DXL_IOCTL_SYNC_WRITE:
     {
-        struct dxl_ioctl_sync_write_s s;
-        if (copy_from_user(&s, (const void *)arg, sizeof(s)))
-            return -EFAULT;
-        return dxl_sync_write(s.address, s.data_len, s.payload, s.payload_len);
+        FAR struct dxl_ioctl_sync_write_s *sw = (FAR struct dxl_ioctl_sync_write_s *)arg;
+        if (sw->payload_len > sizeof(sw->payload))
+            return -EINVAL;
+        return dxl_sync_write(sw->address, sw->data_len, sw->payload, sw->payload_len);
+    }
+    case DXL_IOCTL_GET_TIMING:
+    {
+        FAR struct dxl_ioctl_timing_s *t = (FAR struct dxl_ioctl_timing_s *)arg;
+        return dxl_get_timing(&t->timing, t->reset != 0);
+    }
+    case DXL_IOCTL_SUBMIT:
+    {
+        FAR struct dxl_ioctl_batch_s *b = (FAR struct dxl_ioctl_batch_s *)arg;
+        return dxl_submit(b->ops, b->count, b->flags, &b->completed);
+    }
+    case DXL_IOCTL_SYNC_READ:
+    case DXL_IOCTL_BULK_READ:
+    case DXL_IOCTL_FAST_SYNC_READ:
+    {
+        FAR struct dxl_ioctl_multi_read_s *m = (FAR struct dxl_ioctl_multi_read_s *)arg;
+        uint8_t type = (cmd == DXL_IOCTL_SYNC_READ) ? DXL_OP_SYNC_READ
+                     : (cmd == DXL_IOCTL_BULK_READ) ? DXL_OP_BULK_READ
+                                                    : DXL_OP_FAST_SYNC_READ;
+        return dxl_multi_read_op(type, m->address, m->length, m->slots, m->count, m->timeout_ms);
     }
     default:
         return -ENOTTY;
     }
 }
 
+static const struct file_operations g_dxl_fops =
+{
+    dxl_open_f,   /* open */
+    dxl_close_f,  /* close */
+    dxl_read_f,   /* read */
+    NULL,         /* write */
+    NULL,         /* seek */
+    dxl_ioctl_f,  /* ioctl */
+    NULL,         /* mmap */
+    NULL,         /* truncate */
+    NULL,         /* poll */
+};
+
 /* Registration API to create /dev/dynamixel and initialize uart. Call from
  * board-specific bringup code.
  */
@@ -615,12 +1170,13 @@ int dynamixel_register_device(const char *uart_dev)
     if (ret < 0)
         return ret;
 
-    /* TODO: Register character device using register_driver() or the
-     * appropriate NuttX API. Provide file operations mapping to the
-     * functions above. Example:
-     *   static const struct file_operations fops = { .open = ..., .close = ..., .read = ..., .ioctl = ... };
-     *   register_driver(DXL_DEVICE_PATH, &fops, 0666, NULL);
-     */
+    ret = register_driver(DXL_DEVICE_PATH, &g_dxl_fops, 0666, &g_dxl);
+    if (ret < 0)
+    {
+        syslog(LOG_ERR, "dynamixel: register_driver failed: %d\n", ret);
+        dxl_deinit();
+        return ret;
+    }
 
     syslog(LOG_INFO, "dynamixel: registered on UART %s\n", uart_dev ? uart_dev : DXL_DEFAULT_UART);
     return 0;
@@ -628,31 +1184,24 @@ int dynamixel_register_device(const char *uart_dev)
 
 int dynamixel_unregister_device(void)
 {
-    /* TODO: unregister character device if registered */
+    unregister_driver(DXL_DEVICE_PATH);
     dxl_deinit();
     return 0;
 }
 
 /*
  * Notes for integration:
- * - Provide real implementations for dxl_hw_set_de() and, if needed,
- *   dxl_hw_uart_open() in your board code (weak functions above can be
- *   overridden by implementing non-weak functions in board bringup files).
- * - Replace the ioctl copy_from_user / copy_to_user helpers with the proper
- *   NuttX equivalents if writing a kernel-space driver. For user-space code
- *   these macros won't exist; instead adapt the code to your file_operations
- *   signature.
+ * - Boards that drive DE from a GPIO override dxl_hw_set_de(), and boards
+ *   whose UART needs more than the termios setup override
+ *   dxl_hw_uart_open(), with non-weak functions in their bringup code.
+ * - The ioctls take pointers into the caller's memory, which is only valid
+ *   in the flat build; a protected/kernel build would need the arguments
+ *   copied across the user/kernel boundary.
  * - Tune termios baudrate (default set here to 57600). Many DYNAMIXELs use
  *   57600 or 1000000 depending on model; set as appropriate.
- * - Improve tx/rx timing logic for production: currently the receive helper
- *   is simple and may need framing improvements to handle noise and multi-
- *   packet reads. Consider implementing a read state machine and background
- *   reader thread that accumulates bytes and signals waiting callers.
- * - Add support for bulk read and more robust error reporting as needed.
- *
- * If you want, I can adapt this skeleton for:
- *  - A specific board (e.g. OpenCR, STM32 Nucleo) by wiring the correct
- *    DE/RE GPIO and UART open APIs, returning a ready-to-build file.
- *  - A kernel-space NuttX driver with register_driver() and proper
- *    struct file_operations depending on your NuttX version.
+ * - The receive helper frames on the header and LENGTH field and returns as
+ *   soon as one status packet is complete; multi-status replies (sync/bulk
+ *   read) call it once per expected packet.
+ * - Fast Sync Read needs servo firmware that supports instruction 0x8A;
+ *   older firmware ignores it and every slot reports -ETIMEDOUT.
  */
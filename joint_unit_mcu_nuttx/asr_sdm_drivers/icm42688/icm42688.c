@@ -10,12 +10,14 @@
  *    read() returns a single-shot sample containing raw accel/gyro integer counts.
  *  - Optional FIFO read path: parses a simple header-based FIFO packet layout
  *    and falls back to direct register reads if the packet is invalid.
+ *  - Optional processing stage (ICM_IOCTL_SET_PROCESSING): read() returns
+ *    bias-corrected, low-passed samples in m/s^2 and rad/s instead.
  *
  * Notes:
  *  - Register map follows ICM-42688-P BANK0 commonly used addresses.
- *  - Some bitfield locations (e.g. FS_SEL) are device-specific; this code uses
- *    empirically validated mappings on the target board. Always consult the
- *    official datasheet when adjusting FS/ODR/DLPF.
+ *  - FS_SEL is decoded from CONFIG0[7:5] as in the datasheet; every SI output
+ *    converts with icm_read_scales(). Always consult the official datasheet
+ *    when adjusting FS/ODR/DLPF.
  *
  * Reference:
  *   - ICM-42688-P Datasheet: https://invensense.tdk.com/download-pdf/icm-42688-p-datasheet/
@@ -33,13 +35,21 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <semaphore.h>
+#include <poll.h>
+#include <nuttx/clock.h>
+#include <nuttx/irq.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/mutex.h>
+#include <nuttx/semaphore.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/i2c/i2c_master.h>
 #include <nuttx/fs/ioctl.h>
 #include <syslog.h>
 #include <math.h>
+#ifdef CONFIG_ASR_SDM_DRIVERS_ICM42688_UORB
+#include <nuttx/wqueue.h>
+#include <nuttx/sensors/sensor.h>
+#endif
 
 /* Driver configuration and basic register addresses */
 #define ICM_WHOAMI_EXPECTED 0x47
@@ -50,16 +60,47 @@
 #define ICM_REG_PWR_MGMT0           0x4E  /* [3:2] GYRO_MODE, [1:0] ACCEL_MODE */
 #define ICM_REG_GYRO_CONFIG0        0x4F  /* ODR + FS_SEL */
 #define ICM_REG_ACCEL_CONFIG0       0x50  /* ODR + FS_SEL */
+#define ICM_REG_GYRO_CONFIG1        0x51  /* [3:2] GYRO_UI_FILT_ORD, [1:0] GYRO_DEC2_M2_ORD */
+#define ICM_REG_GYRO_ACCEL_CONFIG0  0x52  /* [7:4] ACCEL_UI_FILT_BW, [3:0] GYRO_UI_FILT_BW */
+#define ICM_REG_ACCEL_CONFIG1       0x53  /* [4:3] ACCEL_UI_FILT_ORD, [2:1] ACCEL_DEC2_M2_ORD */
+#define ICM_REG_BANK_SEL            0x76
+/* Anti-alias filter: GYRO_CONFIG_STATIC2..5 in BANK1, ACCEL_CONFIG_STATIC2..4 in BANK2 */
+#define ICM_REG_B1_GYRO_STATIC2     0x0B  /* [1] GYRO_AAF_DIS, [0] GYRO_NF_DIS */
+#define ICM_REG_B1_GYRO_STATIC3     0x0C  /* [5:0] GYRO_AAF_DELT */
+#define ICM_REG_B1_GYRO_STATIC4     0x0D  /* GYRO_AAF_DELTSQR[7:0] */
+#define ICM_REG_B1_GYRO_STATIC5     0x0E  /* [7:4] GYRO_AAF_BITSHIFT, [3:0] GYRO_AAF_DELTSQR[11:8] */
+#define ICM_REG_B2_ACCEL_STATIC2    0x03  /* [6:1] ACCEL_AAF_DELT, [0] ACCEL_AAF_DIS */
+#define ICM_REG_B2_ACCEL_STATIC3    0x04  /* ACCEL_AAF_DELTSQR[7:0] */
+#define ICM_REG_B2_ACCEL_STATIC4    0x05  /* [7:4] ACCEL_AAF_BITSHIFT, [3:0] ACCEL_AAF_DELTSQR[11:8] */
+#define ICM_GYRO_AAF_DIS            0x02
+#define ICM_DEC2_M2_ORD_3           0x02  /* the only valid DEC2_M2_ORD value */
+#define ICM_GYRO_CONFIG1_FILT_MASK  0x0F  /* order and DEC2 bits; [7:5] TEMP_FILT_BW and [4] kept */
+#define ICM_ACCEL_CONFIG1_FILT_MASK 0x1E  /* order and DEC2 bits; reserved [0] (reset 1) kept */
 #define ICM_REG_INT_STATUS          0x2D
+#define ICM_REG_INT_CONFIG          0x14  /* [2] INT1_MODE, [1] INT1_DRIVE_CIRCUIT, [0] INT1_POLARITY */
+#define ICM_REG_INT_CONFIG1         0x64  /* [4] INT_ASYNC_RESET, must be cleared for the INT pins */
+#define ICM_REG_INT_SOURCE0         0x65  /* [2] FIFO_THS_INT1_EN */
+#define ICM_INT1_PULSED_PP_HIGH     0x03
+#define ICM_INT_ASYNC_RESET         0x10
+#define ICM_FIFO_THS_INT1_EN        0x04
 #define ICM_REG_ACCEL_DATA_X1       0x1F  /* AX_H,AX_L, AY_H,AY_L, AZ_H,AZ_L, GX_H.. in datasheet order */
 /* FIFO registers aligned to bare-metal template */
 #define ICM_REG_FIFO_CONFIG_INIT    0x16  /* FIFO config init */
 #define ICM_REG_FIFO_CONFIGURATION  0x5F  /* FIFO configuration (sources) */
 #define ICM_REG_FIFO_DATA           0x30  /* FIFO data port */
+#define ICM_REG_FIFO_COUNTH         0x2E  /* FIFO byte count, big-endian (INTF_CONFIG0 default) */
+#define ICM_REG_SIGNAL_PATH_RESET   0x4B  /* bit1: FIFO_FLUSH */
+#define ICM_REG_FIFO_CONFIG2        0x60  /* FIFO_WM[7:0] */
+#define ICM_REG_FIFO_CONFIG3        0x61  /* [3:0] FIFO_WM[11:8] */
+#define ICM_FIFO_FLUSH              0x02
+#define ICM_FIFO_CONFIG_SOURCES     0x07  /* accel + gyro + temp, timestamp follows (16-byte packets) */
+#define ICM_FIFO_WM_GT_TH           0x20  /* repeat the watermark interrupt while above it */
 
 /* Legacy 16-byte FIFO read (compatibility with earlier code paths) */
 #define ICM_FIFO_READ_LEN           16
-#define ICM_BURST_READ_LEN          12    /* kept for direct-register fallback path */
+
+/* Default ODR of icm_configure_default() (CONFIG0 0x66) */
+#define ICM_DEFAULT_ODR_HZ 1000
 
 /* Simplified FIFO header bits (to be cross-checked with datasheet):
  * Common InvenSense style:
@@ -70,12 +111,23 @@
 #define ICM_FIFO_HDR_ACCEL 0x20
 #define ICM_FIFO_HDR_GYRO  0x10
 #define ICM_FIFO_HDR_TEMP  0x08
+#define ICM_FIFO_HDR_MSG   0x80  /* FIFO empty marker */
 
 /* PWR_MGMT0 mode value (simplified):
  *  GYRO_MODE: 3=LN (bits[3:2]=11), ACCEL_MODE: 3=LN (bits[1:0]=11)
  */
 #define ICM_PWR_LN_GYRO_ACCEL 0x0F
 
+/* Standard gravity (m/s^2) for the SI outputs */
+#define ICM_ONE_G 9.80665f
+
+/* UI filter bandwidth codes (GYRO_ACCEL_CONFIG0), 0..7 divide max(400 Hz, ODR)
+ * (code 0 divides the ODR itself), 14/15 leave the anti-alias filter alone
+ */
+#define ICM_UI_FILT_BW_MAX_DIVIDED  7
+#define ICM_UI_FILT_BW_LOW_LATENCY  14
+#define ICM_UI_FILT_BW_LOW_LATENCY_8X 15
+
 /* Data layout we will return to users via read()
  * Packed to avoid ABI padding surprises.
  */
@@ -89,6 +141,68 @@ struct icm42688_sample_s
     int16_t gyro_z;
 };
 
+/* On-chip filter profile (kept in sync with icm42688.h) */
+struct icm42688_filter_profile_s
+{
+    uint16_t odr_hz;
+    uint16_t aaf_hz;
+    uint8_t  ui_filter_order;
+    uint8_t  ui_filter_bw;
+};
+
+/* Processing stage configuration and output (kept in sync with icm42688.h) */
+struct icm42688_proc_config_s
+{
+    uint32_t flags;
+    uint32_t bias_tau_ms;
+    uint32_t lpf_tau_ms;
+    uint16_t still_gyro_mdps;
+    uint16_t still_accel_mg;
+};
+
+struct icm42688_si_sample_s
+{
+    float accel[3];
+    float gyro[3];
+};
+
+#define ICM_PROC_ENABLE       0x01
+#define ICM_PROC_GYRO_BIAS    0x02
+#define ICM_PROC_ACCEL_BIAS   0x04
+#define ICM_PROC_LPF          0x08
+#define ICM_PROC_FLAGS        0x0F
+
+/* Processing stage state: conversion, bias estimate and low-pass output,
+ * accel axes first. Coefficients are per sample and follow the ODR.
+ */
+struct icm_proc_s
+{
+    struct icm42688_proc_config_s cfg;
+    float accel_scale;            /* m/s^2 per LSB */
+    float gyro_scale;             /* rad/s per LSB */
+    float beta;                   /* bias EMA weight */
+    float alpha;                  /* low-pass weight */
+    float still_gyro;             /* rad/s */
+    float still_accel;            /* m/s^2 */
+    float bias[6];
+    float out[6];
+    bool out_valid;               /* low-pass seeded */
+};
+
+/* Anti-alias filter settings from the datasheet table, by ascending 3 dB bandwidth */
+static const struct
+{
+    uint16_t hz;
+    uint8_t  delt;
+    uint16_t deltsqr;
+    uint8_t  bitshift;
+} g_icm_aaf[] =
+{
+    {42, 1, 1, 15},   {84, 2, 4, 13},   {126, 3, 9, 12},   {170, 4, 16, 11},
+    {213, 5, 25, 10}, {258, 6, 36, 10}, {303, 7, 49, 9},   {348, 8, 64, 9},
+    {394, 9, 81, 9},  {441, 10, 100, 8}, {536, 12, 144, 8}, {734, 16, 256, 7},
+};
+
 /* Device private structure: holds bus handle, address, cached buffer, etc. */
 struct icm42688_dev_s
 {
@@ -98,6 +212,12 @@ struct icm42688_dev_s
     uint8_t i2c_addr;             /* 7-bit address */
     struct icm42688_sample_s buf; /* last sample cache */
     size_t bufpos;                /* buffer cursor (bytes) */
+    struct icm42688_filter_profile_s profile; /* last applied filter profile */
+    bool has_profile;             /* profile valid (otherwise chip defaults) */
+    struct icm_proc_s proc;       /* optional processing stage for read() */
+    sem_t datasem;                /* posted by the INT1 handler */
+    bool has_int1;                /* INT1 attached, otherwise read() polls */
+    FAR struct pollfd *fds[CONFIG_ASR_SDM_DRIVERS_ICM42688_NPOLLWAITERS];
 };
 
 struct icm42688_config_s
@@ -105,14 +225,21 @@ struct icm42688_config_s
     struct i2c_master_s *i2c;
     uint8_t addr;
     uint32_t freq;
+    int (*attach)(xcpt_t isr, FAR void *arg); /* INT1 wiring (kept in sync with icm42688.h) */
 };
 
+/* Output data rate in effect: the applied filter profile, else the default */
+static uint16_t icm_current_odr_hz(FAR const struct icm42688_dev_s *dev)
+{
+    return dev->has_profile ? dev->profile.odr_hz : ICM_DEFAULT_ODR_HZ;
+}
+
 /* ---- I2C access helpers ----
  * All low-level transfers go through I2C_TRANSFER via icm_i2c_read()/write().
  * For multi-byte writes of a single register, icm_i2c_write1() is provided.
  */
 static int icm_i2c_read(struct icm42688_dev_s *dev, uint8_t reg,
-                        uint8_t *buf, uint8_t len)
+                        uint8_t *buf, size_t len)
 {
     struct i2c_msg_s msg[2];
     msg[0].frequency = dev->i2c_freq;
@@ -189,7 +316,7 @@ static int icm_configure_default(struct icm42688_dev_s *dev)
      * - ACCEL_CONFIG0: 0x66 (ODR + FS_SEL)
      * - FIFO_CONFIG_INIT: 0x40 (enable FIFO)
      * - FIFO_CONFIGURATION: 0x07 (select packet contents)
-     * Note: 0x66 = 0b01100110. Bitfields may vary per device revision; consult the datasheet.
+     * Note: 0x66 = 0b01100110: FS_SEL 3 in [7:5] (+-250 dps / +-2 g), ODR 1 kHz in [3:0].
      */
     int ret = icm_i2c_write1(dev, ICM_REG_PWR_MGMT0, ICM_PWR_LN_GYRO_ACCEL);
     if (ret < 0)
@@ -204,25 +331,207 @@ static int icm_configure_default(struct icm42688_dev_s *dev)
     /* Enable FIFO stream mode (ignore failures to avoid registration abort) */
     (void)icm_i2c_write1(dev, ICM_REG_FIFO_CONFIG_INIT, 0x40);
     /* Select accel+gyro into FIFO (+temp bit optional). 0x07 per template */
-    (void)icm_i2c_write1(dev, ICM_REG_FIFO_CONFIGURATION, 0x07);
+    (void)icm_i2c_write1(dev, ICM_REG_FIFO_CONFIGURATION, ICM_FIFO_CONFIG_SOURCES);
     usleep(100000); /* settle */
     return OK;
 }
 /* No FIFO flush helper needed in legacy fixed-frame mode */
 
-/* ----- Sampling -----
- * Two data paths are supported:
- *  1) FIFO-based: read one packet per invocation according to a simplified
- *     header with ACCEL/GYRO/TEMP presence bits. This path is preferred.
- *  2) Direct register read fallback: read 12 bytes starting from ACCEL_DATA_X1
- *     and parse as AX, AY, AZ, GX, GY, GZ.
+/* Number of whole packets queued in the FIFO (FIFO_COUNT is in bytes) */
+static int icm_fifo_packets(struct icm42688_dev_s *dev)
+{
+    uint8_t count[2];
+    int ret = icm_i2c_read(dev, ICM_REG_FIFO_COUNTH, count, sizeof(count));
+    if (ret < 0)
+        return ret;
+    return ((count[0] << 8) | count[1]) / ICM_FIFO_READ_LEN;
+}
+
+/* Route the FIFO watermark (one packet) to INT1 as a push-pull, active-high
+ * pulse. The pulse repeats for every new sample while the FIFO stays at or
+ * above the watermark, so a reader that leaves packets queued still wakes.
+ */
+static int icm_int1_setup(struct icm42688_dev_s *dev)
+{
+    uint8_t cfg1 = 0;
+    int ret = icm_i2c_write1(dev, ICM_REG_INT_CONFIG, ICM_INT1_PULSED_PP_HIGH);
+    if (ret < 0) return ret;
+    ret = icm_i2c_read(dev, ICM_REG_INT_CONFIG1, &cfg1, 1);
+    if (ret < 0) return ret;
+    ret = icm_i2c_write1(dev, ICM_REG_INT_CONFIG1, cfg1 & (uint8_t)~ICM_INT_ASYNC_RESET);
+    if (ret < 0) return ret;
+    ret = icm_i2c_write1(dev, ICM_REG_FIFO_CONFIGURATION, ICM_FIFO_CONFIG_SOURCES | ICM_FIFO_WM_GT_TH);
+    if (ret < 0) return ret;
+    ret = icm_i2c_write1(dev, ICM_REG_FIFO_CONFIG2, ICM_FIFO_READ_LEN);
+    if (ret < 0) return ret;
+    ret = icm_i2c_write1(dev, ICM_REG_FIFO_CONFIG3, 0);
+    if (ret < 0) return ret;
+    return icm_i2c_write1(dev, ICM_REG_INT_SOURCE0, ICM_FIFO_THS_INT1_EN);
+}
+
+/* INT1 handler for the character device: wake one blocked reader and any
+ * poll() waiters. A single pending post is enough since the reader re-checks
+ * the FIFO count, so the semaphore does not count every pulse.
+ */
+static int icm_int1_isr(int irq, FAR void *context, FAR void *arg)
+{
+    FAR struct icm42688_dev_s *dev = arg;
+    int sval = 0;
+
+    UNUSED(irq);
+    UNUSED(context);
+    if (nxsem_get_value(&dev->datasem, &sval) == OK && sval <= 0)
+        nxsem_post(&dev->datasem);
+    poll_notify(dev->fds, CONFIG_ASR_SDM_DRIVERS_ICM42688_NPOLLWAITERS, POLLIN);
+    return OK;
+}
+
+/* ----- On-chip filter profile ----- */
+
+/* Map an ODR in Hz to the CONFIG0[3:0] code; -EINVAL if unsupported. */
+static int icm_odr_code(uint16_t odr_hz)
+{
+    switch (odr_hz)
+    {
+        case 8000: return 0x03;
+        case 4000: return 0x04;
+        case 2000: return 0x05;
+        case 1000: return 0x06;
+        case 500:  return 0x0F;
+        case 200:  return 0x07;
+        case 100:  return 0x08;
+        case 50:   return 0x09;
+        default:   return -EINVAL;
+    }
+}
+
+static int icm_aaf_index(uint16_t aaf_hz)
+{
+    for (int i = 0; i < (int)(sizeof(g_icm_aaf) / sizeof(g_icm_aaf[0])); i++)
+    {
+        if (g_icm_aaf[i].hz == aaf_hz)
+            return i;
+    }
+    return -EINVAL;
+}
+
+/* Validate a profile: the ODR and AAF bandwidth must be in the tables, the
+ * order 1..3, and the resulting bandwidth (the lower of the UI filter and the
+ * AAF) must not exceed ODR/2, otherwise the profile would alias.
  */
+static int icm_check_filter_profile(FAR const struct icm42688_filter_profile_s *p)
+{
+    static const uint8_t div[] = {2, 4, 5, 8, 10, 16, 20, 40};
+    if (icm_odr_code(p->odr_hz) < 0 || icm_aaf_index(p->aaf_hz) < 0)
+        return -EINVAL;
+    if (p->ui_filter_order < 1 || p->ui_filter_order > 3)
+        return -EINVAL;
+
+    uint32_t bw_x40 = (uint32_t)p->aaf_hz * 40u; /* bandwidth in Hz/40 to stay integer */
+    if (p->ui_filter_bw <= ICM_UI_FILT_BW_MAX_DIVIDED)
+    {
+        uint32_t base = (p->ui_filter_bw == 0 || p->odr_hz > 400) ? p->odr_hz : 400u;
+        uint32_t ui_x40 = base * 40u / div[p->ui_filter_bw];
+        if (ui_x40 < bw_x40)
+            bw_x40 = ui_x40;
+    }
+    else if (p->ui_filter_bw != ICM_UI_FILT_BW_LOW_LATENCY &&
+             p->ui_filter_bw != ICM_UI_FILT_BW_LOW_LATENCY_8X)
+    {
+        return -EINVAL;
+    }
+    return (bw_x40 <= (uint32_t)p->odr_hz * 20u) ? OK : -EINVAL;
+}
+
+/* Program ODR, AAF and UI filter for gyro and accel together, with the
+ * sensors off while the filter registers change. FS_SEL bits and the other
+ * bits of GYRO_CONFIG1 and ACCEL_CONFIG1 are kept.
+ */
+static int icm_apply_filter_profile(struct icm42688_dev_s *dev,
+                                    FAR const struct icm42688_filter_profile_s *p)
+{
+    int ret = icm_check_filter_profile(p);
+    if (ret < 0)
+        return ret;
+    const uint8_t odr = (uint8_t)icm_odr_code(p->odr_hz);
+    const int aaf = icm_aaf_index(p->aaf_hz);
+    const uint8_t delt = g_icm_aaf[aaf].delt;
+    const uint16_t dsq = g_icm_aaf[aaf].deltsqr;
+    const uint8_t shift_hi = (uint8_t)((g_icm_aaf[aaf].bitshift << 4) | (dsq >> 8));
+    const uint8_t order = (uint8_t)(p->ui_filter_order - 1);
+    uint8_t gyro0 = 0, accel0 = 0, gyro1 = 0, accel1 = 0, static2 = 0;
+
+    ret = icm_i2c_read(dev, ICM_REG_GYRO_CONFIG0, &gyro0, 1);
+    if (ret < 0) return ret;
+    ret = icm_i2c_read(dev, ICM_REG_ACCEL_CONFIG0, &accel0, 1);
+    if (ret < 0) return ret;
+    ret = icm_i2c_read(dev, ICM_REG_GYRO_CONFIG1, &gyro1, 1);
+    if (ret < 0) return ret;
+    ret = icm_i2c_read(dev, ICM_REG_ACCEL_CONFIG1, &accel1, 1);
+    if (ret < 0) return ret;
+
+    /* Sensors off; no register writes for 200 us after */
+    ret = icm_i2c_write1(dev, ICM_REG_PWR_MGMT0, 0x00);
+    if (ret < 0) return ret;
+    usleep(1000);
 
-/* Parse a burst read into sample structure. The register layout varies by
- * bank and configuration. Here we assume a contiguous accel + gyro + temp
- * sequence starting at ICM_REG_ACCEL_DATA with each axis in big-endian
- * high/low bytes (common for many InvenSense devices). Adjust according to
- * your device register map and BANK selected.
+    do
+    {
+        ret = icm_i2c_write1(dev, ICM_REG_BANK_SEL, 1);
+        if (ret < 0) break;
+        ret = icm_i2c_read(dev, ICM_REG_B1_GYRO_STATIC2, &static2, 1);
+        if (ret < 0) break;
+        ret = icm_i2c_write1(dev, ICM_REG_B1_GYRO_STATIC2, static2 & (uint8_t)~ICM_GYRO_AAF_DIS);
+        if (ret < 0) break;
+        ret = icm_i2c_write1(dev, ICM_REG_B1_GYRO_STATIC3, delt);
+        if (ret < 0) break;
+        ret = icm_i2c_write1(dev, ICM_REG_B1_GYRO_STATIC4, (uint8_t)(dsq & 0xFF));
+        if (ret < 0) break;
+        ret = icm_i2c_write1(dev, ICM_REG_B1_GYRO_STATIC5, shift_hi);
+        if (ret < 0) break;
+
+        ret = icm_i2c_write1(dev, ICM_REG_BANK_SEL, 2);
+        if (ret < 0) break;
+        ret = icm_i2c_write1(dev, ICM_REG_B2_ACCEL_STATIC2, (uint8_t)(delt << 1));
+        if (ret < 0) break;
+        ret = icm_i2c_write1(dev, ICM_REG_B2_ACCEL_STATIC3, (uint8_t)(dsq & 0xFF));
+        if (ret < 0) break;
+        ret = icm_i2c_write1(dev, ICM_REG_B2_ACCEL_STATIC4, shift_hi);
+        if (ret < 0) break;
+    } while (0);
+
+    /* Always return to BANK0, even after a failed bank access */
+    int ret0 = icm_i2c_write1(dev, ICM_REG_BANK_SEL, 0);
+    if (ret < 0) return ret;
+    if (ret0 < 0) return ret0;
+
+    ret = icm_i2c_write1(dev, ICM_REG_GYRO_CONFIG0, (uint8_t)((gyro0 & 0xE0) | odr));
+    if (ret < 0) return ret;
+    ret = icm_i2c_write1(dev, ICM_REG_ACCEL_CONFIG0, (uint8_t)((accel0 & 0xE0) | odr));
+    if (ret < 0) return ret;
+    ret = icm_i2c_write1(dev, ICM_REG_GYRO_CONFIG1,
+                         (uint8_t)((gyro1 & ~ICM_GYRO_CONFIG1_FILT_MASK) | (order << 2) | ICM_DEC2_M2_ORD_3));
+    if (ret < 0) return ret;
+    ret = icm_i2c_write1(dev, ICM_REG_ACCEL_CONFIG1,
+                         (uint8_t)((accel1 & ~ICM_ACCEL_CONFIG1_FILT_MASK) | (order << 3) |
+                                   (ICM_DEC2_M2_ORD_3 << 1)));
+    if (ret < 0) return ret;
+    ret = icm_i2c_write1(dev, ICM_REG_GYRO_ACCEL_CONFIG0, (uint8_t)((p->ui_filter_bw << 4) | p->ui_filter_bw));
+    if (ret < 0) return ret;
+
+    /* Back to LN mode; gyro start-up takes 45 ms */
+    ret = icm_i2c_write1(dev, ICM_REG_PWR_MGMT0, ICM_PWR_LN_GYRO_ACCEL);
+    if (ret < 0) return ret;
+    usleep(50000);
+
+    dev->profile = *p;
+    dev->has_profile = true;
+    return OK;
+}
+
+/* ----- Sampling -----
+ * FIFO-based: read one packet per invocation according to a simplified
+ * header with ACCEL/GYRO/TEMP presence bits.
  */
 
 /* Legacy 16-byte FIFO parse (compatibility with earlier code):
@@ -236,23 +545,15 @@ static int icm_configure_default(struct icm42688_dev_s *dev)
  * fifo_data[13]: temperature (unused here)
  */
 /* Parse a legacy 16-byte FIFO read (kept for compatibility with earlier code paths).
- * For new code, prefer icm_read_fifo_packet() which reads according to header bits.
+ * Counts are returned as stored, at the FS_SEL scale of icm_read_scales().
  */
 static int icm_parse_fifo_sample(const uint8_t *fifo_buf, size_t len, struct icm42688_sample_s *out)
 {
     if (len < ICM_FIFO_READ_LEN)
         return -EINVAL;
-    /* Reference to bare-metal driver: parse starting from fifo_data[1]
-     * Apply sign-preserving right shift by 1 on accel axes.
-     */
-    {
-        int16_t rx = (int16_t)((fifo_buf[1] << 8) | fifo_buf[2]);
-        int16_t ry = (int16_t)((fifo_buf[3] << 8) | fifo_buf[4]);
-        int16_t rz = (int16_t)((fifo_buf[5] << 8) | fifo_buf[6]);
-        out->accel_x = (int16_t)(rx >> 1);
-        out->accel_y = (int16_t)(ry >> 1);
-        out->accel_z = (int16_t)(rz >> 1);
-    }
+    out->accel_x = (int16_t)((fifo_buf[1] << 8) | fifo_buf[2]);
+    out->accel_y = (int16_t)((fifo_buf[3] << 8) | fifo_buf[4]);
+    out->accel_z = (int16_t)((fifo_buf[5] << 8) | fifo_buf[6]);
     out->gyro_x  = (int16_t)((fifo_buf[7] << 8) | fifo_buf[8]);
     out->gyro_y  = (int16_t)((fifo_buf[9] << 8) | fifo_buf[10]);
     out->gyro_z  = (int16_t)((fifo_buf[11] << 8) | fifo_buf[12]);
@@ -269,36 +570,153 @@ static int icm_read_fifo_packet(struct icm42688_dev_s *dev, struct icm42688_samp
     uint8_t fifo_buf[ICM_FIFO_READ_LEN];
     if (icm_i2c_read(dev, ICM_REG_FIFO_DATA, fifo_buf, sizeof(fifo_buf)) < 0)
         return -EIO;
-    struct icm42688_sample_s tmp = {0};
-    int pret = icm_parse_fifo_sample(fifo_buf, sizeof(fifo_buf), &tmp);
-    if (pret < 0)
-        return pret;
-    tmp.accel_x = (int16_t)(tmp.accel_x >> 1);
-    tmp.accel_y = (int16_t)(tmp.accel_y >> 1);
-    tmp.accel_z = (int16_t)(tmp.accel_z >> 1);
-    memcpy(out, &tmp, sizeof(tmp));
+    if (fifo_buf[0] & ICM_FIFO_HDR_MSG)
+        return -EAGAIN; /* FIFO empty */
+    return icm_parse_fifo_sample(fifo_buf, sizeof(fifo_buf), out);
+}
+
+/* Conversion factors from the datasheet FS_SEL fields (CONFIG0[7:5]):
+ * accel +-16 g >> FS_SEL over 32768 LSB (2048 << FS_SEL LSB/g), gyro
+ * +-2000 dps >> FS_SEL over 32768 LSB. Every SI output of the driver (the
+ * processing stage, ICM_IOCTL_GET_SCALES and uORB) converts with these.
+ */
+static int icm_read_scales(struct icm42688_dev_s *dev, FAR float *accel_lsb_per_g,
+                           FAR float *gyro_lsb_per_dps)
+{
+    uint8_t gyro0 = 0, accel0 = 0;
+    int ret = icm_i2c_read(dev, ICM_REG_GYRO_CONFIG0, &gyro0, 1);
+    if (ret < 0) return ret;
+    ret = icm_i2c_read(dev, ICM_REG_ACCEL_CONFIG0, &accel0, 1);
+    if (ret < 0) return ret;
+    *accel_lsb_per_g = (float)(2048u << ((accel0 >> 5) & 0x03));
+    *gyro_lsb_per_dps = 32768.0f * (float)(1u << (gyro0 >> 5)) / 2000.0f;
     return OK;
 }
 
-/* Reserved: direct data register parsing (fallback) */
-static int icm_parse_sample(const uint8_t *buf, size_t len, struct icm42688_sample_s *out)
+/* Conversion scales as returned by ICM_IOCTL_GET_SCALES: accel LSB/g and
+ * gyro LSB/dps x10 (rounded, 131.072 -> 1311)
+ */
+static int icm_get_scales(struct icm42688_dev_s *dev, uint32_t *scales)
+{
+    float accel_lsb = 0.0f, gyro_lsb = 0.0f;
+    int ret = icm_read_scales(dev, &accel_lsb, &gyro_lsb);
+    if (ret < 0) return ret;
+    scales[0] = (uint32_t)accel_lsb;
+    scales[1] = (uint32_t)lroundf(gyro_lsb * 10.0f);
+    return OK;
+}
+
+/* ----- Processing stage -----
+ * Optional per-sample stage enabled by ICM_IOCTL_SET_PROCESSING: read()
+ * then returns struct icm42688_si_sample_s instead of raw counts. Counts are
+ * scaled with icm_read_scales(), a bias estimated while the sensor is still
+ * is removed and a first-order low-pass smooths the result, all under the
+ * device lock in the reader's context. The state is per device, so every
+ * reader of the node sees the same configuration.
+ */
+
+/* Per-sample weights from the time constants at the current ODR */
+static void icm_proc_update_rates(struct icm42688_dev_s *dev)
+{
+    FAR struct icm_proc_s *p = &dev->proc;
+    const float dt = 1.0f / (float)icm_current_odr_hz(dev);
+    const float bias_tau = (float)p->cfg.bias_tau_ms / 1000.0f;
+    const float lpf_tau = (float)p->cfg.lpf_tau_ms / 1000.0f;
+
+    p->beta = dt / (bias_tau + dt);
+    p->alpha = dt / (lpf_tau + dt);
+}
+
+/* Validate and apply a processing configuration; flags == 0 turns the stage
+ * off. Scales are read once here, the bias and filter state restart.
+ */
+static int icm_proc_configure(struct icm42688_dev_s *dev,
+                              FAR const struct icm42688_proc_config_s *cfg)
 {
-    if (len < ICM_BURST_READ_LEN)
+    FAR struct icm_proc_s *p = &dev->proc;
+    float accel_lsb = 0.0f, gyro_lsb = 0.0f;
+
+    if ((cfg->flags & ~ICM_PROC_FLAGS) != 0)
+        return -EINVAL;
+    if (cfg->flags != 0 && (cfg->flags & ICM_PROC_ENABLE) == 0)
+        return -EINVAL;
+    if ((cfg->flags & (ICM_PROC_GYRO_BIAS | ICM_PROC_ACCEL_BIAS)) != 0 && cfg->bias_tau_ms == 0)
         return -EINVAL;
-    /* Some variants output accel left-shifted by one; apply sign-preserving >>1 */
-    {
-        int16_t rx = (int16_t)((buf[0] << 8) | buf[1]);
-        int16_t ry = (int16_t)((buf[2] << 8) | buf[3]);
-        int16_t rz = (int16_t)((buf[4] << 8) | buf[5]);
-        out->accel_x = (int16_t)(rx >> 1);
-        out->accel_y = (int16_t)(ry >> 1);
-        out->accel_z = (int16_t)(rz >> 1);
-    }
-    out->gyro_x  = (int16_t)((buf[6] << 8) | buf[7]);
-    out->gyro_y  = (int16_t)((buf[8] << 8) | buf[9]);
-    out->gyro_z  = (int16_t)((buf[10] << 8) | buf[11]);
+    if ((cfg->flags & ICM_PROC_LPF) != 0 && cfg->lpf_tau_ms == 0)
+        return -EINVAL;
+
+    if (cfg->flags != 0)
+    {
+        int ret = icm_read_scales(dev, &accel_lsb, &gyro_lsb);
+        if (ret < 0) return ret;
+    }
+
+    memset(p, 0, sizeof(*p));
+    p->cfg = *cfg;
+    if (cfg->flags == 0)
+        return OK;
+    p->accel_scale = ICM_ONE_G / accel_lsb;
+    p->gyro_scale = ((float)M_PI / 180.0f) / gyro_lsb;
+    p->still_gyro = (float)cfg->still_gyro_mdps / 1000.0f * ((float)M_PI / 180.0f);
+    p->still_accel = (float)cfg->still_accel_mg / 1000.0f * ICM_ONE_G;
+    icm_proc_update_rates(dev);
     return OK;
 }
+
+/* Raw counts -> bias-corrected, low-passed m/s^2 and rad/s. The bias
+ * follows an EMA while every gyro axis (bias removed) is below still_gyro
+ * and |a| is within still_accel of 1 g; the accel bias assumes the unit is
+ * still with +Z up, so X/Y settle at 0 and Z at 1 g.
+ */
+static void icm_proc_apply(FAR struct icm_proc_s *p,
+                           FAR const struct icm42688_sample_s *s,
+                           FAR struct icm42688_si_sample_s *out)
+{
+    const int16_t raw[6] = {s->accel_x, s->accel_y, s->accel_z, s->gyro_x, s->gyro_y, s->gyro_z};
+    const float ref[3] = {0.0f, 0.0f, ICM_ONE_G};
+    const uint32_t flags = p->cfg.flags;
+    float v[6];
+    float anorm;
+    bool still;
+    int i;
+
+    for (i = 0; i < 3; i++)
+        v[i] = (float)raw[i] * p->accel_scale;
+    anorm = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+
+    still = fabsf(anorm - ICM_ONE_G) < p->still_accel;
+    for (i = 3; i < 6; i++)
+    {
+        v[i] = (float)raw[i] * p->gyro_scale;
+        if (fabsf(v[i] - p->bias[i]) >= p->still_gyro)
+            still = false;
+    }
+
+    if (still && (flags & ICM_PROC_ACCEL_BIAS) != 0)
+    {
+        for (i = 0; i < 3; i++)
+            p->bias[i] += p->beta * ((v[i] - ref[i]) - p->bias[i]);
+    }
+    if (still && (flags & ICM_PROC_GYRO_BIAS) != 0)
+    {
+        for (i = 3; i < 6; i++)
+            p->bias[i] += p->beta * (v[i] - p->bias[i]);
+    }
+
+    for (i = 0; i < 6; i++)
+    {
+        v[i] -= p->bias[i];
+        if ((flags & ICM_PROC_LPF) != 0 && p->out_valid)
+            p->out[i] += p->alpha * (v[i] - p->out[i]);
+        else
+            p->out[i] = v[i];
+    }
+    p->out_valid = true;
+
+    memcpy(out->accel, &p->out[0], sizeof(out->accel));
+    memcpy(out->gyro, &p->out[3], sizeof(out->gyro));
+}
+
 /* ----- File operations ----- */
 /* Public read path used by the character device: try FIFO first, otherwise fall
  * back to direct register reads. The returned payload is a packed
@@ -310,14 +728,19 @@ static ssize_t icm_read_oneshot(struct icm42688_dev_s *dev, char *buf, size_t le
         return -EINVAL;
 
     /* FIFO-only read: if empty/insufficient, return -EAGAIN to let caller retry */
+    int ret = icm_fifo_packets(dev);
+    if (ret < 0)
+        return ret;
+    if (ret == 0)
+        return -EAGAIN;
     struct icm42688_sample_s s1;
-    int ret = icm_read_fifo_packet(dev, &s1);
+    ret = icm_read_fifo_packet(dev, &s1);
     if (ret == OK)
     {
         memcpy(buf, &s1, sizeof(s1));
         return sizeof(s1);
     }
-    return -EAGAIN;
+    return ret == -EIO ? ret : -EAGAIN;
 }
 
 /* ----- Character device file ops ----- */
@@ -332,19 +755,30 @@ static int icm_close_dev(struct icm42688_dev_s *dev)
     return OK;
 }
 
-/* read: copy latest sample to user buffer. If user buffer is smaller than
- * struct icm42688_sample_s, return EINVAL.
+/* read: copy the next sample to the user buffer, raw counts or, with the
+ * processing stage on, struct icm42688_si_sample_s. If the user buffer is
+ * smaller than that, return EINVAL.
  */
 static ssize_t icm_read_dev(struct icm42688_dev_s *dev, char *buffer, size_t len)
 {
-    return icm_read_oneshot(dev, buffer, len);
+    if ((dev->proc.cfg.flags & ICM_PROC_ENABLE) == 0)
+        return icm_read_oneshot(dev, buffer, len);
+    if (len < sizeof(struct icm42688_si_sample_s))
+        return -EINVAL;
+
+    struct icm42688_sample_s s;
+    ssize_t ret = icm_read_oneshot(dev, (char *)&s, sizeof(s));
+    if (ret < 0)
+        return ret;
+    icm_proc_apply(&dev->proc, &s, (FAR struct icm42688_si_sample_s *)buffer);
+    return sizeof(struct icm42688_si_sample_s);
 }
 
 /* IOCTLs */
 #define ICM_IOCTL_GET_SAMPLE     0x1001
 /* Return current FS selection (register-encoded, not the physical range) */
 #define ICM_IOCTL_GET_ACCEL_FS   0x1101  /* arg: int* -> fs_sel (0..3) */
-#define ICM_IOCTL_GET_GYRO_FS    0x1102  /* arg: int* -> fs_sel (0..3) */
+#define ICM_IOCTL_GET_GYRO_FS    0x1102  /* arg: int* -> fs_sel (0..7) */
 /* Return raw register values (for debugging) */
 #define ICM_IOCTL_GET_ACCEL_CONFIG0_RAW 0x1201  /* arg: uint8_t* -> raw ACCEL_CONFIG0 */
 #define ICM_IOCTL_GET_GYRO_CONFIG0_RAW  0x1202  /* arg: uint8_t* -> raw GYRO_CONFIG0 */
@@ -354,6 +788,20 @@ static ssize_t icm_read_dev(struct icm42688_dev_s *dev, char *buffer, size_t len
  *    scales[1] = gyro_lsb_per_dps_times10 (e.g. 16.4 -> 164)
  */
 #define ICM_IOCTL_GET_SCALES      0x1301
+/* Filter profile: arg points to struct icm42688_filter_profile_s.
+ *  SET validates and applies ODR + AAF + UI filter together (-EINVAL if the
+ *  sensor cannot run it or it would alias); GET returns the last applied
+ *  profile (-ENODATA while the chip runs its reset defaults).
+ */
+#define ICM_IOCTL_SET_FILTER_PROFILE 0x1401
+#define ICM_IOCTL_GET_FILTER_PROFILE 0x1402
+/* Processing stage: arg points to struct icm42688_proc_config_s.
+ *  SET validates it, reads the scales and restarts the bias and filter
+ *  state (-EINVAL on unknown flags or a zero time constant that is used);
+ *  flags 0 returns read() to raw counts. GET returns the active config.
+ */
+#define ICM_IOCTL_SET_PROCESSING     0x1501
+#define ICM_IOCTL_GET_PROCESSING     0x1502
 
 static int icm_ioctl_dev(struct icm42688_dev_s *dev, int cmd, unsigned long arg)
 {
@@ -372,52 +820,7 @@ static int icm_ioctl_dev(struct icm42688_dev_s *dev, int cmd, unsigned long arg)
     {
         if ((void *)arg == NULL)
             return -EINVAL;
-        uint8_t acc = 0, gyr = 0;
-        int ret1 = icm_i2c_read(dev, ICM_REG_ACCEL_CONFIG0, &acc, 1);
-        int ret2 = icm_i2c_read(dev, ICM_REG_GYRO_CONFIG0, &gyr, 1);
-        if (ret1 < 0) return ret1;
-        if (ret2 < 0) return ret2;
-        /* Follow the reference app's mapping: use bits[5:4] */
-        int acc_fs_sel = (acc >> 4) & 0x03;
-        int gyr_fs_sel = (gyr >> 4) & 0x03;
-        uint32_t *scales = (uint32_t *)((void *)arg);
-        /* Use the reference mapping */
-        switch (acc_fs_sel) {
-            case 0: scales[0] = 16384; break; /* ±2g */
-            case 1: scales[0] = 8192;  break; /* ±4g */
-            case 2: scales[0] = 16384; break; /* ±2g */
-            case 3: scales[0] = 2048;  break; /* ±16g */
-            default: scales[0] = 16384; break;
-        }
-        switch (gyr_fs_sel) {
-            case 0: scales[1] = 164; break;  /* 16.4 */
-            case 1: scales[1] = 328; break;  /* 32.8 */
-            case 2: scales[1] = 656; break;  /* 65.6 */
-            case 3: scales[1] = 1310; break; /* 131.0 */
-            default: scales[1] = 164; break;
-        }
-        /* No dynamic adjustment in reference version */
-        do {
-            uint8_t raw[ICM_BURST_READ_LEN];
-            if (icm_i2c_read(dev, ICM_REG_ACCEL_DATA_X1, raw, sizeof(raw)) != OK)
-                break;
-            struct icm42688_sample_s s;
-            if (icm_parse_sample(raw, sizeof(raw), &s) != OK)
-                break;
-            float ax = (float)s.accel_x / (float)scales[0];
-            float ay = (float)s.accel_y / (float)scales[0];
-            float az = (float)s.accel_z / (float)scales[0];
-            float an = sqrtf(ax*ax + ay*ay + az*az);
-            if (an > 1.7f && an < 2.2f && scales[0] < 65536u)
-            {
-                scales[0] *= 2u;
-            }
-            else if (an > 0.45f && an < 0.65f && scales[0] > 512u)
-            {
-                scales[0] /= 2u;
-            }
-        } while (0);
-        return OK;
+        return icm_get_scales(dev, (uint32_t *)((void *)arg));
     }
     else if (cmd == ICM_IOCTL_GET_ACCEL_FS)
     {
@@ -426,10 +829,9 @@ static int icm_ioctl_dev(struct icm42688_dev_s *dev, int cmd, unsigned long arg)
         uint8_t v = 0;
         int ret = icm_i2c_read(dev, ICM_REG_ACCEL_CONFIG0, &v, 1);
         if (ret < 0) return ret;
-        /* ACCEL_CONFIG0 FS_SEL: use bits[5:4] per reference */
-        int fs_sel = (v >> 4) & 0x03;
-        syslog(LOG_INFO, "icm42688: ACCEL_CONFIG0=0x%02x (raw), FS_SEL=%d (bits[4:3])\n", v, fs_sel);
-        /* If not as expected, adjust bitfield per datasheet for your revision */
+        /* ACCEL_CONFIG0 FS_SEL: bits[7:5] per datasheet, as icm_read_scales() */
+        int fs_sel = (v >> 5) & 0x03;
+        syslog(LOG_INFO, "icm42688: ACCEL_CONFIG0=0x%02x (raw), FS_SEL=%d (bits[7:5])\n", v, fs_sel);
         *(int *)((void *)arg) = fs_sel;
         return OK;
     }
@@ -440,12 +842,61 @@ static int icm_ioctl_dev(struct icm42688_dev_s *dev, int cmd, unsigned long arg)
         uint8_t v = 0;
         int ret = icm_i2c_read(dev, ICM_REG_GYRO_CONFIG0, &v, 1);
         if (ret < 0) return ret;
-        /* GYRO_CONFIG0 FS_SEL: use bits[5:4] per reference */
-        int fs_sel = (v >> 4) & 0x03;
-        syslog(LOG_INFO, "icm42688: GYRO_CONFIG0=0x%02x (raw), FS_SEL=%d (bits[4:3])\n", v, fs_sel);
+        /* GYRO_CONFIG0 FS_SEL: bits[7:5] per datasheet, as icm_read_scales() */
+        int fs_sel = (v >> 5) & 0x07;
+        syslog(LOG_INFO, "icm42688: GYRO_CONFIG0=0x%02x (raw), FS_SEL=%d (bits[7:5])\n", v, fs_sel);
         *(int *)((void *)arg) = fs_sel;
         return OK;
     }
+    else if (cmd == ICM_IOCTL_SET_FILTER_PROFILE)
+    {
+        if ((void *)arg == NULL)
+            return -EINVAL;
+        struct icm42688_filter_profile_s p;
+        memcpy(&p, (void *)arg, sizeof(p));
+        nxmutex_lock(&dev->lock);
+        int ret = icm_apply_filter_profile(dev, &p);
+        if (ret == OK && dev->proc.cfg.flags != 0)
+            icm_proc_update_rates(dev);
+        nxmutex_unlock(&dev->lock);
+        return ret;
+    }
+    else if (cmd == ICM_IOCTL_SET_PROCESSING)
+    {
+        if ((void *)arg == NULL)
+            return -EINVAL;
+        struct icm42688_proc_config_s c;
+        memcpy(&c, (void *)arg, sizeof(c));
+        nxmutex_lock(&dev->lock);
+        int ret = icm_proc_configure(dev, &c);
+        nxmutex_unlock(&dev->lock);
+        return ret;
+    }
+    else if (cmd == ICM_IOCTL_GET_PROCESSING)
+    {
+        if ((void *)arg == NULL)
+            return -EINVAL;
+        struct icm42688_proc_config_s c;
+        nxmutex_lock(&dev->lock);
+        c = dev->proc.cfg;
+        nxmutex_unlock(&dev->lock);
+        memcpy((void *)arg, &c, sizeof(c));
+        return OK;
+    }
+    else if (cmd == ICM_IOCTL_GET_FILTER_PROFILE)
+    {
+        if ((void *)arg == NULL)
+            return -EINVAL;
+        struct icm42688_filter_profile_s p;
+        nxmutex_lock(&dev->lock);
+        bool valid = dev->has_profile;
+        p = dev->profile;
+        nxmutex_unlock(&dev->lock);
+        if (!valid)
+            return -ENODATA;
+        memcpy((void *)arg, &p, sizeof(p));
+        return OK;
+    }
     else if (cmd == ICM_IOCTL_GET_ACCEL_CONFIG0_RAW)
     {
         if ((void *)arg == NULL)
@@ -490,11 +941,36 @@ static int icm_close_f(FAR struct file *filep)
     return OK;
 }
 
+/* Blocking read without INT1: re-check the FIFO once per sample period at
+ * the current ODR, at least one tick.
+ */
+static clock_t icm_poll_ticks(FAR struct icm42688_dev_s *dev)
+{
+    const clock_t ticks = USEC2TICK(1000000u / icm_current_odr_hz(dev));
+    return ticks > 0 ? ticks : 1;
+}
+
+/* Blocks until a sample is queued (or returns -EAGAIN under O_NONBLOCK).
+ * With INT1 attached the caller sleeps on the data semaphore; otherwise it
+ * re-checks the FIFO once per sample period.
+ */
 static ssize_t icm_read_f(FAR struct file *filep, FAR char *buf, size_t len)
 {
     FAR struct inode *inode = filep->f_inode;
     FAR struct icm42688_dev_s *dev = inode->i_private;
-    return icm_read_dev(dev, buf, len);
+    for (;;)
+    {
+        nxmutex_lock(&dev->lock);
+        ssize_t ret = icm_read_dev(dev, buf, len);
+        nxmutex_unlock(&dev->lock);
+        if (ret != -EAGAIN || (filep->f_oflags & O_NONBLOCK) != 0)
+            return ret;
+
+        int wret = dev->has_int1 ? nxsem_wait(&dev->datasem)
+                                 : nxsem_tickwait(&dev->datasem, icm_poll_ticks(dev));
+        if (wret < 0 && wret != -ETIMEDOUT)
+            return wret; /* -EINTR */
+    }
 }
 
 static ssize_t icm_write_f(FAR struct file *filep, FAR const char *buf, size_t len)
@@ -519,6 +995,42 @@ static int icm_ioctl_f(FAR struct file *filep, int cmd, unsigned long arg)
     return icm_ioctl_dev(dev, cmd, arg);
 }
 
+/* POLLIN when a sample is queued. Without INT1 nothing would wake the
+ * waiter, so POLLIN is reported at once and read() does the waiting.
+ */
+static int icm_poll_f(FAR struct file *filep, FAR struct pollfd *fds, bool setup)
+{
+    FAR struct inode *inode = filep->f_inode;
+    FAR struct icm42688_dev_s *dev = inode->i_private;
+    int ret = OK;
+
+    nxmutex_lock(&dev->lock);
+    if (setup)
+    {
+        int i;
+        for (i = 0; i < CONFIG_ASR_SDM_DRIVERS_ICM42688_NPOLLWAITERS; i++)
+        {
+            if (dev->fds[i] == NULL)
+            {
+                dev->fds[i] = fds;
+                fds->priv = &dev->fds[i];
+                break;
+            }
+        }
+        if (i >= CONFIG_ASR_SDM_DRIVERS_ICM42688_NPOLLWAITERS)
+            ret = -EBUSY;
+        else if (!dev->has_int1 || icm_fifo_packets(dev) > 0)
+            poll_notify(&fds, 1, POLLIN);
+    }
+    else if (fds->priv != NULL)
+    {
+        *(FAR struct pollfd **)fds->priv = NULL;
+        fds->priv = NULL;
+    }
+    nxmutex_unlock(&dev->lock);
+    return ret;
+}
+
 static const struct file_operations g_icm_fops =
 {
     icm_open_f,   /* open */
@@ -527,8 +1039,50 @@ static const struct file_operations g_icm_fops =
     icm_write_f,  /* write */
     icm_seek_f,   /* seek */
     icm_ioctl_f,  /* ioctl */
+    NULL,         /* mmap */
+    NULL,         /* truncate */
+    icm_poll_f,   /* poll */
 };
 
+/* Reset, identify (trying the alternate address), configure defaults and
+ * apply the Kconfig filter profile. Shared by the char device and uORB paths.
+ */
+static int icm_bringup(struct icm42688_dev_s *dev)
+{
+    int ret = icm_reset(dev);
+    if (ret < 0) return ret;
+    ret = icm_check_whoami(dev);
+    if (ret < 0)
+    {
+        /* Try alternate address 0x68<->0x69 automatically */
+        uint8_t alt = (dev->i2c_addr == 0x68) ? 0x69 : 0x68;
+        dev->i2c_addr = alt;
+        ret = icm_reset(dev);
+        if (ret < 0) return ret;
+        ret = icm_check_whoami(dev);
+        if (ret < 0) return ret;
+    }
+    ret = icm_configure_default(dev);
+    if (ret < 0) return ret;
+#ifdef CONFIG_ASR_SDM_DRIVERS_ICM42688_FILTER_PROFILE
+    {
+        const struct icm42688_filter_profile_s profile =
+        {
+            .odr_hz          = CONFIG_ASR_SDM_DRIVERS_ICM42688_ODR_HZ,
+            .aaf_hz          = CONFIG_ASR_SDM_DRIVERS_ICM42688_AAF_HZ,
+            .ui_filter_order = CONFIG_ASR_SDM_DRIVERS_ICM42688_UI_FILTER_ORDER,
+            .ui_filter_bw    = CONFIG_ASR_SDM_DRIVERS_ICM42688_UI_FILTER_BW,
+        };
+        ret = icm_apply_filter_profile(dev, &profile);
+        if (ret < 0)
+        {
+            syslog(LOG_ERR, "icm42688: filter profile rejected (%d), keeping defaults\n", ret);
+        }
+    }
+#endif
+    return OK;
+}
+
 int icm42688_register(FAR const char *path, FAR const struct icm42688_config_s *cfg)
 {
     FAR struct icm42688_dev_s *dev;
@@ -546,27 +1100,27 @@ int icm42688_register(FAR const char *path, FAR const struct icm42688_config_s *
     dev->i2c_addr = cfg->addr;
     dev->i2c_freq = cfg->freq ? cfg->freq : 400000; /* default 400 kHz */
 
-    ret = icm_reset(dev);
+    nxsem_init(&dev->datasem, 0, 0);
+
+    ret = icm_bringup(dev);
     if (ret < 0) goto fail;
-    ret = icm_check_whoami(dev);
-    if (ret < 0)
+    if (cfg->attach != NULL)
     {
-        /* Try alternate address 0x68<->0x69 automatically */
-        uint8_t alt = (dev->i2c_addr == 0x68) ? 0x69 : 0x68;
-        dev->i2c_addr = alt;
-        ret = icm_reset(dev);
+        ret = icm_int1_setup(dev);
         if (ret < 0) goto fail;
-        ret = icm_check_whoami(dev);
+        ret = cfg->attach(icm_int1_isr, dev);
         if (ret < 0) goto fail;
+        dev->has_int1 = true;
     }
-    ret = icm_configure_default(dev);
-    if (ret < 0) goto fail;
 
     ret = register_driver(path, &g_icm_fops, 0666, dev);
     if (ret < 0) goto fail;
     return OK;
 
 fail:
+    if (dev->has_int1)
+        (void)cfg->attach(NULL, NULL);
+    nxsem_destroy(&dev->datasem);
     nxmutex_destroy(&dev->lock);
     kmm_free(dev);
     return ret;
@@ -578,6 +1132,404 @@ int icm42688_unregister(FAR const char *path)
     return unregister_driver(path);
 }
 
+/* ----- uORB sensor lower-half -----
+ * Alternative to the /dev/imu0 character device: registers accel and gyro
+ * topics (/dev/uorb/sensor_accelN, /dev/uorb/sensor_gyroN) on the standard
+ * sensor upper-half. Both topics share one FIFO, so the ODR follows the
+ * shorter of the requested intervals and the FIFO watermark the shorter batch
+ * latency. A work item drains a whole batch in one I2C transfer and pushes
+ * every sample in SI units, timestamped from the FIFO timestamps.
+ */
+
+#ifdef CONFIG_ASR_SDM_DRIVERS_ICM42688_UORB
+
+#define ICM_UORB_BATCH       CONFIG_ASR_SDM_DRIVERS_ICM42688_UORB_BATCH
+#define ICM_FIFO_PACKET_LEN  16    /* header, accel, gyro, temp, timestamp (FIFO_CONFIGURATION 0x07) */
+#define ICM_UORB_ACCEL       0
+#define ICM_UORB_GYRO        1
+
+struct icm_uorb_s;
+
+struct icm_uorb_sensor_s
+{
+    struct sensor_lowerhalf_s lower; /* must be first */
+    FAR struct icm_uorb_s *uorb;
+    uint32_t interval;               /* requested sample period (us) */
+    uint32_t latency;                /* requested batch latency (us) */
+    bool enabled;
+};
+
+struct icm_uorb_s
+{
+    struct icm42688_dev_s dev;
+    struct icm_uorb_sensor_s sensor[2];
+    struct work_s work;
+    uint32_t period;                 /* programmed sample period (us), 0 before the first activate */
+    uint32_t watermark;              /* programmed FIFO watermark (packets) */
+    float accel_scale;               /* m/s^2 per LSB */
+    float gyro_scale;                /* rad/s per LSB */
+    bool running;
+    uint8_t fifo[ICM_UORB_BATCH * ICM_FIFO_PACKET_LEN];
+    struct sensor_accel accel[ICM_UORB_BATCH];
+    struct sensor_gyro gyro[ICM_UORB_BATCH];
+};
+
+/* Sample periods of the supported ODRs (8 kHz .. 50 Hz) */
+static const uint32_t g_icm_uorb_period[] = {125, 250, 500, 1000, 2000, 5000, 10000, 20000};
+
+/* Longest supported period not longer than the request */
+static uint32_t icm_uorb_period(uint32_t interval)
+{
+    uint32_t period = g_icm_uorb_period[0];
+    for (int i = 0; i < (int)(sizeof(g_icm_uorb_period) / sizeof(g_icm_uorb_period[0])); i++)
+    {
+        if (g_icm_uorb_period[i] <= interval)
+            period = g_icm_uorb_period[i];
+    }
+    return period;
+}
+
+/* Packets per batch for a latency, at least one and at most the buffer */
+static uint32_t icm_uorb_watermark(uint32_t latency, uint32_t period)
+{
+    uint32_t n = latency / period;
+    if (n < 1)
+        n = 1;
+    if (n > ICM_UORB_BATCH)
+        n = ICM_UORB_BATCH;
+    return n;
+}
+
+/* Program a new ODR. A filter profile is re-applied at the new rate when it
+ * still validates there; otherwise only the ODR bits change and the profile
+ * is dropped, since its bandwidth no longer matches the rate.
+ */
+static int icm_uorb_set_odr(FAR struct icm42688_dev_s *dev, uint16_t odr_hz)
+{
+    uint8_t gyro0 = 0, accel0 = 0;
+    if (dev->has_profile)
+    {
+        struct icm42688_filter_profile_s p = dev->profile;
+        p.odr_hz = odr_hz;
+        if (icm_apply_filter_profile(dev, &p) == OK)
+            return OK;
+        dev->has_profile = false;
+    }
+    const uint8_t odr = (uint8_t)icm_odr_code(odr_hz);
+    int ret = icm_i2c_read(dev, ICM_REG_GYRO_CONFIG0, &gyro0, 1);
+    if (ret < 0) return ret;
+    ret = icm_i2c_read(dev, ICM_REG_ACCEL_CONFIG0, &accel0, 1);
+    if (ret < 0) return ret;
+    ret = icm_i2c_write1(dev, ICM_REG_GYRO_CONFIG0, (uint8_t)((gyro0 & 0xE0) | odr));
+    if (ret < 0) return ret;
+    return icm_i2c_write1(dev, ICM_REG_ACCEL_CONFIG0, (uint8_t)((accel0 & 0xE0) | odr));
+}
+
+/* Conversion factors for the published topics, from icm_read_scales() */
+static int icm_uorb_update_scales(FAR struct icm_uorb_s *uorb)
+{
+    float accel_lsb = 0.0f, gyro_lsb = 0.0f;
+    int ret = icm_read_scales(&uorb->dev, &accel_lsb, &gyro_lsb);
+    if (ret < 0) return ret;
+    uorb->accel_scale = ICM_ONE_G / accel_lsb;
+    uorb->gyro_scale = ((float)M_PI / 180.0f) / gyro_lsb;
+    return OK;
+}
+
+/* Bring ODR and watermark in line with the enabled topics (dev->lock held) */
+static int icm_uorb_configure(FAR struct icm_uorb_s *uorb)
+{
+    FAR struct icm42688_dev_s *dev = &uorb->dev;
+    uint32_t interval = UINT32_MAX;
+    uint32_t latency = UINT32_MAX;
+    for (int i = 0; i < 2; i++)
+    {
+        if (uorb->sensor[i].enabled)
+        {
+            if (uorb->sensor[i].interval < interval)
+                interval = uorb->sensor[i].interval;
+            if (uorb->sensor[i].latency < latency)
+                latency = uorb->sensor[i].latency;
+        }
+    }
+    if (interval == UINT32_MAX)
+        return OK;
+
+    const uint32_t period = icm_uorb_period(interval);
+    const uint32_t watermark = icm_uorb_watermark(latency, period);
+    int ret;
+    if (period != uorb->period)
+    {
+        ret = icm_uorb_set_odr(dev, (uint16_t)(1000000u / period));
+        if (ret < 0) return ret;
+        uorb->period = period;
+    }
+    if (watermark != uorb->watermark)
+    {
+        const uint16_t bytes = (uint16_t)(watermark * ICM_FIFO_PACKET_LEN);
+        ret = icm_i2c_write1(dev, ICM_REG_FIFO_CONFIG2, (uint8_t)(bytes & 0xFF));
+        if (ret < 0) return ret;
+        ret = icm_i2c_write1(dev, ICM_REG_FIFO_CONFIG3, (uint8_t)(bytes >> 8));
+        if (ret < 0) return ret;
+        uorb->watermark = watermark;
+    }
+    return OK;
+}
+
+/* Convert the packets read into uorb->fifo, newest stamped 'newest' and the
+ * older ones back-dated by their 16-bit FIFO timestamp deltas. Parsing stops
+ * at the empty-FIFO marker; returns the number of samples converted.
+ */
+static size_t icm_uorb_convert(FAR struct icm_uorb_s *uorb, size_t n, uint64_t newest)
+{
+    size_t valid = 0;
+    while (valid < n && (uorb->fifo[valid * ICM_FIFO_PACKET_LEN] & ICM_FIFO_HDR_MSG) == 0)
+        valid++;
+
+    uint64_t ts = newest;
+    for (size_t i = valid; i-- > 0; )
+    {
+        FAR const uint8_t *pkt = &uorb->fifo[i * ICM_FIFO_PACKET_LEN];
+        if (i + 1 < valid)
+        {
+            uint16_t t0 = (uint16_t)((pkt[14] << 8) | pkt[15]);
+            uint16_t t1 = (uint16_t)((pkt[ICM_FIFO_PACKET_LEN + 14] << 8) | pkt[ICM_FIFO_PACKET_LEN + 15]);
+            ts -= (uint16_t)(t1 - t0);
+        }
+        float temp = (float)(int8_t)pkt[13] / 2.07f + 25.0f;
+
+        uorb->accel[i].timestamp   = ts;
+        uorb->accel[i].x           = (float)(int16_t)((pkt[1] << 8) | pkt[2]) * uorb->accel_scale;
+        uorb->accel[i].y           = (float)(int16_t)((pkt[3] << 8) | pkt[4]) * uorb->accel_scale;
+        uorb->accel[i].z           = (float)(int16_t)((pkt[5] << 8) | pkt[6]) * uorb->accel_scale;
+        uorb->accel[i].temperature = temp;
+
+        uorb->gyro[i].timestamp    = ts;
+        uorb->gyro[i].x            = (float)(int16_t)((pkt[7] << 8) | pkt[8]) * uorb->gyro_scale;
+        uorb->gyro[i].y            = (float)(int16_t)((pkt[9] << 8) | pkt[10]) * uorb->gyro_scale;
+        uorb->gyro[i].z            = (float)(int16_t)((pkt[11] << 8) | pkt[12]) * uorb->gyro_scale;
+        uorb->gyro[i].temperature  = temp;
+    }
+    return valid;
+}
+
+/* Drain one batch from the FIFO and push it to both topics. Runs on the
+ * INT1 watermark interrupt, or once per batch latency when INT1 is not
+ * wired; when more than a batch is queued it runs again at once.
+ */
+static void icm_uorb_worker(FAR void *arg)
+{
+    FAR struct icm_uorb_s *uorb = arg;
+    FAR struct icm42688_dev_s *dev = &uorb->dev;
+    size_t queued = 0;
+    size_t n = 0;
+
+    nxmutex_lock(&dev->lock);
+    if (!uorb->running)
+    {
+        nxmutex_unlock(&dev->lock);
+        return;
+    }
+    uint64_t now = sensor_get_timestamp();
+    int packets = icm_fifo_packets(dev);
+    if (packets > 0)
+    {
+        queued = (size_t)packets;
+        n = queued < ICM_UORB_BATCH ? queued : ICM_UORB_BATCH;
+        if (n > 0 && icm_i2c_read(dev, ICM_REG_FIFO_DATA, uorb->fifo, n * ICM_FIFO_PACKET_LEN) < 0)
+            n = 0;
+    }
+    /* Packets left in the FIFO are newer than the ones read */
+    n = icm_uorb_convert(uorb, n, now - (uint64_t)(queued - n) * uorb->period);
+    if (queued > ICM_UORB_BATCH)
+        work_queue(HPWORK, &uorb->work, icm_uorb_worker, uorb, 0);
+    else if (!dev->has_int1)
+        work_queue(HPWORK, &uorb->work, icm_uorb_worker, uorb, USEC2TICK(uorb->period * uorb->watermark));
+    bool accel_on = uorb->sensor[ICM_UORB_ACCEL].enabled;
+    bool gyro_on = uorb->sensor[ICM_UORB_GYRO].enabled;
+    nxmutex_unlock(&dev->lock);
+
+    /* The buffers are only refilled by this work item, so push unlocked */
+    if (n > 0 && accel_on)
+    {
+        FAR struct sensor_lowerhalf_s *lower = &uorb->sensor[ICM_UORB_ACCEL].lower;
+        lower->push_event(lower->priv, uorb->accel, n * sizeof(struct sensor_accel));
+    }
+    if (n > 0 && gyro_on)
+    {
+        FAR struct sensor_lowerhalf_s *lower = &uorb->sensor[ICM_UORB_GYRO].lower;
+        lower->push_event(lower->priv, uorb->gyro, n * sizeof(struct sensor_gyro));
+    }
+}
+
+/* INT1 watermark interrupt: defer the FIFO drain to the work queue */
+static int icm_uorb_isr(int irq, FAR void *context, FAR void *arg)
+{
+    FAR struct icm_uorb_s *uorb = arg;
+
+    UNUSED(irq);
+    UNUSED(context);
+    if (uorb->running && work_available(&uorb->work))
+        work_queue(HPWORK, &uorb->work, icm_uorb_worker, uorb, 0);
+    return OK;
+}
+
+static int icm_uorb_activate(FAR struct sensor_lowerhalf_s *lower,
+                             FAR struct file *filep, bool enable)
+{
+    FAR struct icm_uorb_sensor_s *sensor = (FAR struct icm_uorb_sensor_s *)lower;
+    FAR struct icm_uorb_s *uorb = sensor->uorb;
+    FAR struct icm42688_dev_s *dev = &uorb->dev;
+    int ret = OK;
+
+    UNUSED(filep);
+    nxmutex_lock(&dev->lock);
+    sensor->enabled = enable;
+    bool any = uorb->sensor[ICM_UORB_ACCEL].enabled || uorb->sensor[ICM_UORB_GYRO].enabled;
+    if (any && !uorb->running)
+    {
+        /* LN mode (gyro start-up 45 ms), then start from an empty FIFO */
+        ret = icm_i2c_write1(dev, ICM_REG_PWR_MGMT0, ICM_PWR_LN_GYRO_ACCEL);
+        if (ret == OK)
+        {
+            usleep(50000);
+            ret = icm_uorb_configure(uorb);
+        }
+        if (ret == OK)
+            ret = icm_uorb_update_scales(uorb);
+        if (ret == OK)
+            ret = icm_i2c_write1(dev, ICM_REG_SIGNAL_PATH_RESET, ICM_FIFO_FLUSH);
+        if (ret == OK)
+        {
+            uorb->running = true;
+            work_queue(HPWORK, &uorb->work, icm_uorb_worker, uorb,
+                       USEC2TICK(uorb->period * uorb->watermark));
+        }
+        else
+        {
+            sensor->enabled = false;
+        }
+    }
+    else if (any)
+    {
+        ret = icm_uorb_configure(uorb);
+    }
+    else if (uorb->running)
+    {
+        uorb->running = false;
+        work_cancel(HPWORK, &uorb->work);
+        ret = icm_i2c_write1(dev, ICM_REG_PWR_MGMT0, 0x00);
+    }
+    nxmutex_unlock(&dev->lock);
+    return ret;
+}
+
+static int icm_uorb_set_interval(FAR struct sensor_lowerhalf_s *lower,
+                                 FAR struct file *filep, FAR uint32_t *period_us)
+{
+    FAR struct icm_uorb_sensor_s *sensor = (FAR struct icm_uorb_sensor_s *)lower;
+    FAR struct icm_uorb_s *uorb = sensor->uorb;
+    int ret = OK;
+
+    UNUSED(filep);
+    nxmutex_lock(&uorb->dev.lock);
+    sensor->interval = *period_us;
+    if (uorb->running)
+        ret = icm_uorb_configure(uorb);
+    *period_us = icm_uorb_period(sensor->interval);
+    nxmutex_unlock(&uorb->dev.lock);
+    return ret;
+}
+
+static int icm_uorb_batch(FAR struct sensor_lowerhalf_s *lower,
+                          FAR struct file *filep, FAR uint32_t *latency_us)
+{
+    FAR struct icm_uorb_sensor_s *sensor = (FAR struct icm_uorb_sensor_s *)lower;
+    FAR struct icm_uorb_s *uorb = sensor->uorb;
+    int ret = OK;
+
+    UNUSED(filep);
+    nxmutex_lock(&uorb->dev.lock);
+    sensor->latency = *latency_us;
+    if (uorb->running)
+        ret = icm_uorb_configure(uorb);
+    const uint32_t period = icm_uorb_period(sensor->interval);
+    const uint32_t watermark = icm_uorb_watermark(sensor->latency, period);
+    *latency_us = watermark > 1 ? watermark * period : 0;
+    nxmutex_unlock(&uorb->dev.lock);
+    return ret;
+}
+
+static const struct sensor_ops_s g_icm_uorb_ops =
+{
+    .activate     = icm_uorb_activate,
+    .set_interval = icm_uorb_set_interval,
+    .batch        = icm_uorb_batch,
+};
+
+int icm42688_register_uorb(int devno, FAR const struct icm42688_config_s *cfg)
+{
+    FAR struct icm_uorb_s *uorb;
+    int ret;
+
+    if (cfg == NULL || cfg->i2c == NULL)
+        return -EINVAL;
+
+    uorb = kmm_malloc(sizeof(struct icm_uorb_s));
+    if (!uorb)
+        return -ENOMEM;
+    memset(uorb, 0, sizeof(*uorb));
+    nxmutex_init(&uorb->dev.lock);
+    uorb->dev.i2c = cfg->i2c;
+    uorb->dev.i2c_addr = cfg->addr;
+    uorb->dev.i2c_freq = cfg->freq ? cfg->freq : 400000; /* default 400 kHz */
+
+    ret = icm_bringup(&uorb->dev);
+    if (ret < 0) goto fail;
+    /* Sensors stay off until a topic is activated */
+    ret = icm_i2c_write1(&uorb->dev, ICM_REG_PWR_MGMT0, 0x00);
+    if (ret < 0) goto fail;
+    if (cfg->attach != NULL)
+    {
+        /* The watermark is reprogrammed from the batch latency on activate */
+        ret = icm_int1_setup(&uorb->dev);
+        if (ret < 0) goto fail;
+        ret = cfg->attach(icm_uorb_isr, uorb);
+        if (ret < 0) goto fail;
+        uorb->dev.has_int1 = true;
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        FAR struct icm_uorb_sensor_s *sensor = &uorb->sensor[i];
+        sensor->lower.type = (i == ICM_UORB_ACCEL) ? SENSOR_TYPE_ACCELEROMETER : SENSOR_TYPE_GYROSCOPE;
+        sensor->lower.nbuffer = ICM_UORB_BATCH;
+        sensor->lower.batch_number = ICM_UORB_BATCH;
+        sensor->lower.ops = &g_icm_uorb_ops;
+        sensor->uorb = uorb;
+        sensor->interval = 1000; /* 1 kHz, the bring-up ODR */
+    }
+
+    ret = sensor_register(&uorb->sensor[ICM_UORB_ACCEL].lower, devno);
+    if (ret < 0) goto fail;
+    ret = sensor_register(&uorb->sensor[ICM_UORB_GYRO].lower, devno);
+    if (ret < 0)
+    {
+        sensor_unregister(&uorb->sensor[ICM_UORB_ACCEL].lower, devno);
+        goto fail;
+    }
+    return OK;
+
+fail:
+    if (uorb->dev.has_int1)
+        (void)cfg->attach(NULL, NULL);
+    nxmutex_destroy(&uorb->dev.lock);
+    kmm_free(uorb);
+    return ret;
+}
+
+#endif /* CONFIG_ASR_SDM_DRIVERS_ICM42688_UORB */
+
 /* ----- End of driver skeleton ----- */
 
 /*
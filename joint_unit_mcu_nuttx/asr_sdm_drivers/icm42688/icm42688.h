@@ -4,6 +4,7 @@
 #include <nuttx/config.h>
 #include <stdint.h>
 #include <sys/types.h>
+#include <nuttx/irq.h>
 
 /* Forward declaration to avoid heavy include here */
 struct i2c_master_s; /* from <nuttx/i2c/i2c_master.h> */
@@ -25,6 +26,48 @@ struct icm42688_config_s
     struct i2c_master_s *i2c;
     uint8_t  addr;   /* 7-bit I2C address */
     uint32_t freq;   /* I2C frequency in Hz; 0 -> default 400k */
+
+    /* Optional INT1 wiring: attach 'isr' to the rising edge of the GPIO
+     * connected to INT1 and enable it (isr == NULL detaches). Without it
+     * read() re-checks the FIFO once per sample and poll() always reports
+     * POLLIN.
+     */
+    int (*attach)(xcpt_t isr, FAR void *arg);
+};
+
+/* On-chip filter profile: ODR, anti-alias filter and UI filter applied
+ * together by ICM_IOCTL_SET_FILTER_PROFILE (kept in sync with icm42688.c)
+ */
+struct icm42688_filter_profile_s
+{
+    uint16_t odr_hz;          /* 50, 100, 200, 500, 1000, 2000, 4000 or 8000 */
+    uint16_t aaf_hz;          /* anti-alias 3 dB bandwidth, 42..734 Hz (datasheet table) */
+    uint8_t  ui_filter_order; /* 1..3 */
+    uint8_t  ui_filter_bw;    /* UI_FILT_BW code: 0..7 (ODR/2..ODR/40), 14/15 (low latency) */
+};
+
+/* Processing stage applied by read() after ICM_IOCTL_SET_PROCESSING
+ * (kept in sync with icm42688.c). With ICM_PROC_ENABLE set, read() returns
+ * struct icm42688_si_sample_s; ICM_IOCTL_GET_SAMPLE stays raw.
+ */
+struct icm42688_proc_config_s
+{
+    uint32_t flags;           /* ICM_PROC_*, 0 = raw counts */
+    uint32_t bias_tau_ms;     /* bias EMA time constant, e.g. 20000 */
+    uint32_t lpf_tau_ms;      /* low-pass time constant, e.g. 600 */
+    uint16_t still_gyro_mdps; /* bias update only while every gyro axis is below */
+    uint16_t still_accel_mg;  /* ... and ||a| - 1 g| is below */
+};
+
+#define ICM_PROC_ENABLE       0x01  /* read() returns struct icm42688_si_sample_s */
+#define ICM_PROC_GYRO_BIAS    0x02  /* estimate and remove the gyro bias */
+#define ICM_PROC_ACCEL_BIAS   0x04  /* same for accel, assumes +Z up while still */
+#define ICM_PROC_LPF          0x08  /* first-order low-pass */
+
+struct icm42688_si_sample_s
+{
+    float accel[3];           /* m/s^2 */
+    float gyro[3];            /* rad/s */
 };
 
 /* IOCTL command definitions (kept in sync with icm42688.c) */
@@ -34,6 +77,10 @@ struct icm42688_config_s
 #define ICM_IOCTL_GET_ACCEL_CONFIG0_RAW   0x1201
 #define ICM_IOCTL_GET_GYRO_CONFIG0_RAW    0x1202
 #define ICM_IOCTL_GET_SCALES              0x1301
+#define ICM_IOCTL_SET_FILTER_PROFILE      0x1401
+#define ICM_IOCTL_GET_FILTER_PROFILE      0x1402
+#define ICM_IOCTL_SET_PROCESSING          0x1501
+#define ICM_IOCTL_GET_PROCESSING          0x1502
 
 #ifdef __cplusplus
 extern "C" {
@@ -43,6 +90,22 @@ int icm42688_register(FAR const char *path,
                       FAR const struct icm42688_config_s *cfg);
 int icm42688_unregister(FAR const char *path);
 
+#ifdef CONFIG_ASR_SDM_DRIVERS_ICM42688_UORB
+/* Register accel and gyro uORB topics (/dev/uorb/sensor_accel<devno>,
+ * /dev/uorb/sensor_gyro<devno>) instead of a character device.
+ */
+int icm42688_register_uorb(int devno,
+                           FAR const struct icm42688_config_s *cfg);
+#endif
+
+#ifdef CONFIG_ASR_SDM_DRIVERS_ICM42688_SIM
+/* Simulator: an I2C master answered by an emulated ICM-42688 at 0x68, and
+ * a struct icm42688_config_s 'attach' callback emulating INT1.
+ */
+FAR struct i2c_master_s *icm42688_sim_initialize(void);
+int icm42688_sim_attach(xcpt_t isr, FAR void *arg);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
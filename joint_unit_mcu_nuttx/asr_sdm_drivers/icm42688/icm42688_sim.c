@@ -0,0 +1,458 @@
+/*
+ * icm42688_sim.c
+ *
+ * Emulated ICM-42688 behind an I2C master, for the NuttX simulator.
+ *
+ * icm42688_sim_initialize() returns a struct i2c_master_s whose transfers are
+ * answered by a register-level model of the sensor, so the unmodified driver
+ * in icm42688.c (character device or uORB) runs on sim:
+ *  - BANK0..2 register file with auto-increment, WHO_AM_I 0x47 at 0x68 (other
+ *    addresses NACK), soft reset and FIFO flush. ODR and FS_SEL follow
+ *    GYRO/ACCEL_CONFIG0 in the datasheet encoding ([7:5] FS_SEL, [3:0] ODR).
+ *  - While both sensors are in LN mode and the FIFO is enabled, one 16-byte
+ *    packet (header, accel, gyro, temperature, timestamp) is queued per
+ *    sample period of the sim clock. The FIFO holds 2 KiB (128 packets);
+ *    like stream-to-FIFO mode, an overflow discards the oldest packets.
+ *  - Packets replay a recording (raw 16-byte FIFO packets as read from
+ *    FIFO_DATA, looped) or, without one, a synthetic stream: gravity on +Z,
+ *    a vibration tone on X/Z, a constant gyro bias, a slow yaw oscillation
+ *    and a little noise. The data registers read the synthetic stream.
+ *  - icm42688_sim_attach() stands in for the INT1 wiring: a watchdog at the
+ *    sample period calls the driver's handler while the FIFO is at or above
+ *    the watermark and the watermark interrupt is routed to INT1.
+ *  - Optionally every transfer busy-waits for its time on the wire at the
+ *    message frequency, so the bus cost shows up in timing measurements.
+ */
+
+#include <nuttx/config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <syslog.h>
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/irq.h>
+#include <nuttx/wdog.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/i2c/i2c_master.h>
+
+#include "icm42688.h"
+
+#define ICM_SIM_ADDR              0x68
+#define ICM_SIM_WHOAMI            0x47
+#define ICM_SIM_PACKET_LEN        16
+#define ICM_SIM_FIFO_PACKETS      128   /* 2 KiB FIFO */
+#define ICM_SIM_BANKS             3
+
+/* BANK0 registers with side effects or computed contents */
+#define ICM_SIM_DEVICE_CONFIG     0x11
+#define ICM_SIM_FIFO_CONFIG       0x16  /* [7:6] FIFO_MODE, 0 = bypass */
+#define ICM_SIM_TEMP_DATA1        0x1D  /* TEMP, ACCEL, GYRO data, big-endian */
+#define ICM_SIM_FIFO_COUNTH       0x2E
+#define ICM_SIM_FIFO_DATA         0x30
+#define ICM_SIM_SIGNAL_PATH_RESET 0x4B
+#define ICM_SIM_PWR_MGMT0         0x4E
+#define ICM_SIM_GYRO_CONFIG0      0x4F
+#define ICM_SIM_ACCEL_CONFIG0     0x50
+#define ICM_SIM_GYRO_CONFIG1      0x51
+#define ICM_SIM_ACCEL_CONFIG1     0x53
+#define ICM_SIM_FIFO_CONFIG2      0x60  /* watermark in bytes */
+#define ICM_SIM_FIFO_CONFIG3      0x61
+#define ICM_SIM_INT_SOURCE0       0x65
+#define ICM_SIM_WHO_AM_I          0x75
+#define ICM_SIM_BANK_SEL          0x76  /* present in every bank */
+
+#define ICM_SIM_CONFIG0_RESET     0x06  /* +-2000 dps / +-16 g, 1 kHz */
+#define ICM_SIM_GYRO_CONFIG1_RESET  0x16
+#define ICM_SIM_ACCEL_CONFIG1_RESET 0x0D  /* bit 0 reserved, reads 1 */
+#define ICM_SIM_PWR_LN            0x0F
+#define ICM_SIM_FIFO_MODE_MASK    0xC0
+#define ICM_SIM_FIFO_FLUSH        0x02
+#define ICM_SIM_FIFO_THS_INT1     0x04
+#define ICM_SIM_HDR               0x68  /* accel + gyro, ODR timestamp */
+#define ICM_SIM_HDR_EMPTY         0x80
+
+#define ICM_SIM_ONE_PI            3.14159265358979323846
+
+/* Wire time of a message: start/address/stop overhead plus 9 bits a byte */
+#define ICM_SIM_MSG_BITS(len)     (9u * ((uint32_t)(len) + 1u) + 2u)
+
+struct icm_sim_s
+{
+    struct i2c_master_s dev;      /* must be first */
+    bool initialized;
+    uint8_t regs[ICM_SIM_BANKS][128];
+    uint8_t bank;
+    uint8_t reg;                  /* register pointer */
+    uint32_t period_us;           /* sample period, 0 while not sampling */
+    uint64_t next_us;             /* sim time of the next sample */
+    uint64_t head_us;             /* sample time of the oldest queued packet */
+    uint32_t queued;              /* packets in the FIFO */
+    uint32_t seed;                /* noise generator */
+    struct file replay;
+    bool has_replay;
+    struct wdog_s wdog;           /* INT1 emulation */
+    xcpt_t isr;
+    FAR void *isr_arg;
+};
+
+static struct icm_sim_s g_icm_sim;
+
+static uint64_t icm_sim_now_us(void)
+{
+    struct timespec ts;
+    clock_systime_timespec(&ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/* Sample period of an ODR code (CONFIG0[3:0]), 0 for reserved codes */
+static uint32_t icm_sim_odr_period(uint8_t code)
+{
+    static const uint32_t period_us[16] =
+    {
+        0, 31, 63, 125, 250, 500, 1000, 5000, 10000, 20000, 40000, 80000, 160000, 320000, 640000, 2000
+    };
+    return period_us[code & 0x0F];
+}
+
+/* Queue the packets sampled up to now; call inside a critical section */
+static void icm_sim_advance(FAR struct icm_sim_s *sim)
+{
+    uint64_t now = icm_sim_now_us();
+    if (sim->period_us == 0 || now < sim->next_us)
+        return;
+
+    uint64_t n = (now - sim->next_us) / sim->period_us + 1;
+    sim->next_us += n * sim->period_us;
+    if (sim->queued == 0)
+        sim->head_us = sim->next_us - n * sim->period_us;
+    if (sim->queued + n > ICM_SIM_FIFO_PACKETS)
+    {
+        /* Stream-to-FIFO: the oldest packets are overwritten */
+        uint64_t lost = sim->queued + n - ICM_SIM_FIFO_PACKETS;
+        sim->head_us += lost * sim->period_us;
+        sim->queued = ICM_SIM_FIFO_PACKETS;
+    }
+    else
+    {
+        sim->queued += (uint32_t)n;
+    }
+}
+
+/* Restart sampling after a power, ODR or FIFO mode change */
+static void icm_sim_rebase(FAR struct icm_sim_s *sim)
+{
+    irqstate_t flags = enter_critical_section();
+    icm_sim_advance(sim);
+    bool on = (sim->regs[0][ICM_SIM_PWR_MGMT0] & ICM_SIM_PWR_LN) == ICM_SIM_PWR_LN &&
+              (sim->regs[0][ICM_SIM_FIFO_CONFIG] & ICM_SIM_FIFO_MODE_MASK) != 0;
+    uint32_t period = on ? icm_sim_odr_period(sim->regs[0][ICM_SIM_GYRO_CONFIG0]) : 0;
+    if (period != sim->period_us)
+    {
+        sim->period_us = period;
+        sim->next_us = icm_sim_now_us() + period;
+    }
+    leave_critical_section(flags);
+}
+
+static void icm_sim_reset(FAR struct icm_sim_s *sim)
+{
+    irqstate_t flags = enter_critical_section();
+    memset(sim->regs, 0, sizeof(sim->regs));
+    sim->regs[0][ICM_SIM_WHO_AM_I] = ICM_SIM_WHOAMI;
+    sim->regs[0][ICM_SIM_GYRO_CONFIG0] = ICM_SIM_CONFIG0_RESET;
+    sim->regs[0][ICM_SIM_ACCEL_CONFIG0] = ICM_SIM_CONFIG0_RESET;
+    sim->regs[0][ICM_SIM_GYRO_CONFIG1] = ICM_SIM_GYRO_CONFIG1_RESET;
+    sim->regs[0][ICM_SIM_ACCEL_CONFIG1] = ICM_SIM_ACCEL_CONFIG1_RESET;
+    sim->bank = 0;
+    sim->period_us = 0;
+    sim->queued = 0;
+    leave_critical_section(flags);
+}
+
+static void icm_sim_put16(FAR uint8_t *p, double value)
+{
+    int32_t v = (int32_t)lrint(value);
+    if (v > INT16_MAX) v = INT16_MAX;
+    if (v < INT16_MIN) v = INT16_MIN;
+    p[0] = (uint8_t)((uint16_t)v >> 8);
+    p[1] = (uint8_t)((uint16_t)v & 0xFF);
+}
+
+/* Uniform noise in [-1, 1) */
+static double icm_sim_noise(FAR struct icm_sim_s *sim)
+{
+    sim->seed = sim->seed * 1664525u + 1013904223u;
+    return (double)(int32_t)sim->seed / 2147483648.0;
+}
+
+/* Synthetic sample at sim time t_us: accel, gyro in counts at the current
+ * FS_SEL, big-endian X, Y, Z each
+ */
+static void icm_sim_synth(FAR struct icm_sim_s *sim, uint64_t t_us, FAR uint8_t *accel, FAR uint8_t *gyro)
+{
+    const double t = (double)t_us * 1e-6;
+    const double vib = 2.0 * ICM_SIM_ONE_PI * CONFIG_ASR_SDM_DRIVERS_ICM42688_SIM_VIBRATION_HZ * t;
+    const double vib_g = CONFIG_ASR_SDM_DRIVERS_ICM42688_SIM_VIBRATION_MG / 1000.0;
+    const double bias_dps = CONFIG_ASR_SDM_DRIVERS_ICM42688_SIM_GYRO_BIAS_MDPS / 1000.0;
+    const double accel_lsb = (double)(2048u << ((sim->regs[0][ICM_SIM_ACCEL_CONFIG0] >> 5) & 0x03));
+    const double gyro_lsb = 32768.0 * (double)(1u << (sim->regs[0][ICM_SIM_GYRO_CONFIG0] >> 5)) / 2000.0;
+    const double a[3] =
+    {
+        vib_g * sin(vib),
+        0.0,
+        1.0 + vib_g * sin(vib + 1.0),
+    };
+    const double g[3] =
+    {
+        bias_dps,
+        -bias_dps,
+        bias_dps + 20.0 * sin(2.0 * ICM_SIM_ONE_PI * 0.5 * t), /* +-20 dps yaw at 0.5 Hz */
+    };
+
+    for (int i = 0; i < 3; i++)
+    {
+        icm_sim_put16(&accel[2 * i], (a[i] + 0.002 * icm_sim_noise(sim)) * accel_lsb);
+        icm_sim_put16(&gyro[2 * i], (g[i] + 0.05 * icm_sim_noise(sim)) * gyro_lsb);
+    }
+}
+
+/* Next recorded packet, rewinding at the end; false once the recording
+ * cannot be read
+ */
+static bool icm_sim_replay(FAR struct icm_sim_s *sim, FAR uint8_t *pkt)
+{
+    for (int pass = 0; pass < 2; pass++)
+    {
+        if (file_read(&sim->replay, pkt, ICM_SIM_PACKET_LEN) == ICM_SIM_PACKET_LEN)
+            return true;
+        file_seek(&sim->replay, 0, SEEK_SET);
+    }
+    syslog(LOG_WARNING, "icm42688_sim: replay unreadable, switching to synthetic data\n");
+    file_close(&sim->replay);
+    sim->has_replay = false;
+    return false;
+}
+
+static void icm_sim_packet(FAR struct icm_sim_s *sim, uint64_t t_us, FAR uint8_t *pkt)
+{
+    if (sim->has_replay && icm_sim_replay(sim, pkt))
+        return;
+
+    pkt[0] = ICM_SIM_HDR;
+    icm_sim_synth(sim, t_us, &pkt[1], &pkt[7]);
+    pkt[13] = 0;                                  /* 25 degC */
+    pkt[14] = (uint8_t)((t_us >> 8) & 0xFF);      /* 1 us timestamp, 16 bits */
+    pkt[15] = (uint8_t)(t_us & 0xFF);
+}
+
+/* FIFO_DATA read: whole packets, the rest marked empty */
+static void icm_sim_fifo_read(FAR struct icm_sim_s *sim, FAR uint8_t *buf, size_t len)
+{
+    size_t want = len / ICM_SIM_PACKET_LEN;
+    irqstate_t flags = enter_critical_section();
+    icm_sim_advance(sim);
+    size_t n = want < sim->queued ? want : sim->queued;
+    uint64_t t_us = sim->head_us;
+    uint32_t period = sim->period_us;
+    sim->queued -= (uint32_t)n;
+    sim->head_us += n * period;
+    leave_critical_section(flags);
+
+    memset(buf, 0, len);
+    for (size_t i = 0; i < want; i++)
+    {
+        if (i < n)
+            icm_sim_packet(sim, t_us + i * period, &buf[i * ICM_SIM_PACKET_LEN]);
+        else
+            buf[i * ICM_SIM_PACKET_LEN] = ICM_SIM_HDR_EMPTY;
+    }
+    if (want == 0 && len > 0)
+        buf[0] = ICM_SIM_HDR_EMPTY;
+}
+
+/* Refresh FIFO_COUNT and the data registers before a BANK0 read */
+static void icm_sim_refresh(FAR struct icm_sim_s *sim)
+{
+    irqstate_t flags = enter_critical_section();
+    icm_sim_advance(sim);
+    uint16_t bytes = (uint16_t)(sim->queued * ICM_SIM_PACKET_LEN);
+    leave_critical_section(flags);
+
+    sim->regs[0][ICM_SIM_FIFO_COUNTH] = (uint8_t)(bytes >> 8);
+    sim->regs[0][ICM_SIM_FIFO_COUNTH + 1] = (uint8_t)(bytes & 0xFF);
+    sim->regs[0][ICM_SIM_TEMP_DATA1] = 0;
+    sim->regs[0][ICM_SIM_TEMP_DATA1 + 1] = 0;
+    icm_sim_synth(sim, icm_sim_now_us(), &sim->regs[0][ICM_SIM_TEMP_DATA1 + 2],
+                  &sim->regs[0][ICM_SIM_TEMP_DATA1 + 8]);
+}
+
+static void icm_sim_read(FAR struct icm_sim_s *sim, FAR uint8_t *buf, size_t len)
+{
+    if (sim->bank == 0 && sim->reg == ICM_SIM_FIFO_DATA)
+    {
+        icm_sim_fifo_read(sim, buf, len); /* the FIFO port does not auto-increment */
+        return;
+    }
+    if (sim->bank == 0)
+        icm_sim_refresh(sim);
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t reg = (uint8_t)((sim->reg + i) & 0x7F);
+        buf[i] = (reg == ICM_SIM_BANK_SEL) ? sim->bank : sim->regs[sim->bank][reg];
+    }
+    sim->reg = (uint8_t)(sim->reg + len);
+}
+
+static void icm_sim_write(FAR struct icm_sim_s *sim, uint8_t reg, uint8_t val)
+{
+    reg &= 0x7F;
+    if (reg == ICM_SIM_BANK_SEL)
+    {
+        sim->bank = (uint8_t)((val & 0x07) < ICM_SIM_BANKS ? (val & 0x07) : 0);
+        return;
+    }
+    sim->regs[sim->bank][reg] = val;
+    if (sim->bank != 0)
+        return;
+
+    switch (reg)
+    {
+        case ICM_SIM_DEVICE_CONFIG:
+            if (val & 0x01)
+                icm_sim_reset(sim);
+            break;
+        case ICM_SIM_SIGNAL_PATH_RESET:
+            if (val & ICM_SIM_FIFO_FLUSH)
+            {
+                irqstate_t flags = enter_critical_section();
+                icm_sim_advance(sim);
+                sim->queued = 0;
+                leave_critical_section(flags);
+            }
+            sim->regs[0][reg] = 0; /* self-clearing */
+            break;
+        case ICM_SIM_PWR_MGMT0:
+        case ICM_SIM_GYRO_CONFIG0:
+        case ICM_SIM_FIFO_CONFIG:
+            icm_sim_rebase(sim);
+            break;
+        case ICM_SIM_WHO_AM_I:
+            sim->regs[0][reg] = ICM_SIM_WHOAMI; /* read-only */
+            break;
+        default:
+            break;
+    }
+}
+
+static int icm_sim_transfer(FAR struct i2c_master_s *dev, FAR struct i2c_msg_s *msgs, int count)
+{
+    FAR struct icm_sim_s *sim = (FAR struct icm_sim_s *)dev;
+    uint32_t bits = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        FAR struct i2c_msg_s *msg = &msgs[i];
+        if (msg->addr != ICM_SIM_ADDR)
+            return -ENXIO; /* address NACK */
+        bits += ICM_SIM_MSG_BITS(msg->length);
+
+        if (msg->flags & I2C_M_READ)
+        {
+            icm_sim_read(sim, msg->buffer, msg->length);
+        }
+        else if (msg->length > 0)
+        {
+            sim->reg = msg->buffer[0];
+            for (ssize_t j = 1; j < msg->length; j++)
+                icm_sim_write(sim, sim->reg++, msg->buffer[j]);
+        }
+    }
+
+#ifdef CONFIG_ASR_SDM_DRIVERS_ICM42688_SIM_BUS_TIMING
+    uint32_t freq = (count > 0 && msgs[0].frequency > 0) ? msgs[0].frequency : 400000;
+    up_udelay((bits * 1000000u + freq - 1) / freq);
+#else
+    UNUSED(bits);
+#endif
+    return OK;
+}
+
+#ifdef CONFIG_I2C_RESET
+static int icm_sim_bus_reset(FAR struct i2c_master_s *dev)
+{
+    UNUSED(dev);
+    return OK;
+}
+#endif
+
+static const struct i2c_ops_s g_icm_sim_ops =
+{
+    icm_sim_transfer,  /* transfer */
+#ifdef CONFIG_I2C_RESET
+    icm_sim_bus_reset, /* reset */
+#endif
+};
+
+/* INT1 pulse: once per sample period while the FIFO is at or above the
+ * watermark (FIFO_CONFIG2/3, bytes) and the watermark interrupt is routed
+ * to INT1 (INT_SOURCE0)
+ */
+static void icm_sim_int1(wdparm_t arg)
+{
+    FAR struct icm_sim_s *sim = (FAR struct icm_sim_s *)arg;
+    uint32_t period = sim->period_us ? sim->period_us : 1000;
+    uint32_t wm = sim->regs[0][ICM_SIM_FIFO_CONFIG2] | ((sim->regs[0][ICM_SIM_FIFO_CONFIG3] & 0x0F) << 8);
+
+    irqstate_t flags = enter_critical_section();
+    icm_sim_advance(sim);
+    bool pulse = sim->isr != NULL && sim->period_us != 0 &&
+                 (sim->regs[0][ICM_SIM_INT_SOURCE0] & ICM_SIM_FIFO_THS_INT1) != 0 &&
+                 sim->queued > 0 && sim->queued * ICM_SIM_PACKET_LEN >= wm;
+    leave_critical_section(flags);
+    if (pulse)
+        sim->isr(0, NULL, sim->isr_arg);
+
+    sclock_t ticks = USEC2TICK(period);
+    wd_start(&sim->wdog, ticks > 0 ? ticks : 1, icm_sim_int1, arg);
+}
+
+int icm42688_sim_attach(xcpt_t isr, FAR void *arg)
+{
+    FAR struct icm_sim_s *sim = &g_icm_sim;
+
+    wd_cancel(&sim->wdog);
+    sim->isr = isr;
+    sim->isr_arg = arg;
+    if (isr == NULL)
+        return OK;
+    return wd_start(&sim->wdog, 1, icm_sim_int1, (wdparm_t)sim);
+}
+
+FAR struct i2c_master_s *icm42688_sim_initialize(void)
+{
+    FAR struct icm_sim_s *sim = &g_icm_sim;
+
+    if (sim->initialized)
+        return &sim->dev;
+
+    sim->dev.ops = &g_icm_sim_ops;
+    sim->seed = 0x42688u;
+    icm_sim_reset(sim);
+
+    /* The recording lives in the sim's file system, e.g. a hostfs mount */
+    const char *replay = CONFIG_ASR_SDM_DRIVERS_ICM42688_SIM_REPLAY;
+    if (replay[0] != '\0')
+    {
+        int ret = file_open(&sim->replay, replay, O_RDONLY);
+        sim->has_replay = (ret >= 0);
+        syslog(sim->has_replay ? LOG_INFO : LOG_WARNING, "icm42688_sim: replay %s: %d%s\n",
+               replay, ret, sim->has_replay ? "" : ", using synthetic data");
+    }
+
+    sim->initialized = true;
+    return &sim->dev;
+}